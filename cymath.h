@@ -1,9 +1,13 @@
+// cymath.h includes itself to instantiate its kernels for each precision and SIMD level, see the passes at the end
+#if !defined(ICYM_PRECISION_PASS) && !defined(ICYM_KERNEL_PASS) && !defined(ICYM_API_PASS)
+
 #ifndef CMATH_HEADER
 #define CMATH_HEADER
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -23,8 +27,26 @@ CYM_FLOAT cym_absf(CYM_FLOAT x);
 double cym_Q_rsqrt_d(double number);
 // if the norm of vector is 0 the ouput vector will be filled with 0
 CYM_FLOAT cym_normalize_vec(const CYM_FLOAT* vector, unsigned int size, CYM_FLOAT* ouput);
-// It is NOT safe to pass one of the input matrices as output to this funtion
+// normalizes the count vectors of dim elements stored one after the other in vectors (vector i at vectors + i * dim),
+// writing them to output (which may be vectors) and their norms to norms unless it is NULL, zero vectors are left zero
+// fast allows the hardware reciprocal square root estimate with one newton step (see cym_rsqrt_batch)
+void cym_normalize_vecs(const CYM_FLOAT* vectors, size_t count, size_t dim, CYM_FLOAT* output, CYM_FLOAT* norms, int fast);
+// same as cym_normalize_vecs for vectors stored by component (element k of vector i at vectors[k * count + i]), which
+// vectorizes across the vectors, so it is the faster layout for short ones
+void cym_normalize_vecs_soa(const CYM_FLOAT* vectors, size_t count, size_t dim, CYM_FLOAT* output, CYM_FLOAT* norms, int fast);
+// out[i] = 1 / sqrt(x[i]) for n values, correctly rounded root then division unless fast, which takes the hardware estimate
+// refined by one newton step where the cpu has one (about 22 correct bits for float, 27 for double with AVX-512)
+// out may be x
+void cym_rsqrt_batch(const CYM_FLOAT* x, size_t n, CYM_FLOAT* out, int fast);
+// out[i] = sqrt(x[i]) correctly rounded for n values, out may be x
+void cym_sqrt_batch(const CYM_FLOAT* x, size_t n, CYM_FLOAT* out);
+// It is safe to pass the input matrix as output to this funtion, it is then transposed in place
+// (see cym_mat_transpose_inplace), otherwise they must not overlap
 void cym_mat_transpose(const CYM_FLOAT* input, unsigned int sizex, unsigned int sizey, CYM_FLOAT* output);
+// transposes the sizey x sizex matrix mat in place, square matrices are swapped block by block and the others follow the
+// cycles of the permutation, using one bit of scratch per element instead of a second matrix
+// \returns 0 on success, 1 if the scratch bits could not be allocated (mat is left untouched)
+int cym_mat_transpose_inplace(CYM_FLOAT* mat, unsigned int sizex, unsigned int sizey);
 // It is safe to pass one of the input matrices as output to this funtion
 void cym_mat_scale(CYM_FLOAT scalar, const CYM_FLOAT* mat, unsigned int sizex, unsigned int sizey, CYM_FLOAT* output);
 // It is safe to pass one of the input matrices as output to this funtion
@@ -33,611 +55,7294 @@ void cym_mat_sum(const CYM_FLOAT* mat1, const CYM_FLOAT* mat2, unsigned int size
 void cym_mat_sub(const CYM_FLOAT* mat1, const CYM_FLOAT* mat2, unsigned int sizex, unsigned int sizey, CYM_FLOAT* output);
 // It is NOT safe to pass one of the input matrices as output to this funtion
 void cym_mat_multiply(const CYM_FLOAT* mat_1, unsigned int mat1_sizex, unsigned int mat1_sizey,const CYM_FLOAT* mat_2, unsigned int mat2_sizex, CYM_FLOAT* output);
-// solves the system a * x = y through gauss method, outputing the result to x
-// this modifies the memory at a and y
+// general matrix multiply c = alpha * a * b + beta * c, where a is m x k, b is k x n and c is m x n, each given with its
+// row and column strides (in elements) so transposes and submatrices can be passed without copying
+// when beta is 0 c is only written, it is NOT safe for c to overlap a or b
+void cym_gemm(size_t m, size_t n, size_t k, CYM_FLOAT alpha, const CYM_FLOAT* a, ptrdiff_t a_rs, ptrdiff_t a_cs,
+    const CYM_FLOAT* b, ptrdiff_t b_rs, ptrdiff_t b_cs, CYM_FLOAT beta, CYM_FLOAT* c, ptrdiff_t c_rs, ptrdiff_t c_cs);
+// X==============X BLAS 1 X=================X
+// element-wise vector kernels, element i of a vector is x[i * incx], negative increments walk backwards from x,
+// unit increments go through the SIMD kernels. Outputs must not overlap the inputs unless they are the same vector
+
+// y = alpha * x + y
+void cym_axpy(size_t n, CYM_FLOAT alpha, const CYM_FLOAT* x, ptrdiff_t incx, CYM_FLOAT* y, ptrdiff_t incy);
+// y = alpha * x + beta * y, when beta is 0 y is only written
+void cym_axpby(size_t n, CYM_FLOAT alpha, const CYM_FLOAT* x, ptrdiff_t incx, CYM_FLOAT beta, CYM_FLOAT* y, ptrdiff_t incy);
+// w = alpha * x + beta * y in a single pass
+void cym_waxpby(size_t n, CYM_FLOAT alpha, const CYM_FLOAT* x, ptrdiff_t incx, CYM_FLOAT beta, const CYM_FLOAT* y, ptrdiff_t incy,
+    CYM_FLOAT* w, ptrdiff_t incw);
+// x = alpha * x
+void cym_scal(size_t n, CYM_FLOAT alpha, CYM_FLOAT* x, ptrdiff_t incx);
+CYM_FLOAT cym_dot(size_t n, const CYM_FLOAT* x, ptrdiff_t incx, const CYM_FLOAT* y, ptrdiff_t incy);
+// euclidean norm of x, rescaled when the sum of squares would overflow or underflow
+CYM_FLOAT cym_nrm2(size_t n, const CYM_FLOAT* x, ptrdiff_t incx);
+// sum of the absolute values of x
+CYM_FLOAT cym_asum(size_t n, const CYM_FLOAT* x, ptrdiff_t incx);
+// \returns the index of the first element of x with the biggest absolute value, 0 when n is 0
+size_t cym_iamax(size_t n, const CYM_FLOAT* x, ptrdiff_t incx);
+// solves the system a * x = y through gauss method (LU with partial pivoting), outputing the result to x
+// this modifies the memory at a (it is left holding the LU factors), y is left untouched and may be x
 void cym_solve_gauss(CYM_FLOAT* a, CYM_FLOAT* y, unsigned int size, CYM_FLOAT* x);
+// factors the size x size matrix a in place as P * a = L * U with partial pivoting, L (unit lower triangular, its diagonal
+// is not stored) and U sharing a, and writes to pivots[i] the line swapped with line i at step i
+// the factors can then be reused by cym_lu_solve, cym_lu_solve_many, cym_lu_determinant and cym_lu_inverse
+// \returns 0 on success, or 1 + the first column without a non zero pivot (a is still fully factored)
+int cym_lu_factor(CYM_FLOAT* a, unsigned int size, unsigned int* pivots);
+// solves a * x = y with the factors of a from cym_lu_factor, it is safe to pass y as x
+void cym_lu_solve(const CYM_FLOAT* lu, const unsigned int* pivots, unsigned int size, const CYM_FLOAT* y, CYM_FLOAT* x);
+// solves a * x = y for the count columns of the size x count matrix y at once, it is safe to pass y as x
+void cym_lu_solve_many(const CYM_FLOAT* lu, const unsigned int* pivots, unsigned int size, const CYM_FLOAT* y, unsigned int count, CYM_FLOAT* x);
+CYM_FLOAT cym_lu_determinant(const CYM_FLOAT* lu, const unsigned int* pivots, unsigned int size);
+// writes the inverse of a to output (which must not be lu)
+void cym_lu_inverse(const CYM_FLOAT* lu, const unsigned int* pivots, unsigned int size, CYM_FLOAT* output);
+// factors the rows x columns matrix a (rows >= columns) in place as a = Q * R with Householder reflections, blocked so
+// most of the work goes through the gemm: R is written over the upper triangle and the reflectors H_j = I - tau[j] * v * v^T
+// below the diagonal (v[j] = 1 is not stored), Q = H_0 * H_1 * ... * H_(columns - 1)
+// \returns 0 on success, 1 if rows < columns or the scratch could not be allocated
+int cym_qr_factor(CYM_FLOAT* a, size_t rows, size_t columns, CYM_FLOAT* tau);
+// b = Q^T * b for the rows x count matrix b, with the factors of cym_qr_factor
+void cym_qr_apply_qt(const CYM_FLOAT* qr, const CYM_FLOAT* tau, size_t rows, size_t columns, CYM_FLOAT* b, size_t count);
+// factors the symmetric positive definite size x size matrix a in place as a = R^T * R, R (upper triangular) being written
+// over the upper triangle, the lower one is used as scratch
+// \returns 0 on success, or 1 + the first column whose pivot is not positive
+int cym_cholesky_factor(CYM_FLOAT* a, unsigned int size);
+// solves a * x = y with the factor of a from cym_cholesky_factor, it is safe to pass y as x
+void cym_cholesky_solve(const CYM_FLOAT* r, unsigned int size, const CYM_FLOAT* y, CYM_FLOAT* x);
+
+// the methods of the least squares solvers
+enum CymLsqFlags{
+    // Householder QR of a, the default, stable for any full rank a
+    CYM_LSQ_QR       = 0,
+    // Cholesky of the normal equations a^T * a, twice as fast but it squares the condition number, falls back to the QR
+    // when a^T * a is not numerically positive definite
+    CYM_LSQ_CHOLESKY = 1,
+    // scales the columns of a to unit norm before solving (cym_lstsq only, the polynomial fits always map x to [-1, 1])
+    CYM_LSQ_SCALE    = 2
+};
+
+// writes to x (columns x count) the x minimizing |a * x - b| for each of the count columns of b (rows x count), rows >= columns
+// flags is a combination of CymLsqFlags, a and b are used as scratch
+// \returns 0 on success, 1 if a does not have full column rank, rows < columns or the scratch could not be allocated
+int cym_lstsq(CYM_FLOAT* a, size_t rows, size_t columns, CYM_FLOAT* b, size_t count, CYM_FLOAT* x, int flags);
 // takes a vector and outputs an unitary matrice with its first column proportional to that vector
 // It is safe to pass the input vector as output to this funtion
 // \returns 0 on success or 1 if the input vector is zero (it still writes a 0 matrice to output)
 int cym_make_unitary(const CYM_FLOAT* input, unsigned int size, CYM_FLOAT* output);
+// the unitary of cym_make_unitary kept in size values: writes to w the unit vector of the Householder reflector
+// U = I - 2 w w^T whose first column is input / |input|, w being 0 when that is already the first column of I
+// \returns 0 on success or 1 if the input vector is zero (w is then 0)
+int cym_make_unitary_reflector(const CYM_FLOAT* input, unsigned int size, CYM_FLOAT* w);
+// x = U * x for the reflector w of cym_make_unitary_reflector and the size x count matrix x, without forming U
+// U being symmetric and its own inverse, this also applies its transpose and inverse
+void cym_apply_unitary_reflector(const CYM_FLOAT* w, unsigned int size, CYM_FLOAT* x, size_t count);
+// \returns 1 if every element of mat^T * mat is within accuracy of the identity (for a square matrix mat * mat^T then is
+// as well), 0 otherwise
 int cym_test_unitary(const CYM_FLOAT* mat, unsigned int size, double accuracy);
+// cym_test_unitary computing the upper half of mat^T * mat by blocks of lines through the gemm, on the heap, and stopping at
+// the first block out of accuracy, the biggest deviation from the identity seen is written to deviation unless it is NULL
+// \returns 1 if mat is unitary, 0 if not, -1 if the blocks could not be allocated (deviation is then NaN)
+int cym_test_unitary_deviation(const CYM_FLOAT* mat, unsigned int size, double accuracy, double* deviation);
 void cym_mat_print(const char* name, const CYM_FLOAT* mat, unsigned int sizex, unsigned int sizey);
 
+// X==============X MATRIX VIEWS X=================X
+// a rows x columns matrix whose element (i, j) is data[i * stride + j * cstride], so submatrices, lines, columns and
+// transposes of a matrix are views of its memory instead of copies, a dense row major matrix has stride = columns
+// and cstride = 1, CYM_IMAT_d and CYM_IMAT_f are the double and float views
+typedef struct CYM_IMAT{
+    CYM_FLOAT* data;
+    size_t     rows;
+    size_t     columns;
+    ptrdiff_t  stride;
+    ptrdiff_t  cstride;
+} CYM_IMAT;
+typedef struct CYM_IMAT_d{
+    double*   data;
+    size_t    rows;
+    size_t    columns;
+    ptrdiff_t stride;
+    ptrdiff_t cstride;
+} CYM_IMAT_d;
+typedef struct CYM_IMAT_f{
+    float*    data;
+    size_t    rows;
+    size_t    columns;
+    ptrdiff_t stride;
+    ptrdiff_t cstride;
+} CYM_IMAT_f;
+
+// element (I, J) of the view M, as an lvalue
+#define CYM_IMAT_AT(M, I, J) ((M).data[(ptrdiff_t)(I) * (M).stride + (ptrdiff_t)(J) * (M).cstride])
+
+// the dense row major rows x columns matrix at data
+CYM_IMAT cym_imat(CYM_FLOAT* data, size_t rows, size_t columns);
+// the rows x columns block of m whose top left element is (row, column)
+CYM_IMAT cym_imat_sub(CYM_IMAT m, size_t row, size_t column, size_t rows, size_t columns);
+// line i of m as a 1 x columns view
+CYM_IMAT cym_imat_row(CYM_IMAT m, size_t i);
+// column j of m as a rows x 1 view
+CYM_IMAT cym_imat_col(CYM_IMAT m, size_t j);
+CYM_IMAT cym_imat_transpose(CYM_IMAT m);
+// c = alpha * a * b + beta * c through the gemm, c must not overlap a or b
+// \returns 0 on success, 1 if the shapes do not match
+int cym_imat_multiply(CYM_FLOAT alpha, CYM_IMAT a, CYM_IMAT b, CYM_FLOAT beta, CYM_IMAT c);
+// y = alpha * x + beta * y element by element, when beta is 0 y is only written
+// \returns 0 on success, 1 if the shapes do not match
+int cym_imat_axpby(CYM_FLOAT alpha, CYM_IMAT x, CYM_FLOAT beta, CYM_IMAT y);
+// copies src to dst, copying a transposed view transposes
+// \returns 0 on success, 1 if the shapes do not match
+int cym_imat_copy(CYM_IMAT src, CYM_IMAT dst);
+// output = mat1 * mat2, output being dense (mat1.rows x mat2.columns) and not overlapping the views
+// \returns 0 on success, 1 if mat1.columns != mat2.rows
+int cym_smatmul(CYM_IMAT mat1, CYM_IMAT mat2, CYM_FLOAT* output);
+
+// X==============X COMPLEX MATRICES X=================X
+// complex matrices are row major arrays of CymComplex, the real part of each element followed by its imaginary part, which is
+// the layout of C99 double _Complex (float _Complex) and C++ std::complex<double> (std::complex<float>), so arrays of those can
+// be passed cast to CymComplex_d* (CymComplex_f*), CymComplex being the CYM_FLOAT one
+
+typedef struct CymComplex{
+    CYM_FLOAT re;
+    CYM_FLOAT im;
+} CymComplex;
+typedef struct CymComplex_d{
+    double re;
+    double im;
+} CymComplex_d;
+typedef struct CymComplex_f{
+    float re;
+    float im;
+} CymComplex_f;
+
+// the operands cym_cgemm conjugates
+enum CymConjFlags{
+    CYM_CONJ_A = 1,
+    CYM_CONJ_B = 2
+};
+
+// complex general matrix multiply c = alpha * op(a) * op(b) + beta * c, op conjugating the operands named in conjugate
+// (a combination of CymConjFlags), with the shapes and strides (in complex elements) of cym_gemm, so conjugate transposes
+// are a swap of strides and the flag. It runs as real gemms on the real and imaginary parts
+// when beta is 0 c is only written, it is NOT safe for c to overlap a or b
+void cym_cgemm(size_t m, size_t n, size_t k, CymComplex alpha, const CymComplex* a, ptrdiff_t a_rs, ptrdiff_t a_cs,
+    const CymComplex* b, ptrdiff_t b_rs, ptrdiff_t b_cs, CymComplex beta, CymComplex* c, ptrdiff_t c_rs, ptrdiff_t c_cs,
+    int conjugate);
+// the complex cym_mat_multiply, it is NOT safe to pass one of the input matrices as output
+void cym_cmat_multiply(const CymComplex* mat_1, unsigned int mat1_sizex, unsigned int mat1_sizey, const CymComplex* mat_2,
+    unsigned int mat2_sizex, CymComplex* output);
+// writes the transpose of the sizey x sizex matrix input to output, which must not overlap it unless output is input (it
+// is then transposed in place, following the cycles of the permutation like cym_mat_transpose_inplace if not square)
+void cym_cmat_transpose(const CymComplex* input, unsigned int sizex, unsigned int sizey, CymComplex* output);
+// cym_cmat_transpose also conjugating the elements, the adjoint (dagger) of input
+void cym_cmat_conj_transpose(const CymComplex* input, unsigned int sizex, unsigned int sizey, CymComplex* output);
+// It is safe to pass the input matrix as output to this funtion
+void cym_cmat_scale(CymComplex scalar, const CymComplex* mat, unsigned int sizex, unsigned int sizey, CymComplex* output);
+// It is safe to pass one of the input matrices as output to this funtion
+void cym_cmat_sum(const CymComplex* mat1, const CymComplex* mat2, unsigned int sizex, unsigned int sizey, CymComplex* output);
+// factors the complex size x size matrix a in place as P * a = L * U with partial pivoting, as cym_lu_factor
+// \returns 0 on success, or 1 + the first column without a non zero pivot (a is still fully factored)
+int cym_clu_factor(CymComplex* a, unsigned int size, unsigned int* pivots);
+// solves a * x = y with the factors of a from cym_clu_factor, it is safe to pass y as x
+void cym_clu_solve(const CymComplex* lu, const unsigned int* pivots, unsigned int size, const CymComplex* y, CymComplex* x);
+// solves the complex system a * x = y through gauss method (LU with partial pivoting), outputing the result to x
+// this modifies the memory at a (it is left holding the LU factors), y is left untouched and may be x
+// \returns 0 on success, 1 if a is singular or the pivots could not be allocated (x is then NaN)
+int cym_csolve_gauss(CymComplex* a, const CymComplex* y, unsigned int size, CymComplex* x);
+// \returns 1 if every element of mat * mat^dagger is within accuracy (in modulus) of the identity, 0 otherwise
+int cym_ctest_unitary(const CymComplex* mat, unsigned int size, double accuracy);
+// cym_ctest_unitary computing the upper half of mat * mat^dagger by blocks of lines on the heap and stopping at the first
+// block out of accuracy, the biggest deviation from the identity seen is written to deviation unless it is NULL
+// \returns 1 if mat is unitary, 0 if not, -1 if the blocks could not be allocated (deviation is then NaN)
+int cym_ctest_unitary_deviation(const CymComplex* mat, unsigned int size, double accuracy, double* deviation);
+
 // X==============X DATA ANALYSIS X=================X
 
-// performs a polynomial interolation and outputs the coefficients to output in order of smallest power coefficient to biggest
-// \returns 0 on success, 1 otherwise
+// performs a polynomial interolation and outputs the coefficients to output in order of smallest power coefficient to biggest,
+// through the Newton divided differences of the nodes in Leja order converted in place to the monomial basis, in O(n^2)
+// the monomial coefficients of many points are badly conditioned, the Newton and barycentric forms below evaluate better
+// \returns 0 on success, 1 if two x are equal or the workspace could not be allocated (output is then NaN)
 int cym_interpol(const CYM_FLOAT* x, const CYM_FLOAT* y, size_t number_of_points, CYM_FLOAT* output);
-// performs a linear fit of the form y = A*x + B
+// computes the Newton divided differences of the n points in O(n^2), first writing x to nodes in Leja order (the node of
+// biggest magnitude, then each time the one with the biggest product of distances to those before it), without which the
+// Newton form of more than a few dozen nodes loses accuracy. coefficients[k] = y[nodes_0, ..., nodes_k] so that the
+// interpolating polynomial is c_0 + (t - nodes_0) * (c_1 + (t - nodes_1) * (c_2 + ...)), nodes may be x and coefficients
+// may be y (they are then reordered in place). The ordering takes n doubles of scratch, on the heap past about 2000 nodes
+// the rounding errors of the coefficients grow as (4 / span of the nodes)^k, so they overflow past about 1050 nodes
+// spanning 2 in double (150 in float), where the barycentric form below still works
+// \returns 0 on success, 1 if two x are equal or the scratch could not be allocated (coefficients are then NaN)
+int cym_newton_coefficients(const CYM_FLOAT* x, const CYM_FLOAT* y, size_t n, CYM_FLOAT* nodes, CYM_FLOAT* coefficients);
+// evaluates the Newton form of cym_newton_coefficients at t in O(n), nodes being the ordered nodes it wrote
+CYM_FLOAT cym_newton_eval(const CYM_FLOAT* nodes, const CYM_FLOAT* coefficients, size_t n, CYM_FLOAT t);
+// evaluates the Newton form at the count values of t into out, SIMD over the values and split over the thread pool
+void cym_newton_eval_batch(const CYM_FLOAT* nodes, const CYM_FLOAT* coefficients, size_t n, const CYM_FLOAT* t, size_t count,
+    CYM_FLOAT* out);
+// converts the Newton form to the n monomial coefficients (smallest power first) in O(n^2), output may be coefficients
+void cym_newton_to_monomial(const CYM_FLOAT* nodes, const CYM_FLOAT* coefficients, size_t n, CYM_FLOAT* output);
+// computes the barycentric weights 1 / prod_{k != j} (x_j - x_k) of the n nodes in O(n^2), the differences scaled by 4 over the
+// span of the nodes and the weights by their biggest so they neither overflow nor underflow (the evaluation does not see it)
+// \returns 0 on success, 1 if two x are equal (weights are then NaN)
+int cym_barycentric_weights(const CYM_FLOAT* x, size_t n, CYM_FLOAT* weights);
+// evaluates the interpolating polynomial of the n points at t in O(n) through the second barycentric form, which is stable
+// for nodes clustered at the ends (e.g. Chebyshev), t being one of the nodes giving its y
+CYM_FLOAT cym_barycentric_eval(const CYM_FLOAT* x, const CYM_FLOAT* y, const CYM_FLOAT* weights, size_t n, CYM_FLOAT t);
+// evaluates cym_barycentric_eval at the count values of t into out, SIMD over the values and split over the thread pool
+void cym_barycentric_eval_batch(const CYM_FLOAT* x, const CYM_FLOAT* y, const CYM_FLOAT* weights, size_t n, const CYM_FLOAT* t,
+    size_t count, CYM_FLOAT* out);
+// performs a linear fit of the form y = A*x + B through a fit accumulator, A, B and r are NaN if the x values are all the same
 void cym_linear_fit(const CYM_FLOAT* x, const CYM_FLOAT* y, size_t number_of_points, CYM_FLOAT* a, CYM_FLOAT* b, CYM_FLOAT* r);
-// performs a wheighted linear fit of the form y = A*x + B
+// performs a linear fit of the form y = A*x + B with errors dx and dy on both axes, the points being weighted by
+// 1 / (dy^2 + A^2 dx^2) and A found by fixed point iteration from the unweighted fit, accelerated with Aitken's extrapolation,
+// each iteration being a single parallel SIMD pass. dA and dB are the standard errors, r the correlation of the unweighted fit
+// \returns 0 on success, 1 if the points are degenerate (the outputs are NaN) or A did not converge (the last estimates are kept)
 int cym_rlinear_fit(const CYM_FLOAT* x, const CYM_FLOAT* y, const CYM_FLOAT* dx, const CYM_FLOAT* dy, size_t number_of_points, CYM_FLOAT* a, CYM_FLOAT* b, CYM_FLOAT* da, CYM_FLOAT* db ,CYM_FLOAT* r);
-// performs a polynomial fit of the form y = sum_n a_n * x^n
+// performs cym_rlinear_fit on series datasets of number_of_points points at once, dataset s having its points at x, y, dx and
+// dy + s * number_of_points and its results at a[s], b[s], da[s], db[s] and r[s], the datasets being split over the thread pool
+// slopes holds the starting slope of each dataset (a warm start, e.g. the slope of a previous fit of similar data) or is NULL
+// to start from the unweighted fits, r may be NULL, which skips the unweighted pass when slopes are given
+// \returns 0 on success, 1 if some dataset could not be fitted
+int cym_rlinear_fit_batch(const CYM_FLOAT* x, const CYM_FLOAT* y, const CYM_FLOAT* dx, const CYM_FLOAT* dy, size_t number_of_points,
+    size_t series, const CYM_FLOAT* slopes, CYM_FLOAT* a, CYM_FLOAT* b, CYM_FLOAT* da, CYM_FLOAT* db, CYM_FLOAT* r);
+// performs a least squares polynomial fit of the form y = sum_n a_n * x^n, through the QR of the design matrix with x mapped to
+// [-1, 1], streamed by blocks of points so it needs no more memory than a few hundred lines of it
+// \returns 0 on success, 1 if order is negative or the points do not determine the polynomial
 int cym_poly_fit(const CYM_FLOAT* x, const CYM_FLOAT* y, size_t number_of_points, int order, CYM_FLOAT* output);
+// fits series polynomials of the given order at once, series s having its number_of_points y values at y + s * number_of_points,
+// its x values at x + s * x_stride (0 for all the series sharing the same x, which are then solved together) and its
+// order + 1 coefficients written to output + s * (order + 1), flags being CYM_LSQ_QR or CYM_LSQ_CHOLESKY
+// \returns 0 on success, 1 if some series could not be fitted (their coefficients are NaN)
+int cym_poly_fit_batch(const CYM_FLOAT* x, size_t x_stride, const CYM_FLOAT* y, size_t number_of_points, size_t series,
+    int order, int flags, CYM_FLOAT* output);
+// evaluates the polys polynomials of the given order (order + 1 coefficients each, smallest power first, one polynomial after
+// the other as cym_poly_fit_batch writes them) at the n values of x, writing polynomial p at x[i] to out[p * n + i]
+void cym_poly_eval_batch(const CYM_FLOAT* coefficients, int order, size_t polys, const CYM_FLOAT* x, size_t n, CYM_FLOAT* out);
+// computes the residuals y - p(x) of the polynomial of the given order over the n points in a single pass, writing them to
+// residuals unless it is NULL and the coefficient of determination R^2 to r2 unless it is NULL (NaN when y is constant)
+// \returns the sum of the squared residuals
+CYM_FLOAT cym_poly_residuals(const CYM_FLOAT* coefficients, int order, const CYM_FLOAT* x, const CYM_FLOAT* y, size_t n,
+    CYM_FLOAT* residuals, CYM_FLOAT* r2);
+
+// X==============X WORKSPACES X=================X
+// the functions below that need temporaries also come as name_ws, taking them from the workspace_size bytes at workspace
+// instead of the heap, so a loop calling them with the same sizes allocates nothing. name_workspace_size gives the bytes
+// a workspace needs for the sizes and the current number of threads (any alignment will do), it also has _d and _f versions
+// Smaller workspaces make the gemm use fewer threads or its unpacked loops and the fits run serially, a workspace too small
+// for the rest is an error
+
+size_t cym_gemm_workspace_size(size_t m, size_t n, size_t k);
+void cym_gemm_ws(size_t m, size_t n, size_t k, CYM_FLOAT alpha, const CYM_FLOAT* a, ptrdiff_t a_rs, ptrdiff_t a_cs,
+    const CYM_FLOAT* b, ptrdiff_t b_rs, ptrdiff_t b_cs, CYM_FLOAT beta, CYM_FLOAT* c, ptrdiff_t c_rs, ptrdiff_t c_cs,
+    void* workspace, size_t workspace_size);
+// the panels are factored in place when the workspace does not hold them
+size_t cym_lu_factor_workspace_size(unsigned int size);
+int cym_lu_factor_ws(CYM_FLOAT* a, unsigned int size, unsigned int* pivots, void* workspace, size_t workspace_size);
+// x is NaN when the workspace does not hold the pivots
+size_t cym_solve_gauss_workspace_size(unsigned int size);
+void cym_solve_gauss_ws(CYM_FLOAT* a, CYM_FLOAT* y, unsigned int size, CYM_FLOAT* x, void* workspace, size_t workspace_size);
+size_t cym_qr_factor_workspace_size(size_t rows, size_t columns);
+int cym_qr_factor_ws(CYM_FLOAT* a, size_t rows, size_t columns, CYM_FLOAT* tau, void* workspace, size_t workspace_size);
+// for cym_test_unitary_deviation_ws, which is cym_test_unitary as well with a NULL deviation
+size_t cym_test_unitary_workspace_size(unsigned int size);
+int cym_test_unitary_deviation_ws(const CYM_FLOAT* mat, unsigned int size, double accuracy, double* deviation,
+    void* workspace, size_t workspace_size);
+// cym_interpol takes the ordered nodes and their Leja scores from the workspace
+size_t cym_interpol_workspace_size(size_t number_of_points);
+int cym_interpol_ws(const CYM_FLOAT* x, const CYM_FLOAT* y, size_t number_of_points, CYM_FLOAT* output, void* workspace,
+    size_t workspace_size);
+size_t cym_poly_fit_workspace_size(size_t number_of_points, int order);
+int cym_poly_fit_ws(const CYM_FLOAT* x, const CYM_FLOAT* y, size_t number_of_points, int order, CYM_FLOAT* output,
+    void* workspace, size_t workspace_size);
+size_t cym_lstsq_workspace_size(size_t rows, size_t columns, size_t count, int flags);
+int cym_lstsq_ws(CYM_FLOAT* a, size_t rows, size_t columns, CYM_FLOAT* b, size_t count, CYM_FLOAT* x, int flags, void* workspace,
+    size_t workspace_size);
+// cym_lm_solve and the sparse solvers have theirs next to them
+
+// X==============X ROOT FINDING X=================X
+
+// the function whose root is searched, user being passed through
+typedef CYM_FLOAT (*CymRootFn)(CYM_FLOAT x, void* user);
+typedef double    (*CymRootFn_d)(double x, void* user);
+typedef float     (*CymRootFn_f)(float x, void* user);
+// evaluates the function at the count values of x into fx, index[i] being the number of the root x[i] belongs to in the batch
+// (the roots still searched are packed together every step, so this is a plain loop over contiguous arrays)
+typedef void (*CymRootBatchFn)(const CYM_FLOAT* x, const size_t* index, CYM_FLOAT* fx, size_t count, void* user);
+typedef void (*CymRootBatchFn_d)(const double* x, const size_t* index, double* fx, size_t count, void* user);
+typedef void (*CymRootBatchFn_f)(const float* x, const size_t* index, float* fx, size_t count, void* user);
+
+enum CymRootMethod{
+    // inverse quadratic interpolation and secant steps, falling back to bisection when they do not shrink the bracket
+    CYM_ROOT_BRENT = 0,
+    // regula falsi halving the value kept at the end that did not move twice in a row
+    CYM_ROOT_ILLINOIS
+};
+
+enum CymRootStatus{
+    CYM_ROOT_CONVERGED = 0,
+    // the values at both ends of the bracket have the same sign (or are NaN), the root is NaN
+    CYM_ROOT_NO_BRACKET,
+    // CYM_ROOT_ITERATIONS steps were not enough, the root is the best estimate
+    CYM_ROOT_MAX_ITERATIONS,
+    // the workspace of a batch could not be allocated, its roots are NaN
+    CYM_ROOT_FAILED
+};
+
+typedef struct CymRootStats{
+    // a CymRootStatus, the worst one of a batch
+    int    status;
+    // the steps taken, the lock-step rounds of the longest block of a batch
+    int    iterations;
+    // the function values computed
+    size_t evaluations;
+    // the roots of a batch that did not converge
+    size_t failures;
+} CymRootStats;
+
+// finds x in [a, b] with function(x) = value, function(a) - value and function(b) - value having opposite signs, to within
+// tolerance (plus a few ulps of x), method being a CymRootMethod, stats may be NULL
+// \returns the root, NaN if [a, b] does not bracket one
+CYM_FLOAT cym_root_bracket(CymRootFn function, void* user, CYM_FLOAT a, CYM_FLOAT b, CYM_FLOAT value, CYM_FLOAT tolerance,
+    int method, CymRootStats* stats);
+// secant search from guess and guess + step, every step reusing the previous value so it costs one call, switching to Brent's
+// method on the two latest points once they bracket the root, stats may be NULL
+// \returns the root, the last estimate if it did not converge
+CYM_FLOAT cym_root_secant(CymRootFn function, void* user, CYM_FLOAT guess, CYM_FLOAT step, CYM_FLOAT value, CYM_FLOAT tolerance,
+    CymRootStats* stats);
+// solves function(x) = value[i] in [a[i], b[i]] for the count roots at once: blocks of roots advance in lock-step and each step
+// evaluates all the roots of a block still searched in a single call, the blocks being split over the thread pool (function
+// must be thread safe), roots that do not converge are counted in stats->failures, stats may be NULL
+// \returns 0 when every root converged, 1 otherwise
+int cym_root_batch(CymRootBatchFn function, void* user, const CYM_FLOAT* a, const CYM_FLOAT* b, const CYM_FLOAT* value,
+    size_t count, CYM_FLOAT tolerance, int method, CYM_FLOAT* roots, CymRootStats* stats);
+// solves function(x) = value to within accuracy on the value, starting from guess, as cym_root_secant with guess + step as its
+// second point (so one call per step instead of the two of a forward difference Newton step)
 CYM_FLOAT cym_newton_method(CYM_FLOAT (*function)(CYM_FLOAT), CYM_FLOAT guess, CYM_FLOAT value, CYM_FLOAT accuracy, CYM_FLOAT step);
 
+// X==============X FIT ACCUMULATORS X=================X
+// streaming linear and polynomial fits: points are pushed one by one or in batches into an accumulator, accumulators
+// filled separately (per thread, per file, per chunk) are merged, and the fit is solved from the result at any time
+// the sums are kept in double with a compensation term each (Neumaier), so billions of points lose no more precision
+// than a few hundred, and they are taken around center, which should be close to the middle of the x values
+
+// highest polynomial order the accumulators can fit
+#ifndef CYM_FIT_MAX_ORDER
+#define CYM_FIT_MAX_ORDER 16
+#endif
+
+typedef struct CymFitAcc{
+    int      order;
+    double   center;
+    uint64_t count;
+    // sums of (x - center)^n for n in [0, 2 * order], of (x - center)^n * y for n in [0, order] and of y^2
+    double   sums[3 * CYM_FIT_MAX_ORDER + 3];
+    double   compensations[3 * CYM_FIT_MAX_ORDER + 3];
+} CymFitAcc;
+
+// starts an empty accumulator for fits up to order (1 for linear fits) with the sums taken around center
+// \returns 0 on success, 1 if order is not in [0, CYM_FIT_MAX_ORDER]
+int cym_fit_acc_init(CymFitAcc* acc, int order, double center);
+// adds the points of other to acc, the result is the same (up to rounding) as pushing them to acc
+// \returns 0 on success, 1 if the accumulators have different orders or centers (acc is left untouched)
+int cym_fit_acc_merge(CymFitAcc* acc, const CymFitAcc* other);
+void cym_fit_acc_push(CymFitAcc* acc, CYM_FLOAT x, CYM_FLOAT y);
+// pushes count points at once through the SIMD kernels
+void cym_fit_acc_push_batch(CymFitAcc* acc, const CYM_FLOAT* x, const CYM_FLOAT* y, size_t count);
+// solves the polynomial fit y = sum_n output[n] * x^n for n in [0, acc->order] of the pushed points
+// \returns 0 on success, 1 if there are not enough distinct x values for the order
+int cym_fit_acc_poly(const CymFitAcc* acc, CYM_FLOAT* output);
+// solves the linear fit y = A*x + B of the pushed points, r being the correlation coefficient, acc->order must be at least 1
+// \returns 0 on success, 1 if the order is 0 or the x values are all the same
+int cym_fit_acc_linear(const CymFitAcc* acc, CYM_FLOAT* a, CYM_FLOAT* b, CYM_FLOAT* r);
+
+// X==============X MINIMIZATION X=================X
+
+// writes the residual_count residuals of a nonlinear least squares problem at params to residuals
+// \returns 0 to go on, anything else stops the solver
+typedef int (*CymLmResiduals)(const CYM_FLOAT* params, CYM_FLOAT* residuals, void* user);
+typedef int (*CymLmResiduals_d)(const double* params, double* residuals, void* user);
+typedef int (*CymLmResiduals_f)(const float* params, float* residuals, void* user);
+// writes the jacobian of the residuals at params, the derivative of residual i by parameter j going to
+// jacobian[j * residual_count + i] (one parameter after the other)
+// \returns 0 to go on, anything else stops the solver
+typedef int (*CymLmJacobian)(const CYM_FLOAT* params, CYM_FLOAT* jacobian, void* user);
+typedef int (*CymLmJacobian_d)(const double* params, double* jacobian, void* user);
+typedef int (*CymLmJacobian_f)(const float* params, float* jacobian, void* user);
+
+// zeroed fields pick the defaults
+typedef struct CymLmOptions{
+    // 100 by default
+    int    max_iterations;
+    // stops when the step is smaller than this relative to the parameters, 16 * epsilon by default
+    double step_tolerance;
+    // stops when the cosine between the residuals and every column of the jacobian is below this, sqrt(epsilon) by default
+    double gradient_tolerance;
+    // stops when an accepted step decreases the cost by less than this relative to it, 16 * epsilon by default
+    double cost_tolerance;
+    // stops once the cost (half the sum of the squared residuals) is at or below this
+    double target_cost;
+    // stops after this many seconds, no limit when 0
+    double max_seconds;
+    // corrects the steps with the geodesic acceleration (second directional derivative of the residuals, one more
+    // evaluation per step), which helps on long curved valleys
+    int    geodesic;
+    // evaluates the forward differences on the calling thread, they are otherwise split over the thread pool and the
+    // residuals callback must then be thread safe
+    int    serial;
+} CymLmOptions;
+
+enum CymLmStatus{
+    // the converged ones
+    CYM_LM_SMALL_GRADIENT = 0,
+    CYM_LM_SMALL_STEP,
+    CYM_LM_SMALL_DECREASE,
+    CYM_LM_TARGET_COST,
+    // stopped early
+    CYM_LM_MAX_ITERATIONS,
+    CYM_LM_TIME_LIMIT,
+    // a callback returned non zero
+    CYM_LM_STOPPED,
+    // the workspace could not be allocated (or is too small) or the initial residuals are not finite
+    CYM_LM_FAILED
+};
+
+typedef struct CymLmResult{
+    int    status;
+    int    iterations;
+    size_t residual_evaluations;
+    size_t jacobian_evaluations;
+    double initial_cost;
+    double cost;
+    double seconds;
+} CymLmResult;
+
+// minimizes half the sum of the squared residuals over the param_count params with Levenberg-Marquardt, params holding the
+// initial guess and getting the solution. jacobian may be NULL, it is then built by forward differences (one residuals call
+// per parameter, in parallel). J^T J goes through the gemm, computing only its upper half. options and result may be NULL
+// \returns a CymLmStatus, also written to result
+int cym_lm_solve(CymLmResiduals residuals, CymLmJacobian jacobian, void* user, CYM_FLOAT* params, size_t param_count,
+    size_t residual_count, const CymLmOptions* options, CymLmResult* result);
+// see X WORKSPACES X, the workspace also holds the copies of the parameters of the forward differences
+size_t cym_lm_solve_workspace_size(size_t param_count, size_t residual_count);
+int cym_lm_solve_ws(CymLmResiduals residuals, CymLmJacobian jacobian, void* user, CYM_FLOAT* params, size_t param_count,
+    size_t residual_count, const CymLmOptions* options, CymLmResult* result, void* workspace, size_t workspace_size);
+
+// fits the param_count parameters of model to the data_point_count points of input_data by nonlinear least squares, each
+// point being param_count inputs followed by its y value. model is called with a buffer holding the inputs of a point followed
+// by the parameters and returns its prediction of y, param holds the initial guess and gets the fitted parameters
+// runs cym_lm_solve with forward differences, so model is called from several threads at once
 void cym_minimize(CYM_FLOAT* input_data, size_t data_point_count, CYM_FLOAT(*model)(CYM_FLOAT*), CYM_FLOAT* param, size_t param_count);
 
+// X==============X SPARSE MATRICES X=================X
+// compressed matrices, taking memory proportional to their nonzeros: in CSR (compressed sparse rows) the nonzeros of line i
+// are values[k] in column indices[k] for k in [offsets[i], offsets[i + 1]), in CSC (compressed sparse columns) lines and
+// columns swap roles. The indices of a line (column) are sorted and unique, and the matrices have less than 2^31 columns (lines)
+
+enum CymSparseFormat{
+    CYM_SPARSE_CSR = 0,
+    CYM_SPARSE_CSC
+};
+
+typedef struct CymSparse{
+    CYM_FLOAT*    values;
+    unsigned int* indices;
+    // rows + 1 values for CSR, columns + 1 for CSC
+    size_t*       offsets;
+    size_t        rows;
+    size_t        columns;
+    size_t        nonzeros;
+    // a CymSparseFormat
+    int           format;
+} CymSparse;
+typedef struct CymSparse_d{
+    double*       values;
+    unsigned int* indices;
+    size_t*       offsets;
+    size_t        rows;
+    size_t        columns;
+    size_t        nonzeros;
+    int           format;
+} CymSparse_d;
+typedef struct CymSparse_f{
+    float*        values;
+    unsigned int* indices;
+    size_t*       offsets;
+    size_t        rows;
+    size_t        columns;
+    size_t        nonzeros;
+    int           format;
+} CymSparse_f;
+
+// builds the rows x columns matrix out in format from the count nonzeros (row_indices[k], column_indices[k], values[k]) given
+// in any order (COO), duplicates being summed, with two counting sorts, out owning its arrays until cym_sparse_free
+// \returns 0 on success, 1 if an index is out of the matrix, it has 2^31 lines or columns or the arrays could not be allocated
+int cym_sparse_from_coo(size_t rows, size_t columns, const unsigned int* row_indices, const unsigned int* column_indices,
+    const CYM_FLOAT* values, size_t count, int format, CymSparse* out);
+// writes a in format to out (CSR to CSC and back in one counting pass, or a copy), out owning its arrays until cym_sparse_free
+// \returns 0 on success, 1 if the arrays could not be allocated
+int cym_sparse_convert(const CymSparse* a, int format, CymSparse* out);
+// frees the arrays of a matrix built by cym_sparse_from_coo or cym_sparse_convert and zeroes it
+void cym_sparse_free(CymSparse* a);
+// y = alpha * a * x + beta * y, when beta is 0 y is only written, y must not overlap x. CSR matrices split their lines over
+// the thread pool, lines of at least 2 SIMD vectors of nonzeros gathering x with SIMD and shorter ones (stencils) being
+// scalar, CSC matrices scatter their columns on the calling thread (convert them to CSR)
+void cym_sparse_mv(CYM_FLOAT alpha, const CymSparse* a, const CYM_FLOAT* x, CYM_FLOAT beta, CYM_FLOAT* y);
+
+enum CymPreconditioner{
+    CYM_PRECOND_NONE = 0,
+    // the inverse of the diagonal
+    CYM_PRECOND_JACOBI,
+    // the incomplete LU factorization keeping the nonzeros of a (for symmetric a, its incomplete Cholesky)
+    CYM_PRECOND_ILU0
+};
+
+enum CymIterStatus{
+    CYM_ITER_CONVERGED = 0,
+    CYM_ITER_MAX_ITERATIONS,
+    // a division by zero in the iteration (for cg, a is not positive definite), x is the last iterate
+    CYM_ITER_BREAKDOWN,
+    // a is not square, it lacks a diagonal element the preconditioner needs (or ILU(0) hit a zero pivot) or the
+    // workspace could not be allocated (or is too small), x is left untouched
+    CYM_ITER_FAILED
+};
+
+typedef struct CymIterStats{
+    // a CymIterStatus
+    int    status;
+    int    iterations;
+    // |b - a * x| / |b| at the end
+    double residual;
+    double seconds;
+} CymIterStats;
+
+// solves a * x = b for the symmetric positive definite a with preconditioned conjugate gradients, x holding the initial guess
+// (zeros will do) and getting the solution, until |b - a * x| <= tolerance * |b| or after max_iterations (the size of a when
+// 0), preconditioner being a CymPreconditioner, stats may be NULL. CSC matrices are converted to CSR first
+// \returns a CymIterStatus
+int cym_sparse_cg(const CymSparse* a, const CYM_FLOAT* b, CYM_FLOAT* x, double tolerance, int max_iterations, int preconditioner,
+    CymIterStats* stats);
+// cym_sparse_cg for any square a with right preconditioned BiCGSTAB (two products by a per iteration)
+// \returns a CymIterStatus
+int cym_sparse_bicgstab(const CymSparse* a, const CYM_FLOAT* b, CYM_FLOAT* x, double tolerance, int max_iterations,
+    int preconditioner, CymIterStats* stats);
+// see X WORKSPACES X, the workspace also holds the CSR form of a CSC a and the factors of the preconditioner
+size_t cym_sparse_cg_workspace_size(const CymSparse* a, int preconditioner);
+int cym_sparse_cg_ws(const CymSparse* a, const CYM_FLOAT* b, CYM_FLOAT* x, double tolerance, int max_iterations,
+    int preconditioner, CymIterStats* stats, void* workspace, size_t workspace_size);
+size_t cym_sparse_bicgstab_workspace_size(const CymSparse* a, int preconditioner);
+int cym_sparse_bicgstab_ws(const CymSparse* a, const CYM_FLOAT* b, CYM_FLOAT* x, double tolerance, int max_iterations,
+    int preconditioner, CymIterStats* stats, void* workspace, size_t workspace_size);
+
+// X==============X PRECISIONS X=================X
+// every function above taking CYM_FLOAT (but cym_absf) also exists as name_d for double and name_f for float
+// (cym_mat_multiply_d, cym_mat_multiply_f, ...), so a program can use both precisions, the CYM_FLOAT names forward to one of them
+// C++ also gets both as overloads in namespace cym, without the prefix (cym::mat_multiply)
+
+#define ICYM_API_PASS
+#define ICYM_API(RET, NAME, PARAMS, ARGS) RET ICYM_FN(cym_##NAME) PARAMS;
+#define ICYM_API_C(RET, NAME, PARAMS, ARGS) RET ICYM_FN(cym_##NAME) PARAMS;
+#define ICYM_T double
+#define ICYM_FN(name) name##_d
+#include "cymath.h"
+#undef ICYM_FN
+#undef ICYM_T
+#define ICYM_T float
+#define ICYM_FN(name) name##_f
+#include "cymath.h"
+#undef ICYM_FN
+#undef ICYM_T
+#undef ICYM_API
+#undef ICYM_API_C
+#undef ICYM_API_PASS
+
+// X==============X SIMD X=================X
+
+enum CymSimdLevel{
+    CYM_SIMD_SCALAR = 0,
+    // SSE2 on x86, the compiler's native 128 bit vectors on other targets
+    CYM_SIMD_SSE2,
+    // AVX2 and FMA
+    CYM_SIMD_AVX2,
+    CYM_SIMD_AVX512
+};
+
+// \returns the SIMD level used by the kernels, the best one supported by the cpu unless changed with cym_simd_set_level
+int cym_simd_level(void);
+// makes the kernels use level (for comparing them), levels the cpu does not support and negative levels select the best one
+// \returns the level that will be used
+int cym_simd_set_level(int level);
+
+// X==============X THREADS X=================X
+
+// sets how many threads the parallel kernels use (1 makes them serial), 0 goes back to the default: the CYM_NUM_THREADS
+// environment variable if set, the number of online cpus otherwise
+// must not be called while a parallel kernel is running
+void cym_set_num_threads(unsigned int count);
+// \returns how many threads the parallel kernels use
+unsigned int cym_get_num_threads(void);
+// pins the worker threads to cpus ordered by NUMA node (linux only), so threads working on neighbouring chunks share a node,
+// also enabled by setting the CYM_PIN_THREADS environment variable to 1, applies to threads started after the call
+void cym_set_thread_pinning(int enable);
+
+// calls body over [begin, end) split in chunks of grain indices (the last one may be smaller), in parallel with work stealing
+// the chunks only depend on begin, end and grain, never on the number of threads, calls made from inside a body run serially
+void cym_parallel_for(size_t begin, size_t end, size_t grain, void (*body)(size_t begin, size_t end, void* user), void* user);
+// deterministic parallel reduction, body writes the reduction of its chunk to partial (result_size bytes) and combine then
+// folds the partials into result in chunk order, so result only depends on begin, end and grain
+// \returns 0 on success, 1 if the partials could not be allocated (result is left untouched)
+int cym_parallel_reduce(size_t begin, size_t end, size_t grain, void* result, size_t result_size,
+    void (*body)(size_t begin, size_t end, void* partial, void* user),
+    void (*combine)(void* result, const void* partial, void* user), void* user);
+// \returns the bytes of workspace cym_parallel_reduce_ws needs for these arguments (any number of threads)
+size_t cym_parallel_reduce_workspace_size(size_t begin, size_t end, size_t grain, size_t result_size);
+// cym_parallel_reduce keeping its partials in the workspace_size bytes at workspace instead of the heap, running serially
+// (with the same result) when the workspace holds a single partial
+// \returns 0 on success, 1 if the workspace does not hold a partial (result is left untouched)
+int cym_parallel_reduce_ws(size_t begin, size_t end, size_t grain, void* result, size_t result_size,
+    void (*body)(size_t begin, size_t end, void* partial, void* user),
+    void (*combine)(void* result, const void* partial, void* user), void* user, void* workspace, size_t workspace_size);
 
-#ifdef CYMATH_IMPLEMENTATION
 
+#ifdef CYMATH_IMPLEMENTATION
 
-CYM_FLOAT cym_absf(CYM_FLOAT x){ return x > 0? x : -x; }
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)) && !defined(CYM_NO_SIMD)
+#define ICYM_X86_SIMD 1
+#elif defined(__GNUC__) && !defined(CYM_NO_SIMD)
+#define ICYM_VECTOR_SIMD 1
+#endif
 
-double cym_Q_rsqrt_d(double number) {
-    const double x2 = number * 0.5;
-    const double threehalfs = 1.5;
+#if defined(ICYM_X86_SIMD)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-    union {
-        double d;
-        uint64_t i;
-    } conv = {number};
+#include <float.h>
+#include <limits.h>
+#include <time.h>
 
-    conv.i = 0x5fe6ec85e7de30da - (conv.i >> 1);
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define ICYM_RESTRICT __restrict
+#else
+#define ICYM_RESTRICT
+#endif
 
-    conv.d = conv.d * (threehalfs - (x2 * conv.d * conv.d));
-    conv.d = conv.d * (threehalfs - (x2 * conv.d * conv.d));
-    conv.d = conv.d * (threehalfs - (x2 * conv.d * conv.d));
-    conv.d = conv.d * (threehalfs - (x2 * conv.d * conv.d));
-    conv.d = conv.d * (threehalfs - (x2 * conv.d * conv.d));
+// the CymSimdLevel values, for the preprocessor
+#define ICYM_ISA_SCALAR 0
+#define ICYM_ISA_SSE2   1
+#define ICYM_ISA_AVX2   2
+#define ICYM_ISA_AVX512 3
 
-    return conv.d;
-}
+// rows of the gemm micro kernel, its columns are 2 vectors of the SIMD level
+#define ICYM_GEMM_MR 6
 
-#define cym_sqrt(VALUE) (1.0 / cym_Q_rsqrt_d(VALUE))
+// k, rows of a and columns of b of the blocks packed by the gemm (so they stay in L1, L2 and L3 respectively),
+// given for double, float blocks are twice as wide
+#ifndef CYM_GEMM_KC
+#define CYM_GEMM_KC 256
+#endif
+#ifndef CYM_GEMM_MC
+#define CYM_GEMM_MC 96
+#endif
+#ifndef CYM_GEMM_NC
+#define CYM_GEMM_NC 2048
+#endif
 
-CYM_FLOAT cym_normalize_vec(const CYM_FLOAT* vector, unsigned int size, CYM_FLOAT* ouput){
-    CYM_FLOAT norm2 = 0;
+// below this many multiply adds the gemm skips packing
+#ifndef CYM_GEMM_SMALL
+#define CYM_GEMM_SMALL (32 * 32 * 32)
+#endif
 
-    for(unsigned int i = 0; i < size; i+=1){
-        norm2 += vector[i] * vector[i];
-    }
+// the transposes recurse down to blocks of at most this many lines and columns
+#ifndef CYM_TRANSPOSE_BLOCK
+#define CYM_TRANSPOSE_BLOCK 32
+#endif
 
-    if(norm2 == 0.0f){
-        for(unsigned int i = 0; i < size; i+=1){
-            ouput[i] = 0.0f;
-        }
-        return 0.0f;
-    }
+// from this many elements on the transposes run in parallel
+#ifndef CYM_TRANSPOSE_PARALLEL
+#define CYM_TRANSPOSE_PARALLEL (1 << 18)
+#endif
 
-    const CYM_FLOAT rnorm = cym_Q_rsqrt_d(norm2);
+// elements per chunk of the batched element-wise kernels (square roots, normalizations) when they run in parallel
+#ifndef CYM_BATCH_GRAIN
+#define CYM_BATCH_GRAIN (1 << 16)
+#endif
 
-    for(unsigned int i = 0; i < size; i+=1){
-        ouput[i] = vector[i] * rnorm;
-    }
+// columns factored per panel by cym_lu_factor, the rest of the matrix is updated through the gemm once per panel
+#ifndef CYM_LU_BLOCK
+#define CYM_LU_BLOCK 128
+#endif
 
-    return 1.0f / rnorm;
+// columns factored per panel by cym_qr_factor, the trailing columns are updated through the gemm once per panel
+#ifndef CYM_QR_BLOCK
+#define CYM_QR_BLOCK 32
+#endif
 
-}
+// columns of a^T * a computed per gemm when only its upper half is built
+#ifndef CYM_SYRK_BLOCK
+#define CYM_SYRK_BLOCK 64
+#endif
 
-void cym_mat_transpose(const CYM_FLOAT* input, unsigned int sizex, unsigned int sizey, CYM_FLOAT* output){
-    for(unsigned int i = 0; i < sizey; i+=1){
-        for(unsigned int j = 0; j < sizex; j+=1){
-            output[j * sizey + i] = input[i * sizex + j];
-        }
-    }
-}
+// steps after which the root finders give up, and roots advanced in lock-step per block by cym_root_batch
+#ifndef CYM_ROOT_ITERATIONS
+#define CYM_ROOT_ITERATIONS 200
+#endif
+#ifndef CYM_ROOT_BLOCK
+#define CYM_ROOT_BLOCK 1024
+#endif
 
-void cym_mat_scale(CYM_FLOAT scalar, const CYM_FLOAT* mat, unsigned int sizex, unsigned int sizey, CYM_FLOAT* output){
-    for(unsigned int i = 0; i < sizey; i+=1){
-        for (unsigned int j = 0; j < sizex; j+=1){
-            output[i * sizex + j] = scalar * mat[i * sizex + j];
-        }
-    }
-}
+// weighted passes after which cym_rlinear_fit gives up on the slope
+#ifndef CYM_RLINEAR_ITERATIONS
+#define CYM_RLINEAR_ITERATIONS 100
+#endif
 
-void cym_mat_sum(const CYM_FLOAT* mat1, const CYM_FLOAT* mat2, unsigned int sizex, unsigned int sizey, CYM_FLOAT* output){
-    for(unsigned int i = 0; i < sizey; i+=1){
-        for (unsigned int j = 0; j < sizex; j+=1){
-            output[i * sizex + j] = mat1[i * sizex + j] + mat2[i * sizex + j];
-        }
-    }
-}
+// nonzeros per chunk of the lines of a CSR matrix split over the thread pool by cym_sparse_mv
+#ifndef CYM_SPARSE_GRAIN
+#define CYM_SPARSE_GRAIN (1 << 14)
+#endif
 
-void cym_mat_sub(const CYM_FLOAT* mat1, const CYM_FLOAT* mat2, unsigned int sizex, unsigned int sizey, CYM_FLOAT* output){
-    for(unsigned int i = 0; i < sizey; i+=1){
-        for (unsigned int j = 0; j < sizex; j+=1){
-            output[i * sizex + j] = mat1[i * sizex + j] - mat2[i * sizex + j];
-        }
-    }
-}
+// points added per step to the streamed QR of the polynomial fits
+#ifndef CYM_LSQ_ROWS
+#define CYM_LSQ_ROWS 256
+#endif
 
-void cym_mat_multiply(const CYM_FLOAT* mat_1, unsigned int mat1_sizex, unsigned int mat1_sizey,
-    const CYM_FLOAT* mat_2, unsigned int mat2_sizex, CYM_FLOAT* output){
+// below this many multiply adds the gemm runs on a single thread
+#ifndef CYM_GEMM_PARALLEL
+#define CYM_GEMM_PARALLEL (128 * 128 * 128)
+#endif
 
-    const unsigned long ran = mat1_sizey * mat2_sizex;
+static int icym_simd_current = -1;
+
+static int icym_simd_detect(void){
+#if defined(ICYM_X86_SIMD)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f")) return CYM_SIMD_AVX512;
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return CYM_SIMD_AVX2;
+    if(__builtin_cpu_supports("sse2")) return CYM_SIMD_SSE2;
+    return CYM_SIMD_SCALAR;
+#elif defined(ICYM_VECTOR_SIMD)
+    return CYM_SIMD_SSE2;
+#else
+    return CYM_SIMD_SCALAR;
+#endif
+}
 
-    for(unsigned long i = 0; i < ran; i +=1){
-        output[i] = 0;
-    }
+int cym_simd_level(void){
+    if(icym_simd_current < 0) icym_simd_current = icym_simd_detect();
+    return icym_simd_current;
+}
 
-    for(unsigned int i = 0; i < mat1_sizey; i += 1){
-        for(unsigned int j = 0; j < mat2_sizex; j += 1)
-        for(unsigned int j1 = 0; j1 < mat1_sizex; j1 += 1){
-            output[i * mat2_sizex + j] += mat_1[i * mat1_sizex + j1] * mat_2[j1 * mat2_sizex + j];
-        }
-    }
+int cym_simd_set_level(int level){
+    const int best = icym_simd_detect();
+    icym_simd_current = (level < 0 || level > best)? best : level;
+    return icym_simd_current;
+}
 
+// wall clock seconds for the time limits, processor time when there is no POSIX clock
+static double icym_seconds(void){
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
 }
 
-void cym_solve_gauss(CYM_FLOAT* a, CYM_FLOAT* y, unsigned int size, CYM_FLOAT* x){
+// the workspaces of the _ws functions are handed out in pieces aligned to 64 bytes, so their sizes count one line of slack
+// for aligning the start and round each piece up to whole lines
+#define ICYM_WORKSPACE_ALIGN 64
+// the workspaces of the allocating functions live on the stack up to this many bytes
+#define ICYM_STACK_WORKSPACE 16384
 
-    // a variable to store the pivot line
-    int64_t t = 0;
-    // stores the number of times a line got sent to the end
-    size_t number_of_swaps = 0;
+typedef struct ICymWorkspace{
+    uint8_t* next;
+    size_t   left;
+} ICymWorkspace;
 
-    for(unsigned int m = 0; m < size; m += 1){
-        t = -1;
-        for(unsigned int n = 0; n < size; n += 1){
+static ICymWorkspace icym_workspace(void* memory, size_t size){
+    ICymWorkspace ws = { (uint8_t*)memory, memory? size : 0 };
+    return ws;
+}
 
-            if(a[n * size + m] != 0 && t >= 0){ // if a pivot was found
+// \returns what bytes take of a workspace
+static size_t icym_workspace_bytes(size_t bytes){
+    return (bytes + ICYM_WORKSPACE_ALIGN - 1) & ~(size_t)(ICYM_WORKSPACE_ALIGN - 1);
+}
 
-                const CYM_FLOAT scale = a[n * size + m] / a[t * size + m];
-                // using x to temporarilly store a[t] * (a[n][m] / a[t][m]) {a[n] is a vector/matrice_line}
-                cym_mat_scale(scale, a + t * size, size, 1, x);
-                // a[n] -= a[t] * (a[n][m] / a[t][m])
-                cym_mat_sub(a + n * size, x, size, 1, a + n * size);
-                // y[n] -= y[t] * (a[n][m] / a[t][m])
-                y[n] -= y[t] * scale;
-                // making sure the value at the pivot's column was zerod as it should
-                a[n * size + m] = 0;
+// \returns bytes of ws aligned to 64 bytes, NULL if they do not fit (ws is then left untouched)
+static void* icym_workspace_take(ICymWorkspace* ws, size_t bytes){
+    const size_t pad  = (size_t)(-(uintptr_t)ws->next & (ICYM_WORKSPACE_ALIGN - 1));
+    const size_t need = pad + icym_workspace_bytes(bytes);
+    if(!ws->next || need > ws->left) return NULL;
+    uint8_t* piece = ws->next + pad;
+    ws->next += need;
+    ws->left -= need;
+    return piece;
+}
 
-            } else if(a[n * size + m] != 0){ // otherwise set the pivot
-                t = n;
-            }
-        }
-        if(t >= 0){// if there was a pivot send its line to the end
+// the stack buffer or heap memory an allocating function runs its _ws twin on, NULL if it could not be allocated
+static void* icym_workspace_alloc(size_t size, void* stack){
+    if(size <= ICYM_STACK_WORKSPACE) return stack;
+    return malloc(size);
+}
 
-            const CYM_FLOAT yy = y[t];
+static void icym_workspace_free(void* workspace, void* stack){
+    if(workspace != stack) free(workspace);
+}
 
-            for(unsigned int n = t + 1; n < size; n+=1){
-                y[n - 1] = y[n];
-            }
+// X==============X THREAD POOL X=================X
+
+#if !defined(CYM_NO_THREADS) && defined(__GNUC__) && (defined(__unix__) || defined(__APPLE__))
+#define ICYM_THREADS 1
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#if !defined(__USE_MISC) && !defined(__cplusplus)
+extern long syscall(long number, ...);
+#endif
+#endif
+#endif
 
-            y[size - 1] = yy;
+#ifndef ICYM_THREAD_LOCAL
+#if defined(__cplusplus)
+#define ICYM_THREAD_LOCAL thread_local
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define ICYM_THREAD_LOCAL _Thread_local
+#else
+#define ICYM_THREAD_LOCAL __thread
+#endif
+#endif
 
-            for(unsigned int i = 0; i < size; i+=1){
-                x[i] = a[t * size + i];
+#ifndef CYM_MAX_THREADS
+#define CYM_MAX_THREADS 256
+#endif
 
-                for(unsigned int n = t + 1; n < size; n+=1){
-                    a[(n - 1) * size + i] = a[n * size + i];
-                }
+// how many times idle threads poll for work before sleeping
+#ifndef CYM_THREAD_SPIN
+#define CYM_THREAD_SPIN 4000
+#endif
 
-                a[(size - 1) * size + i] = x[i];
-            }
+// runs chunk on worker (in [0, number of workers)), workers own a contiguous range of chunks and steal from each other
+typedef void (*icym_task_fn)(size_t chunk, unsigned int worker, void* user);
+
+static unsigned int icym_thread_count = 0;
+static int          icym_thread_pinning = -1;
+
+#if defined(ICYM_THREADS)
+
+// a worker's remaining chunks [first, last) packed as first << 32 | last, popped from the front by the owner and split
+// from the back by thieves
+typedef struct ICymRange{
+    uint64_t range;
+    uint8_t  padding[64 - sizeof(uint64_t)];
+} ICymRange;
+
+typedef struct ICymPool{
+    pthread_mutex_t lock;
+    pthread_cond_t  wake;
+    pthread_cond_t  done;
+    // only one parallel region runs at a time, others run serially
+    pthread_mutex_t region;
+
+    pthread_t*      threads;
+    // including the calling thread
+    unsigned int    size;
+    int             stop;
+    uint64_t        generation;
+
+    icym_task_fn    task;
+    void*           user;
+    unsigned int    participants;
+    unsigned int    busy;
+    ICymRange       ranges[CYM_MAX_THREADS];
+} ICymPool;
+
+static ICymPool* icym_pool = NULL;
+static pthread_mutex_t icym_pool_create_lock = PTHREAD_MUTEX_INITIALIZER;
+static ICYM_THREAD_LOCAL int icym_in_parallel = 0;
+
+// the i-th poll of a spin wait, yields now and then in case the threads outnumber the cpus
+static inline void icym_spin(int i){
+    if((i & 63) == 63){
+        sched_yield();
+        return;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
 
+static inline int icym_range_pop(ICymRange* r, size_t* chunk){
+    uint64_t v = __atomic_load_n(&r->range, __ATOMIC_ACQUIRE);
+    while((v >> 32) < (v & 0xffffffffu)){
+        if(__atomic_compare_exchange_n(&r->range, &v, v + ((uint64_t)1 << 32), 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)){
+            *chunk = (size_t)(v >> 32);
+            return 1;
         }
     }
+    return 0;
+}
 
-    for(unsigned int i = 0; i < size; i += 1){
-        x[i] = y[i] / a[i * size + i];
+// takes the back half of victim's chunks, keeping the first one and storing the rest in own
+static inline int icym_range_steal(ICymRange* victim, ICymRange* own, size_t* chunk){
+    uint64_t v = __atomic_load_n(&victim->range, __ATOMIC_ACQUIRE);
+    for(;;){
+        const uint64_t first = v >> 32, last = v & 0xffffffffu;
+        if(first >= last) return 0;
+        const uint64_t mid = last - (last - first + 1) / 2;
+        if(__atomic_compare_exchange_n(&victim->range, &v, first << 32 | mid, 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)){
+            *chunk = (size_t)mid;
+            __atomic_store_n(&own->range, (mid + 1) << 32 | last, __ATOMIC_RELEASE);
+            return 1;
+        }
     }
-
 }
 
-int cym_make_unitary(const CYM_FLOAT* input, unsigned int size, CYM_FLOAT* output){
+static void icym_pool_work(ICymPool* pool, unsigned int worker){
+    const unsigned int participants = pool->participants;
+    ICymRange* own = &pool->ranges[worker];
+    size_t chunk;
 
-    CYM_FLOAT norm2 = 0.0f;
-    CYM_FLOAT rnorm = 0.0f;
+    for(;;){
+        while(icym_range_pop(own, &chunk)) pool->task(chunk, worker, pool->user);
 
-    for(unsigned int i = 0; i < size; i+=1){
-        norm2 += input[i] * input[i];
+        int stolen = 0;
+        for(unsigned int i = 1; i < participants && !stolen; i+=1){
+            stolen = icym_range_steal(&pool->ranges[(worker + i) % participants], own, &chunk);
+        }
+        if(!stolen) return;
+        pool->task(chunk, worker, pool->user);
     }
+}
 
-    if(norm2 == 0.0f){
-        for(size_t i = 0; i < size * size; i+=1){
-            output[i] = 0.0f;
+// the cpus ordered by NUMA node, from /sys on linux, just 0..count-1 elsewhere
+// \returns how many were written to order
+static unsigned int icym_numa_cpu_order(unsigned int* order, unsigned int max){
+    unsigned int count = 0;
+#if defined(__linux__)
+    for(int node = 0; node < 1024 && count < max; node+=1){
+        char path[64];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        FILE* f = fopen(path, "r");
+        if(!f){
+            if(node > 0) break;
+            continue;
         }
-        return 1;
+        unsigned int first, last;
+        while(count < max && fscanf(f, "%u", &first) == 1){
+            last = first;
+            int c = fgetc(f);
+            if(c == '-'){
+                if(fscanf(f, "%u", &last) != 1) break;
+                c = fgetc(f);
+            }
+            for(unsigned int cpu = first; cpu <= last && count < max; cpu+=1) order[count++] = cpu;
+            if(c != ',') break;
+        }
+        fclose(f);
+    }
+#endif
+    if(count == 0){
+        const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        for(long cpu = 0; cpu < cpus && count < max; cpu+=1) order[count++] = (unsigned int)cpu;
     }
+    return count;
+}
 
-    rnorm = cym_Q_rsqrt_d(norm2);
+static void icym_pin_to_cpu(unsigned int cpu){
+#if defined(__linux__) && defined(__NR_sched_setaffinity)
+    unsigned long mask[1024 / (8 * sizeof(unsigned long))] = {0};
+    if(cpu >= 1024) return;
+    mask[cpu / (8 * sizeof(unsigned long))] = 1ul << (cpu % (8 * sizeof(unsigned long)));
+    syscall(__NR_sched_setaffinity, 0, sizeof(mask), mask);
+#else
+    (void)cpu;
+#endif
+}
 
-    for(unsigned int i = 0; i < size; i+=1){
+typedef struct ICymWorkerArgs{
+    ICymPool*    pool;
+    unsigned int index;
+    int          cpu;
+} ICymWorkerArgs;
 
-        output[i * size] = input[i] * rnorm;
+static void* icym_pool_worker(void* arg){
+    ICymWorkerArgs args = *(ICymWorkerArgs*)arg;
+    free(arg);
 
-    }
-    
+    ICymPool* pool = args.pool;
+    icym_in_parallel = 1;
+    if(args.cpu >= 0) icym_pin_to_cpu((unsigned int)args.cpu);
 
-    unsigned int j = 1;
+    uint64_t seen = 0;
 
-   while((j < size) && (input[j - 1] == 0.0f)){
-        output[(j - 1) * size + j] = 1.0f;
-        j += 1;
-    }
+    for(;;){
+        for(int i = 0; i < CYM_THREAD_SPIN && __atomic_load_n(&pool->generation, __ATOMIC_ACQUIRE) == seen; i+=1){
+            icym_spin(i);
+        }
 
-    for(; j < size; j+=1){
+        pthread_mutex_lock(&pool->lock);
+        while(pool->generation == seen && !pool->stop) pthread_cond_wait(&pool->wake, &pool->lock);
+        if(pool->stop){
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->generation;
+        const int participates = args.index < pool->participants;
+        pthread_mutex_unlock(&pool->lock);
 
-        if(input[j] != 0.0f){
-            CYM_FLOAT dummy = 0.0f;
+        if(!participates) continue;
 
-            for(unsigned int i = 0; i < j; i+=1){
-                output[i * size + j] = input[i];
-                dummy -= input[i] * input[i];
-            }
+        icym_pool_work(pool, args.index);
 
-            output[j * (size + 1)] = dummy / input[j];
+        if(__atomic_sub_fetch(&pool->busy, 1, __ATOMIC_ACQ_REL) == 0){
+            pthread_mutex_lock(&pool->lock);
+            pthread_cond_signal(&pool->done);
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+}
 
-            norm2 = output[j * (size + 1)] * output[j * (size + 1)] - dummy;
+static void icym_pool_destroy(ICymPool* pool){
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
 
-            rnorm = cym_Q_rsqrt_d(norm2);
+    for(unsigned int i = 1; i < pool->size; i+=1) pthread_join(pool->threads[i], NULL);
 
-            for(unsigned int i = 0; i < j + 1; i+=1){
-                output[i * size + j] *= rnorm;
-            }
-            
-        } else{
-            output[j * (size + 1)] = 1.0f;
-        }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->region);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->done);
+    free(pool->threads);
+    free(pool);
+}
 
-        
+static ICymPool* icym_pool_create(unsigned int size){
+    ICymPool* pool = (ICymPool*)calloc(1, sizeof(ICymPool));
+    if(!pool) return NULL;
+    pool->threads = (pthread_t*)calloc(size, sizeof(pthread_t));
+    if(!pool->threads){
+        free(pool);
+        return NULL;
     }
 
-    return 0;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_mutex_init(&pool->region, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->size = 1;
+
+    unsigned int order[CYM_MAX_THREADS];
+    unsigned int cpus = 0;
+    if(icym_thread_pinning > 0) cpus = icym_numa_cpu_order(order, CYM_MAX_THREADS);
+
+    for(unsigned int i = 1; i < size; i+=1){
+        ICymWorkerArgs* args = (ICymWorkerArgs*)malloc(sizeof(ICymWorkerArgs));
+        if(!args) break;
+        args->pool  = pool;
+        args->index = i;
+        args->cpu   = cpus? (int)order[i % cpus] : -1;
+        if(pthread_create(&pool->threads[i], NULL, icym_pool_worker, args)){
+            free(args);
+            break;
+        }
+        pool->size += 1;
+    }
+
+    return pool;
 }
 
-int cym_test_unitary(const CYM_FLOAT* mat, unsigned int size, double accuracy){
-    CYM_FLOAT dag[size * size];
+#endif // ICYM_THREADS
 
-    cym_mat_transpose(mat, size, size, dag);
+unsigned int cym_get_num_threads(void){
+    unsigned int count = __atomic_load_n(&icym_thread_count, __ATOMIC_ACQUIRE);
+    if(count) return count;
 
-    CYM_FLOAT I[size * size];
+    const char* env = getenv("CYM_NUM_THREADS");
+    if(env) count = (unsigned int)strtoul(env, NULL, 10);
+#if defined(ICYM_THREADS)
+    if(!count){
+        const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        count = (cpus > 0)? (unsigned int)cpus : 1;
+    }
+#endif
+    if(count == 0) count = 1;
+    if(count > CYM_MAX_THREADS) count = CYM_MAX_THREADS;
 
-    cym_mat_multiply(mat, size, size, dag, size, I);
+    __atomic_store_n(&icym_thread_count, count, __ATOMIC_RELEASE);
+    return count;
+}
 
-    int is_un = 1;
+void cym_set_num_threads(unsigned int count){
+    if(count > CYM_MAX_THREADS) count = CYM_MAX_THREADS;
+    __atomic_store_n(&icym_thread_count, count, __ATOMIC_RELEASE);
+
+#if defined(ICYM_THREADS)
+    // the pool is started again with the new size by the next parallel region
+    pthread_mutex_lock(&icym_pool_create_lock);
+    ICymPool* pool = icym_pool;
+    icym_pool = NULL;
+    pthread_mutex_unlock(&icym_pool_create_lock);
+    if(pool) icym_pool_destroy(pool);
+#endif
+}
 
-    for(int i = 0; i < size && is_un; i++){
-        for(int j = 0; j < size && is_un; j++){
-            if(i == j){
-                is_un = CYM_ABS(I[i * size + j] - 1) < accuracy;
-            } else{
-                is_un = CYM_ABS(I[i * size + j]) < accuracy;
-            }
-        }
-    }
-    if(!is_un){
-        return 0;
-    }
+void cym_set_thread_pinning(int enable){
+    icym_thread_pinning = enable? 1 : 0;
+}
+
+// \returns how many workers icym_parallel_run would use for chunk_count chunks
+static unsigned int icym_parallel_workers(size_t chunk_count){
+#if defined(ICYM_THREADS)
+    if(icym_in_parallel || chunk_count < 2) return 1;
+    const unsigned int threads = cym_get_num_threads();
+    return (chunk_count < threads)? (unsigned int)chunk_count : threads;
+#else
+    (void)chunk_count;
+    return 1;
+#endif
+}
 
-    cym_mat_multiply(dag, size, size, mat, size, I);
+// runs task over chunks [0, chunk_count), on the pool when it has more than one thread and serially in order otherwise
+static void icym_parallel_run(size_t chunk_count, icym_task_fn task, void* user){
+#if defined(ICYM_THREADS)
+    const unsigned int workers = icym_parallel_workers(chunk_count);
 
-    for(int i = 0; i < size && is_un; i++){
-        for(int j = 0; j < size && is_un; j++){
-            if(i == j){
-                is_un = CYM_ABS(I[i * size + j] - 1) < accuracy;
-            } else{
-                is_un = CYM_ABS(I[i * size + j]) < accuracy;
-            }
+    if(workers > 1 && chunk_count <= 0xffffffffu){
+        if(icym_thread_pinning < 0){
+            const char* env = getenv("CYM_PIN_THREADS");
+            icym_thread_pinning = (env && atoi(env) > 0)? 1 : 0;
         }
-    }
 
-    return is_un;
+        pthread_mutex_lock(&icym_pool_create_lock);
+        if(!icym_pool) icym_pool = icym_pool_create(cym_get_num_threads());
+        ICymPool* pool = icym_pool;
+        const int acquired = pool && pthread_mutex_trylock(&pool->region) == 0;
+        pthread_mutex_unlock(&icym_pool_create_lock);
 
-}
+        if(acquired){
+            const unsigned int participants = (workers < pool->size)? workers : pool->size;
 
-void cym_mat_print(const char* name, const CYM_FLOAT* mat, unsigned int sizey, unsigned int sizex){
-    if(name) printf("\n%s[%u][%u]:\n\t",name, sizey, sizex);
-    else     printf("\n(NOT NAMED)[%u][%u]:\n\t", sizey, sizex);
+            for(unsigned int i = 0; i < participants; i+=1){
+                const uint64_t first = chunk_count * i / participants, last = chunk_count * (i + 1) / participants;
+                pool->ranges[i].range = first << 32 | last;
+            }
 
-    for(unsigned int i = 0; i < sizey; i++){
-        for(unsigned int j = 0; j < sizex; j++){
-            printf("%f, ", mat[i * sizex + j]);
+            pthread_mutex_lock(&pool->lock);
+            pool->task         = task;
+            pool->user         = user;
+            pool->participants = participants;
+            pool->busy         = participants - 1;
+            __atomic_store_n(&pool->generation, pool->generation + 1, __ATOMIC_RELEASE);
+            pthread_cond_broadcast(&pool->wake);
+            pthread_mutex_unlock(&pool->lock);
+
+            icym_in_parallel = 1;
+            icym_pool_work(pool, 0);
+            icym_in_parallel = 0;
+
+            for(int i = 0; i < CYM_THREAD_SPIN && __atomic_load_n(&pool->busy, __ATOMIC_ACQUIRE); i+=1) icym_spin(i);
+            pthread_mutex_lock(&pool->lock);
+            while(__atomic_load_n(&pool->busy, __ATOMIC_ACQUIRE)) pthread_cond_wait(&pool->done, &pool->lock);
+            pthread_mutex_unlock(&pool->lock);
+
+            pthread_mutex_unlock(&pool->region);
+            return;
         }
-        printf("\n");
     }
-    printf("\n");
+#endif
+    for(size_t chunk = 0; chunk < chunk_count; chunk+=1) task(chunk, 0, user);
 }
 
-// X===============================================X (DATA ANALYSIS) X=================================================X
+typedef struct ICymParallelFor{
+    size_t begin, end, grain;
+    void (*body)(size_t begin, size_t end, void* user);
+    void (*reduce_body)(size_t begin, size_t end, void* partial, void* user);
+    void* user;
+    uint8_t* partials;
+    size_t partial_size;
+} ICymParallelFor;
+
+static void icym_parallel_for_task(size_t chunk, unsigned int worker, void* user){
+    const ICymParallelFor* job = (const ICymParallelFor*)user;
+    const size_t begin = job->begin + chunk * job->grain;
+    const size_t end   = (job->end - begin < job->grain)? job->end : begin + job->grain;
+    (void)worker;
+    if(job->body) job->body(begin, end, job->user);
+    else          job->reduce_body(begin, end, job->partials + chunk * job->partial_size, job->user);
+}
 
-int cym_interpol(const CYM_FLOAT* x, const CYM_FLOAT* y, size_t number_of_points, CYM_FLOAT* output){
+void cym_parallel_for(size_t begin, size_t end, size_t grain, void (*body)(size_t begin, size_t end, void* user), void* user){
+    if(end <= begin) return;
+    if(grain == 0) grain = 1;
 
-    CYM_FLOAT* a = (CYM_FLOAT*)malloc(number_of_points * number_of_points * sizeof(CYM_FLOAT) + number_of_points * sizeof(CYM_FLOAT));
+    ICymParallelFor job = { begin, end, grain, body, NULL, user, NULL, 0 };
+    icym_parallel_run((end - begin + grain - 1) / grain, icym_parallel_for_task, &job);
+}
 
-    CYM_FLOAT* y_ = a + number_of_points * number_of_points;
+size_t cym_parallel_reduce_workspace_size(size_t begin, size_t end, size_t grain, size_t result_size){
+    if(end <= begin) return 0;
+    if(grain == 0) grain = 1;
+    return ICYM_WORKSPACE_ALIGN + icym_workspace_bytes((end - begin + grain - 1) / grain * result_size);
+}
 
-    for(size_t i = 0; i < number_of_points; i+=1){
-        y_[i] = y[i];
+int cym_parallel_reduce_ws(size_t begin, size_t end, size_t grain, void* result, size_t result_size,
+    void (*body)(size_t begin, size_t end, void* partial, void* user),
+    void (*combine)(void* result, const void* partial, void* user), void* user, void* workspace, size_t workspace_size){
+
+    if(end <= begin) return 0;
+    if(grain == 0) grain = 1;
+
+    const size_t chunk_count = (end - begin + grain - 1) / grain;
+    // serially one partial is reused, the combination order is the same, so a workspace too small for a partial per chunk
+    // only costs the threads
+    ICymWorkspace ws = icym_workspace(workspace, workspace_size);
+    size_t partial_count = (icym_parallel_workers(chunk_count) > 1)? chunk_count : 1;
+    uint8_t* partials = (uint8_t*)icym_workspace_take(&ws, partial_count * result_size);
+    if(!partials && partial_count > 1){
+        partial_count = 1;
+        partials = (uint8_t*)icym_workspace_take(&ws, result_size);
     }
+    if(!partials) return 1;
 
-    for(size_t i = 0; i < number_of_points; i+=1){
-        a[i * number_of_points] = 1.0;
-        const CYM_FLOAT xn = x[i];
-        for(size_t j = 1; j < number_of_points; j+=1){
-            a[i * number_of_points + j] = a[i * number_of_points + j - 1] * xn;
+    if(partial_count == 1){
+        for(size_t chunk = 0; chunk < chunk_count; chunk+=1){
+            const size_t first = begin + chunk * grain;
+            body(first, (end - first < grain)? end : first + grain, partials, user);
+            combine(result, partials, user);
         }
+    } else{
+        ICymParallelFor job = { begin, end, grain, NULL, body, user, partials, result_size };
+        icym_parallel_run(chunk_count, icym_parallel_for_task, &job);
+        for(size_t chunk = 0; chunk < chunk_count; chunk+=1) combine(result, partials + chunk * result_size, user);
     }
 
-    cym_solve_gauss(a, y_, number_of_points, output);
-
-    free(a);
-
     return 0;
 }
 
-void cym_linear_fit(const CYM_FLOAT* x, const CYM_FLOAT* y, size_t number_of_points, CYM_FLOAT* a, CYM_FLOAT* b, CYM_FLOAT* r){
+int cym_parallel_reduce(size_t begin, size_t end, size_t grain, void* result, size_t result_size,
+    void (*body)(size_t begin, size_t end, void* partial, void* user),
+    void (*combine)(void* result, const void* partial, void* user), void* user){
 
-    CYM_FLOAT sumx  = 0;
-    CYM_FLOAT sumx2 = 0;
-    CYM_FLOAT sumy  = 0;
-    CYM_FLOAT sumy2 = 0;
-    CYM_FLOAT sumyx = 0;
+    if(end <= begin) return 0;
+    if(grain == 0) grain = 1;
 
-    for (size_t i = 0; i < number_of_points; i++){
-        sumx  += x[i];
-        sumx2 += x[i] * x[i];
-        sumy  += y[i];
-        sumy2 += y[i] * y[i];
-        sumyx += y[i] * x[i];
-    }
+    // the partials of the threads, or the single one of a serial run
+    const size_t chunk_count = (end - begin + grain - 1) / grain;
+    const size_t partial_count = (icym_parallel_workers(chunk_count) > 1)? chunk_count : 1;
+    size_t size = ICYM_WORKSPACE_ALIGN + icym_workspace_bytes(partial_count * result_size);
 
-    const CYM_FLOAT ar_numerador  = (number_of_points * sumyx - sumx * sumy);
-    const CYM_FLOAT a_denominador = (number_of_points * sumx2 - sumx * sumx);
+    uint8_t stack[ICYM_STACK_WORKSPACE];
+    void* workspace = icym_workspace_alloc(size, stack);
+    if(!workspace && partial_count > 1){
+        size = ICYM_WORKSPACE_ALIGN + icym_workspace_bytes(result_size);
+        workspace = icym_workspace_alloc(size, stack);
+    }
+    if(!workspace) return 1;
 
-    *a = ar_numerador / a_denominador;
-    *b = (sumy - (*a) * sumx) / number_of_points;
-    *r = ar_numerador * cym_Q_rsqrt_d((number_of_points * sumy2 - sumy * sumy) * a_denominador);
+    const int status = cym_parallel_reduce_ws(begin, end, grain, result, result_size, body, combine, user, workspace, size);
+    icym_workspace_free(workspace, stack);
+    return status;
 }
 
-int cym_rlinear_fit(const CYM_FLOAT* x, const CYM_FLOAT* y, const CYM_FLOAT* dx, const CYM_FLOAT* dy,
-        size_t number_of_points, CYM_FLOAT* a, CYM_FLOAT* b, CYM_FLOAT* da, CYM_FLOAT* db ,CYM_FLOAT* r){
+// correctly rounded square roots without linking libm: the sse2 instructions on x86, the builtins when they can't set errno
+static inline double icym_sqrt_d(double x){
+#if defined(__SSE2__)
+    return _mm_cvtsd_f64(_mm_sqrt_sd(_mm_set_sd(x), _mm_set_sd(x)));
+#elif defined(__NO_MATH_ERRNO__)
+    return __builtin_sqrt(x);
+#else
+    // 0, inf and NaN are their own roots, the estimate would turn them into NaN
+    if(!(x > 0) || x - x != 0) return (x < 0)? 0.0 / 0.0 : x;
+    return x * cym_Q_rsqrt_d(x);
+#endif
+}
 
-    CYM_FLOAT sumx  = 0;
-    CYM_FLOAT sumx2 = 0;
-    CYM_FLOAT sumy  = 0;
-    CYM_FLOAT sumy2 = 0;
-    CYM_FLOAT sumyx = 0;
+static inline float icym_sqrt_f(float x){
+#if defined(__SSE2__)
+    return _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(x)));
+#elif defined(__NO_MATH_ERRNO__)
+    return __builtin_sqrtf(x);
+#else
+    return (float)icym_sqrt_d(x);
+#endif
+}
 
-    for (size_t i = 0; i < number_of_points; i++){
-        sumx  += x[i];
-        sumx2 += x[i] * x[i];
-        sumy  += y[i];
-        sumy2 += y[i] * y[i];
-        sumyx += y[i] * x[i];
-    }
+// adds value to the sum term of acc, Neumaier's compensated summation: the rounding error of each addition goes to the
+// compensation, whichever of the two operands is bigger
+static inline void icym_fit_acc_add(CymFitAcc* acc, int term, double value){
+    const double sum = acc->sums[term];
+    const double t   = sum + value;
+    if(CYM_ABS(sum) >= CYM_ABS(value)) acc->compensations[term] += (sum - t) + value;
+    else                               acc->compensations[term] += (value - t) + sum;
+    acc->sums[term] = t;
+}
 
-    const CYM_FLOAT a_numerador  = (number_of_points * sumyx - sumx * sumy);
-    const CYM_FLOAT a_denominador = (number_of_points * sumx2 - sumx * sumx);
+// points summed by the SIMD kernels before each compensated addition
+#define ICYM_FIT_BLOCK 512
 
-    CYM_FLOAT av = a_numerador / a_denominador;
-    CYM_FLOAT bv = (sumy - av * sumx) / number_of_points;
-    *r           = a_numerador * cym_Q_rsqrt_d((number_of_points * sumy2 - sumy * sumy) * a_denominador);
+static void icym_fit_acc_combine(void* result, const void* partial, void* user){
+    (void)user;
+    cym_fit_acc_merge((CymFitAcc*)result, (const CymFitAcc*)partial);
+}
 
-    CYM_FLOAT last_b = bv + 1;
-    CYM_FLOAT dav    = 0;
-    CYM_FLOAT dbv    = 0;
+// the float and double instantiations of the kernels
+#define ICYM_PRECISION_PASS
+#define ICYM_T double
+#define ICYM_F32 0
+#define ICYM_FN(name) name##_d
+#include "cymath.h"
+#undef ICYM_T
+#undef ICYM_F32
+#undef ICYM_FN
+#define ICYM_T float
+#define ICYM_F32 1
+#define ICYM_FN(name) name##_f
+#include "cymath.h"
+#undef ICYM_T
+#undef ICYM_F32
+#undef ICYM_FN
+#undef ICYM_PRECISION_PASS
+
+// the CYM_FLOAT functions forward to the float or double instantiation
+typedef char icym_cym_float_must_be_float_or_double[(sizeof(CYM_FLOAT) == sizeof(float) || sizeof(CYM_FLOAT) == sizeof(double))? 1 : -1];
+#define ICYM_FLOAT_IS_F32 (sizeof(CYM_FLOAT) == sizeof(float))
+// casts the CYM_FLOAT callback F to the callback type TYPE of an instantiation, through void (*)(void) so the branch of the
+// other precision (never taken) does not warn about incompatible function types
+#define ICYM_CALLBACK_CAST(TYPE, F) ((TYPE)(void (*)(void))(F))
 
-    int iterations = 0;
 
-    while(CYM_ABS(bv - last_b) > dbv && iterations++ < 1000){
-        last_b = bv;
 
-        CYM_FLOAT sumw   = 0;
-        CYM_FLOAT sumwx  = 0;
-        CYM_FLOAT sumwx2 = 0;
-        CYM_FLOAT sumwy  = 0;
-        CYM_FLOAT sumwxy = 0;
+CYM_FLOAT cym_absf(CYM_FLOAT x){ return x > 0? x : -x; }
 
-        for (size_t i = 0; i < number_of_points; i+=1)
-        {
-            const CYM_FLOAT w = 1.0 / (dy[i] * dy[i] + dx[i] * dx[i] * av * av);
+double cym_Q_rsqrt_d(double number) {
+    const double x2 = number * 0.5;
+    const double threehalfs = 1.5;
 
-            sumw   += w;
-            sumwx  += w * x[i];
-            sumwx2 += w * x[i] * x[i];
-            sumwy  += w * y[i];
-            sumwxy += w * x[i] * y[i];
+    union {
+        double d;
+        uint64_t i;
+    } conv = {number};
 
-        }
+    conv.i = 0x5fe6ec85e7de30da - (conv.i >> 1);
 
-        const CYM_FLOAT val = sumw * sumwx2 - sumwx * sumwx;
+    conv.d = conv.d * (threehalfs - (x2 * conv.d * conv.d));
+    conv.d = conv.d * (threehalfs - (x2 * conv.d * conv.d));
+    conv.d = conv.d * (threehalfs - (x2 * conv.d * conv.d));
+    conv.d = conv.d * (threehalfs - (x2 * conv.d * conv.d));
+    conv.d = conv.d * (threehalfs - (x2 * conv.d * conv.d));
 
-        av  = (sumw * sumwxy - sumwx * sumwy) / val;
-        bv  = (sumwy - sumwx * av) / sumw;
-        dav = 1.0 / cym_Q_rsqrt_d(sumw / val);
-        dbv = 1.0 / cym_Q_rsqrt_d(sumwx2 / val);
-    }
-    
-    if(iterations > 1000){
-        return -1;
-    }
+    return conv.d;
+}
 
-    *a  = av;
-    *b  = bv;
-    *da = dav;
-    *db = dbv;
+#define cym_sqrt(VALUE) icym_sqrt_d(VALUE)
 
-    return 0;
+CYM_FLOAT cym_normalize_vec(const CYM_FLOAT* vector, unsigned int size, CYM_FLOAT* ouput){
+    if(ICYM_FLOAT_IS_F32) return (CYM_FLOAT)cym_normalize_vec_f((const float*)vector, size, (float*)ouput);
+    return (CYM_FLOAT)cym_normalize_vec_d((const double*)vector, size, (double*)ouput);
 }
 
-/*
-    x0, x1, x2, x3 = x0y
-    x1, x2, x3, x4 = x1y
-    x2, x3, x4, x5 = x2y
-    x3, x4, x5, x6 = x3y
-*/
-int cym_poly_fit(const CYM_FLOAT* x, const CYM_FLOAT* y, size_t number_of_points, int order, CYM_FLOAT* output){
-
-    const int columns = order + 1;
-    const int rows    = order + 1;
+void cym_mat_transpose(const CYM_FLOAT* input, unsigned int sizex, unsigned int sizey, CYM_FLOAT* output){
+    if(ICYM_FLOAT_IS_F32) cym_mat_transpose_f((const float*)input, sizex, sizey, (float*)output);
+    else                  cym_mat_transpose_d((const double*)input, sizex, sizey, (double*)output);
+}
 
-    CYM_FLOAT* system = (CYM_FLOAT*)malloc(
-        (order + 1) * (order + 1) * sizeof(CYM_FLOAT) + number_of_points * sizeof(CYM_FLOAT)
-    );
-    CYM_FLOAT* y__ = system + number_of_points * number_of_points;
+void cym_normalize_vecs(const CYM_FLOAT* vectors, size_t count, size_t dim, CYM_FLOAT* output, CYM_FLOAT* norms, int fast){
+    if(ICYM_FLOAT_IS_F32) cym_normalize_vecs_f((const float*)vectors, count, dim, (float*)output, (float*)norms, fast);
+    else                  cym_normalize_vecs_d((const double*)vectors, count, dim, (double*)output, (double*)norms, fast);
+}
 
-    for(size_t m = 1; m < columns; m+=1){
-        system[m] = 0;
-    }
+void cym_normalize_vecs_soa(const CYM_FLOAT* vectors, size_t count, size_t dim, CYM_FLOAT* output, CYM_FLOAT* norms, int fast){
+    if(ICYM_FLOAT_IS_F32) cym_normalize_vecs_soa_f((const float*)vectors, count, dim, (float*)output, (float*)norms, fast);
+    else                  cym_normalize_vecs_soa_d((const double*)vectors, count, dim, (double*)output, (double*)norms, fast);
+}
 
-    for(size_t n = 0; n < rows; n+=1){
-        system[n * columns + (columns - 1)] = 0;
-    }
+void cym_rsqrt_batch(const CYM_FLOAT* x, size_t n, CYM_FLOAT* out, int fast){
+    if(ICYM_FLOAT_IS_F32) cym_rsqrt_batch_f((const float*)x, n, (float*)out, fast);
+    else                  cym_rsqrt_batch_d((const double*)x, n, (double*)out, fast);
+}
 
-    y__[0] = 0;
+void cym_sqrt_batch(const CYM_FLOAT* x, size_t n, CYM_FLOAT* out){
+    if(ICYM_FLOAT_IS_F32) cym_sqrt_batch_f((const float*)x, n, (float*)out);
+    else                  cym_sqrt_batch_d((const double*)x, n, (double*)out);
+}
 
-    for(size_t i = 0; i < number_of_points; i+=1){
+int cym_mat_transpose_inplace(CYM_FLOAT* mat, unsigned int sizex, unsigned int sizey){
+    if(ICYM_FLOAT_IS_F32) return cym_mat_transpose_inplace_f((float*)mat, sizex, sizey);
+    return cym_mat_transpose_inplace_d((double*)mat, sizex, sizey);
+}
 
-        const CYM_FLOAT yi = y[i];
+void cym_axpy(size_t n, CYM_FLOAT alpha, const CYM_FLOAT* x, ptrdiff_t incx, CYM_FLOAT* y, ptrdiff_t incy){
+    if(ICYM_FLOAT_IS_F32) cym_axpy_f(n, (float)alpha, (const float*)x, incx, (float*)y, incy);
+    else                  cym_axpy_d(n, (double)alpha, (const double*)x, incx, (double*)y, incy);
+}
 
-        CYM_FLOAT xi = x[i];
+void cym_axpby(size_t n, CYM_FLOAT alpha, const CYM_FLOAT* x, ptrdiff_t incx, CYM_FLOAT beta, CYM_FLOAT* y, ptrdiff_t incy){
+    if(ICYM_FLOAT_IS_F32) cym_axpby_f(n, (float)alpha, (const float*)x, incx, (float)beta, (float*)y, incy);
+    else                  cym_axpby_d(n, (double)alpha, (const double*)x, incx, (double)beta, (double*)y, incy);
+}
 
-        y__[0] += yi;
+void cym_waxpby(size_t n, CYM_FLOAT alpha, const CYM_FLOAT* x, ptrdiff_t incx, CYM_FLOAT beta, const CYM_FLOAT* y, ptrdiff_t incy,
+    CYM_FLOAT* w, ptrdiff_t incw){
+    if(ICYM_FLOAT_IS_F32) cym_waxpby_f(n, (float)alpha, (const float*)x, incx, (float)beta, (const float*)y, incy, (float*)w, incw);
+    else                  cym_waxpby_d(n, (double)alpha, (const double*)x, incx, (double)beta, (const double*)y, incy, (double*)w, incw);
+}
 
-        for(size_t m = 1; m < columns; m+=1){
+void cym_scal(size_t n, CYM_FLOAT alpha, CYM_FLOAT* x, ptrdiff_t incx){
+    if(ICYM_FLOAT_IS_F32) cym_scal_f(n, (float)alpha, (float*)x, incx);
+    else                  cym_scal_d(n, (double)alpha, (double*)x, incx);
+}
 
-            y__[m] += xi * yi;
+CYM_FLOAT cym_dot(size_t n, const CYM_FLOAT* x, ptrdiff_t incx, const CYM_FLOAT* y, ptrdiff_t incy){
+    if(ICYM_FLOAT_IS_F32) return (CYM_FLOAT)cym_dot_f(n, (const float*)x, incx, (const float*)y, incy);
+    return (CYM_FLOAT)cym_dot_d(n, (const double*)x, incx, (const double*)y, incy);
+}
 
-            system[m] += xi;
-            xi *= x[i];
+CYM_FLOAT cym_nrm2(size_t n, const CYM_FLOAT* x, ptrdiff_t incx){
+    if(ICYM_FLOAT_IS_F32) return (CYM_FLOAT)cym_nrm2_f(n, (const float*)x, incx);
+    return (CYM_FLOAT)cym_nrm2_d(n, (const double*)x, incx);
+}
 
-        }
+CYM_FLOAT cym_asum(size_t n, const CYM_FLOAT* x, ptrdiff_t incx){
+    if(ICYM_FLOAT_IS_F32) return (CYM_FLOAT)cym_asum_f(n, (const float*)x, incx);
+    return (CYM_FLOAT)cym_asum_d(n, (const double*)x, incx);
+}
 
-        for(size_t n = 1; n < rows; n+=1){
-            system[n * columns + (columns - 1)] += xi;
-            xi *= x[i];
-        }
+size_t cym_iamax(size_t n, const CYM_FLOAT* x, ptrdiff_t incx){
+    if(ICYM_FLOAT_IS_F32) return cym_iamax_f(n, (const float*)x, incx);
+    return cym_iamax_d(n, (const double*)x, incx);
+}
 
-    }
+void cym_mat_scale(CYM_FLOAT scalar, const CYM_FLOAT* mat, unsigned int sizex, unsigned int sizey, CYM_FLOAT* output){
+    if(ICYM_FLOAT_IS_F32) cym_mat_scale_f((float)scalar, (const float*)mat, sizex, sizey, (float*)output);
+    else                  cym_mat_scale_d((double)scalar, (const double*)mat, sizex, sizey, (double*)output);
+}
 
-    system[0] = number_of_points;
+void cym_mat_sum(const CYM_FLOAT* mat1, const CYM_FLOAT* mat2, unsigned int sizex, unsigned int sizey, CYM_FLOAT* output){
+    if(ICYM_FLOAT_IS_F32) cym_mat_sum_f((const float*)mat1, (const float*)mat2, sizex, sizey, (float*)output);
+    else                  cym_mat_sum_d((const double*)mat1, (const double*)mat2, sizex, sizey, (double*)output);
+}
 
-    for(size_t n = 1; n < rows; n+=1){
-        for(size_t m = 0; m < columns - 1; m+=1){
+void cym_mat_sub(const CYM_FLOAT* mat1, const CYM_FLOAT* mat2, unsigned int sizex, unsigned int sizey, CYM_FLOAT* output){
+    if(ICYM_FLOAT_IS_F32) cym_mat_sub_f((const float*)mat1, (const float*)mat2, sizex, sizey, (float*)output);
+    else                  cym_mat_sub_d((const double*)mat1, (const double*)mat2, sizex, sizey, (double*)output);
+}
 
-            system[n * columns + m] = system[(n - 1) * columns + (m + 1)];
+void cym_mat_multiply(const CYM_FLOAT* mat_1, unsigned int mat1_sizex, unsigned int mat1_sizey,
+    const CYM_FLOAT* mat_2, unsigned int mat2_sizex, CYM_FLOAT* output){
+    if(ICYM_FLOAT_IS_F32){
+        cym_mat_multiply_f((const float*)mat_1, mat1_sizex, mat1_sizey, (const float*)mat_2, mat2_sizex, (float*)output);
+    } else{
+        cym_mat_multiply_d((const double*)mat_1, mat1_sizex, mat1_sizey, (const double*)mat_2, mat2_sizex, (double*)output);
+    }
+}
 
-        }
+void cym_gemm(size_t m, size_t n, size_t k, CYM_FLOAT alpha, const CYM_FLOAT* a, ptrdiff_t a_rs, ptrdiff_t a_cs,
+    const CYM_FLOAT* b, ptrdiff_t b_rs, ptrdiff_t b_cs, CYM_FLOAT beta, CYM_FLOAT* c, ptrdiff_t c_rs, ptrdiff_t c_cs){
+    if(ICYM_FLOAT_IS_F32){
+        cym_gemm_f(m, n, k, (float)alpha, (const float*)a, a_rs, a_cs, (const float*)b, b_rs, b_cs, (float)beta, (float*)c, c_rs, c_cs);
+    } else{
+        cym_gemm_d(m, n, k, (double)alpha, (const double*)a, a_rs, a_cs, (const double*)b, b_rs, b_cs, (double)beta, (double*)c, c_rs, c_cs);
     }
+}
 
-    cym_solve_gauss(system, y__, order + 1, output); 
+int cym_lu_factor(CYM_FLOAT* a, unsigned int size, unsigned int* pivots){
+    if(ICYM_FLOAT_IS_F32) return cym_lu_factor_f((float*)a, size, pivots);
+    return cym_lu_factor_d((double*)a, size, pivots);
+}
 
-    free(system);
+void cym_lu_solve(const CYM_FLOAT* lu, const unsigned int* pivots, unsigned int size, const CYM_FLOAT* y, CYM_FLOAT* x){
+    if(ICYM_FLOAT_IS_F32) cym_lu_solve_f((const float*)lu, pivots, size, (const float*)y, (float*)x);
+    else                  cym_lu_solve_d((const double*)lu, pivots, size, (const double*)y, (double*)x);
+}
 
-    return 0;
+void cym_lu_solve_many(const CYM_FLOAT* lu, const unsigned int* pivots, unsigned int size, const CYM_FLOAT* y, unsigned int count, CYM_FLOAT* x){
+    if(ICYM_FLOAT_IS_F32) cym_lu_solve_many_f((const float*)lu, pivots, size, (const float*)y, count, (float*)x);
+    else                  cym_lu_solve_many_d((const double*)lu, pivots, size, (const double*)y, count, (double*)x);
 }
 
+CYM_FLOAT cym_lu_determinant(const CYM_FLOAT* lu, const unsigned int* pivots, unsigned int size){
+    if(ICYM_FLOAT_IS_F32) return (CYM_FLOAT)cym_lu_determinant_f((const float*)lu, pivots, size);
+    return (CYM_FLOAT)cym_lu_determinant_d((const double*)lu, pivots, size);
+}
 
-CYM_FLOAT cym_newton_method(CYM_FLOAT (*function)(CYM_FLOAT), CYM_FLOAT guess, CYM_FLOAT value, CYM_FLOAT accuracy, CYM_FLOAT step){
-    
-    const int max_iterations = 1000;
+void cym_lu_inverse(const CYM_FLOAT* lu, const unsigned int* pivots, unsigned int size, CYM_FLOAT* output){
+    if(ICYM_FLOAT_IS_F32) cym_lu_inverse_f((const float*)lu, pivots, size, (float*)output);
+    else                  cym_lu_inverse_d((const double*)lu, pivots, size, (double*)output);
+}
 
-    int i = 0;
+int cym_qr_factor(CYM_FLOAT* a, size_t rows, size_t columns, CYM_FLOAT* tau){
+    if(ICYM_FLOAT_IS_F32) return cym_qr_factor_f((float*)a, rows, columns, (float*)tau);
+    return cym_qr_factor_d((double*)a, rows, columns, (double*)tau);
+}
 
-    CYM_FLOAT fx = function(guess) - value;
+void cym_qr_apply_qt(const CYM_FLOAT* qr, const CYM_FLOAT* tau, size_t rows, size_t columns, CYM_FLOAT* b, size_t count){
+    if(ICYM_FLOAT_IS_F32) cym_qr_apply_qt_f((const float*)qr, (const float*)tau, rows, columns, (float*)b, count);
+    else                  cym_qr_apply_qt_d((const double*)qr, (const double*)tau, rows, columns, (double*)b, count);
+}
 
-    while (CYM_ABS(fx) > accuracy && i < max_iterations){
+int cym_cholesky_factor(CYM_FLOAT* a, unsigned int size){
+    if(ICYM_FLOAT_IS_F32) return cym_cholesky_factor_f((float*)a, size);
+    return cym_cholesky_factor_d((double*)a, size);
+}
 
-        const CYM_FLOAT dfx = function(guess + step) - value - fx;
+void cym_cholesky_solve(const CYM_FLOAT* r, unsigned int size, const CYM_FLOAT* y, CYM_FLOAT* x){
+    if(ICYM_FLOAT_IS_F32) cym_cholesky_solve_f((const float*)r, size, (const float*)y, (float*)x);
+    else                  cym_cholesky_solve_d((const double*)r, size, (const double*)y, (double*)x);
+}
 
-        guess = guess - fx / dfx;
+int cym_lstsq(CYM_FLOAT* a, size_t rows, size_t columns, CYM_FLOAT* b, size_t count, CYM_FLOAT* x, int flags){
+    if(ICYM_FLOAT_IS_F32) return cym_lstsq_f((float*)a, rows, columns, (float*)b, count, (float*)x, flags);
+    return cym_lstsq_d((double*)a, rows, columns, (double*)b, count, (double*)x, flags);
+}
 
-        fx = function(guess) - value;
+size_t cym_lstsq_workspace_size(size_t rows, size_t columns, size_t count, int flags){
+    if(ICYM_FLOAT_IS_F32) return cym_lstsq_workspace_size_f(rows, columns, count, flags);
+    return cym_lstsq_workspace_size_d(rows, columns, count, flags);
+}
 
-        i += 1;
+int cym_lstsq_ws(CYM_FLOAT* a, size_t rows, size_t columns, CYM_FLOAT* b, size_t count, CYM_FLOAT* x, int flags, void* workspace,
+    size_t workspace_size){
+    if(ICYM_FLOAT_IS_F32){
+        return cym_lstsq_ws_f((float*)a, rows, columns, (float*)b, count, (float*)x, flags, workspace, workspace_size);
     }
-    
-    
-    return guess;
+    return cym_lstsq_ws_d((double*)a, rows, columns, (double*)b, count, (double*)x, flags, workspace, workspace_size);
 }
 
-/* TODO:
-typedef struct CYM_IMAT
-{
-    CYM_FLOAT* data;
-    size_t     rows;
-    size_t     columns;
-    size_t     stride;
-} CYM_IMAT;
+void cym_solve_gauss(CYM_FLOAT* a, CYM_FLOAT* y, unsigned int size, CYM_FLOAT* x){
+    if(ICYM_FLOAT_IS_F32) cym_solve_gauss_f((float*)a, (float*)y, size, (float*)x);
+    else                  cym_solve_gauss_d((double*)a, (double*)y, size, (double*)x);
+}
+
+int cym_make_unitary(const CYM_FLOAT* input, unsigned int size, CYM_FLOAT* output){
+    if(ICYM_FLOAT_IS_F32) return cym_make_unitary_f((const float*)input, size, (float*)output);
+    return cym_make_unitary_d((const double*)input, size, (double*)output);
+}
+
+int cym_make_unitary_reflector(const CYM_FLOAT* input, unsigned int size, CYM_FLOAT* w){
+    if(ICYM_FLOAT_IS_F32) return cym_make_unitary_reflector_f((const float*)input, size, (float*)w);
+    return cym_make_unitary_reflector_d((const double*)input, size, (double*)w);
+}
+
+void cym_apply_unitary_reflector(const CYM_FLOAT* w, unsigned int size, CYM_FLOAT* x, size_t count){
+    if(ICYM_FLOAT_IS_F32) cym_apply_unitary_reflector_f((const float*)w, size, (float*)x, count);
+    else                  cym_apply_unitary_reflector_d((const double*)w, size, (double*)x, count);
+}
+
+int cym_test_unitary(const CYM_FLOAT* mat, unsigned int size, double accuracy){
+    if(ICYM_FLOAT_IS_F32) return cym_test_unitary_f((const float*)mat, size, accuracy);
+    return cym_test_unitary_d((const double*)mat, size, accuracy);
+}
+
+int cym_test_unitary_deviation(const CYM_FLOAT* mat, unsigned int size, double accuracy, double* deviation){
+    if(ICYM_FLOAT_IS_F32) return cym_test_unitary_deviation_f((const float*)mat, size, accuracy, deviation);
+    return cym_test_unitary_deviation_d((const double*)mat, size, accuracy, deviation);
+}
+
+void cym_mat_print(const char* name, const CYM_FLOAT* mat, unsigned int sizey, unsigned int sizex){
+    if(ICYM_FLOAT_IS_F32) cym_mat_print_f(name, (const float*)mat, sizey, sizex);
+    else                  cym_mat_print_d(name, (const double*)mat, sizey, sizex);
+}
+
+// X===============================================X (MATRIX VIEWS) X==================================================X
+// the views are plain index arithmetic, so the CYM_FLOAT ones are built here and the routines convert them field by field
+
+CYM_IMAT cym_imat(CYM_FLOAT* data, size_t rows, size_t columns){
+    CYM_IMAT m = { data, rows, columns, (ptrdiff_t)columns, 1 };
+    return m;
+}
+
+CYM_IMAT cym_imat_sub(CYM_IMAT m, size_t row, size_t column, size_t rows, size_t columns){
+    m.data    = &CYM_IMAT_AT(m, row, column);
+    m.rows    = rows;
+    m.columns = columns;
+    return m;
+}
+
+CYM_IMAT cym_imat_row(CYM_IMAT m, size_t i){ return cym_imat_sub(m, i, 0, 1, m.columns); }
+
+CYM_IMAT cym_imat_col(CYM_IMAT m, size_t j){ return cym_imat_sub(m, 0, j, m.rows, 1); }
+
+CYM_IMAT cym_imat_transpose(CYM_IMAT m){
+    CYM_IMAT t = { m.data, m.columns, m.rows, m.cstride, m.stride };
+    return t;
+}
+
+static inline CYM_IMAT_d icym_imat_d(CYM_IMAT m){
+    CYM_IMAT_d v = { (double*)m.data, m.rows, m.columns, m.stride, m.cstride };
+    return v;
+}
+
+static inline CYM_IMAT_f icym_imat_f(CYM_IMAT m){
+    CYM_IMAT_f v = { (float*)m.data, m.rows, m.columns, m.stride, m.cstride };
+    return v;
+}
+
+int cym_imat_multiply(CYM_FLOAT alpha, CYM_IMAT a, CYM_IMAT b, CYM_FLOAT beta, CYM_IMAT c){
+    if(ICYM_FLOAT_IS_F32) return cym_imat_multiply_f((float)alpha, icym_imat_f(a), icym_imat_f(b), (float)beta, icym_imat_f(c));
+    return cym_imat_multiply_d(alpha, icym_imat_d(a), icym_imat_d(b), beta, icym_imat_d(c));
+}
+
+int cym_imat_axpby(CYM_FLOAT alpha, CYM_IMAT x, CYM_FLOAT beta, CYM_IMAT y){
+    if(ICYM_FLOAT_IS_F32) return cym_imat_axpby_f((float)alpha, icym_imat_f(x), (float)beta, icym_imat_f(y));
+    return cym_imat_axpby_d(alpha, icym_imat_d(x), beta, icym_imat_d(y));
+}
+
+int cym_imat_copy(CYM_IMAT src, CYM_IMAT dst){
+    if(ICYM_FLOAT_IS_F32) return cym_imat_copy_f(icym_imat_f(src), icym_imat_f(dst));
+    return cym_imat_copy_d(icym_imat_d(src), icym_imat_d(dst));
+}
+
+int cym_smatmul(CYM_IMAT mat1, CYM_IMAT mat2, CYM_FLOAT* output){
+    if(ICYM_FLOAT_IS_F32) return cym_smatmul_f(icym_imat_f(mat1), icym_imat_f(mat2), (float*)output);
+    return cym_smatmul_d(icym_imat_d(mat1), icym_imat_d(mat2), (double*)output);
+}
+
+static inline CymComplex_d icym_complex_d(CymComplex z){
+    CymComplex_d v = { (double)z.re, (double)z.im };
+    return v;
+}
+
+static inline CymComplex_f icym_complex_f(CymComplex z){
+    CymComplex_f v = { (float)z.re, (float)z.im };
+    return v;
+}
+
+void cym_cgemm(size_t m, size_t n, size_t k, CymComplex alpha, const CymComplex* a, ptrdiff_t a_rs, ptrdiff_t a_cs,
+    const CymComplex* b, ptrdiff_t b_rs, ptrdiff_t b_cs, CymComplex beta, CymComplex* c, ptrdiff_t c_rs, ptrdiff_t c_cs,
+    int conjugate){
+
+    if(ICYM_FLOAT_IS_F32){
+        cym_cgemm_f(m, n, k, icym_complex_f(alpha), (const CymComplex_f*)a, a_rs, a_cs, (const CymComplex_f*)b, b_rs, b_cs,
+            icym_complex_f(beta), (CymComplex_f*)c, c_rs, c_cs, conjugate);
+    } else{
+        cym_cgemm_d(m, n, k, icym_complex_d(alpha), (const CymComplex_d*)a, a_rs, a_cs, (const CymComplex_d*)b, b_rs, b_cs,
+            icym_complex_d(beta), (CymComplex_d*)c, c_rs, c_cs, conjugate);
+    }
+}
+
+void cym_cmat_multiply(const CymComplex* mat_1, unsigned int mat1_sizex, unsigned int mat1_sizey, const CymComplex* mat_2,
+    unsigned int mat2_sizex, CymComplex* output){
+
+    if(ICYM_FLOAT_IS_F32){
+        cym_cmat_multiply_f((const CymComplex_f*)mat_1, mat1_sizex, mat1_sizey, (const CymComplex_f*)mat_2, mat2_sizex,
+            (CymComplex_f*)output);
+    } else{
+        cym_cmat_multiply_d((const CymComplex_d*)mat_1, mat1_sizex, mat1_sizey, (const CymComplex_d*)mat_2, mat2_sizex,
+            (CymComplex_d*)output);
+    }
+}
+
+void cym_cmat_transpose(const CymComplex* input, unsigned int sizex, unsigned int sizey, CymComplex* output){
+    if(ICYM_FLOAT_IS_F32) cym_cmat_transpose_f((const CymComplex_f*)input, sizex, sizey, (CymComplex_f*)output);
+    else                  cym_cmat_transpose_d((const CymComplex_d*)input, sizex, sizey, (CymComplex_d*)output);
+}
+
+void cym_cmat_conj_transpose(const CymComplex* input, unsigned int sizex, unsigned int sizey, CymComplex* output){
+    if(ICYM_FLOAT_IS_F32) cym_cmat_conj_transpose_f((const CymComplex_f*)input, sizex, sizey, (CymComplex_f*)output);
+    else                  cym_cmat_conj_transpose_d((const CymComplex_d*)input, sizex, sizey, (CymComplex_d*)output);
+}
+
+void cym_cmat_scale(CymComplex scalar, const CymComplex* mat, unsigned int sizex, unsigned int sizey, CymComplex* output){
+    if(ICYM_FLOAT_IS_F32){
+        cym_cmat_scale_f(icym_complex_f(scalar), (const CymComplex_f*)mat, sizex, sizey, (CymComplex_f*)output);
+    } else{
+        cym_cmat_scale_d(icym_complex_d(scalar), (const CymComplex_d*)mat, sizex, sizey, (CymComplex_d*)output);
+    }
+}
+
+void cym_cmat_sum(const CymComplex* mat1, const CymComplex* mat2, unsigned int sizex, unsigned int sizey, CymComplex* output){
+    if(ICYM_FLOAT_IS_F32){
+        cym_cmat_sum_f((const CymComplex_f*)mat1, (const CymComplex_f*)mat2, sizex, sizey, (CymComplex_f*)output);
+    } else{
+        cym_cmat_sum_d((const CymComplex_d*)mat1, (const CymComplex_d*)mat2, sizex, sizey, (CymComplex_d*)output);
+    }
+}
+
+int cym_clu_factor(CymComplex* a, unsigned int size, unsigned int* pivots){
+    if(ICYM_FLOAT_IS_F32) return cym_clu_factor_f((CymComplex_f*)a, size, pivots);
+    return cym_clu_factor_d((CymComplex_d*)a, size, pivots);
+}
+
+void cym_clu_solve(const CymComplex* lu, const unsigned int* pivots, unsigned int size, const CymComplex* y, CymComplex* x){
+    if(ICYM_FLOAT_IS_F32) cym_clu_solve_f((const CymComplex_f*)lu, pivots, size, (const CymComplex_f*)y, (CymComplex_f*)x);
+    else                  cym_clu_solve_d((const CymComplex_d*)lu, pivots, size, (const CymComplex_d*)y, (CymComplex_d*)x);
+}
+
+int cym_csolve_gauss(CymComplex* a, const CymComplex* y, unsigned int size, CymComplex* x){
+    if(ICYM_FLOAT_IS_F32) return cym_csolve_gauss_f((CymComplex_f*)a, (const CymComplex_f*)y, size, (CymComplex_f*)x);
+    return cym_csolve_gauss_d((CymComplex_d*)a, (const CymComplex_d*)y, size, (CymComplex_d*)x);
+}
+
+int cym_ctest_unitary(const CymComplex* mat, unsigned int size, double accuracy){
+    if(ICYM_FLOAT_IS_F32) return cym_ctest_unitary_f((const CymComplex_f*)mat, size, accuracy);
+    return cym_ctest_unitary_d((const CymComplex_d*)mat, size, accuracy);
+}
+
+int cym_ctest_unitary_deviation(const CymComplex* mat, unsigned int size, double accuracy, double* deviation){
+    if(ICYM_FLOAT_IS_F32) return cym_ctest_unitary_deviation_f((const CymComplex_f*)mat, size, accuracy, deviation);
+    return cym_ctest_unitary_deviation_d((const CymComplex_d*)mat, size, accuracy, deviation);
+}
+
+// X===============================================X (DATA ANALYSIS) X=================================================X
+
+int cym_interpol(const CYM_FLOAT* x, const CYM_FLOAT* y, size_t number_of_points, CYM_FLOAT* output){
+    if(ICYM_FLOAT_IS_F32) return cym_interpol_f((const float*)x, (const float*)y, number_of_points, (float*)output);
+    return cym_interpol_d((const double*)x, (const double*)y, number_of_points, (double*)output);
+}
+
+int cym_newton_coefficients(const CYM_FLOAT* x, const CYM_FLOAT* y, size_t n, CYM_FLOAT* nodes, CYM_FLOAT* coefficients){
+    if(ICYM_FLOAT_IS_F32){
+        return cym_newton_coefficients_f((const float*)x, (const float*)y, n, (float*)nodes, (float*)coefficients);
+    }
+    return cym_newton_coefficients_d((const double*)x, (const double*)y, n, (double*)nodes, (double*)coefficients);
+}
+
+CYM_FLOAT cym_newton_eval(const CYM_FLOAT* nodes, const CYM_FLOAT* coefficients, size_t n, CYM_FLOAT t){
+    if(ICYM_FLOAT_IS_F32) return cym_newton_eval_f((const float*)nodes, (const float*)coefficients, n, (float)t);
+    return (CYM_FLOAT)cym_newton_eval_d((const double*)nodes, (const double*)coefficients, n, (double)t);
+}
+
+void cym_newton_eval_batch(const CYM_FLOAT* nodes, const CYM_FLOAT* coefficients, size_t n, const CYM_FLOAT* t, size_t count,
+    CYM_FLOAT* out){
+    if(ICYM_FLOAT_IS_F32){
+        cym_newton_eval_batch_f((const float*)nodes, (const float*)coefficients, n, (const float*)t, count, (float*)out);
+    } else{
+        cym_newton_eval_batch_d((const double*)nodes, (const double*)coefficients, n, (const double*)t, count, (double*)out);
+    }
+}
+
+void cym_newton_to_monomial(const CYM_FLOAT* nodes, const CYM_FLOAT* coefficients, size_t n, CYM_FLOAT* output){
+    if(ICYM_FLOAT_IS_F32) cym_newton_to_monomial_f((const float*)nodes, (const float*)coefficients, n, (float*)output);
+    else                  cym_newton_to_monomial_d((const double*)nodes, (const double*)coefficients, n, (double*)output);
+}
+
+int cym_barycentric_weights(const CYM_FLOAT* x, size_t n, CYM_FLOAT* weights){
+    if(ICYM_FLOAT_IS_F32) return cym_barycentric_weights_f((const float*)x, n, (float*)weights);
+    return cym_barycentric_weights_d((const double*)x, n, (double*)weights);
+}
+
+CYM_FLOAT cym_barycentric_eval(const CYM_FLOAT* x, const CYM_FLOAT* y, const CYM_FLOAT* weights, size_t n, CYM_FLOAT t){
+    if(ICYM_FLOAT_IS_F32) return cym_barycentric_eval_f((const float*)x, (const float*)y, (const float*)weights, n, (float)t);
+    return (CYM_FLOAT)cym_barycentric_eval_d((const double*)x, (const double*)y, (const double*)weights, n, (double)t);
+}
+
+void cym_barycentric_eval_batch(const CYM_FLOAT* x, const CYM_FLOAT* y, const CYM_FLOAT* weights, size_t n, const CYM_FLOAT* t,
+    size_t count, CYM_FLOAT* out){
+    if(ICYM_FLOAT_IS_F32){
+        cym_barycentric_eval_batch_f((const float*)x, (const float*)y, (const float*)weights, n, (const float*)t, count,
+            (float*)out);
+    } else{
+        cym_barycentric_eval_batch_d((const double*)x, (const double*)y, (const double*)weights, n, (const double*)t, count,
+            (double*)out);
+    }
+}
+
+void cym_linear_fit(const CYM_FLOAT* x, const CYM_FLOAT* y, size_t number_of_points, CYM_FLOAT* a, CYM_FLOAT* b, CYM_FLOAT* r){
+    if(ICYM_FLOAT_IS_F32) cym_linear_fit_f((const float*)x, (const float*)y, number_of_points, (float*)a, (float*)b, (float*)r);
+    else                  cym_linear_fit_d((const double*)x, (const double*)y, number_of_points, (double*)a, (double*)b, (double*)r);
+}
+
+int cym_rlinear_fit(const CYM_FLOAT* x, const CYM_FLOAT* y, const CYM_FLOAT* dx, const CYM_FLOAT* dy,
+        size_t number_of_points, CYM_FLOAT* a, CYM_FLOAT* b, CYM_FLOAT* da, CYM_FLOAT* db ,CYM_FLOAT* r){
+    if(ICYM_FLOAT_IS_F32){
+        return cym_rlinear_fit_f((const float*)x, (const float*)y, (const float*)dx, (const float*)dy, number_of_points,
+            (float*)a, (float*)b, (float*)da, (float*)db, (float*)r);
+    }
+    return cym_rlinear_fit_d((const double*)x, (const double*)y, (const double*)dx, (const double*)dy, number_of_points,
+        (double*)a, (double*)b, (double*)da, (double*)db, (double*)r);
+}
+
+int cym_rlinear_fit_batch(const CYM_FLOAT* x, const CYM_FLOAT* y, const CYM_FLOAT* dx, const CYM_FLOAT* dy, size_t number_of_points,
+    size_t series, const CYM_FLOAT* slopes, CYM_FLOAT* a, CYM_FLOAT* b, CYM_FLOAT* da, CYM_FLOAT* db, CYM_FLOAT* r){
+
+    if(ICYM_FLOAT_IS_F32){
+        return cym_rlinear_fit_batch_f((const float*)x, (const float*)y, (const float*)dx, (const float*)dy, number_of_points,
+            series, (const float*)slopes, (float*)a, (float*)b, (float*)da, (float*)db, (float*)r);
+    }
+    return cym_rlinear_fit_batch_d((const double*)x, (const double*)y, (const double*)dx, (const double*)dy, number_of_points,
+        series, (const double*)slopes, (double*)a, (double*)b, (double*)da, (double*)db, (double*)r);
+}
+
+int cym_poly_fit(const CYM_FLOAT* x, const CYM_FLOAT* y, size_t number_of_points, int order, CYM_FLOAT* output){
+    if(ICYM_FLOAT_IS_F32) return cym_poly_fit_f((const float*)x, (const float*)y, number_of_points, order, (float*)output);
+    return cym_poly_fit_d((const double*)x, (const double*)y, number_of_points, order, (double*)output);
+}
+
+int cym_poly_fit_batch(const CYM_FLOAT* x, size_t x_stride, const CYM_FLOAT* y, size_t number_of_points, size_t series,
+        int order, int flags, CYM_FLOAT* output){
+    if(ICYM_FLOAT_IS_F32){
+        return cym_poly_fit_batch_f((const float*)x, x_stride, (const float*)y, number_of_points, series, order, flags,
+            (float*)output);
+    }
+    return cym_poly_fit_batch_d((const double*)x, x_stride, (const double*)y, number_of_points, series, order, flags,
+        (double*)output);
+}
+
+void cym_poly_eval_batch(const CYM_FLOAT* coefficients, int order, size_t polys, const CYM_FLOAT* x, size_t n, CYM_FLOAT* out){
+    if(ICYM_FLOAT_IS_F32) cym_poly_eval_batch_f((const float*)coefficients, order, polys, (const float*)x, n, (float*)out);
+    else                  cym_poly_eval_batch_d((const double*)coefficients, order, polys, (const double*)x, n, (double*)out);
+}
+
+CYM_FLOAT cym_poly_residuals(const CYM_FLOAT* coefficients, int order, const CYM_FLOAT* x, const CYM_FLOAT* y, size_t n,
+        CYM_FLOAT* residuals, CYM_FLOAT* r2){
+    if(ICYM_FLOAT_IS_F32){
+        return (CYM_FLOAT)cym_poly_residuals_f((const float*)coefficients, order, (const float*)x, (const float*)y, n,
+            (float*)residuals, (float*)r2);
+    }
+    return (CYM_FLOAT)cym_poly_residuals_d((const double*)coefficients, order, (const double*)x, (const double*)y, n,
+        (double*)residuals, (double*)r2);
+}
+
+// X===============================================X (WORKSPACES) X=================================================X
+
+size_t cym_gemm_workspace_size(size_t m, size_t n, size_t k){
+    if(ICYM_FLOAT_IS_F32) return cym_gemm_workspace_size_f(m, n, k);
+    return cym_gemm_workspace_size_d(m, n, k);
+}
+
+void cym_gemm_ws(size_t m, size_t n, size_t k, CYM_FLOAT alpha, const CYM_FLOAT* a, ptrdiff_t a_rs, ptrdiff_t a_cs,
+    const CYM_FLOAT* b, ptrdiff_t b_rs, ptrdiff_t b_cs, CYM_FLOAT beta, CYM_FLOAT* c, ptrdiff_t c_rs, ptrdiff_t c_cs,
+    void* workspace, size_t workspace_size){
+    if(ICYM_FLOAT_IS_F32){
+        cym_gemm_ws_f(m, n, k, (float)alpha, (const float*)a, a_rs, a_cs, (const float*)b, b_rs, b_cs, (float)beta, (float*)c,
+            c_rs, c_cs, workspace, workspace_size);
+    } else{
+        cym_gemm_ws_d(m, n, k, (double)alpha, (const double*)a, a_rs, a_cs, (const double*)b, b_rs, b_cs, (double)beta,
+            (double*)c, c_rs, c_cs, workspace, workspace_size);
+    }
+}
+
+size_t cym_lu_factor_workspace_size(unsigned int size){
+    if(ICYM_FLOAT_IS_F32) return cym_lu_factor_workspace_size_f(size);
+    return cym_lu_factor_workspace_size_d(size);
+}
+
+int cym_lu_factor_ws(CYM_FLOAT* a, unsigned int size, unsigned int* pivots, void* workspace, size_t workspace_size){
+    if(ICYM_FLOAT_IS_F32) return cym_lu_factor_ws_f((float*)a, size, pivots, workspace, workspace_size);
+    return cym_lu_factor_ws_d((double*)a, size, pivots, workspace, workspace_size);
+}
+
+size_t cym_solve_gauss_workspace_size(unsigned int size){
+    if(ICYM_FLOAT_IS_F32) return cym_solve_gauss_workspace_size_f(size);
+    return cym_solve_gauss_workspace_size_d(size);
+}
+
+void cym_solve_gauss_ws(CYM_FLOAT* a, CYM_FLOAT* y, unsigned int size, CYM_FLOAT* x, void* workspace, size_t workspace_size){
+    if(ICYM_FLOAT_IS_F32) cym_solve_gauss_ws_f((float*)a, (float*)y, size, (float*)x, workspace, workspace_size);
+    else                  cym_solve_gauss_ws_d((double*)a, (double*)y, size, (double*)x, workspace, workspace_size);
+}
+
+size_t cym_qr_factor_workspace_size(size_t rows, size_t columns){
+    if(ICYM_FLOAT_IS_F32) return cym_qr_factor_workspace_size_f(rows, columns);
+    return cym_qr_factor_workspace_size_d(rows, columns);
+}
+
+int cym_qr_factor_ws(CYM_FLOAT* a, size_t rows, size_t columns, CYM_FLOAT* tau, void* workspace, size_t workspace_size){
+    if(ICYM_FLOAT_IS_F32) return cym_qr_factor_ws_f((float*)a, rows, columns, (float*)tau, workspace, workspace_size);
+    return cym_qr_factor_ws_d((double*)a, rows, columns, (double*)tau, workspace, workspace_size);
+}
+
+size_t cym_test_unitary_workspace_size(unsigned int size){
+    if(ICYM_FLOAT_IS_F32) return cym_test_unitary_workspace_size_f(size);
+    return cym_test_unitary_workspace_size_d(size);
+}
+
+int cym_test_unitary_deviation_ws(const CYM_FLOAT* mat, unsigned int size, double accuracy, double* deviation,
+    void* workspace, size_t workspace_size){
+    if(ICYM_FLOAT_IS_F32){
+        return cym_test_unitary_deviation_ws_f((const float*)mat, size, accuracy, deviation, workspace, workspace_size);
+    }
+    return cym_test_unitary_deviation_ws_d((const double*)mat, size, accuracy, deviation, workspace, workspace_size);
+}
+
+size_t cym_interpol_workspace_size(size_t number_of_points){
+    if(ICYM_FLOAT_IS_F32) return cym_interpol_workspace_size_f(number_of_points);
+    return cym_interpol_workspace_size_d(number_of_points);
+}
+
+int cym_interpol_ws(const CYM_FLOAT* x, const CYM_FLOAT* y, size_t number_of_points, CYM_FLOAT* output, void* workspace,
+    size_t workspace_size){
+    if(ICYM_FLOAT_IS_F32){
+        return cym_interpol_ws_f((const float*)x, (const float*)y, number_of_points, (float*)output, workspace, workspace_size);
+    }
+    return cym_interpol_ws_d((const double*)x, (const double*)y, number_of_points, (double*)output, workspace, workspace_size);
+}
+
+size_t cym_poly_fit_workspace_size(size_t number_of_points, int order){
+    if(ICYM_FLOAT_IS_F32) return cym_poly_fit_workspace_size_f(number_of_points, order);
+    return cym_poly_fit_workspace_size_d(number_of_points, order);
+}
+
+int cym_poly_fit_ws(const CYM_FLOAT* x, const CYM_FLOAT* y, size_t number_of_points, int order, CYM_FLOAT* output,
+    void* workspace, size_t workspace_size){
+    if(ICYM_FLOAT_IS_F32){
+        return cym_poly_fit_ws_f((const float*)x, (const float*)y, number_of_points, order, (float*)output, workspace,
+            workspace_size);
+    }
+    return cym_poly_fit_ws_d((const double*)x, (const double*)y, number_of_points, order, (double*)output, workspace,
+        workspace_size);
+}
+
+CYM_FLOAT cym_root_bracket(CymRootFn function, void* user, CYM_FLOAT a, CYM_FLOAT b, CYM_FLOAT value, CYM_FLOAT tolerance,
+    int method, CymRootStats* stats){
+
+    if(ICYM_FLOAT_IS_F32){
+        return (CYM_FLOAT)cym_root_bracket_f(ICYM_CALLBACK_CAST(CymRootFn_f, function), user, a, b, value, tolerance, method,
+            stats);
+    }
+    return (CYM_FLOAT)cym_root_bracket_d(ICYM_CALLBACK_CAST(CymRootFn_d, function), user, a, b, value, tolerance, method, stats);
+}
+
+CYM_FLOAT cym_root_secant(CymRootFn function, void* user, CYM_FLOAT guess, CYM_FLOAT step, CYM_FLOAT value, CYM_FLOAT tolerance,
+    CymRootStats* stats){
+
+    if(ICYM_FLOAT_IS_F32){
+        return (CYM_FLOAT)cym_root_secant_f(ICYM_CALLBACK_CAST(CymRootFn_f, function), user, guess, step, value, tolerance, stats);
+    }
+    return (CYM_FLOAT)cym_root_secant_d(ICYM_CALLBACK_CAST(CymRootFn_d, function), user, guess, step, value, tolerance, stats);
+}
+
+int cym_root_batch(CymRootBatchFn function, void* user, const CYM_FLOAT* a, const CYM_FLOAT* b, const CYM_FLOAT* value,
+    size_t count, CYM_FLOAT tolerance, int method, CYM_FLOAT* roots, CymRootStats* stats){
+
+    if(ICYM_FLOAT_IS_F32){
+        return cym_root_batch_f(ICYM_CALLBACK_CAST(CymRootBatchFn_f, function), user, (const float*)a, (const float*)b,
+            (const float*)value, count, (float)tolerance, method, (float*)roots, stats);
+    }
+    return cym_root_batch_d(ICYM_CALLBACK_CAST(CymRootBatchFn_d, function), user, (const double*)a, (const double*)b,
+        (const double*)value, count, tolerance, method, (double*)roots, stats);
+}
+
+CYM_FLOAT cym_newton_method(CYM_FLOAT (*function)(CYM_FLOAT), CYM_FLOAT guess, CYM_FLOAT value, CYM_FLOAT accuracy, CYM_FLOAT step){
+    // CYM_FLOAT is the type of the instantiation called, so the function pointer is only cast to its own type
+    if(ICYM_FLOAT_IS_F32){
+        return (CYM_FLOAT)cym_newton_method_f(ICYM_CALLBACK_CAST(float (*)(float), function), guess, value, accuracy, step);
+    }
+    return (CYM_FLOAT)cym_newton_method_d(ICYM_CALLBACK_CAST(double (*)(double), function), guess, value, accuracy, step);
+}
+
+// X===============================================X (FIT ACCUMULATORS) X==============================================X
+
+int cym_fit_acc_init(CymFitAcc* acc, int order, double center){
+    if(order < 0 || order > CYM_FIT_MAX_ORDER) return 1;
+
+    acc->order  = order;
+    acc->center = center;
+    acc->count  = 0;
+    for(int t = 0; t < 3 * CYM_FIT_MAX_ORDER + 3; t+=1){
+        acc->sums[t] = 0;
+        acc->compensations[t] = 0;
+    }
+    return 0;
+}
+
+int cym_fit_acc_merge(CymFitAcc* acc, const CymFitAcc* other){
+    if(acc->order != other->order || acc->center != other->center) return 1;
+
+    for(int t = 0; t < 3 * acc->order + 3; t+=1){
+        icym_fit_acc_add(acc, t, other->sums[t]);
+        acc->compensations[t] += other->compensations[t];
+    }
+    acc->count += other->count;
+    return 0;
+}
+
+void cym_fit_acc_push(CymFitAcc* acc, CYM_FLOAT x, CYM_FLOAT y){
+    if(ICYM_FLOAT_IS_F32) cym_fit_acc_push_f(acc, (float)x, (float)y);
+    else                  cym_fit_acc_push_d(acc, x, y);
+}
+
+void cym_fit_acc_push_batch(CymFitAcc* acc, const CYM_FLOAT* x, const CYM_FLOAT* y, size_t count){
+    if(ICYM_FLOAT_IS_F32) cym_fit_acc_push_batch_f(acc, (const float*)x, (const float*)y, count);
+    else                  cym_fit_acc_push_batch_d(acc, (const double*)x, (const double*)y, count);
+}
+
+int cym_fit_acc_poly(const CymFitAcc* acc, CYM_FLOAT* output){
+    if(ICYM_FLOAT_IS_F32) return cym_fit_acc_poly_f(acc, (float*)output);
+    return cym_fit_acc_poly_d(acc, (double*)output);
+}
+
+int cym_fit_acc_linear(const CymFitAcc* acc, CYM_FLOAT* a, CYM_FLOAT* b, CYM_FLOAT* r){
+    if(ICYM_FLOAT_IS_F32) return cym_fit_acc_linear_f(acc, (float*)a, (float*)b, (float*)r);
+    return cym_fit_acc_linear_d(acc, (double*)a, (double*)b, (double*)r);
+}
+
+int cym_lm_solve(CymLmResiduals residuals, CymLmJacobian jacobian, void* user, CYM_FLOAT* params, size_t param_count,
+    size_t residual_count, const CymLmOptions* options, CymLmResult* result){
+
+    if(ICYM_FLOAT_IS_F32){
+        return cym_lm_solve_f((CymLmResiduals_f)residuals, (CymLmJacobian_f)jacobian, user, (float*)params, param_count,
+            residual_count, options, result);
+    }
+    return cym_lm_solve_d((CymLmResiduals_d)residuals, (CymLmJacobian_d)jacobian, user, (double*)params, param_count,
+        residual_count, options, result);
+}
+
+size_t cym_lm_solve_workspace_size(size_t param_count, size_t residual_count){
+    if(ICYM_FLOAT_IS_F32) return cym_lm_solve_workspace_size_f(param_count, residual_count);
+    return cym_lm_solve_workspace_size_d(param_count, residual_count);
+}
+
+int cym_lm_solve_ws(CymLmResiduals residuals, CymLmJacobian jacobian, void* user, CYM_FLOAT* params, size_t param_count,
+    size_t residual_count, const CymLmOptions* options, CymLmResult* result, void* workspace, size_t workspace_size){
+
+    if(ICYM_FLOAT_IS_F32){
+        return cym_lm_solve_ws_f((CymLmResiduals_f)residuals, (CymLmJacobian_f)jacobian, user, (float*)params, param_count,
+            residual_count, options, result, workspace, workspace_size);
+    }
+    return cym_lm_solve_ws_d((CymLmResiduals_d)residuals, (CymLmJacobian_d)jacobian, user, (double*)params, param_count,
+        residual_count, options, result, workspace, workspace_size);
+}
+
+void cym_minimize(CYM_FLOAT* input_data, size_t data_point_count, CYM_FLOAT(*model)(CYM_FLOAT*), CYM_FLOAT* param, size_t param_count){
+    if(ICYM_FLOAT_IS_F32){
+        cym_minimize_f((float*)input_data, data_point_count, ICYM_CALLBACK_CAST(float (*)(float*), model), (float*)param,
+            param_count);
+    } else{
+        cym_minimize_d((double*)input_data, data_point_count, ICYM_CALLBACK_CAST(double (*)(double*), model), (double*)param,
+            param_count);
+    }
+}
+
+int cym_sparse_from_coo(size_t rows, size_t columns, const unsigned int* row_indices, const unsigned int* column_indices,
+    const CYM_FLOAT* values, size_t count, int format, CymSparse* out){
+
+    if(ICYM_FLOAT_IS_F32){
+        return cym_sparse_from_coo_f(rows, columns, row_indices, column_indices, (const float*)values, count, format,
+            (CymSparse_f*)out);
+    }
+    return cym_sparse_from_coo_d(rows, columns, row_indices, column_indices, (const double*)values, count, format,
+        (CymSparse_d*)out);
+}
+
+int cym_sparse_convert(const CymSparse* a, int format, CymSparse* out){
+    if(ICYM_FLOAT_IS_F32) return cym_sparse_convert_f((const CymSparse_f*)a, format, (CymSparse_f*)out);
+    return cym_sparse_convert_d((const CymSparse_d*)a, format, (CymSparse_d*)out);
+}
+
+void cym_sparse_free(CymSparse* a){
+    if(ICYM_FLOAT_IS_F32) cym_sparse_free_f((CymSparse_f*)a);
+    else                  cym_sparse_free_d((CymSparse_d*)a);
+}
+
+void cym_sparse_mv(CYM_FLOAT alpha, const CymSparse* a, const CYM_FLOAT* x, CYM_FLOAT beta, CYM_FLOAT* y){
+    if(ICYM_FLOAT_IS_F32) cym_sparse_mv_f((float)alpha, (const CymSparse_f*)a, (const float*)x, (float)beta, (float*)y);
+    else                  cym_sparse_mv_d(alpha, (const CymSparse_d*)a, (const double*)x, beta, (double*)y);
+}
+
+int cym_sparse_cg(const CymSparse* a, const CYM_FLOAT* b, CYM_FLOAT* x, double tolerance, int max_iterations, int preconditioner,
+    CymIterStats* stats){
+
+    if(ICYM_FLOAT_IS_F32){
+        return cym_sparse_cg_f((const CymSparse_f*)a, (const float*)b, (float*)x, tolerance, max_iterations, preconditioner, stats);
+    }
+    return cym_sparse_cg_d((const CymSparse_d*)a, (const double*)b, (double*)x, tolerance, max_iterations, preconditioner, stats);
+}
+
+int cym_sparse_bicgstab(const CymSparse* a, const CYM_FLOAT* b, CYM_FLOAT* x, double tolerance, int max_iterations,
+    int preconditioner, CymIterStats* stats){
+
+    if(ICYM_FLOAT_IS_F32){
+        return cym_sparse_bicgstab_f((const CymSparse_f*)a, (const float*)b, (float*)x, tolerance, max_iterations,
+            preconditioner, stats);
+    }
+    return cym_sparse_bicgstab_d((const CymSparse_d*)a, (const double*)b, (double*)x, tolerance, max_iterations,
+        preconditioner, stats);
+}
+
+size_t cym_sparse_cg_workspace_size(const CymSparse* a, int preconditioner){
+    if(ICYM_FLOAT_IS_F32) return cym_sparse_cg_workspace_size_f((const CymSparse_f*)a, preconditioner);
+    return cym_sparse_cg_workspace_size_d((const CymSparse_d*)a, preconditioner);
+}
+
+int cym_sparse_cg_ws(const CymSparse* a, const CYM_FLOAT* b, CYM_FLOAT* x, double tolerance, int max_iterations,
+    int preconditioner, CymIterStats* stats, void* workspace, size_t workspace_size){
+
+    if(ICYM_FLOAT_IS_F32){
+        return cym_sparse_cg_ws_f((const CymSparse_f*)a, (const float*)b, (float*)x, tolerance, max_iterations, preconditioner,
+            stats, workspace, workspace_size);
+    }
+    return cym_sparse_cg_ws_d((const CymSparse_d*)a, (const double*)b, (double*)x, tolerance, max_iterations, preconditioner,
+        stats, workspace, workspace_size);
+}
+
+size_t cym_sparse_bicgstab_workspace_size(const CymSparse* a, int preconditioner){
+    if(ICYM_FLOAT_IS_F32) return cym_sparse_bicgstab_workspace_size_f((const CymSparse_f*)a, preconditioner);
+    return cym_sparse_bicgstab_workspace_size_d((const CymSparse_d*)a, preconditioner);
+}
+
+int cym_sparse_bicgstab_ws(const CymSparse* a, const CYM_FLOAT* b, CYM_FLOAT* x, double tolerance, int max_iterations,
+    int preconditioner, CymIterStats* stats, void* workspace, size_t workspace_size){
+
+    if(ICYM_FLOAT_IS_F32){
+        return cym_sparse_bicgstab_ws_f((const CymSparse_f*)a, (const float*)b, (float*)x, tolerance, max_iterations,
+            preconditioner, stats, workspace, workspace_size);
+    }
+    return cym_sparse_bicgstab_ws_d((const CymSparse_d*)a, (const double*)b, (double*)x, tolerance, max_iterations,
+        preconditioner, stats, workspace, workspace_size);
+}
+
+#endif // ======================== END OF FUNCTION IMPLEMENTATIONS =========================
+
+
+#ifdef __cplusplus
+}
+
+// both precisions as overloads, so templates can call cym::gemm and the others on float and double alike
+namespace cym{
+#define ICYM_API_PASS
+#define ICYM_API(RET, NAME, PARAMS, ARGS) inline RET NAME PARAMS { return ICYM_FN(cym_##NAME) ARGS; }
+#define ICYM_API_C(RET, NAME, PARAMS, ARGS)
+#define ICYM_T double
+#define ICYM_FN(name) name##_d
+#include "cymath.h"
+#undef ICYM_FN
+#undef ICYM_T
+#define ICYM_T float
+#define ICYM_FN(name) name##_f
+#include "cymath.h"
+#undef ICYM_FN
+#undef ICYM_T
+#undef ICYM_API
+#undef ICYM_API_C
+#undef ICYM_API_PASS
+}
+#endif
+
+#endif // =====================  END OF FILE CMATH_HEADER ===========================
+
+#elif defined(ICYM_API_PASS)
+
+// X===============================================X API PASS X========================================================X
+// the functions instantiated for each precision, listed once as ICYM_API(return type, name without cym_, parameters,
+// arguments), included with ICYM_T and ICYM_FN(name) set for a precision and ICYM_API defined by the includer
+// to declare them (or to wrap them, like the C++ overloads do), see the CYM_FLOAT declarations for their documentation
+// ICYM_API_C lists the ones without an ICYM_T parameter, which C++ can not tell apart by precision
+
+ICYM_API(ICYM_T, normalize_vec, (const ICYM_T* vector, unsigned int size, ICYM_T* ouput), (vector, size, ouput))
+ICYM_API(void, normalize_vecs, (const ICYM_T* vectors, size_t count, size_t dim, ICYM_T* output, ICYM_T* norms, int fast),
+    (vectors, count, dim, output, norms, fast))
+ICYM_API(void, normalize_vecs_soa, (const ICYM_T* vectors, size_t count, size_t dim, ICYM_T* output, ICYM_T* norms, int fast),
+    (vectors, count, dim, output, norms, fast))
+ICYM_API(void, rsqrt_batch, (const ICYM_T* x, size_t n, ICYM_T* out, int fast), (x, n, out, fast))
+ICYM_API(void, sqrt_batch, (const ICYM_T* x, size_t n, ICYM_T* out), (x, n, out))
+ICYM_API(void, mat_transpose, (const ICYM_T* input, unsigned int sizex, unsigned int sizey, ICYM_T* output),
+    (input, sizex, sizey, output))
+ICYM_API(int, mat_transpose_inplace, (ICYM_T* mat, unsigned int sizex, unsigned int sizey), (mat, sizex, sizey))
+ICYM_API(void, mat_scale, (ICYM_T scalar, const ICYM_T* mat, unsigned int sizex, unsigned int sizey, ICYM_T* output),
+    (scalar, mat, sizex, sizey, output))
+ICYM_API(void, mat_sum, (const ICYM_T* mat1, const ICYM_T* mat2, unsigned int sizex, unsigned int sizey, ICYM_T* output),
+    (mat1, mat2, sizex, sizey, output))
+ICYM_API(void, mat_sub, (const ICYM_T* mat1, const ICYM_T* mat2, unsigned int sizex, unsigned int sizey, ICYM_T* output),
+    (mat1, mat2, sizex, sizey, output))
+ICYM_API(void, mat_multiply, (const ICYM_T* mat_1, unsigned int mat1_sizex, unsigned int mat1_sizey, const ICYM_T* mat_2,
+    unsigned int mat2_sizex, ICYM_T* output), (mat_1, mat1_sizex, mat1_sizey, mat_2, mat2_sizex, output))
+ICYM_API(void, gemm, (size_t m, size_t n, size_t k, ICYM_T alpha, const ICYM_T* a, ptrdiff_t a_rs, ptrdiff_t a_cs,
+    const ICYM_T* b, ptrdiff_t b_rs, ptrdiff_t b_cs, ICYM_T beta, ICYM_T* c, ptrdiff_t c_rs, ptrdiff_t c_cs),
+    (m, n, k, alpha, a, a_rs, a_cs, b, b_rs, b_cs, beta, c, c_rs, c_cs))
+
+ICYM_API(void, axpy, (size_t n, ICYM_T alpha, const ICYM_T* x, ptrdiff_t incx, ICYM_T* y, ptrdiff_t incy),
+    (n, alpha, x, incx, y, incy))
+ICYM_API(void, axpby, (size_t n, ICYM_T alpha, const ICYM_T* x, ptrdiff_t incx, ICYM_T beta, ICYM_T* y, ptrdiff_t incy),
+    (n, alpha, x, incx, beta, y, incy))
+ICYM_API(void, waxpby, (size_t n, ICYM_T alpha, const ICYM_T* x, ptrdiff_t incx, ICYM_T beta, const ICYM_T* y, ptrdiff_t incy,
+    ICYM_T* w, ptrdiff_t incw), (n, alpha, x, incx, beta, y, incy, w, incw))
+ICYM_API(void, scal, (size_t n, ICYM_T alpha, ICYM_T* x, ptrdiff_t incx), (n, alpha, x, incx))
+ICYM_API(ICYM_T, dot, (size_t n, const ICYM_T* x, ptrdiff_t incx, const ICYM_T* y, ptrdiff_t incy), (n, x, incx, y, incy))
+ICYM_API(ICYM_T, nrm2, (size_t n, const ICYM_T* x, ptrdiff_t incx), (n, x, incx))
+ICYM_API(ICYM_T, asum, (size_t n, const ICYM_T* x, ptrdiff_t incx), (n, x, incx))
+ICYM_API(size_t, iamax, (size_t n, const ICYM_T* x, ptrdiff_t incx), (n, x, incx))
+
+ICYM_API(void, solve_gauss, (ICYM_T* a, ICYM_T* y, unsigned int size, ICYM_T* x), (a, y, size, x))
+ICYM_API(int, lu_factor, (ICYM_T* a, unsigned int size, unsigned int* pivots), (a, size, pivots))
+ICYM_API(void, lu_solve, (const ICYM_T* lu, const unsigned int* pivots, unsigned int size, const ICYM_T* y, ICYM_T* x),
+    (lu, pivots, size, y, x))
+ICYM_API(void, lu_solve_many, (const ICYM_T* lu, const unsigned int* pivots, unsigned int size, const ICYM_T* y,
+    unsigned int count, ICYM_T* x), (lu, pivots, size, y, count, x))
+ICYM_API(ICYM_T, lu_determinant, (const ICYM_T* lu, const unsigned int* pivots, unsigned int size), (lu, pivots, size))
+ICYM_API(void, lu_inverse, (const ICYM_T* lu, const unsigned int* pivots, unsigned int size, ICYM_T* output),
+    (lu, pivots, size, output))
+ICYM_API(int, qr_factor, (ICYM_T* a, size_t rows, size_t columns, ICYM_T* tau), (a, rows, columns, tau))
+ICYM_API(void, qr_apply_qt, (const ICYM_T* qr, const ICYM_T* tau, size_t rows, size_t columns, ICYM_T* b, size_t count),
+    (qr, tau, rows, columns, b, count))
+ICYM_API(int, cholesky_factor, (ICYM_T* a, unsigned int size), (a, size))
+ICYM_API(void, cholesky_solve, (const ICYM_T* r, unsigned int size, const ICYM_T* y, ICYM_T* x), (r, size, y, x))
+ICYM_API(int, lstsq, (ICYM_T* a, size_t rows, size_t columns, ICYM_T* b, size_t count, ICYM_T* x, int flags),
+    (a, rows, columns, b, count, x, flags))
+ICYM_API(int, make_unitary, (const ICYM_T* input, unsigned int size, ICYM_T* output), (input, size, output))
+ICYM_API(int, make_unitary_reflector, (const ICYM_T* input, unsigned int size, ICYM_T* w), (input, size, w))
+ICYM_API(void, apply_unitary_reflector, (const ICYM_T* w, unsigned int size, ICYM_T* x, size_t count), (w, size, x, count))
+ICYM_API(int, test_unitary, (const ICYM_T* mat, unsigned int size, double accuracy), (mat, size, accuracy))
+ICYM_API(int, test_unitary_deviation, (const ICYM_T* mat, unsigned int size, double accuracy, double* deviation),
+    (mat, size, accuracy, deviation))
+ICYM_API(void, mat_print, (const char* name, const ICYM_T* mat, unsigned int sizex, unsigned int sizey),
+    (name, mat, sizex, sizey))
+
+ICYM_API(ICYM_FN(CYM_IMAT), imat, (ICYM_T* data, size_t rows, size_t columns), (data, rows, columns))
+ICYM_API(ICYM_FN(CYM_IMAT), imat_sub, (ICYM_FN(CYM_IMAT) m, size_t row, size_t column, size_t rows, size_t columns),
+    (m, row, column, rows, columns))
+ICYM_API(ICYM_FN(CYM_IMAT), imat_row, (ICYM_FN(CYM_IMAT) m, size_t i), (m, i))
+ICYM_API(ICYM_FN(CYM_IMAT), imat_col, (ICYM_FN(CYM_IMAT) m, size_t j), (m, j))
+ICYM_API(ICYM_FN(CYM_IMAT), imat_transpose, (ICYM_FN(CYM_IMAT) m), (m))
+ICYM_API(int, imat_multiply, (ICYM_T alpha, ICYM_FN(CYM_IMAT) a, ICYM_FN(CYM_IMAT) b, ICYM_T beta, ICYM_FN(CYM_IMAT) c),
+    (alpha, a, b, beta, c))
+ICYM_API(int, imat_axpby, (ICYM_T alpha, ICYM_FN(CYM_IMAT) x, ICYM_T beta, ICYM_FN(CYM_IMAT) y), (alpha, x, beta, y))
+ICYM_API(int, imat_copy, (ICYM_FN(CYM_IMAT) src, ICYM_FN(CYM_IMAT) dst), (src, dst))
+ICYM_API(int, smatmul, (ICYM_FN(CYM_IMAT) mat1, ICYM_FN(CYM_IMAT) mat2, ICYM_T* output), (mat1, mat2, output))
+
+ICYM_API(int, interpol, (const ICYM_T* x, const ICYM_T* y, size_t number_of_points, ICYM_T* output),
+    (x, y, number_of_points, output))
+ICYM_API(int, newton_coefficients, (const ICYM_T* x, const ICYM_T* y, size_t n, ICYM_T* nodes, ICYM_T* coefficients),
+    (x, y, n, nodes, coefficients))
+ICYM_API(ICYM_T, newton_eval, (const ICYM_T* nodes, const ICYM_T* coefficients, size_t n, ICYM_T t), (nodes, coefficients, n, t))
+ICYM_API(void, newton_eval_batch, (const ICYM_T* nodes, const ICYM_T* coefficients, size_t n, const ICYM_T* t, size_t count,
+    ICYM_T* out), (nodes, coefficients, n, t, count, out))
+ICYM_API(void, newton_to_monomial, (const ICYM_T* nodes, const ICYM_T* coefficients, size_t n, ICYM_T* output),
+    (nodes, coefficients, n, output))
+ICYM_API(int, barycentric_weights, (const ICYM_T* x, size_t n, ICYM_T* weights), (x, n, weights))
+ICYM_API(ICYM_T, barycentric_eval, (const ICYM_T* x, const ICYM_T* y, const ICYM_T* weights, size_t n, ICYM_T t),
+    (x, y, weights, n, t))
+ICYM_API(void, barycentric_eval_batch, (const ICYM_T* x, const ICYM_T* y, const ICYM_T* weights, size_t n, const ICYM_T* t,
+    size_t count, ICYM_T* out), (x, y, weights, n, t, count, out))
+ICYM_API(void, linear_fit, (const ICYM_T* x, const ICYM_T* y, size_t number_of_points, ICYM_T* a, ICYM_T* b, ICYM_T* r),
+    (x, y, number_of_points, a, b, r))
+ICYM_API(int, rlinear_fit, (const ICYM_T* x, const ICYM_T* y, const ICYM_T* dx, const ICYM_T* dy, size_t number_of_points,
+    ICYM_T* a, ICYM_T* b, ICYM_T* da, ICYM_T* db, ICYM_T* r), (x, y, dx, dy, number_of_points, a, b, da, db, r))
+ICYM_API(int, rlinear_fit_batch, (const ICYM_T* x, const ICYM_T* y, const ICYM_T* dx, const ICYM_T* dy, size_t number_of_points,
+    size_t series, const ICYM_T* slopes, ICYM_T* a, ICYM_T* b, ICYM_T* da, ICYM_T* db, ICYM_T* r),
+    (x, y, dx, dy, number_of_points, series, slopes, a, b, da, db, r))
+ICYM_API(int, poly_fit, (const ICYM_T* x, const ICYM_T* y, size_t number_of_points, int order, ICYM_T* output),
+    (x, y, number_of_points, order, output))
+ICYM_API(int, poly_fit_batch, (const ICYM_T* x, size_t x_stride, const ICYM_T* y, size_t number_of_points, size_t series,
+    int order, int flags, ICYM_T* output), (x, x_stride, y, number_of_points, series, order, flags, output))
+ICYM_API_C(size_t, gemm_workspace_size, (size_t m, size_t n, size_t k), (m, n, k))
+ICYM_API(void, gemm_ws, (size_t m, size_t n, size_t k, ICYM_T alpha, const ICYM_T* a, ptrdiff_t a_rs, ptrdiff_t a_cs,
+    const ICYM_T* b, ptrdiff_t b_rs, ptrdiff_t b_cs, ICYM_T beta, ICYM_T* c, ptrdiff_t c_rs, ptrdiff_t c_cs, void* workspace,
+    size_t workspace_size), (m, n, k, alpha, a, a_rs, a_cs, b, b_rs, b_cs, beta, c, c_rs, c_cs, workspace, workspace_size))
+ICYM_API_C(size_t, lu_factor_workspace_size, (unsigned int size), (size))
+ICYM_API(int, lu_factor_ws, (ICYM_T* a, unsigned int size, unsigned int* pivots, void* workspace, size_t workspace_size),
+    (a, size, pivots, workspace, workspace_size))
+ICYM_API_C(size_t, solve_gauss_workspace_size, (unsigned int size), (size))
+ICYM_API(void, solve_gauss_ws, (ICYM_T* a, ICYM_T* y, unsigned int size, ICYM_T* x, void* workspace, size_t workspace_size),
+    (a, y, size, x, workspace, workspace_size))
+ICYM_API_C(size_t, qr_factor_workspace_size, (size_t rows, size_t columns), (rows, columns))
+ICYM_API(int, qr_factor_ws, (ICYM_T* a, size_t rows, size_t columns, ICYM_T* tau, void* workspace, size_t workspace_size),
+    (a, rows, columns, tau, workspace, workspace_size))
+ICYM_API_C(size_t, test_unitary_workspace_size, (unsigned int size), (size))
+ICYM_API(int, test_unitary_deviation_ws, (const ICYM_T* mat, unsigned int size, double accuracy, double* deviation,
+    void* workspace, size_t workspace_size), (mat, size, accuracy, deviation, workspace, workspace_size))
+ICYM_API_C(size_t, interpol_workspace_size, (size_t number_of_points), (number_of_points))
+ICYM_API(int, interpol_ws, (const ICYM_T* x, const ICYM_T* y, size_t number_of_points, ICYM_T* output, void* workspace,
+    size_t workspace_size), (x, y, number_of_points, output, workspace, workspace_size))
+ICYM_API_C(size_t, poly_fit_workspace_size, (size_t number_of_points, int order), (number_of_points, order))
+ICYM_API(int, poly_fit_ws, (const ICYM_T* x, const ICYM_T* y, size_t number_of_points, int order, ICYM_T* output,
+    void* workspace, size_t workspace_size), (x, y, number_of_points, order, output, workspace, workspace_size))
+ICYM_API_C(size_t, lstsq_workspace_size, (size_t rows, size_t columns, size_t count, int flags), (rows, columns, count, flags))
+ICYM_API(int, lstsq_ws, (ICYM_T* a, size_t rows, size_t columns, ICYM_T* b, size_t count, ICYM_T* x, int flags, void* workspace,
+    size_t workspace_size), (a, rows, columns, b, count, x, flags, workspace, workspace_size))
+ICYM_API(void, poly_eval_batch, (const ICYM_T* coefficients, int order, size_t polys, const ICYM_T* x, size_t n, ICYM_T* out),
+    (coefficients, order, polys, x, n, out))
+ICYM_API(ICYM_T, poly_residuals, (const ICYM_T* coefficients, int order, const ICYM_T* x, const ICYM_T* y, size_t n,
+    ICYM_T* residuals, ICYM_T* r2), (coefficients, order, x, y, n, residuals, r2))
+ICYM_API(ICYM_T, newton_method, (ICYM_T (*function)(ICYM_T), ICYM_T guess, ICYM_T value, ICYM_T accuracy, ICYM_T step),
+    (function, guess, value, accuracy, step))
+ICYM_API(int, lm_solve, (ICYM_FN(CymLmResiduals) residuals, ICYM_FN(CymLmJacobian) jacobian, void* user, ICYM_T* params,
+    size_t param_count, size_t residual_count, const CymLmOptions* options, CymLmResult* result),
+    (residuals, jacobian, user, params, param_count, residual_count, options, result))
+ICYM_API_C(size_t, lm_solve_workspace_size, (size_t param_count, size_t residual_count), (param_count, residual_count))
+ICYM_API(int, lm_solve_ws, (ICYM_FN(CymLmResiduals) residuals, ICYM_FN(CymLmJacobian) jacobian, void* user, ICYM_T* params,
+    size_t param_count, size_t residual_count, const CymLmOptions* options, CymLmResult* result, void* workspace,
+    size_t workspace_size), (residuals, jacobian, user, params, param_count, residual_count, options, result, workspace,
+    workspace_size))
+ICYM_API(ICYM_T, root_bracket, (ICYM_FN(CymRootFn) function, void* user, ICYM_T a, ICYM_T b, ICYM_T value, ICYM_T tolerance,
+    int method, CymRootStats* stats), (function, user, a, b, value, tolerance, method, stats))
+ICYM_API(ICYM_T, root_secant, (ICYM_FN(CymRootFn) function, void* user, ICYM_T guess, ICYM_T step, ICYM_T value, ICYM_T tolerance,
+    CymRootStats* stats), (function, user, guess, step, value, tolerance, stats))
+ICYM_API(int, root_batch, (ICYM_FN(CymRootBatchFn) function, void* user, const ICYM_T* a, const ICYM_T* b, const ICYM_T* value,
+    size_t count, ICYM_T tolerance, int method, ICYM_T* roots, CymRootStats* stats),
+    (function, user, a, b, value, count, tolerance, method, roots, stats))
+ICYM_API(void, minimize, (ICYM_T* input_data, size_t data_point_count, ICYM_T (*model)(ICYM_T*), ICYM_T* param, size_t param_count),
+    (input_data, data_point_count, model, param, param_count))
+ICYM_API(void, cgemm, (size_t m, size_t n, size_t k, ICYM_FN(CymComplex) alpha, const ICYM_FN(CymComplex)* a, ptrdiff_t a_rs,
+    ptrdiff_t a_cs, const ICYM_FN(CymComplex)* b, ptrdiff_t b_rs, ptrdiff_t b_cs, ICYM_FN(CymComplex) beta, ICYM_FN(CymComplex)* c,
+    ptrdiff_t c_rs, ptrdiff_t c_cs, int conjugate), (m, n, k, alpha, a, a_rs, a_cs, b, b_rs, b_cs, beta, c, c_rs, c_cs, conjugate))
+ICYM_API(void, cmat_multiply, (const ICYM_FN(CymComplex)* mat_1, unsigned int mat1_sizex, unsigned int mat1_sizey,
+    const ICYM_FN(CymComplex)* mat_2, unsigned int mat2_sizex, ICYM_FN(CymComplex)* output),
+    (mat_1, mat1_sizex, mat1_sizey, mat_2, mat2_sizex, output))
+ICYM_API(void, cmat_transpose, (const ICYM_FN(CymComplex)* input, unsigned int sizex, unsigned int sizey,
+    ICYM_FN(CymComplex)* output), (input, sizex, sizey, output))
+ICYM_API(void, cmat_conj_transpose, (const ICYM_FN(CymComplex)* input, unsigned int sizex, unsigned int sizey,
+    ICYM_FN(CymComplex)* output), (input, sizex, sizey, output))
+ICYM_API(void, cmat_scale, (ICYM_FN(CymComplex) scalar, const ICYM_FN(CymComplex)* mat, unsigned int sizex, unsigned int sizey,
+    ICYM_FN(CymComplex)* output), (scalar, mat, sizex, sizey, output))
+ICYM_API(void, cmat_sum, (const ICYM_FN(CymComplex)* mat1, const ICYM_FN(CymComplex)* mat2, unsigned int sizex,
+    unsigned int sizey, ICYM_FN(CymComplex)* output), (mat1, mat2, sizex, sizey, output))
+ICYM_API(int, clu_factor, (ICYM_FN(CymComplex)* a, unsigned int size, unsigned int* pivots), (a, size, pivots))
+ICYM_API(void, clu_solve, (const ICYM_FN(CymComplex)* lu, const unsigned int* pivots, unsigned int size,
+    const ICYM_FN(CymComplex)* y, ICYM_FN(CymComplex)* x), (lu, pivots, size, y, x))
+ICYM_API(int, csolve_gauss, (ICYM_FN(CymComplex)* a, const ICYM_FN(CymComplex)* y, unsigned int size, ICYM_FN(CymComplex)* x),
+    (a, y, size, x))
+ICYM_API(int, ctest_unitary, (const ICYM_FN(CymComplex)* mat, unsigned int size, double accuracy), (mat, size, accuracy))
+ICYM_API(int, ctest_unitary_deviation, (const ICYM_FN(CymComplex)* mat, unsigned int size, double accuracy, double* deviation),
+    (mat, size, accuracy, deviation))
+ICYM_API(int, sparse_from_coo, (size_t rows, size_t columns, const unsigned int* row_indices, const unsigned int* column_indices,
+    const ICYM_T* values, size_t count, int format, ICYM_FN(CymSparse)* out),
+    (rows, columns, row_indices, column_indices, values, count, format, out))
+ICYM_API(int, sparse_convert, (const ICYM_FN(CymSparse)* a, int format, ICYM_FN(CymSparse)* out), (a, format, out))
+ICYM_API(void, sparse_free, (ICYM_FN(CymSparse)* a), (a))
+ICYM_API(void, sparse_mv, (ICYM_T alpha, const ICYM_FN(CymSparse)* a, const ICYM_T* x, ICYM_T beta, ICYM_T* y),
+    (alpha, a, x, beta, y))
+ICYM_API(int, sparse_cg, (const ICYM_FN(CymSparse)* a, const ICYM_T* b, ICYM_T* x, double tolerance, int max_iterations,
+    int preconditioner, CymIterStats* stats), (a, b, x, tolerance, max_iterations, preconditioner, stats))
+ICYM_API(int, sparse_bicgstab, (const ICYM_FN(CymSparse)* a, const ICYM_T* b, ICYM_T* x, double tolerance, int max_iterations,
+    int preconditioner, CymIterStats* stats), (a, b, x, tolerance, max_iterations, preconditioner, stats))
+ICYM_API(size_t, sparse_cg_workspace_size, (const ICYM_FN(CymSparse)* a, int preconditioner), (a, preconditioner))
+ICYM_API(int, sparse_cg_ws, (const ICYM_FN(CymSparse)* a, const ICYM_T* b, ICYM_T* x, double tolerance, int max_iterations,
+    int preconditioner, CymIterStats* stats, void* workspace, size_t workspace_size),
+    (a, b, x, tolerance, max_iterations, preconditioner, stats, workspace, workspace_size))
+ICYM_API(size_t, sparse_bicgstab_workspace_size, (const ICYM_FN(CymSparse)* a, int preconditioner), (a, preconditioner))
+ICYM_API(int, sparse_bicgstab_ws, (const ICYM_FN(CymSparse)* a, const ICYM_T* b, ICYM_T* x, double tolerance,
+    int max_iterations, int preconditioner, CymIterStats* stats, void* workspace, size_t workspace_size),
+    (a, b, x, tolerance, max_iterations, preconditioner, stats, workspace, workspace_size))
+
+ICYM_API(void, fit_acc_push, (CymFitAcc* acc, ICYM_T x, ICYM_T y), (acc, x, y))
+ICYM_API(void, fit_acc_push_batch, (CymFitAcc* acc, const ICYM_T* x, const ICYM_T* y, size_t count), (acc, x, y, count))
+ICYM_API(int, fit_acc_poly, (const CymFitAcc* acc, ICYM_T* output), (acc, output))
+ICYM_API(int, fit_acc_linear, (const CymFitAcc* acc, ICYM_T* a, ICYM_T* b, ICYM_T* r), (acc, a, b, r))
+
+#elif defined(ICYM_KERNEL_PASS)
+
+// X===============================================X SIMD KERNEL PASS X================================================X
+// included by the precision pass once per SIMD level with ICYM_K(name) naming the kernels, ICYM_ISA the ICYM_ISA_ level
+// they target and ICYM_VBYTES the vector size, the kernels are written on ICYM_V vectors of ICYM_VL elements,
+// which are plain scalars when ICYM_VBYTES is 0
+
+#if ICYM_ISA != ICYM_ISA_SCALAR && defined(ICYM_X86_SIMD)
+#if defined(__clang__)
+#if ICYM_ISA == ICYM_ISA_AVX512
+#pragma clang attribute push (__attribute__((target("avx512f,avx2,fma"))), apply_to = function)
+#elif ICYM_ISA == ICYM_ISA_AVX2
+#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#else
+#pragma clang attribute push (__attribute__((target("sse2"))), apply_to = function)
+#endif
+#else
+#pragma GCC push_options
+#if ICYM_ISA == ICYM_ISA_AVX512
+#pragma GCC target("avx512f,avx2,fma")
+#elif ICYM_ISA == ICYM_ISA_AVX2
+#pragma GCC target("avx2,fma")
+#else
+#pragma GCC target("sse2")
+#endif
+#endif
+#endif
+
+#if ICYM_VBYTES
+typedef ICYM_T ICYM_K(icym_vec) __attribute__((vector_size(ICYM_VBYTES), aligned(sizeof(ICYM_T)), may_alias));
+#define ICYM_VL (ICYM_VBYTES / sizeof(ICYM_T))
+#else
+typedef ICYM_T ICYM_K(icym_vec);
+#define ICYM_VL 1
+#endif
+
+#define ICYM_V ICYM_K(icym_vec)
+#define ICYM_VLOAD(P) (*(const ICYM_V*)(P))
+#define ICYM_VSTORE(P, X) (*(ICYM_V*)(P) = (X))
+
+#define ICYM_GEMM_NR (2 * ICYM_VL)
+
+// computes the top left mr x nr of an ICYM_GEMM_MR x ICYM_GEMM_NR block of c = alpha * a * b + beta * c from packed panels,
+// a holding ICYM_GEMM_MR values and b ICYM_GEMM_NR values per k, the whole block stays in registers
+static void ICYM_K(icym_gemm_kernel)(size_t kc, ICYM_T alpha, const ICYM_T* ICYM_RESTRICT a, const ICYM_T* ICYM_RESTRICT b,
+    ICYM_T beta, ICYM_T* ICYM_RESTRICT c, ptrdiff_t rs, ptrdiff_t cs, size_t mr, size_t nr){
+
+    ICYM_V c00 = {0}, c01 = {0}, c10 = {0}, c11 = {0}, c20 = {0}, c21 = {0};
+    ICYM_V c30 = {0}, c31 = {0}, c40 = {0}, c41 = {0}, c50 = {0}, c51 = {0};
+
+    for(size_t p = 0; p < kc; p+=1){
+        const ICYM_V b0 = ICYM_VLOAD(b);
+        const ICYM_V b1 = ICYM_VLOAD(b + ICYM_VL);
+
+        c00 += b0 * a[0]; c01 += b1 * a[0];
+        c10 += b0 * a[1]; c11 += b1 * a[1];
+        c20 += b0 * a[2]; c21 += b1 * a[2];
+        c30 += b0 * a[3]; c31 += b1 * a[3];
+        c40 += b0 * a[4]; c41 += b1 * a[4];
+        c50 += b0 * a[5]; c51 += b1 * a[5];
+
+        a += ICYM_GEMM_MR;
+        b += ICYM_GEMM_NR;
+    }
+
+    if(mr == ICYM_GEMM_MR && nr == ICYM_GEMM_NR && cs == 1){
+#define ICYM_GEMM_ROW(I, X0, X1) do{ \
+            ICYM_T* row = c + (I) * rs; \
+            if(beta == 0){ \
+                ICYM_VSTORE(row, alpha * X0); \
+                ICYM_VSTORE(row + ICYM_VL, alpha * X1); \
+            } else{ \
+                ICYM_VSTORE(row, alpha * X0 + beta * ICYM_VLOAD(row)); \
+                ICYM_VSTORE(row + ICYM_VL, alpha * X1 + beta * ICYM_VLOAD(row + ICYM_VL)); \
+            } \
+        } while(0)
+
+        ICYM_GEMM_ROW(0, c00, c01);
+        ICYM_GEMM_ROW(1, c10, c11);
+        ICYM_GEMM_ROW(2, c20, c21);
+        ICYM_GEMM_ROW(3, c30, c31);
+        ICYM_GEMM_ROW(4, c40, c41);
+        ICYM_GEMM_ROW(5, c50, c51);
+#undef ICYM_GEMM_ROW
+        return;
+    }
+
+    // edge blocks and strided outputs go through memory
+    ICYM_T tile[ICYM_GEMM_MR * ICYM_GEMM_NR];
+    ICYM_VSTORE(tile + 0  * ICYM_VL, c00); ICYM_VSTORE(tile + 1  * ICYM_VL, c01);
+    ICYM_VSTORE(tile + 2  * ICYM_VL, c10); ICYM_VSTORE(tile + 3  * ICYM_VL, c11);
+    ICYM_VSTORE(tile + 4  * ICYM_VL, c20); ICYM_VSTORE(tile + 5  * ICYM_VL, c21);
+    ICYM_VSTORE(tile + 6  * ICYM_VL, c30); ICYM_VSTORE(tile + 7  * ICYM_VL, c31);
+    ICYM_VSTORE(tile + 8  * ICYM_VL, c40); ICYM_VSTORE(tile + 9  * ICYM_VL, c41);
+    ICYM_VSTORE(tile + 10 * ICYM_VL, c50); ICYM_VSTORE(tile + 11 * ICYM_VL, c51);
+
+    for(size_t i = 0; i < mr; i+=1){
+        for(size_t j = 0; j < nr; j+=1){
+            ICYM_T* out = c + (ptrdiff_t)i * rs + (ptrdiff_t)j * cs;
+            *out = (beta == 0)? alpha * tile[i * ICYM_GEMM_NR + j] : alpha * tile[i * ICYM_GEMM_NR + j] + beta * *out;
+        }
+    }
+}
+
+// X==============X BLAS 1 X=================X
+// contiguous vectors, 4 vectors per iteration so the reductions keep independent accumulators
+
+#if ICYM_VBYTES
+#if ICYM_F32
+typedef int32_t ICYM_K(icym_ivec) __attribute__((vector_size(ICYM_VBYTES), aligned(sizeof(ICYM_T)), may_alias));
+#define ICYM_VABS(X) ((ICYM_V)((ICYM_K(icym_ivec))(X) & 0x7fffffff))
+#else
+typedef int64_t ICYM_K(icym_ivec) __attribute__((vector_size(ICYM_VBYTES), aligned(sizeof(ICYM_T)), may_alias));
+#define ICYM_VABS(X) ((ICYM_V)((ICYM_K(icym_ivec))(X) & 0x7fffffffffffffffLL))
+#endif
+
+static inline ICYM_V ICYM_K(icym_vmax)(ICYM_V a, ICYM_V b){
+    const ICYM_K(icym_ivec) greater = (ICYM_K(icym_ivec))(a > b);
+    return (ICYM_V)(((ICYM_K(icym_ivec))a & greater) | ((ICYM_K(icym_ivec))b & ~greater));
+}
+
+static inline ICYM_T ICYM_K(icym_vsum)(ICYM_V v){
+    ICYM_T sum = 0;
+    for(size_t l = 0; l < ICYM_VL; l+=1) sum += v[l];
+    return sum;
+}
+
+static inline ICYM_T ICYM_K(icym_vhmax)(ICYM_V v){
+    ICYM_T max = v[0];
+    for(size_t l = 1; l < ICYM_VL; l+=1) if(v[l] > max) max = v[l];
+    return max;
+}
+#else
+#define ICYM_VABS(X) CYM_ABS(X)
+static inline ICYM_V ICYM_K(icym_vmax)(ICYM_V a, ICYM_V b){ return (a > b)? a : b; }
+static inline ICYM_T ICYM_K(icym_vsum)(ICYM_V v){ return v; }
+static inline ICYM_T ICYM_K(icym_vhmax)(ICYM_V v){ return v; }
+#endif
+
+#define ICYM_BLAS_STEP (4 * ICYM_VL)
+
+static void ICYM_K(icym_axpy)(size_t n, ICYM_T alpha, const ICYM_T* x, ICYM_T* y){
+    size_t i = 0;
+    for(; i + ICYM_BLAS_STEP <= n; i += ICYM_BLAS_STEP){
+        ICYM_VSTORE(y + i,               ICYM_VLOAD(y + i)               + alpha * ICYM_VLOAD(x + i));
+        ICYM_VSTORE(y + i + ICYM_VL,     ICYM_VLOAD(y + i + ICYM_VL)     + alpha * ICYM_VLOAD(x + i + ICYM_VL));
+        ICYM_VSTORE(y + i + 2 * ICYM_VL, ICYM_VLOAD(y + i + 2 * ICYM_VL) + alpha * ICYM_VLOAD(x + i + 2 * ICYM_VL));
+        ICYM_VSTORE(y + i + 3 * ICYM_VL, ICYM_VLOAD(y + i + 3 * ICYM_VL) + alpha * ICYM_VLOAD(x + i + 3 * ICYM_VL));
+    }
+    for(; i + ICYM_VL <= n; i += ICYM_VL) ICYM_VSTORE(y + i, ICYM_VLOAD(y + i) + alpha * ICYM_VLOAD(x + i));
+    for(; i < n; i+=1) y[i] += alpha * x[i];
+}
+
+static void ICYM_K(icym_axpby)(size_t n, ICYM_T alpha, const ICYM_T* x, ICYM_T beta, ICYM_T* y){
+    size_t i = 0;
+    if(beta == 0){
+        for(; i + ICYM_BLAS_STEP <= n; i += ICYM_BLAS_STEP){
+            ICYM_VSTORE(y + i,               alpha * ICYM_VLOAD(x + i));
+            ICYM_VSTORE(y + i + ICYM_VL,     alpha * ICYM_VLOAD(x + i + ICYM_VL));
+            ICYM_VSTORE(y + i + 2 * ICYM_VL, alpha * ICYM_VLOAD(x + i + 2 * ICYM_VL));
+            ICYM_VSTORE(y + i + 3 * ICYM_VL, alpha * ICYM_VLOAD(x + i + 3 * ICYM_VL));
+        }
+        for(; i + ICYM_VL <= n; i += ICYM_VL) ICYM_VSTORE(y + i, alpha * ICYM_VLOAD(x + i));
+        for(; i < n; i+=1) y[i] = alpha * x[i];
+        return;
+    }
+    for(; i + ICYM_BLAS_STEP <= n; i += ICYM_BLAS_STEP){
+        ICYM_VSTORE(y + i,               alpha * ICYM_VLOAD(x + i)               + beta * ICYM_VLOAD(y + i));
+        ICYM_VSTORE(y + i + ICYM_VL,     alpha * ICYM_VLOAD(x + i + ICYM_VL)     + beta * ICYM_VLOAD(y + i + ICYM_VL));
+        ICYM_VSTORE(y + i + 2 * ICYM_VL, alpha * ICYM_VLOAD(x + i + 2 * ICYM_VL) + beta * ICYM_VLOAD(y + i + 2 * ICYM_VL));
+        ICYM_VSTORE(y + i + 3 * ICYM_VL, alpha * ICYM_VLOAD(x + i + 3 * ICYM_VL) + beta * ICYM_VLOAD(y + i + 3 * ICYM_VL));
+    }
+    for(; i + ICYM_VL <= n; i += ICYM_VL) ICYM_VSTORE(y + i, alpha * ICYM_VLOAD(x + i) + beta * ICYM_VLOAD(y + i));
+    for(; i < n; i+=1) y[i] = alpha * x[i] + beta * y[i];
+}
+
+static void ICYM_K(icym_waxpby)(size_t n, ICYM_T alpha, const ICYM_T* x, ICYM_T beta, const ICYM_T* y, ICYM_T* w){
+    size_t i = 0;
+    for(; i + ICYM_BLAS_STEP <= n; i += ICYM_BLAS_STEP){
+        ICYM_VSTORE(w + i,               alpha * ICYM_VLOAD(x + i)               + beta * ICYM_VLOAD(y + i));
+        ICYM_VSTORE(w + i + ICYM_VL,     alpha * ICYM_VLOAD(x + i + ICYM_VL)     + beta * ICYM_VLOAD(y + i + ICYM_VL));
+        ICYM_VSTORE(w + i + 2 * ICYM_VL, alpha * ICYM_VLOAD(x + i + 2 * ICYM_VL) + beta * ICYM_VLOAD(y + i + 2 * ICYM_VL));
+        ICYM_VSTORE(w + i + 3 * ICYM_VL, alpha * ICYM_VLOAD(x + i + 3 * ICYM_VL) + beta * ICYM_VLOAD(y + i + 3 * ICYM_VL));
+    }
+    for(; i + ICYM_VL <= n; i += ICYM_VL) ICYM_VSTORE(w + i, alpha * ICYM_VLOAD(x + i) + beta * ICYM_VLOAD(y + i));
+    for(; i < n; i+=1) w[i] = alpha * x[i] + beta * y[i];
+}
+
+static void ICYM_K(icym_scal)(size_t n, ICYM_T alpha, ICYM_T* x){
+    size_t i = 0;
+    for(; i + ICYM_BLAS_STEP <= n; i += ICYM_BLAS_STEP){
+        ICYM_VSTORE(x + i,               alpha * ICYM_VLOAD(x + i));
+        ICYM_VSTORE(x + i + ICYM_VL,     alpha * ICYM_VLOAD(x + i + ICYM_VL));
+        ICYM_VSTORE(x + i + 2 * ICYM_VL, alpha * ICYM_VLOAD(x + i + 2 * ICYM_VL));
+        ICYM_VSTORE(x + i + 3 * ICYM_VL, alpha * ICYM_VLOAD(x + i + 3 * ICYM_VL));
+    }
+    for(; i + ICYM_VL <= n; i += ICYM_VL) ICYM_VSTORE(x + i, alpha * ICYM_VLOAD(x + i));
+    for(; i < n; i+=1) x[i] *= alpha;
+}
+
+static ICYM_T ICYM_K(icym_dot)(size_t n, const ICYM_T* x, const ICYM_T* y){
+    ICYM_V s0 = {0}, s1 = {0}, s2 = {0}, s3 = {0};
+    size_t i = 0;
+    for(; i + ICYM_BLAS_STEP <= n; i += ICYM_BLAS_STEP){
+        s0 += ICYM_VLOAD(x + i)               * ICYM_VLOAD(y + i);
+        s1 += ICYM_VLOAD(x + i + ICYM_VL)     * ICYM_VLOAD(y + i + ICYM_VL);
+        s2 += ICYM_VLOAD(x + i + 2 * ICYM_VL) * ICYM_VLOAD(y + i + 2 * ICYM_VL);
+        s3 += ICYM_VLOAD(x + i + 3 * ICYM_VL) * ICYM_VLOAD(y + i + 3 * ICYM_VL);
+    }
+    for(; i + ICYM_VL <= n; i += ICYM_VL) s0 += ICYM_VLOAD(x + i) * ICYM_VLOAD(y + i);
+    ICYM_T sum = ICYM_K(icym_vsum)((s0 + s1) + (s2 + s3));
+    for(; i < n; i+=1) sum += x[i] * y[i];
+    return sum;
+}
+
+static ICYM_T ICYM_K(icym_asum)(size_t n, const ICYM_T* x){
+    ICYM_V s0 = {0}, s1 = {0}, s2 = {0}, s3 = {0};
+    size_t i = 0;
+    for(; i + ICYM_BLAS_STEP <= n; i += ICYM_BLAS_STEP){
+        s0 += ICYM_VABS(ICYM_VLOAD(x + i));
+        s1 += ICYM_VABS(ICYM_VLOAD(x + i + ICYM_VL));
+        s2 += ICYM_VABS(ICYM_VLOAD(x + i + 2 * ICYM_VL));
+        s3 += ICYM_VABS(ICYM_VLOAD(x + i + 3 * ICYM_VL));
+    }
+    for(; i + ICYM_VL <= n; i += ICYM_VL) s0 += ICYM_VABS(ICYM_VLOAD(x + i));
+    ICYM_T sum = ICYM_K(icym_vsum)((s0 + s1) + (s2 + s3));
+    for(; i < n; i+=1) sum += CYM_ABS(x[i]);
+    return sum;
+}
+
+// \returns the biggest absolute value of x, 0 when n is 0
+static ICYM_T ICYM_K(icym_amax)(size_t n, const ICYM_T* x){
+    ICYM_V m0 = {0}, m1 = {0}, m2 = {0}, m3 = {0};
+    size_t i = 0;
+    for(; i + ICYM_BLAS_STEP <= n; i += ICYM_BLAS_STEP){
+        m0 = ICYM_K(icym_vmax)(ICYM_VABS(ICYM_VLOAD(x + i)), m0);
+        m1 = ICYM_K(icym_vmax)(ICYM_VABS(ICYM_VLOAD(x + i + ICYM_VL)), m1);
+        m2 = ICYM_K(icym_vmax)(ICYM_VABS(ICYM_VLOAD(x + i + 2 * ICYM_VL)), m2);
+        m3 = ICYM_K(icym_vmax)(ICYM_VABS(ICYM_VLOAD(x + i + 3 * ICYM_VL)), m3);
+    }
+    for(; i + ICYM_VL <= n; i += ICYM_VL) m0 = ICYM_K(icym_vmax)(ICYM_VABS(ICYM_VLOAD(x + i)), m0);
+    ICYM_T max = ICYM_K(icym_vhmax)(ICYM_K(icym_vmax)(ICYM_K(icym_vmax)(m0, m1), ICYM_K(icym_vmax)(m2, m3)));
+    for(; i < n; i+=1) if(CYM_ABS(x[i]) > max) max = CYM_ABS(x[i]);
+    return max;
+}
+
+#undef ICYM_BLAS_STEP
+#undef ICYM_VABS
+
+// X==============X SQUARE ROOTS X=================X
+// ICYM_VSQRT is the correctly rounded vector square root and ICYM_VRSQRT_EST the hardware reciprocal square root
+// estimate (12 bits, 14 with AVX-512), the levels missing them go element by element
+
+#if defined(ICYM_X86_SIMD) && ICYM_ISA == ICYM_ISA_AVX512 && ICYM_F32
+#define ICYM_VSQRT(X)      _mm512_sqrt_ps(X)
+#define ICYM_VRSQRT_EST(X) _mm512_rsqrt14_ps(X)
+#elif defined(ICYM_X86_SIMD) && ICYM_ISA == ICYM_ISA_AVX512
+#define ICYM_VSQRT(X)      _mm512_sqrt_pd(X)
+#define ICYM_VRSQRT_EST(X) _mm512_rsqrt14_pd(X)
+#elif defined(ICYM_X86_SIMD) && ICYM_ISA == ICYM_ISA_AVX2 && ICYM_F32
+#define ICYM_VSQRT(X)      _mm256_sqrt_ps(X)
+#define ICYM_VRSQRT_EST(X) _mm256_rsqrt_ps(X)
+#elif defined(ICYM_X86_SIMD) && ICYM_ISA == ICYM_ISA_AVX2
+#define ICYM_VSQRT(X)      _mm256_sqrt_pd(X)
+#elif defined(ICYM_X86_SIMD) && ICYM_ISA == ICYM_ISA_SSE2 && ICYM_F32
+#define ICYM_VSQRT(X)      _mm_sqrt_ps(X)
+#define ICYM_VRSQRT_EST(X) _mm_rsqrt_ps(X)
+#elif defined(ICYM_X86_SIMD) && ICYM_ISA == ICYM_ISA_SSE2
+#define ICYM_VSQRT(X)      _mm_sqrt_pd(X)
+#endif
+
+static void ICYM_K(icym_sqrt_batch)(size_t n, const ICYM_T* x, ICYM_T* out){
+    size_t i = 0;
+#if defined(ICYM_VSQRT)
+    for(; i + ICYM_VL <= n; i += ICYM_VL) ICYM_VSTORE(out + i, ICYM_VSQRT(ICYM_VLOAD(x + i)));
+#endif
+    for(; i < n; i+=1) out[i] = ICYM_FN(icym_sqrt)(x[i]);
+}
+
+// fast takes the estimate with one newton step instead of the correctly rounded root and a division
+static void ICYM_K(icym_rsqrt_batch)(size_t n, const ICYM_T* x, ICYM_T* out, int fast){
+    size_t i = 0;
+#if defined(ICYM_VRSQRT_EST)
+    if(fast){
+        for(; i + ICYM_VL <= n; i += ICYM_VL){
+            const ICYM_V v = ICYM_VLOAD(x + i);
+            const ICYM_V e = ICYM_VRSQRT_EST(v);
+            const ICYM_V r = e * ((ICYM_T)1.5 - (ICYM_T)0.5 * v * e * e);
+            // the step turns the infinite and zero estimates (of 0, subnormals and inf) into NaN, those keep the estimate
+            const ICYM_K(icym_ivec) finite = (ICYM_K(icym_ivec))((e - e) == 0) & (ICYM_K(icym_ivec))(e != 0);
+            ICYM_VSTORE(out + i, (ICYM_V)(((ICYM_K(icym_ivec))r & finite) | ((ICYM_K(icym_ivec))e & ~finite)));
+        }
+    }
+#else
+    (void)fast;
+#endif
+#if defined(ICYM_VSQRT)
+    for(; i + ICYM_VL <= n; i += ICYM_VL) ICYM_VSTORE(out + i, 1 / ICYM_VSQRT(ICYM_VLOAD(x + i)));
+#endif
+    for(; i < n; i+=1) out[i] = 1 / ICYM_FN(icym_sqrt)(x[i]);
+}
+
+// acc += x * x
+static void ICYM_K(icym_sqacc)(size_t n, const ICYM_T* x, ICYM_T* acc){
+    size_t i = 0;
+    for(; i + ICYM_VL <= n; i += ICYM_VL){
+        const ICYM_V v = ICYM_VLOAD(x + i);
+        ICYM_VSTORE(acc + i, ICYM_VLOAD(acc + i) + v * v);
+    }
+    for(; i < n; i+=1) acc[i] += x[i] * x[i];
+}
+
+// out = x * y element by element
+static void ICYM_K(icym_mul)(size_t n, const ICYM_T* x, const ICYM_T* y, ICYM_T* out){
+    size_t i = 0;
+    for(; i + ICYM_VL <= n; i += ICYM_VL) ICYM_VSTORE(out + i, ICYM_VLOAD(x + i) * ICYM_VLOAD(y + i));
+    for(; i < n; i+=1) out[i] = x[i] * y[i];
+}
+
+#undef ICYM_VRSQRT_EST
+#undef ICYM_VSQRT
+
+// X==============X FITS X=================X
+
+// writes to sums the sums over the n points of (x - center)^p for p in [0, 2 * order], of (x - center)^p * y for p in
+// [0, order] and of y^2, each lane of the vectors summing its share of the points
+static void ICYM_K(icym_fit_moments)(size_t n, const ICYM_T* x, const ICYM_T* y, ICYM_T center, int order, ICYM_T* sums){
+    const int terms = 3 * order + 3;
+    const ICYM_V zero = {0};
+    ICYM_V acc[3 * CYM_FIT_MAX_ORDER + 3];
+    for(int t = 0; t < terms; t+=1) acc[t] = zero;
+
+    ICYM_V* sx  = acc;
+    ICYM_V* sxy = acc + 2 * order + 1;
+    size_t i = 0;
+    for(; i + ICYM_VL <= n; i += ICYM_VL){
+        const ICYM_V u  = ICYM_VLOAD(x + i) - center;
+        const ICYM_V yi = ICYM_VLOAD(y + i);
+        ICYM_V power = u;
+        sx[0]  += 1;
+        sxy[0] += yi;
+        for(int p = 1; p <= order; p+=1){
+            sx[p]  += power;
+            sxy[p] += power * yi;
+            power  *= u;
+        }
+        for(int p = order + 1; p <= 2 * order; p+=1){
+            sx[p] += power;
+            power *= u;
+        }
+        acc[terms - 1] += yi * yi;
+    }
+
+    for(int t = 0; t < terms; t+=1) sums[t] = ICYM_K(icym_vsum)(acc[t]);
+
+    for(; i < n; i+=1){
+        const ICYM_T u = x[i] - center;
+        ICYM_T power = 1;
+        for(int p = 0; p <= order; p+=1){
+            sums[p] += power;
+            sums[2 * order + 1 + p] += power * y[i];
+            power *= u;
+        }
+        for(int p = order + 1; p <= 2 * order; p+=1){
+            sums[p] += power;
+            power *= u;
+        }
+        sums[terms - 1] += y[i] * y[i];
+    }
+}
+
+// from this order on the polynomials are evaluated as even(x^2) + x * odd(x^2), the first level of Estrin's scheme, whose two
+// Horner chains per vector keep more multiply adds in flight than Horner's rule on the whole polynomial
+#define ICYM_ESTRIN_ORDER 12
+
+// out[p * out_stride + i] = polynomial p (order + 1 coefficients each, smallest power first) at x[i] for the polys polynomials,
+// 4 vectors of points at a time so each coefficient is loaded once for all of them
+static void ICYM_K(icym_poly_eval)(size_t n, const ICYM_T* x, const ICYM_T* coefficients, int order, size_t polys,
+    ICYM_T* out, size_t out_stride){
+
+    const ICYM_V zero = {0};
+    const size_t stride = (size_t)order + 1;
+    size_t i = 0;
+    for(; i + 4 * ICYM_VL <= n; i += 4 * ICYM_VL){
+        const ICYM_V x0 = ICYM_VLOAD(x + i);
+        const ICYM_V x1 = ICYM_VLOAD(x + i + ICYM_VL);
+        const ICYM_V x2 = ICYM_VLOAD(x + i + 2 * ICYM_VL);
+        const ICYM_V x3 = ICYM_VLOAD(x + i + 3 * ICYM_VL);
+
+        for(size_t p = 0; p < polys; p+=1){
+            const ICYM_T* c = coefficients + p * stride;
+            ICYM_T* o = out + p * out_stride + i;
+            ICYM_V r0, r1, r2, r3;
+
+            if(order < ICYM_ESTRIN_ORDER){
+                r0 = r1 = r2 = r3 = zero + c[order];
+                for(int k = order - 1; k >= 0; k-=1){
+                    r0 = r0 * x0 + c[k];
+                    r1 = r1 * x1 + c[k];
+                    r2 = r2 * x2 + c[k];
+                    r3 = r3 * x3 + c[k];
+                }
+            } else{
+                const ICYM_V y0 = x0 * x0, y1 = x1 * x1, y2 = x2 * x2, y3 = x3 * x3;
+                const int half = order / 2;
+                ICYM_V e0, e1, e2, e3, o0, o1, o2, o3;
+                e0 = e1 = e2 = e3 = zero + c[2 * half];
+                o0 = o1 = o2 = o3 = zero + ((2 * half + 1 <= order)? c[2 * half + 1] : 0);
+                for(int k = half - 1; k >= 0; k-=1){
+                    const ICYM_T even = c[2 * k], odd = c[2 * k + 1];
+                    e0 = e0 * y0 + even; o0 = o0 * y0 + odd;
+                    e1 = e1 * y1 + even; o1 = o1 * y1 + odd;
+                    e2 = e2 * y2 + even; o2 = o2 * y2 + odd;
+                    e3 = e3 * y3 + even; o3 = o3 * y3 + odd;
+                }
+                r0 = e0 + x0 * o0;
+                r1 = e1 + x1 * o1;
+                r2 = e2 + x2 * o2;
+                r3 = e3 + x3 * o3;
+            }
+
+            ICYM_VSTORE(o, r0);
+            ICYM_VSTORE(o + ICYM_VL, r1);
+            ICYM_VSTORE(o + 2 * ICYM_VL, r2);
+            ICYM_VSTORE(o + 3 * ICYM_VL, r3);
+        }
+    }
+
+    for(; i < n; i+=1){
+        for(size_t p = 0; p < polys; p+=1){
+            const ICYM_T* c = coefficients + p * stride;
+            ICYM_T r = c[order];
+            for(int k = order - 1; k >= 0; k-=1) r = r * x[i] + c[k];
+            out[p * out_stride + i] = r;
+        }
+    }
+}
+
+// out[i] = the Newton form of the n nodes x and divided differences c at t[i], 4 vectors of values at a time so each node
+// is loaded once for all of them
+static void ICYM_K(icym_newton_eval)(size_t count, const ICYM_T* t, const ICYM_T* x, const ICYM_T* c, size_t n, ICYM_T* out){
+    const ICYM_V zero = {0};
+    size_t i = 0;
+    for(; i + 4 * ICYM_VL <= count; i += 4 * ICYM_VL){
+        const ICYM_V t0 = ICYM_VLOAD(t + i);
+        const ICYM_V t1 = ICYM_VLOAD(t + i + ICYM_VL);
+        const ICYM_V t2 = ICYM_VLOAD(t + i + 2 * ICYM_VL);
+        const ICYM_V t3 = ICYM_VLOAD(t + i + 3 * ICYM_VL);
+        ICYM_V r0, r1, r2, r3;
+        r0 = r1 = r2 = r3 = zero + c[n - 1];
+        for(size_t k = n - 1; k > 0; k-=1){
+            const ICYM_T xk = x[k - 1], ck = c[k - 1];
+            r0 = r0 * (t0 - xk) + ck;
+            r1 = r1 * (t1 - xk) + ck;
+            r2 = r2 * (t2 - xk) + ck;
+            r3 = r3 * (t3 - xk) + ck;
+        }
+        ICYM_VSTORE(out + i, r0);
+        ICYM_VSTORE(out + i + ICYM_VL, r1);
+        ICYM_VSTORE(out + i + 2 * ICYM_VL, r2);
+        ICYM_VSTORE(out + i + 3 * ICYM_VL, r3);
+    }
+
+    for(; i < count; i+=1){
+        ICYM_T r = c[n - 1];
+        for(size_t k = n - 1; k > 0; k-=1) r = r * (t[i] - x[k - 1]) + c[k - 1];
+        out[i] = r;
+    }
+}
+
+// out[i] = the second barycentric form sum w_j y_j / (t - x_j) / sum w_j / (t - x_j) of the n nodes at t[i], 4 vectors of
+// values at a time. The divisions bound it, so the nodes go by pairs sharing one: 1 / (d_a d_b) gives both 1 / d_a and
+// 1 / d_b, the differences being multiplied by scale (4 over the span of the nodes) to keep their products in range, which
+// the common factor of the two sums cancels. A value on a node gives NaN or inf, the caller fixes those lanes
+static void ICYM_K(icym_barycentric_eval)(size_t count, const ICYM_T* t, const ICYM_T* x, const ICYM_T* y, const ICYM_T* w,
+    size_t n, ICYM_T scale, ICYM_T* out){
+
+    const ICYM_V zero = {0};
+    size_t i = 0;
+    for(; i + 4 * ICYM_VL <= count; i += 4 * ICYM_VL){
+        const ICYM_V t0 = ICYM_VLOAD(t + i) * scale;
+        const ICYM_V t1 = ICYM_VLOAD(t + i + ICYM_VL) * scale;
+        const ICYM_V t2 = ICYM_VLOAD(t + i + 2 * ICYM_VL) * scale;
+        const ICYM_V t3 = ICYM_VLOAD(t + i + 3 * ICYM_VL) * scale;
+        ICYM_V n0 = zero, n1 = zero, n2 = zero, n3 = zero;
+        ICYM_V d0 = zero, d1 = zero, d2 = zero, d3 = zero;
+        size_t j = 0;
+        for(; j + 1 < n; j += 2){
+            const ICYM_T xa = x[j] * scale, xb = x[j + 1] * scale;
+            const ICYM_T wa = w[j], wb = w[j + 1], ya = y[j], yb = y[j + 1];
+#define ICYM_BARY_PAIR(T, N, D) do{ \
+                const ICYM_V da = T - xa, db = T - xb; \
+                const ICYM_V r  = 1 / (da * db); \
+                const ICYM_V qa = (wa * db) * r, qb = (wb * da) * r; \
+                N += qa * ya + qb * yb; \
+                D += qa + qb; \
+            } while(0)
+            ICYM_BARY_PAIR(t0, n0, d0);
+            ICYM_BARY_PAIR(t1, n1, d1);
+            ICYM_BARY_PAIR(t2, n2, d2);
+            ICYM_BARY_PAIR(t3, n3, d3);
+#undef ICYM_BARY_PAIR
+        }
+        if(j < n){
+            const ICYM_T xj = x[j] * scale, wj = w[j], yj = y[j];
+            const ICYM_V q0 = wj / (t0 - xj), q1 = wj / (t1 - xj), q2 = wj / (t2 - xj), q3 = wj / (t3 - xj);
+            n0 += q0 * yj; d0 += q0;
+            n1 += q1 * yj; d1 += q1;
+            n2 += q2 * yj; d2 += q2;
+            n3 += q3 * yj; d3 += q3;
+        }
+        ICYM_VSTORE(out + i, n0 / d0);
+        ICYM_VSTORE(out + i + ICYM_VL, n1 / d1);
+        ICYM_VSTORE(out + i + 2 * ICYM_VL, n2 / d2);
+        ICYM_VSTORE(out + i + 3 * ICYM_VL, n3 / d3);
+    }
+
+    for(; i < count; i+=1){
+        ICYM_T num = 0, den = 0;
+        for(size_t j = 0; j < n; j+=1){
+            const ICYM_T q = w[j] / (t[i] - x[j]);
+            num += q * y[j];
+            den += q;
+        }
+        out[i] = num / den;
+    }
+}
+
+// the residuals y - p(x) of the polynomial c over the n points, written to residuals unless it is NULL, sums getting the sum
+// of their squares, of y - shift and of (y - shift)^2
+static void ICYM_K(icym_poly_residuals)(size_t n, const ICYM_T* x, const ICYM_T* y, const ICYM_T* c, int order, ICYM_T shift,
+    ICYM_T* residuals, ICYM_T* sums){
+
+    const ICYM_V zero = {0};
+    ICYM_V ssr0 = zero, ssr1 = zero, sy = zero, syy = zero;
+    size_t i = 0;
+    for(; i + 2 * ICYM_VL <= n; i += 2 * ICYM_VL){
+        const ICYM_V x0 = ICYM_VLOAD(x + i);
+        const ICYM_V x1 = ICYM_VLOAD(x + i + ICYM_VL);
+        ICYM_V r0 = zero + c[order], r1 = r0;
+        for(int k = order - 1; k >= 0; k-=1){
+            r0 = r0 * x0 + c[k];
+            r1 = r1 * x1 + c[k];
+        }
+        const ICYM_V y0 = ICYM_VLOAD(y + i);
+        const ICYM_V y1 = ICYM_VLOAD(y + i + ICYM_VL);
+        r0 = y0 - r0;
+        r1 = y1 - r1;
+        if(residuals){
+            ICYM_VSTORE(residuals + i, r0);
+            ICYM_VSTORE(residuals + i + ICYM_VL, r1);
+        }
+        ssr0 += r0 * r0;
+        ssr1 += r1 * r1;
+        const ICYM_V d0 = y0 - shift, d1 = y1 - shift;
+        sy  += d0 + d1;
+        syy += d0 * d0 + d1 * d1;
+    }
+
+    sums[0] = ICYM_K(icym_vsum)(ssr0 + ssr1);
+    sums[1] = ICYM_K(icym_vsum)(sy);
+    sums[2] = ICYM_K(icym_vsum)(syy);
+    for(; i < n; i+=1){
+        ICYM_T r = c[order];
+        for(int k = order - 1; k >= 0; k-=1) r = r * x[i] + c[k];
+        r = y[i] - r;
+        if(residuals) residuals[i] = r;
+        const ICYM_T d = y[i] - shift;
+        sums[0] += r * r;
+        sums[1] += d;
+        sums[2] += d * d;
+    }
+}
+
+// the moments of the fits with errors on both axes: the sums of w, w u, w u^2, w v and w u v with the weights
+// w = 1 / (dy^2 + slope^2 dx^2), u = x - xc and v = y - yc
+static void ICYM_K(icym_weighted_moments)(size_t n, const ICYM_T* x, const ICYM_T* y, const ICYM_T* dx, const ICYM_T* dy,
+    ICYM_T slope, ICYM_T xc, ICYM_T yc, ICYM_T* sums){
+
+    const ICYM_V zero = {0};
+    const ICYM_V one  = zero + 1;
+    const ICYM_T s2 = slope * slope;
+    ICYM_V sw = zero, swu = zero, swuu = zero, swv = zero, swuv = zero;
+    size_t i = 0;
+    for(; i + ICYM_VL <= n; i += ICYM_VL){
+        const ICYM_V ex = ICYM_VLOAD(dx + i), ey = ICYM_VLOAD(dy + i);
+        const ICYM_V w  = one / (ey * ey + s2 * (ex * ex));
+        const ICYM_V u  = ICYM_VLOAD(x + i) - xc;
+        const ICYM_V v  = ICYM_VLOAD(y + i) - yc;
+        const ICYM_V wu = w * u;
+        sw   += w;
+        swu  += wu;
+        swuu += wu * u;
+        swv  += w * v;
+        swuv += wu * v;
+    }
+
+    sums[0] = ICYM_K(icym_vsum)(sw);
+    sums[1] = ICYM_K(icym_vsum)(swu);
+    sums[2] = ICYM_K(icym_vsum)(swuu);
+    sums[3] = ICYM_K(icym_vsum)(swv);
+    sums[4] = ICYM_K(icym_vsum)(swuv);
+    for(; i < n; i+=1){
+        const ICYM_T w = 1 / (dy[i] * dy[i] + s2 * (dx[i] * dx[i]));
+        const ICYM_T u = x[i] - xc, v = y[i] - yc;
+        sums[0] += w;
+        sums[1] += w * u;
+        sums[2] += w * u * u;
+        sums[3] += w * v;
+        sums[4] += w * u * v;
+    }
+}
+
+#undef ICYM_ESTRIN_ORDER
+
+// X==============X SPARSE X=================X
+
+// the ICYM_VL elements of x at the indices (below 2^31) of I
+#if defined(ICYM_X86_SIMD) && ICYM_ISA == ICYM_ISA_AVX512 && ICYM_F32
+#define ICYM_VGATHER(X, I) ((ICYM_V)_mm512_i32gather_ps(_mm512_loadu_si512((const void*)(I)), (X), 4))
+#elif defined(ICYM_X86_SIMD) && ICYM_ISA == ICYM_ISA_AVX512
+#define ICYM_VGATHER(X, I) ((ICYM_V)_mm512_i32gather_pd(_mm256_loadu_si256((const __m256i*)(I)), (X), 8))
+#elif defined(ICYM_X86_SIMD) && ICYM_ISA == ICYM_ISA_AVX2 && ICYM_F32
+#define ICYM_VGATHER(X, I) ((ICYM_V)_mm256_i32gather_ps((X), _mm256_loadu_si256((const __m256i*)(I)), 4))
+#elif defined(ICYM_X86_SIMD) && ICYM_ISA == ICYM_ISA_AVX2
+#define ICYM_VGATHER(X, I) ((ICYM_V)_mm256_i32gather_pd((X), _mm_loadu_si128((const __m128i*)(I)), 8))
+#elif ICYM_VBYTES
+static inline ICYM_V ICYM_K(icym_vgather)(const ICYM_T* x, const unsigned int* indices){
+    ICYM_V v = {0};
+    for(size_t l = 0; l < ICYM_VL; l+=1) v[l] = x[indices[l]];
+    return v;
+}
+#define ICYM_VGATHER(X, I) ICYM_K(icym_vgather)(X, I)
+#else
+#define ICYM_VGATHER(X, I) ((X)[*(I)])
+#endif
+
+// y[i] = alpha * (line i of a CSR matrix) . x + beta * y[i] for the lines [begin, end), beta 0 only writing y
+// only lines of at least 2 vectors of nonzeros gather x, the accumulators and their horizontal sum costing more than the
+// gathers save below that (a 5 point stencil line is 5 scalar multiply adds at any SIMD level)
+static void ICYM_K(icym_csr_rows)(size_t begin, size_t end, const size_t* offsets, const unsigned int* indices,
+    const ICYM_T* values, const ICYM_T* x, ICYM_T alpha, ICYM_T beta, ICYM_T* y){
+
+    const ICYM_V zero = {0};
+    for(size_t i = begin; i < end; i+=1){
+        const size_t stop = offsets[i + 1];
+        size_t k = offsets[i];
+        if(stop - k < 2 * ICYM_VL){
+            // two chains, the latency of one multiply add per nonzero being what bounds such short lines
+            ICYM_T sum0 = 0, sum1 = 0;
+            for(; k + 2 <= stop; k += 2){
+                sum0 += values[k] * x[indices[k]];
+                sum1 += values[k + 1] * x[indices[k + 1]];
+            }
+            if(k < stop) sum0 += values[k] * x[indices[k]];
+            const ICYM_T sum = sum0 + sum1;
+            y[i] = (beta == 0)? alpha * sum : alpha * sum + beta * y[i];
+            continue;
+        }
+        ICYM_V acc0 = zero, acc1 = zero;
+        for(; k + 2 * ICYM_VL <= stop; k += 2 * ICYM_VL){
+            acc0 += ICYM_VLOAD(values + k) * ICYM_VGATHER(x, indices + k);
+            acc1 += ICYM_VLOAD(values + k + ICYM_VL) * ICYM_VGATHER(x, indices + k + ICYM_VL);
+        }
+        if(k + ICYM_VL <= stop){
+            acc0 += ICYM_VLOAD(values + k) * ICYM_VGATHER(x, indices + k);
+            k += ICYM_VL;
+        }
+        ICYM_T sum = ICYM_K(icym_vsum)(acc0 + acc1);
+        for(; k < stop; k+=1) sum += values[k] * x[indices[k]];
+        y[i] = (beta == 0)? alpha * sum : alpha * sum + beta * y[i];
+    }
+}
+
+#undef ICYM_VGATHER
+
+// X==============X COMPLEX X=================X
+// interleaved complex numbers, the real part of each followed by its imaginary part, n counting complex numbers
+
+#if ICYM_VBYTES
+// v with the two parts of each complex number swapped
+#if defined(ICYM_X86_SIMD) && ICYM_ISA == ICYM_ISA_AVX512 && ICYM_F32
+#define ICYM_VSWAP(X) ((ICYM_V)_mm512_permute_ps((__m512)(X), 0xb1))
+#elif defined(ICYM_X86_SIMD) && ICYM_ISA == ICYM_ISA_AVX512
+#define ICYM_VSWAP(X) ((ICYM_V)_mm512_permute_pd((__m512d)(X), 0x55))
+#elif defined(ICYM_X86_SIMD) && ICYM_ISA == ICYM_ISA_AVX2 && ICYM_F32
+#define ICYM_VSWAP(X) ((ICYM_V)_mm256_permute_ps((__m256)(X), 0xb1))
+#elif defined(ICYM_X86_SIMD) && ICYM_ISA == ICYM_ISA_AVX2
+#define ICYM_VSWAP(X) ((ICYM_V)_mm256_permute_pd((__m256d)(X), 0x5))
+#elif defined(ICYM_X86_SIMD) && ICYM_F32
+#define ICYM_VSWAP(X) ((ICYM_V)_mm_shuffle_ps((__m128)(X), (__m128)(X), 0xb1))
+#elif defined(ICYM_X86_SIMD)
+#define ICYM_VSWAP(X) ((ICYM_V)_mm_shuffle_pd((__m128d)(X), (__m128d)(X), 1))
+#else
+static inline ICYM_V ICYM_K(icym_vswap)(ICYM_V v){
+    ICYM_V s = v;
+    for(size_t l = 0; l < ICYM_VL; l+=2){
+        s[l] = v[l + 1];
+        s[l + 1] = v[l];
+    }
+    return s;
+}
+#define ICYM_VSWAP(X) ICYM_K(icym_vswap)(X)
+#endif
+
+// -1 on the real parts and 1 on the imaginary ones
+static inline ICYM_V ICYM_K(icym_vsign)(void){
+    ICYM_V s = {0};
+    for(size_t l = 0; l < ICYM_VL; l+=1) s[l] = (l & 1)? 1 : -1;
+    return s;
+}
+#endif
+
+// y = alpha * x + y, alpha being ar + i * ai
+static void ICYM_K(icym_caxpy)(size_t n, ICYM_T ar, ICYM_T ai, const ICYM_T* x, ICYM_T* y){
+    size_t i = 0;
+#if ICYM_VBYTES
+    const ICYM_V si = ICYM_K(icym_vsign)() * ai;
+    for(; 2 * i + 2 * ICYM_VL <= 2 * n; i += ICYM_VL){
+        const ICYM_V x0 = ICYM_VLOAD(x + 2 * i), x1 = ICYM_VLOAD(x + 2 * i + ICYM_VL);
+        ICYM_VSTORE(y + 2 * i,           ICYM_VLOAD(y + 2 * i)           + ar * x0 + si * ICYM_VSWAP(x0));
+        ICYM_VSTORE(y + 2 * i + ICYM_VL, ICYM_VLOAD(y + 2 * i + ICYM_VL) + ar * x1 + si * ICYM_VSWAP(x1));
+    }
+#endif
+    for(; i < n; i+=1){
+        const ICYM_T xr = x[2 * i], xi = x[2 * i + 1];
+        y[2 * i]     += ar * xr - ai * xi;
+        y[2 * i + 1] += ar * xi + ai * xr;
+    }
+}
+
+// out = alpha * x, out may be x
+static void ICYM_K(icym_cscal)(size_t n, ICYM_T ar, ICYM_T ai, const ICYM_T* x, ICYM_T* out){
+    size_t i = 0;
+#if ICYM_VBYTES
+    const ICYM_V si = ICYM_K(icym_vsign)() * ai;
+    for(; 2 * i + ICYM_VL <= 2 * n; i += ICYM_VL / 2){
+        const ICYM_V v = ICYM_VLOAD(x + 2 * i);
+        ICYM_VSTORE(out + 2 * i, ar * v + si * ICYM_VSWAP(v));
+    }
+#endif
+    for(; i < n; i+=1){
+        const ICYM_T xr = x[2 * i], xi = x[2 * i + 1];
+        out[2 * i]     = ar * xr - ai * xi;
+        out[2 * i + 1] = ar * xi + ai * xr;
+    }
+}
+
+// out[0] + i * out[1] = sum(op(x[j]) * y[j]), op conjugating x when conjugate is set
+static void ICYM_K(icym_cdot)(size_t n, const ICYM_T* x, const ICYM_T* y, int conjugate, ICYM_T* out){
+    // the products of the matching parts (xr yr, xi yi) and of the crossed ones (xr yi, xi yr)
+    ICYM_T same[2] = { 0, 0 }, cross[2] = { 0, 0 };
+    size_t i = 0;
+#if ICYM_VBYTES
+    const ICYM_V zero = {0};
+    ICYM_V s0 = zero, s1 = zero, c0 = zero, c1 = zero;
+    for(; 2 * i + 2 * ICYM_VL <= 2 * n; i += ICYM_VL){
+        const ICYM_V x0 = ICYM_VLOAD(x + 2 * i), x1 = ICYM_VLOAD(x + 2 * i + ICYM_VL);
+        const ICYM_V y0 = ICYM_VLOAD(y + 2 * i), y1 = ICYM_VLOAD(y + 2 * i + ICYM_VL);
+        s0 += x0 * y0;
+        s1 += x1 * y1;
+        c0 += x0 * ICYM_VSWAP(y0);
+        c1 += x1 * ICYM_VSWAP(y1);
+    }
+    s0 += s1;
+    c0 += c1;
+    for(size_t l = 0; l < ICYM_VL; l+=1){
+        same[l & 1]  += s0[l];
+        cross[l & 1] += c0[l];
+    }
+#endif
+    for(; i < n; i+=1){
+        same[0]  += x[2 * i] * y[2 * i];
+        same[1]  += x[2 * i + 1] * y[2 * i + 1];
+        cross[0] += x[2 * i] * y[2 * i + 1];
+        cross[1] += x[2 * i + 1] * y[2 * i];
+    }
+    const ICYM_T sign = conjugate? -1 : 1;
+    out[0] = same[0] - sign * same[1];
+    out[1] = cross[0] + sign * cross[1];
+}
+
+#undef ICYM_VSWAP
+
+// transposes the ICYM_TRANSPOSE_TILE x ICYM_TRANSPOSE_TILE tile at in to out in registers
+#if defined(ICYM_X86_SIMD) && ICYM_ISA >= ICYM_ISA_AVX2 && ICYM_F32
+#define ICYM_TRANSPOSE_TILE 8
+static void ICYM_K(icym_transpose_tile)(const ICYM_T* in, ptrdiff_t in_rs, ICYM_T* out, ptrdiff_t out_rs){
+    const __m256 r0 = _mm256_loadu_ps(in + 0 * in_rs), r1 = _mm256_loadu_ps(in + 1 * in_rs);
+    const __m256 r2 = _mm256_loadu_ps(in + 2 * in_rs), r3 = _mm256_loadu_ps(in + 3 * in_rs);
+    const __m256 r4 = _mm256_loadu_ps(in + 4 * in_rs), r5 = _mm256_loadu_ps(in + 5 * in_rs);
+    const __m256 r6 = _mm256_loadu_ps(in + 6 * in_rs), r7 = _mm256_loadu_ps(in + 7 * in_rs);
+
+    const __m256 t0 = _mm256_unpacklo_ps(r0, r1), t1 = _mm256_unpackhi_ps(r0, r1);
+    const __m256 t2 = _mm256_unpacklo_ps(r2, r3), t3 = _mm256_unpackhi_ps(r2, r3);
+    const __m256 t4 = _mm256_unpacklo_ps(r4, r5), t5 = _mm256_unpackhi_ps(r4, r5);
+    const __m256 t6 = _mm256_unpacklo_ps(r6, r7), t7 = _mm256_unpackhi_ps(r6, r7);
+
+    const __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)), u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)), u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0)), u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0)), u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+    _mm256_storeu_ps(out + 0 * out_rs, _mm256_permute2f128_ps(u0, u4, 0x20));
+    _mm256_storeu_ps(out + 1 * out_rs, _mm256_permute2f128_ps(u1, u5, 0x20));
+    _mm256_storeu_ps(out + 2 * out_rs, _mm256_permute2f128_ps(u2, u6, 0x20));
+    _mm256_storeu_ps(out + 3 * out_rs, _mm256_permute2f128_ps(u3, u7, 0x20));
+    _mm256_storeu_ps(out + 4 * out_rs, _mm256_permute2f128_ps(u0, u4, 0x31));
+    _mm256_storeu_ps(out + 5 * out_rs, _mm256_permute2f128_ps(u1, u5, 0x31));
+    _mm256_storeu_ps(out + 6 * out_rs, _mm256_permute2f128_ps(u2, u6, 0x31));
+    _mm256_storeu_ps(out + 7 * out_rs, _mm256_permute2f128_ps(u3, u7, 0x31));
+}
+#elif defined(ICYM_X86_SIMD) && ICYM_ISA == ICYM_ISA_AVX512
+#define ICYM_TRANSPOSE_TILE 8
+static void ICYM_K(icym_transpose_tile)(const ICYM_T* in, ptrdiff_t in_rs, ICYM_T* out, ptrdiff_t out_rs){
+    const __m512d r0 = _mm512_loadu_pd(in + 0 * in_rs), r1 = _mm512_loadu_pd(in + 1 * in_rs);
+    const __m512d r2 = _mm512_loadu_pd(in + 2 * in_rs), r3 = _mm512_loadu_pd(in + 3 * in_rs);
+    const __m512d r4 = _mm512_loadu_pd(in + 4 * in_rs), r5 = _mm512_loadu_pd(in + 5 * in_rs);
+    const __m512d r6 = _mm512_loadu_pd(in + 6 * in_rs), r7 = _mm512_loadu_pd(in + 7 * in_rs);
+
+    // pairs of lines interleaved inside each 128 bit lane, then the lanes gathered in two steps
+    const __m512d t0 = _mm512_unpacklo_pd(r0, r1), t1 = _mm512_unpackhi_pd(r0, r1);
+    const __m512d t2 = _mm512_unpacklo_pd(r2, r3), t3 = _mm512_unpackhi_pd(r2, r3);
+    const __m512d t4 = _mm512_unpacklo_pd(r4, r5), t5 = _mm512_unpackhi_pd(r4, r5);
+    const __m512d t6 = _mm512_unpacklo_pd(r6, r7), t7 = _mm512_unpackhi_pd(r6, r7);
+
+    const __m512d u0 = _mm512_shuffle_f64x2(t0, t2, 0x88), u1 = _mm512_shuffle_f64x2(t0, t2, 0xdd);
+    const __m512d u2 = _mm512_shuffle_f64x2(t1, t3, 0x88), u3 = _mm512_shuffle_f64x2(t1, t3, 0xdd);
+    const __m512d u4 = _mm512_shuffle_f64x2(t4, t6, 0x88), u5 = _mm512_shuffle_f64x2(t4, t6, 0xdd);
+    const __m512d u6 = _mm512_shuffle_f64x2(t5, t7, 0x88), u7 = _mm512_shuffle_f64x2(t5, t7, 0xdd);
+
+    _mm512_storeu_pd(out + 0 * out_rs, _mm512_shuffle_f64x2(u0, u4, 0x88));
+    _mm512_storeu_pd(out + 1 * out_rs, _mm512_shuffle_f64x2(u2, u6, 0x88));
+    _mm512_storeu_pd(out + 2 * out_rs, _mm512_shuffle_f64x2(u1, u5, 0x88));
+    _mm512_storeu_pd(out + 3 * out_rs, _mm512_shuffle_f64x2(u3, u7, 0x88));
+    _mm512_storeu_pd(out + 4 * out_rs, _mm512_shuffle_f64x2(u0, u4, 0xdd));
+    _mm512_storeu_pd(out + 5 * out_rs, _mm512_shuffle_f64x2(u2, u6, 0xdd));
+    _mm512_storeu_pd(out + 6 * out_rs, _mm512_shuffle_f64x2(u1, u5, 0xdd));
+    _mm512_storeu_pd(out + 7 * out_rs, _mm512_shuffle_f64x2(u3, u7, 0xdd));
+}
+#elif defined(ICYM_X86_SIMD) && ICYM_ISA == ICYM_ISA_AVX2
+#define ICYM_TRANSPOSE_TILE 4
+static void ICYM_K(icym_transpose_tile)(const ICYM_T* in, ptrdiff_t in_rs, ICYM_T* out, ptrdiff_t out_rs){
+    const __m256d r0 = _mm256_loadu_pd(in + 0 * in_rs), r1 = _mm256_loadu_pd(in + 1 * in_rs);
+    const __m256d r2 = _mm256_loadu_pd(in + 2 * in_rs), r3 = _mm256_loadu_pd(in + 3 * in_rs);
+
+    const __m256d t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+    const __m256d t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+
+    _mm256_storeu_pd(out + 0 * out_rs, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(out + 1 * out_rs, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(out + 2 * out_rs, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(out + 3 * out_rs, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+#elif defined(ICYM_X86_SIMD) && ICYM_ISA == ICYM_ISA_SSE2 && ICYM_F32
+#define ICYM_TRANSPOSE_TILE 4
+static void ICYM_K(icym_transpose_tile)(const ICYM_T* in, ptrdiff_t in_rs, ICYM_T* out, ptrdiff_t out_rs){
+    __m128 r0 = _mm_loadu_ps(in + 0 * in_rs), r1 = _mm_loadu_ps(in + 1 * in_rs);
+    __m128 r2 = _mm_loadu_ps(in + 2 * in_rs), r3 = _mm_loadu_ps(in + 3 * in_rs);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(out + 0 * out_rs, r0);
+    _mm_storeu_ps(out + 1 * out_rs, r1);
+    _mm_storeu_ps(out + 2 * out_rs, r2);
+    _mm_storeu_ps(out + 3 * out_rs, r3);
+}
+#elif defined(ICYM_X86_SIMD) && ICYM_ISA == ICYM_ISA_SSE2
+#define ICYM_TRANSPOSE_TILE 2
+static void ICYM_K(icym_transpose_tile)(const ICYM_T* in, ptrdiff_t in_rs, ICYM_T* out, ptrdiff_t out_rs){
+    const __m128d r0 = _mm_loadu_pd(in), r1 = _mm_loadu_pd(in + in_rs);
+    _mm_storeu_pd(out, _mm_unpacklo_pd(r0, r1));
+    _mm_storeu_pd(out + out_rs, _mm_unpackhi_pd(r0, r1));
+}
+#else
+#define ICYM_TRANSPOSE_TILE 4
+static void ICYM_K(icym_transpose_tile)(const ICYM_T* in, ptrdiff_t in_rs, ICYM_T* out, ptrdiff_t out_rs){
+    for(int i = 0; i < 4; i+=1){
+        for(int j = 0; j < 4; j+=1) out[j * out_rs + i] = in[i * in_rs + j];
+    }
+}
+#endif
+
+static const ICYM_FN(IcymKernels) ICYM_K(icym_kernels) = {
+    ICYM_K(icym_gemm_kernel), ICYM_GEMM_NR,
+    ICYM_K(icym_transpose_tile), ICYM_TRANSPOSE_TILE,
+    ICYM_K(icym_axpy), ICYM_K(icym_axpby), ICYM_K(icym_waxpby), ICYM_K(icym_scal),
+    ICYM_K(icym_dot), ICYM_K(icym_asum), ICYM_K(icym_amax),
+    ICYM_K(icym_sqrt_batch), ICYM_K(icym_rsqrt_batch), ICYM_K(icym_sqacc), ICYM_K(icym_mul),
+    ICYM_K(icym_fit_moments), ICYM_K(icym_poly_eval), ICYM_K(icym_poly_residuals), ICYM_K(icym_weighted_moments),
+    ICYM_K(icym_newton_eval), ICYM_K(icym_barycentric_eval),
+    ICYM_K(icym_csr_rows), ICYM_K(icym_caxpy), ICYM_K(icym_cscal), ICYM_K(icym_cdot)
+};
+
+#undef ICYM_TRANSPOSE_TILE
+
+#undef ICYM_GEMM_NR
+#undef ICYM_VSTORE
+#undef ICYM_VLOAD
+#undef ICYM_V
+#undef ICYM_VL
+
+#if ICYM_ISA != ICYM_ISA_SCALAR && defined(ICYM_X86_SIMD)
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif
+
+#else // ICYM_PRECISION_PASS
+
+// X===============================================X PRECISION PASS X==================================================X
+// included by the implementation once with ICYM_T double and ICYM_FN(name) name##_d, and once with float and name##_f,
+// ICYM_F32 telling them apart for the preprocessor
+
+// the kernels of one SIMD level
+typedef struct ICYM_FN(IcymKernels){
+    void (*gemm)(size_t kc, ICYM_T alpha, const ICYM_T* a, const ICYM_T* b, ICYM_T beta, ICYM_T* c,
+        ptrdiff_t rs, ptrdiff_t cs, size_t mr, size_t nr);
+    // columns of the gemm micro kernel
+    size_t gemm_nr;
+    void (*transpose_tile)(const ICYM_T* in, ptrdiff_t in_rs, ICYM_T* out, ptrdiff_t out_rs);
+    // lines and columns of the tiles transposed in registers
+    size_t transpose_tile_size;
+    // BLAS 1 on contiguous vectors, amax returning the biggest absolute value
+    void   (*axpy)(size_t n, ICYM_T alpha, const ICYM_T* x, ICYM_T* y);
+    void   (*axpby)(size_t n, ICYM_T alpha, const ICYM_T* x, ICYM_T beta, ICYM_T* y);
+    void   (*waxpby)(size_t n, ICYM_T alpha, const ICYM_T* x, ICYM_T beta, const ICYM_T* y, ICYM_T* w);
+    void   (*scal)(size_t n, ICYM_T alpha, ICYM_T* x);
+    ICYM_T (*dot)(size_t n, const ICYM_T* x, const ICYM_T* y);
+    ICYM_T (*asum)(size_t n, const ICYM_T* x);
+    ICYM_T (*amax)(size_t n, const ICYM_T* x);
+    // element-wise square roots, sqacc adding the squares of x to acc and mul multiplying x and y
+    void   (*sqrt)(size_t n, const ICYM_T* x, ICYM_T* out);
+    void   (*rsqrt)(size_t n, const ICYM_T* x, ICYM_T* out, int fast);
+    void   (*sqacc)(size_t n, const ICYM_T* x, ICYM_T* acc);
+    void   (*mul)(size_t n, const ICYM_T* x, const ICYM_T* y, ICYM_T* out);
+    // the moments of a block of points for the fit accumulators
+    void   (*fit_moments)(size_t n, const ICYM_T* x, const ICYM_T* y, ICYM_T center, int order, ICYM_T* sums);
+    void   (*poly_eval)(size_t n, const ICYM_T* x, const ICYM_T* coefficients, int order, size_t polys, ICYM_T* out, size_t out_stride);
+    void   (*poly_residuals)(size_t n, const ICYM_T* x, const ICYM_T* y, const ICYM_T* c, int order, ICYM_T shift,
+        ICYM_T* residuals, ICYM_T* sums);
+    void   (*weighted_moments)(size_t n, const ICYM_T* x, const ICYM_T* y, const ICYM_T* dx, const ICYM_T* dy, ICYM_T slope,
+        ICYM_T xc, ICYM_T yc, ICYM_T* sums);
+    // the Newton and second barycentric forms of n nodes at count values of t
+    void   (*newton_eval)(size_t count, const ICYM_T* t, const ICYM_T* x, const ICYM_T* c, size_t n, ICYM_T* out);
+    void   (*barycentric_eval)(size_t count, const ICYM_T* t, const ICYM_T* x, const ICYM_T* y, const ICYM_T* w, size_t n,
+        ICYM_T scale, ICYM_T* out);
+    // lines [begin, end) of the sparse product y = alpha * a * x + beta * y for a CSR matrix
+    void   (*csr_rows)(size_t begin, size_t end, const size_t* offsets, const unsigned int* indices, const ICYM_T* values,
+        const ICYM_T* x, ICYM_T alpha, ICYM_T beta, ICYM_T* y);
+    // interleaved complex vectors of n complex numbers, cdot writing the real and imaginary parts of the sum to out
+    void   (*caxpy)(size_t n, ICYM_T ar, ICYM_T ai, const ICYM_T* x, ICYM_T* y);
+    void   (*cscal)(size_t n, ICYM_T ar, ICYM_T ai, const ICYM_T* x, ICYM_T* out);
+    void   (*cdot)(size_t n, const ICYM_T* x, const ICYM_T* y, int conjugate, ICYM_T* out);
+} ICYM_FN(IcymKernels);
+
+#define ICYM_KERNEL_PASS
+
+#define ICYM_ISA ICYM_ISA_SCALAR
+#define ICYM_VBYTES 0
+#define ICYM_K(name) ICYM_FN(name##_scalar)
+#include "cymath.h"
+#undef ICYM_K
+#undef ICYM_VBYTES
+#undef ICYM_ISA
+
+#if defined(ICYM_X86_SIMD) || defined(ICYM_VECTOR_SIMD)
+#define ICYM_ISA ICYM_ISA_SSE2
+#define ICYM_VBYTES 16
+#define ICYM_K(name) ICYM_FN(name##_sse2)
+#include "cymath.h"
+#undef ICYM_K
+#undef ICYM_VBYTES
+#undef ICYM_ISA
+#endif
+
+#if defined(ICYM_X86_SIMD)
+#define ICYM_ISA ICYM_ISA_AVX2
+#define ICYM_VBYTES 32
+#define ICYM_K(name) ICYM_FN(name##_avx2)
+#include "cymath.h"
+#undef ICYM_K
+#undef ICYM_VBYTES
+#undef ICYM_ISA
+
+#define ICYM_ISA ICYM_ISA_AVX512
+#define ICYM_VBYTES 64
+#define ICYM_K(name) ICYM_FN(name##_avx512)
+#include "cymath.h"
+#undef ICYM_K
+#undef ICYM_VBYTES
+#undef ICYM_ISA
+#endif
+
+#undef ICYM_KERNEL_PASS
+
+static const ICYM_FN(IcymKernels)* ICYM_FN(icym_kernels)(void){
+    switch(cym_simd_level()){
+#if defined(ICYM_X86_SIMD)
+    case CYM_SIMD_AVX512: return &ICYM_FN(icym_kernels_avx512);
+    case CYM_SIMD_AVX2:   return &ICYM_FN(icym_kernels_avx2);
+#endif
+#if defined(ICYM_X86_SIMD) || defined(ICYM_VECTOR_SIMD)
+    case CYM_SIMD_SSE2:   return &ICYM_FN(icym_kernels_sse2);
+#endif
+    default:              return &ICYM_FN(icym_kernels_scalar);
+    }
+}
+
+// X==============X BLAS 1 X=================X
+
+void ICYM_FN(cym_axpy)(size_t n, ICYM_T alpha, const ICYM_T* x, ptrdiff_t incx, ICYM_T* y, ptrdiff_t incy){
+    if(incx == 1 && incy == 1){
+        ICYM_FN(icym_kernels)()->axpy(n, alpha, x, y);
+        return;
+    }
+    for(size_t i = 0; i < n; i+=1) y[(ptrdiff_t)i * incy] += alpha * x[(ptrdiff_t)i * incx];
+}
+
+void ICYM_FN(cym_axpby)(size_t n, ICYM_T alpha, const ICYM_T* x, ptrdiff_t incx, ICYM_T beta, ICYM_T* y, ptrdiff_t incy){
+    if(incx == 1 && incy == 1){
+        ICYM_FN(icym_kernels)()->axpby(n, alpha, x, beta, y);
+        return;
+    }
+    if(beta == 0) for(size_t i = 0; i < n; i+=1) y[(ptrdiff_t)i * incy] = alpha * x[(ptrdiff_t)i * incx];
+    else          for(size_t i = 0; i < n; i+=1) y[(ptrdiff_t)i * incy] = alpha * x[(ptrdiff_t)i * incx] + beta * y[(ptrdiff_t)i * incy];
+}
+
+void ICYM_FN(cym_waxpby)(size_t n, ICYM_T alpha, const ICYM_T* x, ptrdiff_t incx, ICYM_T beta, const ICYM_T* y, ptrdiff_t incy,
+    ICYM_T* w, ptrdiff_t incw){
+    if(incx == 1 && incy == 1 && incw == 1){
+        ICYM_FN(icym_kernels)()->waxpby(n, alpha, x, beta, y, w);
+        return;
+    }
+    for(size_t i = 0; i < n; i+=1){
+        w[(ptrdiff_t)i * incw] = alpha * x[(ptrdiff_t)i * incx] + beta * y[(ptrdiff_t)i * incy];
+    }
+}
+
+void ICYM_FN(cym_scal)(size_t n, ICYM_T alpha, ICYM_T* x, ptrdiff_t incx){
+    if(incx == 1){
+        ICYM_FN(icym_kernels)()->scal(n, alpha, x);
+        return;
+    }
+    for(size_t i = 0; i < n; i+=1) x[(ptrdiff_t)i * incx] *= alpha;
+}
+
+ICYM_T ICYM_FN(cym_dot)(size_t n, const ICYM_T* x, ptrdiff_t incx, const ICYM_T* y, ptrdiff_t incy){
+    if(incx == 1 && incy == 1) return ICYM_FN(icym_kernels)()->dot(n, x, y);
+    ICYM_T sum = 0;
+    for(size_t i = 0; i < n; i+=1) sum += x[(ptrdiff_t)i * incx] * y[(ptrdiff_t)i * incy];
+    return sum;
+}
+
+ICYM_T ICYM_FN(cym_nrm2)(size_t n, const ICYM_T* x, ptrdiff_t incx){
+    const ICYM_T big   = ICYM_F32? FLT_MAX : DBL_MAX;
+    const ICYM_T small = ICYM_F32? FLT_MIN / FLT_EPSILON : DBL_MIN / DBL_EPSILON;
+
+    const ICYM_T sumsq = ICYM_FN(cym_dot)(n, x, incx, x, incx);
+    // the plain sum of squares is only off when it overflowed or its terms were rounded away by underflow
+    if(sumsq > small && sumsq <= big) return ICYM_FN(icym_sqrt)(sumsq);
+
+    const ICYM_T max = CYM_ABS(x[(ptrdiff_t)ICYM_FN(cym_iamax)(n, x, incx) * incx]);
+    if(max == 0 || !(max <= big)) return max;
+
+    const ICYM_T rmax = 1 / max;
+    ICYM_T scaled = 0;
+    for(size_t i = 0; i < n; i+=1){
+        const ICYM_T v = x[(ptrdiff_t)i * incx] * rmax;
+        scaled += v * v;
+    }
+    return max * ICYM_FN(icym_sqrt)(scaled);
+}
+
+ICYM_T ICYM_FN(cym_asum)(size_t n, const ICYM_T* x, ptrdiff_t incx){
+    if(incx == 1) return ICYM_FN(icym_kernels)()->asum(n, x);
+    ICYM_T sum = 0;
+    for(size_t i = 0; i < n; i+=1) sum += CYM_ABS(x[(ptrdiff_t)i * incx]);
+    return sum;
+}
+
+size_t ICYM_FN(cym_iamax)(size_t n, const ICYM_T* x, ptrdiff_t incx){
+    size_t best = 0;
+    ICYM_T max = -1;
+
+    if(incx != 1){
+        for(size_t i = 0; i < n; i+=1){
+            const ICYM_T v = CYM_ABS(x[(ptrdiff_t)i * incx]);
+            if(v > max){
+                max = v;
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    // finds the block holding the maximum with the SIMD kernel, then the maximum's index inside it
+    const ICYM_FN(IcymKernels)* kernels = ICYM_FN(icym_kernels)();
+    for(size_t b = 0; b < n; b += 1024){
+        const ICYM_T v = kernels->amax((n - b < 1024)? n - b : 1024, x + b);
+        if(v > max){
+            max = v;
+            best = b;
+        }
+    }
+    for(size_t i = best; i < n && i < best + 1024; i+=1){
+        if(CYM_ABS(x[i]) == max) return i;
+    }
+    return best;
+}
+
+// X==============X SQUARE ROOTS X=================X
+
+typedef struct ICYM_FN(ICymRoots){
+    const ICYM_FN(IcymKernels)* kernels;
+    const ICYM_T* x;
+    ICYM_T* out;
+    // -1 for square roots, otherwise the fast flag of the reciprocal ones
+    int fast;
+} ICYM_FN(ICymRoots);
+
+static void ICYM_FN(icym_roots_task)(size_t begin, size_t end, void* user){
+    const ICYM_FN(ICymRoots)* job = (const ICYM_FN(ICymRoots)*)user;
+    if(job->fast < 0) job->kernels->sqrt(end - begin, job->x + begin, job->out + begin);
+    else              job->kernels->rsqrt(end - begin, job->x + begin, job->out + begin, job->fast);
+}
+
+void ICYM_FN(cym_sqrt_batch)(const ICYM_T* x, size_t n, ICYM_T* out){
+    ICYM_FN(ICymRoots) job = { ICYM_FN(icym_kernels)(), x, out, -1 };
+    cym_parallel_for(0, n, CYM_BATCH_GRAIN, ICYM_FN(icym_roots_task), &job);
+}
+
+void ICYM_FN(cym_rsqrt_batch)(const ICYM_T* x, size_t n, ICYM_T* out, int fast){
+    ICYM_FN(ICymRoots) job = { ICYM_FN(icym_kernels)(), x, out, fast != 0 };
+    cym_parallel_for(0, n, CYM_BATCH_GRAIN, ICYM_FN(icym_roots_task), &job);
+}
+
+typedef struct ICYM_FN(ICymNormalize){
+    const ICYM_FN(IcymKernels)* kernels;
+    const ICYM_T* vectors;
+    size_t count;
+    size_t dim;
+    ICYM_T* output;
+    ICYM_T* norms;
+    int fast;
+    int soa;
+} ICYM_FN(ICymNormalize);
+
+// normalizes the vectors [begin, end) 256 at a time, their squared norms being summed first so the reciprocal roots
+// go through the batched kernel
+static void ICYM_FN(icym_normalize_task)(size_t begin, size_t end, void* user){
+    const ICYM_FN(ICymNormalize)* job = (const ICYM_FN(ICymNormalize)*)user;
+    const ICYM_FN(IcymKernels)* kernels = job->kernels;
+    const size_t dim = job->dim, count = job->count;
+
+    ICYM_T sumsq[256], rnorm[256];
+
+    for(size_t c0 = begin; c0 < end; c0 += 256){
+        const size_t c = (end - c0 < 256)? end - c0 : 256;
+
+        if(job->soa){
+            for(size_t i = 0; i < c; i+=1) sumsq[i] = 0;
+            for(size_t k = 0; k < dim; k+=1) kernels->sqacc(c, job->vectors + k * count + c0, sumsq);
+        } else{
+            for(size_t i = 0; i < c; i+=1){
+                const ICYM_T* v = job->vectors + (c0 + i) * dim;
+                if(dim >= 16){
+                    sumsq[i] = kernels->dot(dim, v, v);
+                } else{
+                    ICYM_T sum = 0;
+                    for(size_t k = 0; k < dim; k+=1) sum += v[k] * v[k];
+                    sumsq[i] = sum;
+                }
+            }
+        }
+
+        kernels->rsqrt(c, sumsq, rnorm, job->fast);
+        if(job->norms) kernels->sqrt(c, sumsq, job->norms + c0);
+        // zero vectors are left zero
+        for(size_t i = 0; i < c; i+=1) if(sumsq[i] == 0) rnorm[i] = 0;
+
+        if(job->soa){
+            for(size_t k = 0; k < dim; k+=1) kernels->mul(c, job->vectors + k * count + c0, rnorm, job->output + k * count + c0);
+        } else{
+            for(size_t i = 0; i < c; i+=1){
+                const ICYM_T* v = job->vectors + (c0 + i) * dim;
+                ICYM_T* out = job->output + (c0 + i) * dim;
+                if(dim >= 16) kernels->axpby(dim, rnorm[i], v, 0, out);
+                else for(size_t k = 0; k < dim; k+=1) out[k] = v[k] * rnorm[i];
+            }
+        }
+    }
+}
+
+void ICYM_FN(cym_normalize_vecs)(const ICYM_T* vectors, size_t count, size_t dim, ICYM_T* output, ICYM_T* norms, int fast){
+    ICYM_FN(ICymNormalize) job = { ICYM_FN(icym_kernels)(), vectors, count, dim, output, norms, fast, 0 };
+    const size_t grain = (dim && CYM_BATCH_GRAIN / dim > 256)? CYM_BATCH_GRAIN / dim : 256;
+    cym_parallel_for(0, count, grain, ICYM_FN(icym_normalize_task), &job);
+}
+
+void ICYM_FN(cym_normalize_vecs_soa)(const ICYM_T* vectors, size_t count, size_t dim, ICYM_T* output, ICYM_T* norms, int fast){
+    ICYM_FN(ICymNormalize) job = { ICYM_FN(icym_kernels)(), vectors, count, dim, output, norms, fast, 1 };
+    const size_t grain = (dim && CYM_BATCH_GRAIN / dim > 256)? CYM_BATCH_GRAIN / dim : 256;
+    cym_parallel_for(0, count, grain, ICYM_FN(icym_normalize_task), &job);
+}
+
+// packs the mc x kc block of a into panels of ICYM_GEMM_MR rows stored k major, padding the last panel with zeros
+static void ICYM_FN(icym_gemm_pack_a)(size_t mc, size_t kc, const ICYM_T* a, ptrdiff_t rs, ptrdiff_t cs, ICYM_T* ICYM_RESTRICT dest){
+    for(size_t i = 0; i < mc; i += ICYM_GEMM_MR){
+        const size_t mr = (mc - i < ICYM_GEMM_MR)? mc - i : ICYM_GEMM_MR;
+        const ICYM_T* panel = a + (ptrdiff_t)i * rs;
+        for(size_t p = 0; p < kc; p+=1){
+            size_t ii = 0;
+            for(; ii < mr; ii+=1) dest[ii] = panel[(ptrdiff_t)ii * rs + (ptrdiff_t)p * cs];
+            for(; ii < ICYM_GEMM_MR; ii+=1) dest[ii] = 0;
+            dest += ICYM_GEMM_MR;
+        }
+    }
+}
+
+// packs the kc x nc block of b into panels of nr columns stored k major, padding the last panel with zeros
+static void ICYM_FN(icym_gemm_pack_b)(size_t kc, size_t nc, size_t nr, const ICYM_T* b, ptrdiff_t rs, ptrdiff_t cs, ICYM_T* ICYM_RESTRICT dest){
+    for(size_t j = 0; j < nc; j += nr){
+        const size_t w = (nc - j < nr)? nc - j : nr;
+        const ICYM_T* panel = b + (ptrdiff_t)j * cs;
+        for(size_t p = 0; p < kc; p+=1){
+            const ICYM_T* row = panel + (ptrdiff_t)p * rs;
+            size_t jj = 0;
+            if(cs == 1) for(; jj < w; jj+=1) dest[jj] = row[jj];
+            else        for(; jj < w; jj+=1) dest[jj] = row[(ptrdiff_t)jj * cs];
+            for(; jj < nr; jj+=1) dest[jj] = 0;
+            dest += nr;
+        }
+    }
+}
+
+// i-k-j loops for products too small to be worth packing (and for when the packing buffers can not be allocated)
+static void ICYM_FN(icym_gemm_small)(size_t m, size_t n, size_t k, ICYM_T alpha, const ICYM_T* a, ptrdiff_t a_rs, ptrdiff_t a_cs,
+    const ICYM_T* b, ptrdiff_t b_rs, ptrdiff_t b_cs, ICYM_T beta, ICYM_T* c, ptrdiff_t c_rs, ptrdiff_t c_cs){
+
+    for(size_t i = 0; i < m; i+=1){
+        ICYM_T* ICYM_RESTRICT row = c + (ptrdiff_t)i * c_rs;
+
+        for(size_t j = 0; j < n; j+=1){
+            row[(ptrdiff_t)j * c_cs] = (beta == 0)? 0 : beta * row[(ptrdiff_t)j * c_cs];
+        }
+
+        for(size_t p = 0; p < k; p+=1){
+            const ICYM_T aip = alpha * a[(ptrdiff_t)i * a_rs + (ptrdiff_t)p * a_cs];
+            const ICYM_T* ICYM_RESTRICT brow = b + (ptrdiff_t)p * b_rs;
+            if(b_cs == 1 && c_cs == 1) for(size_t j = 0; j < n; j+=1) row[j] += aip * brow[j];
+            else for(size_t j = 0; j < n; j+=1) row[(ptrdiff_t)j * c_cs] += aip * brow[(ptrdiff_t)j * b_cs];
+        }
+    }
+}
+
+typedef struct ICYM_FN(ICymGemmBlock){
+    const ICYM_FN(IcymKernels)* kernels;
+    size_t m, mc, kc, nc;
+    ICYM_T alpha, beta;
+    const ICYM_T* a;
+    ptrdiff_t a_rs, a_cs;
+    const ICYM_T* packed_b;
+    ICYM_T* packed_a;
+    ICYM_T* c;
+    ptrdiff_t c_rs, c_cs;
+} ICYM_FN(ICymGemmBlock);
+
+// multiplies the chunk-th mc rows of a (packed in worker's buffer) by the packed block of b
+static void ICYM_FN(icym_gemm_block_task)(size_t chunk, unsigned int worker, void* user){
+    const ICYM_FN(ICymGemmBlock)* block = (const ICYM_FN(ICymGemmBlock)*)user;
+    const ICYM_FN(IcymKernels)* kernels = block->kernels;
+    const size_t nr = kernels->gemm_nr;
+    const size_t kc = block->kc, nc = block->nc;
+
+    const size_t ic = chunk * block->mc;
+    const size_t mc = (block->m - ic < block->mc)? block->m - ic : block->mc;
+    ICYM_T* packed_a = block->packed_a + (size_t)worker * block->mc * kc;
+
+    ICYM_FN(icym_gemm_pack_a)(mc, kc, block->a + (ptrdiff_t)ic * block->a_rs, block->a_rs, block->a_cs, packed_a);
+
+    for(size_t jr = 0; jr < nc; jr += nr){
+        const size_t w = (nc - jr < nr)? nc - jr : nr;
+
+        for(size_t ir = 0; ir < mc; ir += ICYM_GEMM_MR){
+            const size_t h = (mc - ir < ICYM_GEMM_MR)? mc - ir : ICYM_GEMM_MR;
+
+            kernels->gemm(kc, block->alpha, packed_a + ir * kc, block->packed_b + jr * kc, block->beta,
+                block->c + (ptrdiff_t)(ic + ir) * block->c_rs + (ptrdiff_t)jr * block->c_cs, block->c_rs, block->c_cs, h, w);
+        }
+    }
+}
+
+// the blocking of an m x n x k gemm on workers threads with panels of nr columns: blocks of mc lines of a (one per worker),
+// kc of k and nc columns of b, never bigger than the product, \returns the elements of its packing buffers
+static size_t ICYM_FN(icym_gemm_plan)(size_t m, size_t n, size_t k, unsigned int workers, size_t nr, size_t* mc, size_t* kc,
+    size_t* nc){
+
+    const size_t scale = sizeof(double) / sizeof(ICYM_T);
+    const size_t kc_max = CYM_GEMM_KC * scale;
+    size_t mc_max = (CYM_GEMM_MC * scale + ICYM_GEMM_MR - 1) / ICYM_GEMM_MR * ICYM_GEMM_MR;
+    const size_t nc_max = (CYM_GEMM_NC + nr - 1) / nr * nr;
+
+    // each worker packs its own blocks of a, which get smaller when there are fewer blocks than workers
+    if(workers > 1 && (m + mc_max - 1) / mc_max < workers){
+        mc_max = ((m + workers - 1) / workers + ICYM_GEMM_MR - 1) / ICYM_GEMM_MR * ICYM_GEMM_MR;
+    }
+    const size_t m_up = (m + ICYM_GEMM_MR - 1) / ICYM_GEMM_MR * ICYM_GEMM_MR;
+    const size_t n_up = (n + nr - 1) / nr * nr;
+    *mc = (m_up < mc_max)? m_up : mc_max;
+    *kc = (k < kc_max)? k : kc_max;
+    *nc = (n_up < nc_max)? n_up : nc_max;
+    return workers * *mc * *kc + *kc * *nc;
+}
+
+// \returns how many workers an m x n x k gemm splits its lines over
+static unsigned int ICYM_FN(icym_gemm_workers)(size_t m, size_t n, size_t k){
+    if((double)m * n * k < CYM_GEMM_PARALLEL) return 1;
+    return icym_parallel_workers((m + ICYM_GEMM_MR - 1) / ICYM_GEMM_MR);
+}
+
+size_t ICYM_FN(cym_gemm_workspace_size)(size_t m, size_t n, size_t k){
+    if((double)m * n * k < CYM_GEMM_SMALL) return 0;
+
+    // for every thread and the widest panels of any SIMD level (two AVX-512 vectors)
+    unsigned int workers = 1;
+    if((double)m * n * k >= CYM_GEMM_PARALLEL){
+        const size_t panels = (m + ICYM_GEMM_MR - 1) / ICYM_GEMM_MR;
+        workers = cym_get_num_threads();
+        if(panels < workers) workers = (unsigned int)panels;
+    }
+    size_t mc, kc, nc;
+    const size_t elements = ICYM_FN(icym_gemm_plan)(m, n, k, workers, 128 / sizeof(ICYM_T), &mc, &kc, &nc);
+    return ICYM_WORKSPACE_ALIGN + icym_workspace_bytes(elements * sizeof(ICYM_T));
+}
+
+void ICYM_FN(cym_gemm_ws)(size_t m, size_t n, size_t k, ICYM_T alpha, const ICYM_T* a, ptrdiff_t a_rs, ptrdiff_t a_cs,
+    const ICYM_T* b, ptrdiff_t b_rs, ptrdiff_t b_cs, ICYM_T beta, ICYM_T* c, ptrdiff_t c_rs, ptrdiff_t c_cs,
+    void* workspace, size_t workspace_size){
+
+    if(m == 0 || n == 0) return;
+
+    if(k == 0 || alpha == 0){
+        ICYM_FN(icym_gemm_small)(m, n, 0, alpha, a, a_rs, a_cs, b, b_rs, b_cs, beta, c, c_rs, c_cs);
+        return;
+    }
+
+    const ICYM_FN(IcymKernels)* kernels = ICYM_FN(icym_kernels)();
+    const size_t nr = kernels->gemm_nr;
+
+    // as many workers as the workspace has room for
+    ICYM_T* buffer = NULL;
+    size_t mc_max = 0, kc_max = 0, nc_max = 0;
+    unsigned int workers = ICYM_FN(icym_gemm_workers)(m, n, k);
+    if((double)m * n * k >= CYM_GEMM_SMALL){
+        ICymWorkspace ws = icym_workspace(workspace, workspace_size);
+        for(;;){
+            const size_t elements = ICYM_FN(icym_gemm_plan)(m, n, k, workers, nr, &mc_max, &kc_max, &nc_max);
+            buffer = (ICYM_T*)icym_workspace_take(&ws, elements * sizeof(ICYM_T));
+            if(buffer || workers == 1) break;
+            workers -= 1;
+        }
+    }
+    if(!buffer){
+        ICYM_FN(icym_gemm_small)(m, n, k, alpha, a, a_rs, a_cs, b, b_rs, b_cs, beta, c, c_rs, c_cs);
+        return;
+    }
+
+    ICYM_FN(ICymGemmBlock) block;
+    block.kernels  = kernels;
+    block.m        = m;
+    block.mc       = mc_max;
+    block.alpha    = alpha;
+    block.a_rs     = a_rs;
+    block.a_cs     = a_cs;
+    block.packed_b = buffer;
+    block.packed_a = buffer + kc_max * nc_max;
+    block.c_rs     = c_rs;
+    block.c_cs     = c_cs;
+
+    for(size_t jc = 0; jc < n; jc += nc_max){
+        block.nc = (n - jc < nc_max)? n - jc : nc_max;
+
+        for(size_t pc = 0; pc < k; pc += kc_max){
+            block.kc = (k - pc < kc_max)? k - pc : kc_max;
+            // the first block of k overwrites (or scales) c, the others accumulate on it
+            block.beta = (pc == 0)? beta : 1;
+            block.a    = a + (ptrdiff_t)pc * a_cs;
+            block.c    = c + (ptrdiff_t)jc * c_cs;
+
+            ICYM_FN(icym_gemm_pack_b)(block.kc, block.nc, nr, b + (ptrdiff_t)pc * b_rs + (ptrdiff_t)jc * b_cs, b_rs, b_cs, buffer);
+
+            const size_t chunks = (m + mc_max - 1) / mc_max;
+            if(workers > 1) icym_parallel_run(chunks, ICYM_FN(icym_gemm_block_task), &block);
+            else for(size_t chunk = 0; chunk < chunks; chunk+=1) ICYM_FN(icym_gemm_block_task)(chunk, 0, &block);
+        }
+    }
+}
+
+void ICYM_FN(cym_gemm)(size_t m, size_t n, size_t k, ICYM_T alpha, const ICYM_T* a, ptrdiff_t a_rs, ptrdiff_t a_cs,
+    const ICYM_T* b, ptrdiff_t b_rs, ptrdiff_t b_cs, ICYM_T beta, ICYM_T* c, ptrdiff_t c_rs, ptrdiff_t c_cs){
+
+    // the packing buffers of this call only, the gemm_small fallback when they can not be allocated
+    void* buffer = NULL;
+    size_t size = 0;
+    if(m && n && k && alpha != 0 && (double)m * n * k >= CYM_GEMM_SMALL){
+        size_t mc, kc, nc;
+        const size_t nr = ICYM_FN(icym_kernels)()->gemm_nr;
+        const size_t elements = ICYM_FN(icym_gemm_plan)(m, n, k, ICYM_FN(icym_gemm_workers)(m, n, k), nr, &mc, &kc, &nc);
+        size = ICYM_WORKSPACE_ALIGN + icym_workspace_bytes(elements * sizeof(ICYM_T));
+        buffer = malloc(size);
+    }
+    ICYM_FN(cym_gemm_ws)(m, n, k, alpha, a, a_rs, a_cs, b, b_rs, b_cs, beta, c, c_rs, c_cs, buffer, buffer? size : 0);
+    free(buffer);
+}
+
+// cym_gemm with its packing buffers taken from ws, or allocated when ws is NULL
+static void ICYM_FN(icym_gemm_in)(size_t m, size_t n, size_t k, ICYM_T alpha, const ICYM_T* a, ptrdiff_t a_rs, ptrdiff_t a_cs,
+    const ICYM_T* b, ptrdiff_t b_rs, ptrdiff_t b_cs, ICYM_T beta, ICYM_T* c, ptrdiff_t c_rs, ptrdiff_t c_cs,
+    const ICymWorkspace* ws){
+
+    if(ws) ICYM_FN(cym_gemm_ws)(m, n, k, alpha, a, a_rs, a_cs, b, b_rs, b_cs, beta, c, c_rs, c_cs, ws->next, ws->left);
+    else   ICYM_FN(cym_gemm)(m, n, k, alpha, a, a_rs, a_cs, b, b_rs, b_cs, beta, c, c_rs, c_cs);
+}
+
+// \returns the bytes of workspace icym_syrk needs for its products
+static size_t ICYM_FN(icym_syrk_workspace_size)(size_t n, size_t k){
+    return ICYM_FN(cym_gemm_workspace_size)((n < CYM_SYRK_BLOCK)? n : CYM_SYRK_BLOCK, n, k);
+}
+
+// c = a^T * a for the k x n matrix a, the gemm computing the blocks of lines on and above the diagonal which are then mirrored,
+// with its packing buffers taken from ws (allocated when it is NULL)
+static void ICYM_FN(icym_syrk)(size_t n, size_t k, const ICYM_T* a, ptrdiff_t a_rs, ptrdiff_t a_cs, ICYM_T* c, ptrdiff_t c_rs,
+    const ICymWorkspace* ws){
+
+    for(size_t i0 = 0; i0 < n; i0 += CYM_SYRK_BLOCK){
+        const size_t ib = (n - i0 < CYM_SYRK_BLOCK)? n - i0 : CYM_SYRK_BLOCK;
+        const ICYM_T* columns = a + (ptrdiff_t)i0 * a_cs;
+        ICYM_FN(icym_gemm_in)(ib, n - i0, k, 1, columns, a_cs, a_rs, columns, a_rs, a_cs, 0, c + (ptrdiff_t)i0 * c_rs + i0, c_rs, 1,
+            ws);
+    }
+    for(size_t i = 1; i < n; i+=1){
+        for(size_t j = 0; j < i; j+=1) c[(ptrdiff_t)i * c_rs + j] = c[(ptrdiff_t)j * c_rs + i];
+    }
+}
+
+
+// X==============X TRANSPOSE X=================X
+
+// out = in^T for a rows x cols in, halving the longest side until the blocks fit in L1 (cache oblivious), which are then
+// transposed tile by tile in registers
+static void ICYM_FN(icym_transpose_rec)(const ICYM_FN(IcymKernels)* kernels, size_t rows, size_t cols,
+    const ICYM_T* ICYM_RESTRICT in, ptrdiff_t in_rs, ICYM_T* ICYM_RESTRICT out, ptrdiff_t out_rs){
+
+    if(rows > CYM_TRANSPOSE_BLOCK || cols > CYM_TRANSPOSE_BLOCK){
+        // splits on multiples of the block so the tiles stay aligned to the matrix
+        if(rows >= cols){
+            const size_t half = (rows / 2 + CYM_TRANSPOSE_BLOCK - 1) / CYM_TRANSPOSE_BLOCK * CYM_TRANSPOSE_BLOCK;
+            ICYM_FN(icym_transpose_rec)(kernels, half, cols, in, in_rs, out, out_rs);
+            ICYM_FN(icym_transpose_rec)(kernels, rows - half, cols, in + (ptrdiff_t)half * in_rs, in_rs, out + half, out_rs);
+        } else{
+            const size_t half = (cols / 2 + CYM_TRANSPOSE_BLOCK - 1) / CYM_TRANSPOSE_BLOCK * CYM_TRANSPOSE_BLOCK;
+            ICYM_FN(icym_transpose_rec)(kernels, rows, half, in, in_rs, out, out_rs);
+            ICYM_FN(icym_transpose_rec)(kernels, rows, cols - half, in + half, in_rs, out + (ptrdiff_t)half * out_rs, out_rs);
+        }
+        return;
+    }
+
+    const size_t tile = kernels->transpose_tile_size;
+
+    // full blocks are transposed into a buffer in L1 and then copied out line by line, storing straight to the strided
+    // output makes the stores alias the loads (same offset modulo 4096) and stall them
+    if(rows == CYM_TRANSPOSE_BLOCK && cols == CYM_TRANSPOSE_BLOCK && CYM_TRANSPOSE_BLOCK % tile == 0){
+        ICYM_T buffer[CYM_TRANSPOSE_BLOCK * CYM_TRANSPOSE_BLOCK];
+        for(size_t i = 0; i < CYM_TRANSPOSE_BLOCK; i += tile){
+            for(size_t j = 0; j < CYM_TRANSPOSE_BLOCK; j += tile){
+                kernels->transpose_tile(in + (ptrdiff_t)i * in_rs + j, in_rs, buffer + j * CYM_TRANSPOSE_BLOCK + i, CYM_TRANSPOSE_BLOCK);
+            }
+        }
+        for(size_t j = 0; j < CYM_TRANSPOSE_BLOCK; j+=1){
+            ICYM_T* ICYM_RESTRICT line = out + (ptrdiff_t)j * out_rs;
+            for(size_t i = 0; i < CYM_TRANSPOSE_BLOCK; i+=1) line[i] = buffer[j * CYM_TRANSPOSE_BLOCK + i];
+        }
+        return;
+    }
+
+    size_t i = 0;
+    for(; i + tile <= rows; i += tile){
+        size_t j = 0;
+        for(; j + tile <= cols; j += tile){
+            kernels->transpose_tile(in + (ptrdiff_t)i * in_rs + j, in_rs, out + (ptrdiff_t)j * out_rs + i, out_rs);
+        }
+        for(; j < cols; j+=1){
+            for(size_t ii = i; ii < i + tile; ii+=1) out[(ptrdiff_t)j * out_rs + ii] = in[(ptrdiff_t)ii * in_rs + j];
+        }
+    }
+    for(; i < rows; i+=1){
+        for(size_t j = 0; j < cols; j+=1) out[(ptrdiff_t)j * out_rs + i] = in[(ptrdiff_t)i * in_rs + j];
+    }
+}
+
+typedef struct ICYM_FN(ICymTranspose){
+    const ICYM_FN(IcymKernels)* kernels;
+    size_t rows, cols;
+    const ICYM_T* in;
+    ICYM_T* out;
+} ICYM_FN(ICymTranspose);
+
+// transposes the columns [begin, end) of the input, so each stripe writes whole lines of the output
+static void ICYM_FN(icym_transpose_stripe)(size_t begin, size_t end, void* user){
+    const ICYM_FN(ICymTranspose)* t = (const ICYM_FN(ICymTranspose)*)user;
+    ICYM_FN(icym_transpose_rec)(t->kernels, t->rows, end - begin, t->in + begin, t->cols, t->out + begin * t->rows, t->rows);
+}
+
+void ICYM_FN(cym_mat_transpose)(const ICYM_T* input, unsigned int sizex, unsigned int sizey, ICYM_T* output){
+    if(input == output){
+        ICYM_FN(cym_mat_transpose_inplace)(output, sizex, sizey);
+        return;
+    }
+
+    ICYM_FN(ICymTranspose) t = { ICYM_FN(icym_kernels)(), sizey, sizex, input, output };
+
+    if((size_t)sizex * sizey >= CYM_TRANSPOSE_PARALLEL){
+        cym_parallel_for(0, sizex, CYM_TRANSPOSE_BLOCK, ICYM_FN(icym_transpose_stripe), &t);
+    } else{
+        ICYM_FN(icym_transpose_stripe)(0, sizex, &t);
+    }
+}
+
+typedef struct ICYM_FN(ICymTransposeSquare){
+    const ICYM_FN(IcymKernels)* kernels;
+    size_t size;
+    ICYM_T* mat;
+} ICYM_FN(ICymTransposeSquare);
+
+// swaps each block of the block line with its mirror over the diagonal, both transposed, through a block sized buffer
+static void ICYM_FN(icym_transpose_square_blocks)(size_t begin, size_t end, void* user){
+    const ICYM_FN(ICymTransposeSquare)* t = (const ICYM_FN(ICymTransposeSquare)*)user;
+    const size_t n = t->size;
+    ICYM_T buffer[CYM_TRANSPOSE_BLOCK * CYM_TRANSPOSE_BLOCK];
+
+    for(size_t bi = begin; bi < end; bi+=1){
+        const size_t i0 = bi * CYM_TRANSPOSE_BLOCK;
+        const size_t h  = (n - i0 < CYM_TRANSPOSE_BLOCK)? n - i0 : CYM_TRANSPOSE_BLOCK;
+
+        for(size_t j0 = i0; j0 < n; j0 += CYM_TRANSPOSE_BLOCK){
+            const size_t w = (n - j0 < CYM_TRANSPOSE_BLOCK)? n - j0 : CYM_TRANSPOSE_BLOCK;
+            ICYM_T* upper = t->mat + i0 * n + j0;
+            ICYM_T* lower = t->mat + j0 * n + i0;
+
+            // buffer = lower^T (h x w), lower = upper^T, upper = buffer
+            ICYM_FN(icym_transpose_rec)(t->kernels, w, h, lower, n, buffer, w);
+            if(j0 != i0) ICYM_FN(icym_transpose_rec)(t->kernels, h, w, upper, n, lower, n);
+            for(size_t i = 0; i < h; i+=1){
+                for(size_t j = 0; j < w; j+=1) upper[i * n + j] = buffer[i * w + j];
+            }
+        }
+    }
+}
+
+int ICYM_FN(cym_mat_transpose_inplace)(ICYM_T* mat, unsigned int sizex, unsigned int sizey){
+    if(sizex == sizey){
+        ICYM_FN(ICymTransposeSquare) t = { ICYM_FN(icym_kernels)(), sizex, mat };
+        const size_t blocks = (sizex + CYM_TRANSPOSE_BLOCK - 1) / CYM_TRANSPOSE_BLOCK;
+        if((size_t)sizex * sizey >= CYM_TRANSPOSE_PARALLEL){
+            cym_parallel_for(0, blocks, 1, ICYM_FN(icym_transpose_square_blocks), &t);
+        } else{
+            ICYM_FN(icym_transpose_square_blocks)(0, blocks, &t);
+        }
+        return 0;
+    }
+
+    const size_t rows = sizey, cols = sizex, count = rows * cols;
+    if(rows <= 1 || cols <= 1) return 0;
+
+    // the element at k (line k / cols, column k % cols) moves to (k % cols) * rows + k / cols, the permutation is followed
+    // one cycle at a time marking the visited elements, the first and last elements never move
+    uint64_t* visited = (uint64_t*)calloc((count + 63) / 64, sizeof(uint64_t));
+    if(!visited) return 1;
+
+    for(size_t start = 1; start + 1 < count; start+=1){
+        if(visited[start / 64] >> (start % 64) & 1) continue;
+
+        size_t k = start;
+        ICYM_T value = mat[k];
+        do{
+            const size_t next = (k % cols) * rows + k / cols;
+            const ICYM_T t = mat[next];
+            mat[next] = value;
+            value = t;
+            visited[next / 64] |= (uint64_t)1 << (next % 64);
+            k = next;
+        } while(k != start);
+    }
+
+    free(visited);
+    return 0;
+}
+
+// X==============X LU X=================X
+
+// solves l * x = b in place for the n x count matrix b, l being unit lower triangular, blocked so most of the work
+// goes through the gemm
+static void ICYM_FN(icym_trsm_lower_unit)(size_t n, size_t count, const ICYM_T* l, ptrdiff_t l_rs, ICYM_T* b, ptrdiff_t b_rs){
+    const ICYM_FN(IcymKernels)* kernels = ICYM_FN(icym_kernels)();
+
+    for(size_t i0 = 0; i0 < n; i0 += CYM_LU_BLOCK){
+        const size_t i1 = (n - i0 < CYM_LU_BLOCK)? n : i0 + CYM_LU_BLOCK;
+
+        for(size_t i = i0 + 1; i < i1; i+=1){
+            ICYM_T* row = b + (ptrdiff_t)i * b_rs;
+            for(size_t p = i0; p < i; p+=1){
+                const ICYM_T lip = l[(ptrdiff_t)i * l_rs + p];
+                if(lip != 0) kernels->axpy(count, -lip, b + (ptrdiff_t)p * b_rs, row);
+            }
+        }
+        if(i1 < n){
+            ICYM_FN(cym_gemm)(n - i1, count, i1 - i0, -1, l + (ptrdiff_t)i1 * l_rs + i0, l_rs, 1,
+                b + (ptrdiff_t)i0 * b_rs, b_rs, 1, 1, b + (ptrdiff_t)i1 * b_rs, b_rs, 1);
+        }
+    }
+}
+
+// solves u * x = b in place for the n x count matrix b, u being upper triangular, the gemm taking its packing buffers
+// from ws (allocated when it is NULL)
+static void ICYM_FN(icym_trsm_upper)(size_t n, size_t count, const ICYM_T* u, ptrdiff_t u_rs, ICYM_T* b, ptrdiff_t b_rs,
+    const ICymWorkspace* ws){
+    const ICYM_FN(IcymKernels)* kernels = ICYM_FN(icym_kernels)();
+
+    for(size_t i1 = n; i1 > 0;){
+        const size_t i0 = (i1 < CYM_LU_BLOCK)? 0 : i1 - CYM_LU_BLOCK;
+
+        for(size_t i = i1; i > i0; i-=1){
+            ICYM_T* row = b + (ptrdiff_t)(i - 1) * b_rs;
+            for(size_t p = i; p < i1; p+=1){
+                const ICYM_T uip = u[(ptrdiff_t)(i - 1) * u_rs + p];
+                if(uip != 0) kernels->axpy(count, -uip, b + (ptrdiff_t)p * b_rs, row);
+            }
+            kernels->scal(count, 1 / u[(ptrdiff_t)(i - 1) * u_rs + (i - 1)], row);
+        }
+        if(i0 > 0){
+            ICYM_FN(icym_gemm_in)(i0, count, i1 - i0, -1, u + i0, u_rs, 1,
+                b + (ptrdiff_t)i0 * b_rs, b_rs, 1, 1, b, b_rs, 1, ws);
+        }
+        i1 = i0;
+    }
+}
+
+// factors the rows x nb panel p (line stride rs) with partial pivoting, swapping only the lines of the panel, and writes the
+// swapped line of each step to pivots (relative to the panel)
+// \returns 0 on success, or 1 + the first column without a non zero pivot
+static int ICYM_FN(icym_lu_panel_unblocked)(size_t rows, size_t nb, ICYM_T* p, ptrdiff_t rs, unsigned int* pivots){
+    const ICYM_FN(IcymKernels)* kernels = ICYM_FN(icym_kernels)();
+    int info = 0;
+
+    // the pivot search of each column is fused with the update of the previous one
+    size_t pivot = 0;
+    ICYM_T max = -1;
+    for(size_t i = 0; i < rows; i+=1){
+        const ICYM_T v = CYM_ABS(p[(ptrdiff_t)i * rs]);
+        if(v > max){
+            max = v;
+            pivot = i;
+        }
+    }
+
+    for(size_t k = 0; k < nb && k < rows; k+=1){
+        pivots[k] = (unsigned int)pivot;
+
+        ICYM_T* ICYM_RESTRICT rk = p + (ptrdiff_t)k * rs;
+        if(pivot != k){
+            ICYM_T* ICYM_RESTRICT rp = p + (ptrdiff_t)pivot * rs;
+            for(size_t j = 0; j < nb; j+=1){
+                const ICYM_T t = rk[j];
+                rk[j] = rp[j];
+                rp[j] = t;
+            }
+        }
+
+        const ICYM_T rpivot = (max == 0)? 0 : 1 / rk[k];
+        if(max == 0 && !info) info = (int)k + 1;
+
+        max = -1;
+        pivot = k + 1;
+        for(size_t i = k + 1; i < rows; i+=1){
+            ICYM_T* ICYM_RESTRICT ri = p + (ptrdiff_t)i * rs;
+            const ICYM_T l = ri[k] * rpivot;
+            ri[k] = l;
+            if(l != 0) kernels->axpy(nb - k - 1, -l, rk + k + 1, ri + k + 1);
+            if(k + 1 < nb){
+                const ICYM_T v = CYM_ABS(ri[k + 1]);
+                if(v > max){
+                    max = v;
+                    pivot = i;
+                }
+            }
+        }
+    }
+
+    return info;
+}
+
+// swaps the lines k and pivots[k] of the cols wide block p for k in [0, count)
+static void ICYM_FN(icym_lu_swap_lines)(size_t count, const unsigned int* pivots, size_t cols, ICYM_T* p, ptrdiff_t rs){
+    for(size_t k = 0; k < count; k+=1){
+        if(pivots[k] == k) continue;
+        ICYM_T* ICYM_RESTRICT rk = p + (ptrdiff_t)k * rs;
+        ICYM_T* ICYM_RESTRICT rp = p + (ptrdiff_t)pivots[k] * rs;
+        for(size_t j = 0; j < cols; j+=1){
+            const ICYM_T t = rk[j];
+            rk[j] = rp[j];
+            rp[j] = t;
+        }
+    }
+}
+
+// same as icym_lu_panel_unblocked, splitting the columns in halves recursively so most of the work goes through the gemm,
+// which packs in ws
+static int ICYM_FN(icym_lu_panel)(size_t rows, size_t nb, ICYM_T* p, ptrdiff_t rs, unsigned int* pivots, ICymWorkspace ws){
+    if(nb <= 8 || rows <= nb) return ICYM_FN(icym_lu_panel_unblocked)(rows, nb, p, rs, pivots);
+
+    const size_t n1 = nb / 2, n2 = nb - n1;
+
+    int info = ICYM_FN(icym_lu_panel)(rows, n1, p, rs, pivots, ws);
+    ICYM_FN(icym_lu_swap_lines)(n1, pivots, n2, p + n1, rs);
+
+    // a12 = l11^-1 * a12, a22 -= l21 * a12, then the bottom right part
+    ICYM_FN(icym_trsm_lower_unit)(n1, n2, p, rs, p + n1, rs);
+    ICYM_FN(cym_gemm_ws)(rows - n1, n2, n1, -1, p + (ptrdiff_t)n1 * rs, rs, 1, p + n1, rs, 1, 1, p + (ptrdiff_t)n1 * rs + n1, rs, 1,
+        ws.next, ws.left);
+
+    const int info2 = ICYM_FN(icym_lu_panel)(rows - n1, n2, p + (ptrdiff_t)n1 * rs + n1, rs, pivots + n1, ws);
+    if(info2 && !info) info = (int)n1 + info2;
+
+    // the swaps of the bottom part are relative to its first line
+    ICYM_FN(icym_lu_swap_lines)(n2, pivots + n1, n1, p + (ptrdiff_t)n1 * rs, rs);
+    for(size_t k = n1; k < nb; k+=1) pivots[k] += (unsigned int)n1;
+
+    return info;
+}
+
+size_t ICYM_FN(cym_lu_factor_workspace_size)(unsigned int size){
+    const size_t n = size;
+    const size_t nb = (n < CYM_LU_BLOCK)? n : CYM_LU_BLOCK;
+    // the panel then the gemm of the panels and of the trailing updates, which are never bigger than n x n x nb
+    return ICYM_WORKSPACE_ALIGN + icym_workspace_bytes(n * nb * sizeof(ICYM_T)) + ICYM_FN(cym_gemm_workspace_size)(n, n, nb);
+}
+
+int ICYM_FN(cym_lu_factor_ws)(ICYM_T* a, unsigned int size, unsigned int* pivots, void* workspace, size_t workspace_size){
+    const size_t n = size;
+    int info = 0;
+
+    // the panels are factored in a contiguous copy, so walking down their columns does not touch a page per line,
+    // in place when the workspace does not hold it
+    ICymWorkspace ws = icym_workspace(workspace, workspace_size);
+    ICYM_T* panel = (ICYM_T*)icym_workspace_take(&ws, n * ((n < CYM_LU_BLOCK)? n : CYM_LU_BLOCK) * sizeof(ICYM_T));
+
+    for(size_t k0 = 0; k0 < n; k0 += CYM_LU_BLOCK){
+        const size_t k1 = (n - k0 < CYM_LU_BLOCK)? n : k0 + CYM_LU_BLOCK;
+        const size_t nb = k1 - k0, rows = n - k0;
+
+        int panel_info;
+        if(panel){
+            for(size_t i = 0; i < rows; i+=1){
+                for(size_t j = 0; j < nb; j+=1) panel[i * nb + j] = a[(k0 + i) * n + k0 + j];
+            }
+            panel_info = ICYM_FN(icym_lu_panel)(rows, nb, panel, nb, pivots + k0, ws);
+            for(size_t i = 0; i < rows; i+=1){
+                for(size_t j = 0; j < nb; j+=1) a[(k0 + i) * n + k0 + j] = panel[i * nb + j];
+            }
+        } else{
+            panel_info = ICYM_FN(icym_lu_panel)(rows, nb, a + k0 * n + k0, n, pivots + k0, ws);
+        }
+        if(panel_info && !info) info = (int)k0 + panel_info;
+
+        // applies the panel's swaps to the columns at its left and right
+        for(size_t k = k0; k < k1; k+=1){
+            pivots[k] += (unsigned int)k0;
+            if(pivots[k] == k) continue;
+            ICYM_T* ICYM_RESTRICT rk = a + k * n;
+            ICYM_T* ICYM_RESTRICT rp = a + (size_t)pivots[k] * n;
+            for(size_t j = 0; j < k0; j+=1){
+                const ICYM_T t = rk[j];
+                rk[j] = rp[j];
+                rp[j] = t;
+            }
+            for(size_t j = k1; j < n; j+=1){
+                const ICYM_T t = rk[j];
+                rk[j] = rp[j];
+                rp[j] = t;
+            }
+        }
+
+        if(k1 < n){
+            // u12 = l11^-1 * a12, then a22 -= l21 * u12
+            ICYM_FN(icym_trsm_lower_unit)(nb, n - k1, a + k0 * n + k0, n, a + k0 * n + k1, n);
+            ICYM_FN(cym_gemm_ws)(n - k1, n - k1, nb, -1, a + k1 * n + k0, n, 1,
+                a + k0 * n + k1, n, 1, 1, a + k1 * n + k1, n, 1, ws.next, ws.left);
+        }
+    }
+
+    return info;
+}
+
+int ICYM_FN(cym_lu_factor)(ICYM_T* a, unsigned int size, unsigned int* pivots){
+    uint8_t stack[ICYM_STACK_WORKSPACE];
+    const size_t workspace_size = ICYM_FN(cym_lu_factor_workspace_size)(size);
+    void* workspace = icym_workspace_alloc(workspace_size, stack);
+    const int info = ICYM_FN(cym_lu_factor_ws)(a, size, pivots, workspace, workspace? workspace_size : 0);
+    icym_workspace_free(workspace, stack);
+    return info;
+}
+
+void ICYM_FN(cym_lu_solve_many)(const ICYM_T* lu, const unsigned int* pivots, unsigned int size, const ICYM_T* y, unsigned int count, ICYM_T* x){
+    const size_t n = size;
+
+    if(x != y) for(size_t i = 0; i < n * count; i+=1) x[i] = y[i];
+
+    for(size_t k = 0; k < n; k+=1){
+        if(pivots[k] == k) continue;
+        ICYM_T* ICYM_RESTRICT rk = x + k * count;
+        ICYM_T* ICYM_RESTRICT rp = x + (size_t)pivots[k] * count;
+        for(size_t j = 0; j < count; j+=1){
+            const ICYM_T t = rk[j];
+            rk[j] = rp[j];
+            rp[j] = t;
+        }
+    }
+
+    ICYM_FN(icym_trsm_lower_unit)(n, count, lu, n, x, count);
+    ICYM_FN(icym_trsm_upper)(n, count, lu, n, x, count, NULL);
+}
+
+void ICYM_FN(cym_lu_solve)(const ICYM_T* lu, const unsigned int* pivots, unsigned int size, const ICYM_T* y, ICYM_T* x){
+    const size_t n = size;
+
+    if(x != y) for(size_t i = 0; i < n; i+=1) x[i] = y[i];
+
+    for(size_t k = 0; k < n; k+=1){
+        const ICYM_T t = x[k];
+        x[k] = x[pivots[k]];
+        x[pivots[k]] = t;
+    }
+
+    // with a single right hand side the substitutions are dot products along the lines of lu
+    const ICYM_FN(IcymKernels)* kernels = ICYM_FN(icym_kernels)();
+    for(size_t i = 1; i < n; i+=1){
+        x[i] -= kernels->dot(i, lu + i * n, x);
+    }
+    for(size_t i = n; i > 0; i-=1){
+        const ICYM_T* row = lu + (i - 1) * n;
+        x[i - 1] = (x[i - 1] - kernels->dot(n - i, row + i, x + i)) / row[i - 1];
+    }
+}
+
+ICYM_T ICYM_FN(cym_lu_determinant)(const ICYM_T* lu, const unsigned int* pivots, unsigned int size){
+    ICYM_T det = 1;
+    for(size_t i = 0; i < size; i+=1){
+        det *= lu[i * size + i];
+        if(pivots[i] != i) det = -det;
+    }
+    return det;
+}
+
+void ICYM_FN(cym_lu_inverse)(const ICYM_T* lu, const unsigned int* pivots, unsigned int size, ICYM_T* output){
+    for(size_t i = 0; i < (size_t)size * size; i+=1) output[i] = 0;
+    for(size_t i = 0; i < size; i+=1) output[i * size + i] = 1;
+    ICYM_FN(cym_lu_solve_many)(lu, pivots, size, output, size, output);
+}
+
+
+// X==============X LEAST SQUARES X=================X
+
+// turns the column x (n values, line stride rs) into the Householder reflector H = I - tau * v * v^T with H * x = (beta, 0, ...),
+// writing beta to x[0] and v (without its leading 1) to the rest of x
+static void ICYM_FN(icym_householder)(size_t n, ICYM_T* x, ptrdiff_t rs, ICYM_T* tau){
+    const ICYM_T alpha = x[0];
+    const ICYM_T xnorm = (n > 1)? ICYM_FN(cym_nrm2)(n - 1, x + rs, rs) : 0;
+    if(xnorm == 0){
+        *tau = 0;
+        return;
+    }
+
+    // the norm of (alpha, xnorm) without overflowing
+    const ICYM_T big = (CYM_ABS(alpha) > xnorm)? CYM_ABS(alpha) : xnorm;
+    const ICYM_T ra  = alpha / big;
+    const ICYM_T rx  = xnorm / big;
+    ICYM_T beta = big * ICYM_FN(icym_sqrt)(ra * ra + rx * rx);
+    if(alpha > 0) beta = -beta;
+
+    *tau = (beta - alpha) / beta;
+    ICYM_FN(cym_scal)(n - 1, 1 / (alpha - beta), x + rs, rs);
+    x[0] = beta;
+}
+
+// factors the first k columns of the rows x width matrix a (line stride rs, k <= rows) and applies their reflectors to
+// the other columns, w being width values of scratch
+static void ICYM_FN(icym_qr_unblocked)(size_t rows, size_t width, size_t k, ICYM_T* a, ptrdiff_t rs, ICYM_T* tau, ICYM_T* w){
+    const ICYM_FN(IcymKernels)* kernels = ICYM_FN(icym_kernels)();
+
+    for(size_t j = 0; j < k; j+=1){
+        ICYM_T* aj = a + (ptrdiff_t)j * rs + j;
+        ICYM_FN(icym_householder)(rows - j, aj, rs, tau + j);
+        const size_t n = width - j - 1;
+        if(tau[j] == 0 || n == 0) continue;
+
+        // w = v^T * a, then a -= tau * v * w, both line by line
+        for(size_t c = 0; c < n; c+=1) w[c] = aj[1 + c];
+        for(size_t i = 1; i < rows - j; i+=1){
+            const ICYM_T v = aj[(ptrdiff_t)i * rs];
+            if(v != 0) kernels->axpy(n, v, aj + (ptrdiff_t)i * rs + 1, w);
+        }
+        kernels->axpy(n, -tau[j], w, aj + 1);
+        for(size_t i = 1; i < rows - j; i+=1){
+            const ICYM_T v = aj[(ptrdiff_t)i * rs];
+            if(v != 0) kernels->axpy(n, -tau[j] * v, w, aj + (ptrdiff_t)i * rs + 1);
+        }
+    }
+}
+
+// the scratch of icym_qr_ws, in elements
+static size_t ICYM_FN(icym_qr_scratch)(size_t rows, size_t width, size_t k){
+    const size_t nb = CYM_QR_BLOCK;
+    return width + ((k > nb && rows > nb)? rows * nb + nb * nb + 2 * nb * width : 0);
+}
+
+// \returns the bytes of workspace icym_qr_ws needs
+static size_t ICYM_FN(icym_qr_workspace_size)(size_t rows, size_t width, size_t k){
+    const size_t nb = CYM_QR_BLOCK;
+    const size_t scratch = ICYM_WORKSPACE_ALIGN + icym_workspace_bytes(ICYM_FN(icym_qr_scratch)(rows, width, k) * sizeof(ICYM_T));
+    // the products of the blocked panels are at most rows x width x rows
+    return scratch + ((k > nb && rows > nb)? ICYM_FN(cym_gemm_workspace_size)(rows, width, rows) : 0);
+}
+
+// same as icym_qr_unblocked by panels of CYM_QR_BLOCK columns, the reflectors of a panel being applied to the trailing
+// columns at once as I - V * T^T * V^T (compact WY form) through the gemm, with its scratch taken from ws
+// \returns 0 on success, 1 if the scratch does not fit in ws
+static int ICYM_FN(icym_qr_ws)(size_t rows, size_t width, size_t k, ICYM_T* a, ptrdiff_t rs, ICYM_T* tau, ICymWorkspace ws){
+    const size_t nb      = CYM_QR_BLOCK;
+    const int    blocked = k > nb && rows > nb;
+
+    ICYM_T* w = (ICYM_T*)icym_workspace_take(&ws, ICYM_FN(icym_qr_scratch)(rows, width, k) * sizeof(ICYM_T));
+    if(!w) return 1;
+
+    if(!blocked){
+        ICYM_FN(icym_qr_unblocked)(rows, width, k, a, rs, tau, w);
+        return 0;
+    }
+
+    ICYM_T* v  = w + width;
+    ICYM_T* t  = v + rows * nb;
+    ICYM_T* w1 = t + nb * nb;
+    ICYM_T* w2 = w1 + nb * width;
+
+    for(size_t j0 = 0; j0 < k; j0 += nb){
+        const size_t jb = (k - j0 < nb)? k - j0 : nb;
+        const size_t m  = rows - j0;
+        const size_t nc = width - j0 - jb;
+        ICYM_T* panel = a + (ptrdiff_t)j0 * rs + j0;
+
+        ICYM_FN(icym_qr_unblocked)(m, jb, jb, panel, rs, tau + j0, w);
+        if(nc == 0) continue;
+
+        // V with its unit diagonal and zeros above, then T such that H_j0 * ... * H_(j0 + jb - 1) = I - V * T * V^T,
+        // column c of T being -tau_c * T * V^T * v_c over the columns before c (w1 holds V^T * V)
+        for(size_t i = 0; i < m; i+=1){
+            for(size_t c = 0; c < jb; c+=1){
+                v[i * jb + c] = (i == c)? 1 : (i > c)? panel[(ptrdiff_t)i * rs + c] : 0;
+            }
+        }
+        ICYM_FN(cym_gemm_ws)(jb, jb, m, 1, v, 1, jb, v, jb, 1, 0, w1, jb, 1, ws.next, ws.left);
+        for(size_t c = 0; c < jb; c+=1){
+            for(size_t r = 0; r < c; r+=1){
+                ICYM_T sum = 0;
+                for(size_t q = r; q < c; q+=1) sum += t[r * jb + q] * w1[q * jb + c];
+                t[r * jb + c] = -tau[j0 + c] * sum;
+            }
+            t[c * jb + c] = tau[j0 + c];
+            for(size_t r = c + 1; r < jb; r+=1) t[r * jb + c] = 0;
+        }
+
+        // trailing = (I - V * T^T * V^T) * trailing
+        ICYM_T* trailing = panel + jb;
+        ICYM_FN(cym_gemm_ws)(jb, nc, m, 1, v, 1, jb, trailing, rs, 1, 0, w1, nc, 1, ws.next, ws.left);
+        ICYM_FN(cym_gemm_ws)(jb, nc, jb, 1, t, 1, jb, w1, nc, 1, 0, w2, nc, 1, ws.next, ws.left);
+        ICYM_FN(cym_gemm_ws)(m, nc, jb, -1, v, jb, 1, w2, nc, 1, 1, trailing, rs, 1, ws.next, ws.left);
+    }
+
+    return 0;
+}
+
+// icym_qr_ws on the stack or the heap
+// \returns 0 on success, 1 if the scratch could not be allocated
+static int ICYM_FN(icym_qr)(size_t rows, size_t width, size_t k, ICYM_T* a, ptrdiff_t rs, ICYM_T* tau){
+    uint8_t stack[ICYM_STACK_WORKSPACE];
+    const size_t workspace_size = ICYM_FN(icym_qr_workspace_size)(rows, width, k);
+    void* workspace = icym_workspace_alloc(workspace_size, stack);
+    if(!workspace) return 1;
+    const int info = ICYM_FN(icym_qr_ws)(rows, width, k, a, rs, tau, icym_workspace(workspace, workspace_size));
+    icym_workspace_free(workspace, stack);
+    return info;
+}
+
+size_t ICYM_FN(cym_qr_factor_workspace_size)(size_t rows, size_t columns){
+    return ICYM_FN(icym_qr_workspace_size)(rows, columns, columns);
+}
+
+int ICYM_FN(cym_qr_factor_ws)(ICYM_T* a, size_t rows, size_t columns, ICYM_T* tau, void* workspace, size_t workspace_size){
+    if(rows < columns) return 1;
+    return ICYM_FN(icym_qr_ws)(rows, columns, columns, a, (ptrdiff_t)columns, tau, icym_workspace(workspace, workspace_size));
+}
+
+int ICYM_FN(cym_qr_factor)(ICYM_T* a, size_t rows, size_t columns, ICYM_T* tau){
+    if(rows < columns) return 1;
+    return ICYM_FN(icym_qr)(rows, columns, columns, a, (ptrdiff_t)columns, tau);
+}
+
+void ICYM_FN(cym_qr_apply_qt)(const ICYM_T* qr, const ICYM_T* tau, size_t rows, size_t columns, ICYM_T* b, size_t count){
+    const ICYM_FN(IcymKernels)* kernels = ICYM_FN(icym_kernels)();
+
+    for(size_t j = 0; j < columns && j < rows; j+=1){
+        if(tau[j] == 0) continue;
+        // v[i * columns] for i in [1, rows - j)
+        const ICYM_T* v  = qr + j * columns + j;
+        ICYM_T*       bj = b + j * count;
+        const size_t  m  = rows - j;
+
+        if(count == 1){
+            const ICYM_T w = bj[0] + ICYM_FN(cym_dot)(m - 1, v + columns, (ptrdiff_t)columns, bj + 1, 1);
+            bj[0] -= tau[j] * w;
+            ICYM_FN(cym_axpy)(m - 1, -tau[j] * w, v + columns, (ptrdiff_t)columns, bj + 1, 1);
+            continue;
+        }
+
+        // w = v^T * b then b -= tau * v * w, line by line over the columns of b
+        ICYM_T w[512];
+        for(size_t c0 = 0; c0 < count; c0 += 512){
+            const size_t cn = (count - c0 < 512)? count - c0 : 512;
+            for(size_t c = 0; c < cn; c+=1) w[c] = bj[c0 + c];
+            for(size_t i = 1; i < m; i+=1){
+                if(v[i * columns] != 0) kernels->axpy(cn, v[i * columns], bj + i * count + c0, w);
+            }
+            kernels->axpy(cn, -tau[j], w, bj + c0);
+            for(size_t i = 1; i < m; i+=1){
+                if(v[i * columns] != 0) kernels->axpy(cn, -tau[j] * v[i * columns], w, bj + i * count + c0);
+            }
+        }
+    }
+}
+
+// \returns the bytes of workspace icym_cholesky_factor needs for the updates of the trailing square
+static size_t ICYM_FN(icym_cholesky_workspace_size)(size_t n){
+    return (n > CYM_LU_BLOCK)? ICYM_FN(cym_gemm_workspace_size)(n - CYM_LU_BLOCK, n - CYM_LU_BLOCK, CYM_LU_BLOCK) : 0;
+}
+
+// cym_cholesky_factor with the packing buffers of the gemm taken from ws (allocated when it is NULL)
+static int ICYM_FN(icym_cholesky_factor)(ICYM_T* a, size_t n, const ICymWorkspace* ws){
+    const ICYM_FN(IcymKernels)* kernels = ICYM_FN(icym_kernels)();
+
+    for(size_t k0 = 0; k0 < n; k0 += CYM_LU_BLOCK){
+        const size_t k1 = (n - k0 < CYM_LU_BLOCK)? n : k0 + CYM_LU_BLOCK;
+
+        for(size_t k = k0; k < k1; k+=1){
+            ICYM_T* rk = a + k * n;
+            if(!(rk[k] > 0)) return (int)k + 1;
+            rk[k] = ICYM_FN(icym_sqrt)(rk[k]);
+            kernels->scal(n - k - 1, 1 / rk[k], rk + k + 1);
+            // the lines left in the panel, from their diagonal on
+            for(size_t i = k + 1; i < k1; i+=1) kernels->axpy(n - i, -rk[i], rk + i, a + i * n + i);
+        }
+
+        // a22 -= r12^T * r12, the whole square so the gemm can be used, its lower triangle is never read
+        if(k1 < n){
+            const ICYM_T* r12 = a + k0 * n + k1;
+            ICYM_FN(icym_gemm_in)(n - k1, n - k1, k1 - k0, -1, r12, 1, (ptrdiff_t)n, r12, (ptrdiff_t)n, 1, 1, a + k1 * n + k1,
+                (ptrdiff_t)n, 1, ws);
+        }
+    }
+
+    return 0;
+}
+
+int ICYM_FN(cym_cholesky_factor)(ICYM_T* a, unsigned int size){
+    return ICYM_FN(icym_cholesky_factor)(a, size, NULL);
+}
+
+// solves r^T * r * x = b in place for the n x count matrix b (line stride b_rs), the gemm taking its packing buffers from ws
+// (allocated when it is NULL)
+static void ICYM_FN(icym_cholesky_solve_many)(const ICYM_T* r, size_t n, ICYM_T* b, size_t count, ptrdiff_t b_rs,
+    const ICymWorkspace* ws){
+    const ICYM_FN(IcymKernels)* kernels = ICYM_FN(icym_kernels)();
+
+    // r^T is lower triangular, its columns are the lines of r
+    for(size_t p = 0; p < n; p+=1){
+        ICYM_T* bp = b + (ptrdiff_t)p * b_rs;
+        kernels->scal(count, 1 / r[p * n + p], bp);
+        for(size_t i = p + 1; i < n; i+=1){
+            if(r[p * n + i] != 0) kernels->axpy(count, -r[p * n + i], bp, b + (ptrdiff_t)i * b_rs);
+        }
+    }
+    ICYM_FN(icym_trsm_upper)(n, count, r, (ptrdiff_t)n, b, b_rs, ws);
+}
+
+void ICYM_FN(cym_cholesky_solve)(const ICYM_T* r, unsigned int size, const ICYM_T* y, ICYM_T* x){
+    const ICYM_FN(IcymKernels)* kernels = ICYM_FN(icym_kernels)();
+    const size_t n = size;
+
+    if(x != y) for(size_t i = 0; i < n; i+=1) x[i] = y[i];
+
+    for(size_t p = 0; p < n; p+=1){
+        x[p] /= r[p * n + p];
+        kernels->axpy(n - p - 1, -x[p], r + p * n + p + 1, x + p + 1);
+    }
+    for(size_t i = n; i > 0; i-=1){
+        const ICYM_T* row = r + (i - 1) * n;
+        x[i - 1] = (x[i - 1] - kernels->dot(n - i, row + i, x + i)) / row[i - 1];
+    }
+}
+
+// \returns 1 if the diagonal of the columns x columns triangle r (line stride rs) has an element negligible next to the
+// biggest one, so the system is rank deficient to working precision
+static int ICYM_FN(icym_rank_deficient)(const ICYM_T* r, size_t columns, ptrdiff_t rs){
+    ICYM_T biggest = 0;
+    for(size_t j = 0; j < columns; j+=1){
+        const ICYM_T d = CYM_ABS(r[(ptrdiff_t)j * rs + j]);
+        if(d > biggest) biggest = d;
+    }
+    const ICYM_T tolerance = biggest * (ICYM_F32? FLT_EPSILON : DBL_EPSILON) * columns;
+    for(size_t j = 0; j < columns; j+=1){
+        if(!(CYM_ABS(r[(ptrdiff_t)j * rs + j]) > tolerance)) return 1;
+    }
+    return 0;
+}
+
+size_t ICYM_FN(cym_lstsq_workspace_size)(size_t rows, size_t columns, size_t count, int flags){
+    if(rows < columns || !columns) return 0;
+    const int cholesky = (flags & CYM_LSQ_CHOLESKY) != 0;
+
+    // the normal equations come first and the qr after them when they fail, so their scratch is shared
+    size_t scratch = ICYM_FN(icym_qr_workspace_size)(rows, columns, columns);
+    if(cholesky){
+        const size_t products[3] = {
+            ICYM_FN(icym_syrk_workspace_size)(columns, rows), ICYM_FN(icym_cholesky_workspace_size)(columns),
+            ICYM_FN(cym_gemm_workspace_size)(columns, count, rows)
+        };
+        for(int i = 0; i < 3; i+=1) if(products[i] > scratch) scratch = products[i];
+    }
+    const size_t solve = ICYM_FN(cym_gemm_workspace_size)(columns, count, CYM_LU_BLOCK);
+    if(solve > scratch) scratch = solve;
+
+    const size_t vectors = (2 * columns + (cholesky? columns * columns : 0)) * sizeof(ICYM_T);
+    return ICYM_WORKSPACE_ALIGN + icym_workspace_bytes(vectors) + scratch;
+}
+
+int ICYM_FN(cym_lstsq_ws)(ICYM_T* a, size_t rows, size_t columns, ICYM_T* b, size_t count, ICYM_T* x, int flags,
+    void* workspace, size_t workspace_size){
+
+    if(rows < columns) return 1;
+    if(!columns) return 0;
+
+    const int cholesky = (flags & CYM_LSQ_CHOLESKY) != 0;
+    ICymWorkspace ws = icym_workspace(workspace, workspace_size);
+    ICYM_T* scale = (ICYM_T*)icym_workspace_take(&ws, (2 * columns + (cholesky? columns * columns : 0)) * sizeof(ICYM_T));
+    if(!scale) return 1;
+    ICYM_T* tau    = scale + columns;
+    ICYM_T* normal = tau + columns;
+
+    // a * x = (a * d) * (d^-1 * x), d scaling the columns to unit norm
+    if(flags & CYM_LSQ_SCALE){
+        for(size_t j = 0; j < columns; j+=1){
+            const ICYM_T norm = ICYM_FN(cym_nrm2)(rows, a + j, (ptrdiff_t)columns);
+            scale[j] = (norm > 0)? 1 / norm : 1;
+            ICYM_FN(cym_scal)(rows, scale[j], a + j, (ptrdiff_t)columns);
+        }
+    }
+
+    int solved = 0;
+    if(cholesky){
+        ICYM_FN(icym_syrk)(columns, rows, a, (ptrdiff_t)columns, 1, normal, (ptrdiff_t)columns, &ws);
+        if(!ICYM_FN(icym_cholesky_factor)(normal, columns, &ws)){
+            ICYM_FN(cym_gemm_ws)(columns, count, rows, 1, a, 1, (ptrdiff_t)columns, b, (ptrdiff_t)count, 1, 0, x,
+                (ptrdiff_t)count, 1, ws.next, ws.left);
+            ICYM_FN(icym_cholesky_solve_many)(normal, columns, x, count, (ptrdiff_t)count, &ws);
+            solved = 1;
+        }
+    }
+    if(!solved){
+        if(ICYM_FN(icym_qr_ws)(rows, columns, columns, a, (ptrdiff_t)columns, tau, ws) ||
+            ICYM_FN(icym_rank_deficient)(a, columns, (ptrdiff_t)columns)) return 1;
+        ICYM_FN(cym_qr_apply_qt)(a, tau, rows, columns, b, count);
+        for(size_t i = 0; i < columns * count; i+=1) x[i] = b[i];
+        ICYM_FN(icym_trsm_upper)(columns, count, a, (ptrdiff_t)columns, x, (ptrdiff_t)count, &ws);
+    }
+
+    if(flags & CYM_LSQ_SCALE){
+        for(size_t j = 0; j < columns; j+=1) ICYM_FN(icym_kernels)()->scal(count, scale[j], x + j * count);
+    }
+
+    return 0;
+}
+
+int ICYM_FN(cym_lstsq)(ICYM_T* a, size_t rows, size_t columns, ICYM_T* b, size_t count, ICYM_T* x, int flags){
+    uint8_t stack[ICYM_STACK_WORKSPACE];
+    const size_t workspace_size = ICYM_FN(cym_lstsq_workspace_size)(rows, columns, count, flags);
+    void* workspace = icym_workspace_alloc(workspace_size, stack);
+    const int info = ICYM_FN(cym_lstsq_ws)(a, rows, columns, b, count, x, flags, workspace, workspace? workspace_size : 0);
+    icym_workspace_free(workspace, stack);
+    return info;
+}
+
+// X==============X MATRICES X=================X
+
+ICYM_T ICYM_FN(cym_normalize_vec)(const ICYM_T* vector, unsigned int size, ICYM_T* ouput){
+    ICYM_T norm;
+    ICYM_FN(cym_normalize_vecs)(vector, 1, size, ouput, &norm, 0);
+    return norm;
+}
+
+void ICYM_FN(cym_mat_scale)(ICYM_T scalar, const ICYM_T* mat, unsigned int sizex, unsigned int sizey, ICYM_T* output){
+    ICYM_FN(cym_axpby)((size_t)sizex * sizey, scalar, mat, 1, 0, output, 1);
+}
+
+void ICYM_FN(cym_mat_sum)(const ICYM_T* mat1, const ICYM_T* mat2, unsigned int sizex, unsigned int sizey, ICYM_T* output){
+    ICYM_FN(cym_waxpby)((size_t)sizex * sizey, 1, mat1, 1, 1, mat2, 1, output, 1);
+}
+
+void ICYM_FN(cym_mat_sub)(const ICYM_T* mat1, const ICYM_T* mat2, unsigned int sizex, unsigned int sizey, ICYM_T* output){
+    ICYM_FN(cym_waxpby)((size_t)sizex * sizey, 1, mat1, 1, -1, mat2, 1, output, 1);
+}
+
+void ICYM_FN(cym_mat_multiply)(const ICYM_T* mat_1, unsigned int mat1_sizex, unsigned int mat1_sizey,
+    const ICYM_T* mat_2, unsigned int mat2_sizex, ICYM_T* output){
+    ICYM_FN(cym_gemm)(mat1_sizey, mat2_sizex, mat1_sizex, 1, mat_1, mat1_sizex, 1, mat_2, mat2_sizex, 1, 0, output, mat2_sizex, 1);
+}
+
+size_t ICYM_FN(cym_solve_gauss_workspace_size)(unsigned int size){
+    return icym_workspace_bytes(size * sizeof(unsigned int)) + ICYM_FN(cym_lu_factor_workspace_size)(size);
+}
+
+void ICYM_FN(cym_solve_gauss_ws)(ICYM_T* a, ICYM_T* y, unsigned int size, ICYM_T* x, void* workspace, size_t workspace_size){
+    ICymWorkspace ws = icym_workspace(workspace, workspace_size);
+    unsigned int* pivots = (unsigned int*)icym_workspace_take(&ws, size * sizeof(unsigned int));
+
+    if(!pivots){
+        for(unsigned int i = 0; i < size; i += 1) x[i] = 0.0 / 0.0;
+        return;
+    }
+
+    ICYM_FN(cym_lu_factor_ws)(a, size, pivots, ws.next, ws.left);
+    ICYM_FN(cym_lu_solve)(a, pivots, size, y, x);
+}
+
+void ICYM_FN(cym_solve_gauss)(ICYM_T* a, ICYM_T* y, unsigned int size, ICYM_T* x){
+    uint8_t stack[ICYM_STACK_WORKSPACE];
+    const size_t workspace_size = ICYM_FN(cym_solve_gauss_workspace_size)(size);
+    void* workspace = icym_workspace_alloc(workspace_size, stack);
+    ICYM_FN(cym_solve_gauss_ws)(a, y, size, x, workspace, workspace? workspace_size : 0);
+    icym_workspace_free(workspace, stack);
+}
+
+int ICYM_FN(cym_make_unitary_reflector)(const ICYM_T* input, unsigned int size, ICYM_T* w){
+    const size_t n = size;
+    const ICYM_T norm = ICYM_FN(cym_nrm2)(n, input, 1);
+    for(size_t i = 0; i < n; i+=1) w[i] = 0;
+    if(!(norm > 0)) return 1;
+
+    // with u = input / |input|, w = (e1 - u) / |e1 - u| and |e1 - u|^2 = 2 (1 - u0), 1 - u0 being taken as
+    // sum(u_i^2, i > 0) / (1 + u0) when u0 > 0 so it does not cancel
+    const ICYM_T rnorm = 1 / norm;
+    const ICYM_T u0 = input[0] * rnorm;
+    const ICYM_T tail = (n > 1)? ICYM_FN(cym_nrm2)(n - 1, input + 1, 1) * rnorm : 0;
+    if(tail == 0){
+        // u is e1 (U = I) or -e1 (the reflector of e1)
+        if(u0 < 0) w[0] = 1;
+        return 0;
+    }
+    const ICYM_T d = (u0 > 0)? tail * tail / (1 + u0) : 1 - u0;
+    const ICYM_T scale = 1 / ICYM_FN(icym_sqrt)(2 * d);
+    w[0] = d * scale;
+    for(size_t i = 1; i < n; i+=1) w[i] = -input[i] * rnorm * scale;
+    return 0;
+}
+
+void ICYM_FN(cym_apply_unitary_reflector)(const ICYM_T* w, unsigned int size, ICYM_T* x, size_t count){
+    const size_t n = size;
+    const ICYM_FN(IcymKernels)* kernels = ICYM_FN(icym_kernels)();
+    if(count == 1){
+        kernels->axpy(n, -2 * kernels->dot(n, w, x), w, x);
+        return;
+    }
+
+    // t = w^T x then x -= 2 w t, both through the gemm
+    ICYM_T stack_t[256];
+    ICYM_T* t = (count <= 256)? stack_t : (ICYM_T*)malloc(count * sizeof(ICYM_T));
+    if(!t){
+        for(size_t c = 0; c < count; c+=1){
+            ICYM_FN(cym_axpy)(n, -2 * ICYM_FN(cym_dot)(n, w, 1, x + c, (ptrdiff_t)count), w, 1, x + c, (ptrdiff_t)count);
+        }
+        return;
+    }
+    ICYM_FN(cym_gemm)(1, count, n, 1, w, (ptrdiff_t)n, 1, x, (ptrdiff_t)count, 1, 0, t, (ptrdiff_t)count, 1);
+    ICYM_FN(cym_gemm)(n, count, 1, -2, w, 1, 1, t, (ptrdiff_t)count, 1, 1, x, (ptrdiff_t)count, 1);
+    if(t != stack_t) free(t);
+}
+
+int ICYM_FN(cym_make_unitary)(const ICYM_T* input, unsigned int size, ICYM_T* output){
+    const size_t n = size;
+
+    // the reflector first, since output may be the input
+    ICYM_T stack_w[256];
+    ICYM_T* w = (n <= 256)? stack_w : (ICYM_T*)malloc(n * sizeof(ICYM_T));
+    if(!w){
+        fprintf(stderr, "[ERROR] cym_make_unitary could not allocate its %zu values reflector\n", n);
+        return 1;
+    }
+    const int zero = ICYM_FN(cym_make_unitary_reflector)(input, size, w);
+
+    for(size_t i = 0; i < n; i+=1){
+        for(size_t j = 0; j < n; j+=1) output[i * n + j] = (zero? 0 : (i == j)) - 2 * w[i] * w[j];
+    }
+
+    if(w != stack_w) free(w);
+    return zero;
+}
+
+size_t ICYM_FN(cym_test_unitary_workspace_size)(unsigned int size){
+    const size_t n = size;
+    const size_t ib = (n < CYM_SYRK_BLOCK)? n : CYM_SYRK_BLOCK;
+    return ICYM_WORKSPACE_ALIGN + icym_workspace_bytes(ib * n * sizeof(ICYM_T)) + ICYM_FN(cym_gemm_workspace_size)(ib, n, n);
+}
+
+int ICYM_FN(cym_test_unitary_deviation_ws)(const ICYM_T* mat, unsigned int size, double accuracy, double* deviation,
+    void* workspace, size_t workspace_size){
+
+    const size_t n = size;
+    double biggest = 0;
+    int is_un = 1;
+    if(deviation) *deviation = 0;
+    if(!n) return 1;
+
+    ICymWorkspace ws = icym_workspace(workspace, workspace_size);
+    ICYM_T* block = (ICYM_T*)icym_workspace_take(&ws, (n < CYM_SYRK_BLOCK? n : CYM_SYRK_BLOCK) * n * sizeof(ICYM_T));
+    if(!block){
+        if(deviation) *deviation = 0.0 / 0.0;
+        return -1;
+    }
+
+    // lines i0 to i0 + ib of mat^T * mat from column i0 on, the lower half being their mirror
+    for(size_t i0 = 0; i0 < n && is_un; i0 += CYM_SYRK_BLOCK){
+        const size_t ib = (n - i0 < CYM_SYRK_BLOCK)? n - i0 : CYM_SYRK_BLOCK;
+        const size_t width = n - i0;
+        ICYM_FN(cym_gemm_ws)(ib, width, n, 1, mat + i0, 1, (ptrdiff_t)n, mat + i0, (ptrdiff_t)n, 1, 0, block, (ptrdiff_t)width, 1,
+            ws.next, ws.left);
+
+        for(size_t i = 0; i < ib; i+=1){
+            for(size_t j = i; j < width; j+=1){
+                const double e = CYM_ABS((double)block[i * width + j] - (i == j));
+                if(e > biggest) biggest = e;
+                // NaN fails as well
+                if(!(e < accuracy)) is_un = 0;
+            }
+        }
+    }
+
+    if(deviation) *deviation = biggest;
+    return is_un;
+}
+
+int ICYM_FN(cym_test_unitary_deviation)(const ICYM_T* mat, unsigned int size, double accuracy, double* deviation){
+    uint8_t stack[ICYM_STACK_WORKSPACE];
+    const size_t workspace_size = ICYM_FN(cym_test_unitary_workspace_size)(size);
+    void* workspace = icym_workspace_alloc(workspace_size, stack);
+    const int is_un = ICYM_FN(cym_test_unitary_deviation_ws)(mat, size, accuracy, deviation, workspace,
+        workspace? workspace_size : 0);
+    icym_workspace_free(workspace, stack);
+    return is_un;
+}
+
+int ICYM_FN(cym_test_unitary)(const ICYM_T* mat, unsigned int size, double accuracy){
+    return ICYM_FN(cym_test_unitary_deviation)(mat, size, accuracy, NULL) == 1;
+}
+
+void ICYM_FN(cym_mat_print)(const char* name, const ICYM_T* mat, unsigned int sizey, unsigned int sizex){
+    if(name) printf("\n%s[%u][%u]:\n\t",name, sizey, sizex);
+    else     printf("\n(NOT NAMED)[%u][%u]:\n\t", sizey, sizex);
+
+    for(unsigned int i = 0; i < sizey; i++){
+        for(unsigned int j = 0; j < sizex; j++){
+            printf("%f, ", mat[i * sizex + j]);
+        }
+        printf("\n");
+    }
+    printf("\n");
+}
+
+// X==============X MATRIX VIEWS X=================X
+
+ICYM_FN(CYM_IMAT) ICYM_FN(cym_imat)(ICYM_T* data, size_t rows, size_t columns){
+    ICYM_FN(CYM_IMAT) m = { data, rows, columns, (ptrdiff_t)columns, 1 };
+    return m;
+}
+
+ICYM_FN(CYM_IMAT) ICYM_FN(cym_imat_sub)(ICYM_FN(CYM_IMAT) m, size_t row, size_t column, size_t rows, size_t columns){
+    m.data    = &CYM_IMAT_AT(m, row, column);
+    m.rows    = rows;
+    m.columns = columns;
+    return m;
+}
+
+ICYM_FN(CYM_IMAT) ICYM_FN(cym_imat_row)(ICYM_FN(CYM_IMAT) m, size_t i){ return ICYM_FN(cym_imat_sub)(m, i, 0, 1, m.columns); }
+
+ICYM_FN(CYM_IMAT) ICYM_FN(cym_imat_col)(ICYM_FN(CYM_IMAT) m, size_t j){ return ICYM_FN(cym_imat_sub)(m, 0, j, m.rows, 1); }
+
+ICYM_FN(CYM_IMAT) ICYM_FN(cym_imat_transpose)(ICYM_FN(CYM_IMAT) m){
+    ICYM_FN(CYM_IMAT) t = { m.data, m.columns, m.rows, m.cstride, m.stride };
+    return t;
+}
+
+int ICYM_FN(cym_imat_multiply)(ICYM_T alpha, ICYM_FN(CYM_IMAT) a, ICYM_FN(CYM_IMAT) b, ICYM_T beta, ICYM_FN(CYM_IMAT) c){
+    if(a.columns != b.rows || a.rows != c.rows || b.columns != c.columns) return 1;
+    // the gemm packs a and b, so it takes any strides
+    ICYM_FN(cym_gemm)(c.rows, c.columns, a.columns, alpha, a.data, a.stride, a.cstride, b.data, b.stride, b.cstride,
+        beta, c.data, c.stride, c.cstride);
+    return 0;
+}
+
+int ICYM_FN(cym_imat_axpby)(ICYM_T alpha, ICYM_FN(CYM_IMAT) x, ICYM_T beta, ICYM_FN(CYM_IMAT) y){
+    if(x.rows != y.rows || x.columns != y.columns) return 1;
+    // walks y along its contiguous direction, so the column views of row major matrices go through the strided BLAS 1 once
+    if(CYM_ABS(y.cstride) > CYM_ABS(y.stride) && y.rows > 1){
+        x = ICYM_FN(cym_imat_transpose)(x);
+        y = ICYM_FN(cym_imat_transpose)(y);
+    }
+    for(size_t i = 0; i < y.rows; i+=1){
+        ICYM_FN(cym_axpby)(y.columns, alpha, &CYM_IMAT_AT(x, i, 0), x.cstride, beta, &CYM_IMAT_AT(y, i, 0), y.cstride);
+    }
+    return 0;
+}
+
+int ICYM_FN(cym_imat_copy)(ICYM_FN(CYM_IMAT) src, ICYM_FN(CYM_IMAT) dst){
+    return ICYM_FN(cym_imat_axpby)(1, src, 0, dst);
+}
+
+int ICYM_FN(cym_smatmul)(ICYM_FN(CYM_IMAT) mat1, ICYM_FN(CYM_IMAT) mat2, ICYM_T* output){
+    return ICYM_FN(cym_imat_multiply)(1, mat1, mat2, 0, ICYM_FN(cym_imat)(output, mat1.rows, mat2.columns));
+}
+
+// X==============X COMPLEX MATRICES X=================X
+
+// one real gemm of cym_cgemm, c_part += coefficient * a_part * b_part, the strides being in reals
+static void ICYM_FN(icym_cgemm_part)(size_t m, size_t n, size_t k, ICYM_T coefficient, const ICYM_T* a, ptrdiff_t a_rs,
+    ptrdiff_t a_cs, const ICYM_T* b, ptrdiff_t b_rs, ptrdiff_t b_cs, ICYM_T* c, ptrdiff_t c_rs, ptrdiff_t c_cs){
+
+    if(coefficient != 0) ICYM_FN(cym_gemm)(m, n, k, coefficient, a, a_rs, a_cs, b, b_rs, b_cs, 1, c, c_rs, c_cs);
+}
+
+void ICYM_FN(cym_cgemm)(size_t m, size_t n, size_t k, ICYM_FN(CymComplex) alpha, const ICYM_FN(CymComplex)* a, ptrdiff_t a_rs,
+    ptrdiff_t a_cs, const ICYM_FN(CymComplex)* b, ptrdiff_t b_rs, ptrdiff_t b_cs, ICYM_FN(CymComplex) beta, ICYM_FN(CymComplex)* c,
+    ptrdiff_t c_rs, ptrdiff_t c_cs, int conjugate){
+
+    if(!m || !n) return;
+    const ICYM_FN(IcymKernels)* kernels = ICYM_FN(icym_kernels)();
+
+    // beta * c first, the products are then added to it
+    if(beta.re == 0 && beta.im == 0){
+        for(size_t i = 0; i < m; i+=1){
+            for(size_t j = 0; j < n; j+=1){
+                ICYM_FN(CymComplex)* e = c + (ptrdiff_t)i * c_rs + (ptrdiff_t)j * c_cs;
+                e->re = 0;
+                e->im = 0;
+            }
+        }
+    } else if(beta.re != 1 || beta.im != 0){
+        for(size_t i = 0; i < m; i+=1){
+            ICYM_FN(CymComplex)* row = c + (ptrdiff_t)i * c_rs;
+            if(c_cs == 1){
+                kernels->cscal(n, beta.re, beta.im, &row->re, &row->re);
+                continue;
+            }
+            for(size_t j = 0; j < n; j+=1){
+                ICYM_FN(CymComplex)* e = row + (ptrdiff_t)j * c_cs;
+                const ICYM_T re = e->re;
+                e->re = beta.re * re - beta.im * e->im;
+                e->im = beta.re * e->im + beta.im * re;
+            }
+        }
+    }
+    if(!k || (alpha.re == 0 && alpha.im == 0)) return;
+
+    // the parts are views of the interleaved arrays with doubled strides, with op(a) = ar + i sa ai and op(b) = br + i sb bi
+    // re += alpha_r (ar br - sa sb ai bi) - alpha_i (sb ar bi + sa ai br)
+    // im += alpha_r (sb ar bi + sa ai br) + alpha_i (ar br - sa sb ai bi)
+    const ICYM_T sa = (conjugate & CYM_CONJ_A)? -1 : 1, sb = (conjugate & CYM_CONJ_B)? -1 : 1;
+    const ICYM_T* ar = &a->re;
+    const ICYM_T* ai = ar + 1;
+    const ICYM_T* br = &b->re;
+    const ICYM_T* bi = br + 1;
+    ICYM_T* cr = &c->re;
+    ICYM_T* ci = cr + 1;
+    const ptrdiff_t ars = 2 * a_rs, acs = 2 * a_cs, brs = 2 * b_rs, bcs = 2 * b_cs, crs = 2 * c_rs, ccs = 2 * c_cs;
+
+    ICYM_FN(icym_cgemm_part)(m, n, k, alpha.re,            ar, ars, acs, br, brs, bcs, cr, crs, ccs);
+    ICYM_FN(icym_cgemm_part)(m, n, k, -alpha.re * sa * sb, ai, ars, acs, bi, brs, bcs, cr, crs, ccs);
+    ICYM_FN(icym_cgemm_part)(m, n, k, -alpha.im * sb,      ar, ars, acs, bi, brs, bcs, cr, crs, ccs);
+    ICYM_FN(icym_cgemm_part)(m, n, k, -alpha.im * sa,      ai, ars, acs, br, brs, bcs, cr, crs, ccs);
+
+    ICYM_FN(icym_cgemm_part)(m, n, k, alpha.re * sb,       ar, ars, acs, bi, brs, bcs, ci, crs, ccs);
+    ICYM_FN(icym_cgemm_part)(m, n, k, alpha.re * sa,       ai, ars, acs, br, brs, bcs, ci, crs, ccs);
+    ICYM_FN(icym_cgemm_part)(m, n, k, alpha.im,            ar, ars, acs, br, brs, bcs, ci, crs, ccs);
+    ICYM_FN(icym_cgemm_part)(m, n, k, -alpha.im * sa * sb, ai, ars, acs, bi, brs, bcs, ci, crs, ccs);
+}
+
+void ICYM_FN(cym_cmat_multiply)(const ICYM_FN(CymComplex)* mat_1, unsigned int mat1_sizex, unsigned int mat1_sizey,
+    const ICYM_FN(CymComplex)* mat_2, unsigned int mat2_sizex, ICYM_FN(CymComplex)* output){
+
+    const ICYM_FN(CymComplex) one = { 1, 0 }, zero = { 0, 0 };
+    ICYM_FN(cym_cgemm)(mat1_sizey, mat2_sizex, mat1_sizex, one, mat_1, mat1_sizex, 1, mat_2, mat2_sizex, 1, zero,
+        output, mat2_sizex, 1, 0);
+}
+
+typedef struct ICYM_FN(ICymCTranspose){
+    const ICYM_FN(CymComplex)* input;
+    ICYM_FN(CymComplex)*       output;
+    size_t                     rows;
+    size_t                     columns;
+    // -1 to conjugate
+    ICYM_T                     sign;
+} ICYM_FN(ICymCTranspose);
+
+// transposes the lines [begin, end) of the input by CYM_TRANSPOSE_BLOCK square blocks
+static void ICYM_FN(icym_ctranspose_stripe)(size_t begin, size_t end, void* user){
+    const ICYM_FN(ICymCTranspose)* t = (const ICYM_FN(ICymCTranspose)*)user;
+    for(size_t j0 = 0; j0 < t->columns; j0 += CYM_TRANSPOSE_BLOCK){
+        const size_t j1 = (t->columns - j0 < CYM_TRANSPOSE_BLOCK)? t->columns : j0 + CYM_TRANSPOSE_BLOCK;
+        for(size_t i = begin; i < end; i+=1){
+            const ICYM_FN(CymComplex)* row = t->input + i * t->columns;
+            for(size_t j = j0; j < j1; j+=1){
+                t->output[j * t->rows + i].re = row[j].re;
+                t->output[j * t->rows + i].im = t->sign * row[j].im;
+            }
+        }
+    }
+}
+
+static void ICYM_FN(icym_ctranspose)(const ICYM_FN(CymComplex)* input, unsigned int sizex, unsigned int sizey,
+    ICYM_FN(CymComplex)* output, ICYM_T sign){
+
+    if(input == output && sizex != sizey){
+        // conjugated in place, then moved along the cycles of the permutation as cym_mat_transpose_inplace does
+        const size_t rows = sizey, cols = sizex, count = rows * cols;
+        if(sign != 1){
+            for(size_t k = 0; k < count; k+=1) output[k].im = -output[k].im;
+        }
+        if(rows <= 1 || cols <= 1) return;
+
+        uint64_t* visited = (uint64_t*)calloc((count + 63) / 64, sizeof(uint64_t));
+        if(!visited){
+            fprintf(stderr, "[ERROR] cym_cmat_transpose could not allocate the scratch bits of %zu elements\n", count);
+            return;
+        }
+        for(size_t start = 1; start + 1 < count; start+=1){
+            if(visited[start / 64] >> (start % 64) & 1) continue;
+
+            size_t k = start;
+            ICYM_FN(CymComplex) value = output[k];
+            do{
+                const size_t next = (k % cols) * rows + k / cols;
+                const ICYM_FN(CymComplex) t = output[next];
+                output[next] = value;
+                value = t;
+                visited[next / 64] |= (uint64_t)1 << (next % 64);
+                k = next;
+            } while(k != start);
+        }
+        free(visited);
+        return;
+    }
+
+    if(input == output){
+        // square, swapped in place
+        const size_t n = sizex;
+        for(size_t i = 0; i < n; i+=1){
+            output[i * n + i].im *= sign;
+            for(size_t j = i + 1; j < n; j+=1){
+                const ICYM_FN(CymComplex) upper = output[i * n + j], lower = output[j * n + i];
+                output[i * n + j].re = lower.re;
+                output[i * n + j].im = sign * lower.im;
+                output[j * n + i].re = upper.re;
+                output[j * n + i].im = sign * upper.im;
+            }
+        }
+        return;
+    }
+
+    ICYM_FN(ICymCTranspose) t = { input, output, sizey, sizex, sign };
+    if((size_t)sizex * sizey >= CYM_TRANSPOSE_PARALLEL){
+        cym_parallel_for(0, sizey, CYM_TRANSPOSE_BLOCK, ICYM_FN(icym_ctranspose_stripe), &t);
+    } else{
+        ICYM_FN(icym_ctranspose_stripe)(0, sizey, &t);
+    }
+}
+
+void ICYM_FN(cym_cmat_transpose)(const ICYM_FN(CymComplex)* input, unsigned int sizex, unsigned int sizey,
+    ICYM_FN(CymComplex)* output){
+    ICYM_FN(icym_ctranspose)(input, sizex, sizey, output, 1);
+}
+
+void ICYM_FN(cym_cmat_conj_transpose)(const ICYM_FN(CymComplex)* input, unsigned int sizex, unsigned int sizey,
+    ICYM_FN(CymComplex)* output){
+    ICYM_FN(icym_ctranspose)(input, sizex, sizey, output, -1);
+}
+
+void ICYM_FN(cym_cmat_scale)(ICYM_FN(CymComplex) scalar, const ICYM_FN(CymComplex)* mat, unsigned int sizex, unsigned int sizey,
+    ICYM_FN(CymComplex)* output){
+    ICYM_FN(icym_kernels)()->cscal((size_t)sizex * sizey, scalar.re, scalar.im, &mat->re, &output->re);
+}
+
+void ICYM_FN(cym_cmat_sum)(const ICYM_FN(CymComplex)* mat1, const ICYM_FN(CymComplex)* mat2, unsigned int sizex,
+    unsigned int sizey, ICYM_FN(CymComplex)* output){
+    // the parts add separately
+    ICYM_FN(cym_waxpby)(2 * (size_t)sizex * sizey, 1, &mat1->re, 1, 1, &mat2->re, 1, &output->re, 1);
+}
+
+// 1 / (re + i * im) without overflowing on the way (Smith's method)
+static ICYM_FN(CymComplex) ICYM_FN(icym_creciprocal)(ICYM_T re, ICYM_T im){
+    ICYM_FN(CymComplex) r;
+    if(CYM_ABS(re) >= CYM_ABS(im)){
+        const ICYM_T q = im / re, d = re + im * q;
+        r.re = 1 / d;
+        r.im = -q / d;
+    } else{
+        const ICYM_T q = re / im, d = re * q + im;
+        r.re = q / d;
+        r.im = -1 / d;
+    }
+    return r;
+}
+
+typedef struct ICYM_FN(ICymCluUpdate){
+    const ICYM_FN(IcymKernels)* kernels;
+    ICYM_FN(CymComplex)*        a;
+    size_t                      n;
+    size_t                      k;
+    ICYM_FN(CymComplex)         inverse_pivot;
+} ICYM_FN(ICymCluUpdate);
+
+// eliminates column k from the lines [begin, end) below the pivot
+static void ICYM_FN(icym_clu_update_task)(size_t begin, size_t end, void* user){
+    const ICYM_FN(ICymCluUpdate)* job = (const ICYM_FN(ICymCluUpdate)*)user;
+    const size_t n = job->n, k = job->k;
+    const ICYM_FN(CymComplex)* pivot_row = job->a + k * n + k + 1;
+    for(size_t i = begin; i < end; i+=1){
+        ICYM_FN(CymComplex)* l = job->a + i * n + k;
+        const ICYM_T re = l->re * job->inverse_pivot.re - l->im * job->inverse_pivot.im;
+        const ICYM_T im = l->re * job->inverse_pivot.im + l->im * job->inverse_pivot.re;
+        l->re = re;
+        l->im = im;
+        job->kernels->caxpy(n - k - 1, -re, -im, &pivot_row->re, &l[1].re);
+    }
+}
+
+int ICYM_FN(cym_clu_factor)(ICYM_FN(CymComplex)* a, unsigned int size, unsigned int* pivots){
+    const size_t n = size;
+    int info = 0;
+    ICYM_FN(ICymCluUpdate) job;
+    job.kernels = ICYM_FN(icym_kernels)();
+    job.a = a;
+    job.n = n;
+
+    for(size_t k = 0; k < n; k+=1){
+        // the pivot is the biggest |re| + |im| of the column, as LAPACK does
+        size_t p = k;
+        ICYM_T max = -1;
+        for(size_t i = k; i < n; i+=1){
+            const ICYM_T v = CYM_ABS(a[i * n + k].re) + CYM_ABS(a[i * n + k].im);
+            if(v > max){
+                max = v;
+                p = i;
+            }
+        }
+        pivots[k] = (unsigned int)p;
+        if(p != k){
+            for(size_t j = 0; j < n; j+=1){
+                const ICYM_FN(CymComplex) swap = a[k * n + j];
+                a[k * n + j] = a[p * n + j];
+                a[p * n + j] = swap;
+            }
+        }
+        if(!(max > 0)){
+            if(!info) info = (int)k + 1;
+            continue;
+        }
+
+        job.k = k;
+        job.inverse_pivot = ICYM_FN(icym_creciprocal)(a[k * n + k].re, a[k * n + k].im);
+        const size_t rows = n - k - 1;
+        if(rows * rows >= CYM_BATCH_GRAIN){
+            const size_t grain = (CYM_BATCH_GRAIN / rows > 0)? CYM_BATCH_GRAIN / rows : 1;
+            cym_parallel_for(k + 1, n, grain, ICYM_FN(icym_clu_update_task), &job);
+        } else{
+            ICYM_FN(icym_clu_update_task)(k + 1, n, &job);
+        }
+    }
+    return info;
+}
+
+void ICYM_FN(cym_clu_solve)(const ICYM_FN(CymComplex)* lu, const unsigned int* pivots, unsigned int size,
+    const ICYM_FN(CymComplex)* y, ICYM_FN(CymComplex)* x){
+
+    const ICYM_FN(IcymKernels)* kernels = ICYM_FN(icym_kernels)();
+    const size_t n = size;
+    if(x != y){
+        for(size_t i = 0; i < n; i+=1) x[i] = y[i];
+    }
+    for(size_t i = 0; i < n; i+=1){
+        if(pivots[i] != i){
+            const ICYM_FN(CymComplex) swap = x[i];
+            x[i] = x[pivots[i]];
+            x[pivots[i]] = swap;
+        }
+    }
+
+    ICYM_T dot[2];
+    for(size_t i = 1; i < n; i+=1){
+        kernels->cdot(i, &lu[i * n].re, &x->re, 0, dot);
+        x[i].re -= dot[0];
+        x[i].im -= dot[1];
+    }
+    for(size_t i = n; i > 0; i-=1){
+        const size_t r = i - 1;
+        kernels->cdot(n - i, &lu[r * n + i].re, &x[i].re, 0, dot);
+        const ICYM_T re = x[r].re - dot[0], im = x[r].im - dot[1];
+        const ICYM_FN(CymComplex) inverse = ICYM_FN(icym_creciprocal)(lu[r * n + r].re, lu[r * n + r].im);
+        x[r].re = re * inverse.re - im * inverse.im;
+        x[r].im = re * inverse.im + im * inverse.re;
+    }
+}
+
+int ICYM_FN(cym_csolve_gauss)(ICYM_FN(CymComplex)* a, const ICYM_FN(CymComplex)* y, unsigned int size, ICYM_FN(CymComplex)* x){
+    unsigned int stack_pivots[256];
+    unsigned int* pivots = (size <= 256)? stack_pivots : (unsigned int*)malloc(size * sizeof(unsigned int));
+
+    if(!pivots){
+        for(unsigned int i = 0; i < size; i += 1) x[i].re = x[i].im = 0.0 / 0.0;
+        return 1;
+    }
+
+    const int info = ICYM_FN(cym_clu_factor)(a, size, pivots);
+    ICYM_FN(cym_clu_solve)(a, pivots, size, y, x);
+
+    if(pivots != stack_pivots) free(pivots);
+    return info != 0;
+}
+
+int ICYM_FN(cym_ctest_unitary_deviation)(const ICYM_FN(CymComplex)* mat, unsigned int size, double accuracy, double* deviation){
+    const size_t n = size;
+    const ICYM_FN(CymComplex) one = { 1, 0 }, zero = { 0, 0 };
+    double biggest = 0;
+    int is_un = 1;
+    if(deviation) *deviation = 0;
+    if(!n) return 1;
+
+    ICYM_FN(CymComplex)* block = (ICYM_FN(CymComplex)*)malloc((n < CYM_SYRK_BLOCK? n : CYM_SYRK_BLOCK) * n * sizeof(*block));
+    if(!block){
+        if(deviation) *deviation = 0.0 / 0.0;
+        return -1;
+    }
+
+    // lines i0 to i0 + ib of mat * mat^dagger from column i0 on, mat^dagger being mat with swapped strides, conjugated
+    for(size_t i0 = 0; i0 < n && is_un; i0 += CYM_SYRK_BLOCK){
+        const size_t ib = (n - i0 < CYM_SYRK_BLOCK)? n - i0 : CYM_SYRK_BLOCK;
+        const size_t width = n - i0;
+        ICYM_FN(cym_cgemm)(ib, width, n, one, mat + i0 * n, (ptrdiff_t)n, 1, mat + i0 * n, 1, (ptrdiff_t)n, zero,
+            block, (ptrdiff_t)width, 1, CYM_CONJ_B);
+
+        for(size_t i = 0; i < ib; i+=1){
+            for(size_t j = i; j < width; j+=1){
+                const double re = (double)block[i * width + j].re - (i == j), im = (double)block[i * width + j].im;
+                const double e = icym_sqrt_d(re * re + im * im);
+                if(e > biggest) biggest = e;
+                // NaN fails as well
+                if(!(e < accuracy)) is_un = 0;
+            }
+        }
+    }
+
+    free(block);
+    if(deviation) *deviation = biggest;
+    return is_un;
+}
+
+int ICYM_FN(cym_ctest_unitary)(const ICYM_FN(CymComplex)* mat, unsigned int size, double accuracy){
+    return ICYM_FN(cym_ctest_unitary_deviation)(mat, size, accuracy, NULL) == 1;
+}
+
+// X==============X FIT ACCUMULATORS X=================X
+
+void ICYM_FN(cym_fit_acc_push)(CymFitAcc* acc, ICYM_T x, ICYM_T y){
+    const int order = acc->order;
+    const double u = (double)x - acc->center;
+    double power = 1;
+
+    for(int p = 0; p <= order; p+=1){
+        icym_fit_acc_add(acc, p, power);
+        icym_fit_acc_add(acc, 2 * order + 1 + p, power * y);
+        power *= u;
+    }
+    for(int p = order + 1; p <= 2 * order; p+=1){
+        icym_fit_acc_add(acc, p, power);
+        power *= u;
+    }
+    icym_fit_acc_add(acc, 3 * order + 2, (double)y * y);
+    acc->count += 1;
+}
+
+// the kernels sum blocks of ICYM_FIT_BLOCK points, whose sums then go through the compensated additions, the float
+// points are converted to double first so both precisions accumulate alike
+void ICYM_FN(cym_fit_acc_push_batch)(CymFitAcc* acc, const ICYM_T* x, const ICYM_T* y, size_t count){
+    const IcymKernels_d* kernels = icym_kernels_d();
+    const int terms = 3 * acc->order + 3;
+    double sums[3 * CYM_FIT_MAX_ORDER + 3];
+#if ICYM_F32
+    double xd[ICYM_FIT_BLOCK];
+    double yd[ICYM_FIT_BLOCK];
+#endif
+
+    for(size_t first = 0; first < count; first += ICYM_FIT_BLOCK){
+        const size_t block = (count - first < ICYM_FIT_BLOCK)? count - first : ICYM_FIT_BLOCK;
+#if ICYM_F32
+        for(size_t i = 0; i < block; i+=1){
+            xd[i] = x[first + i];
+            yd[i] = y[first + i];
+        }
+        kernels->fit_moments(block, xd, yd, acc->center, acc->order, sums);
+#else
+        kernels->fit_moments(block, x + first, y + first, acc->center, acc->order, sums);
+#endif
+        for(int t = 0; t < terms; t+=1) icym_fit_acc_add(acc, t, sums[t]);
+    }
+    acc->count += count;
+}
+
+/*
+    u0, u1, u2, u3 = u0y
+    u1, u2, u3, u4 = u1y
+    u2, u3, u4, u5 = u2y
+    u3, u4, u5, u6 = u3y
+    with u = (x - center) / scale, scale equilibrating the system, the solution is then expanded back to powers of x
+*/
+int ICYM_FN(cym_fit_acc_poly)(const CymFitAcc* acc, ICYM_T* output){
+    const int order   = acc->order;
+    const int columns = order + 1;
+    if(acc->count < (uint64_t)columns) return 1;
+
+    double moments[3 * CYM_FIT_MAX_ORDER + 3];
+    for(int t = 0; t < 3 * order + 3; t+=1) moments[t] = acc->sums[t] + acc->compensations[t];
+
+    // the root mean square of x - center
+    double scale = (order > 0)? icym_sqrt_d(moments[2] / moments[0]) : 1;
+    if(!(scale > 0) || scale - scale != 0) scale = 1;
+    double powers[2 * CYM_FIT_MAX_ORDER + 1];
+    powers[0] = 1;
+    for(int n = 1; n <= 2 * order; n+=1) powers[n] = powers[n - 1] / scale;
+
+    double system[(CYM_FIT_MAX_ORDER + 1) * (CYM_FIT_MAX_ORDER + 1)];
+    double rhs[CYM_FIT_MAX_ORDER + 1] = {0};
+    double coefficients[CYM_FIT_MAX_ORDER + 1];
+    unsigned int pivots[CYM_FIT_MAX_ORDER + 1];
+    for(int n = 0; n < columns; n+=1){
+        for(int m = 0; m < columns; m+=1){
+            system[n * columns + m] = moments[n + m] * powers[n + m];
+        }
+        rhs[n] = moments[2 * order + 1 + n] * powers[n];
+    }
+
+    if(cym_lu_factor_d(system, columns, pivots)) return 1;
+    cym_lu_solve_d(system, pivots, columns, rhs, coefficients);
+
+    for(int n = 0; n < columns; n+=1) coefficients[n] *= powers[n];
+
+    // p(x) = q(x - center), taylor shift of q by -center
+    for(int i = 0; i < order; i+=1){
+        for(int j = order - 1; j >= i; j-=1) coefficients[j] -= acc->center * coefficients[j + 1];
+    }
+
+    for(int n = 0; n < columns; n+=1) output[n] = (ICYM_T)coefficients[n];
+    return 0;
+}
+
+int ICYM_FN(cym_fit_acc_linear)(const CymFitAcc* acc, ICYM_T* a, ICYM_T* b, ICYM_T* r){
+    const int order = acc->order;
+    const double nan = 0.0 / 0.0;
+    *a = *b = *r = (ICYM_T)nan;
+    if(order < 1) return 1;
+
+    double m[3 * CYM_FIT_MAX_ORDER + 3];
+    for(int t = 0; t < 3 * order + 3; t+=1) m[t] = acc->sums[t] + acc->compensations[t];
+
+    const double n   = m[0];
+    const double su  = m[1];
+    const double sy  = m[2 * order + 1];
+    // the sums of squares and products around the means
+    const double suu = m[2] - su * su / n;
+    const double suy = m[2 * order + 2] - su * sy / n;
+    const double syy = m[3 * order + 2] - sy * sy / n;
+    if(!(suu > 0)) return 1;
+
+    const double slope = suy / suu;
+    *a = (ICYM_T)slope;
+    *b = (ICYM_T)((sy - slope * su) / n - slope * acc->center);
+    *r = (ICYM_T)(suy / icym_sqrt_d(suu * syy));
+    return 0;
+}
+
+typedef struct ICYM_FN(ICymFitJob){
+    const ICYM_T* x;
+    const ICYM_T* y;
+    int order;
+    double center;
+} ICYM_FN(ICymFitJob);
+
+static void ICYM_FN(icym_fit_task)(size_t begin, size_t end, void* partial, void* user){
+    const ICYM_FN(ICymFitJob)* job = (const ICYM_FN(ICymFitJob)*)user;
+    cym_fit_acc_init((CymFitAcc*)partial, job->order, job->center);
+    ICYM_FN(cym_fit_acc_push_batch)((CymFitAcc*)partial, job->x + begin, job->y + begin, end - begin);
+}
+
+// fills acc with the points, chunk by chunk in parallel, centered on the mean of up to 64 evenly spaced x values
+static void ICYM_FN(icym_fit_acc_fill)(CymFitAcc* acc, const ICYM_T* x, const ICYM_T* y, size_t number_of_points, int order){
+    const size_t stride  = (number_of_points > 64)? number_of_points / 64 : 1;
+    size_t samples = 0;
+    double center  = 0;
+    for(size_t i = 0; i < number_of_points; i += stride){
+        center  += x[i];
+        samples += 1;
+    }
+    if(samples) center /= (double)samples;
+
+    // the chunks only depend on the number of points, so the sums are the same for any number of threads
+    size_t grain = (number_of_points + 255) / 256;
+    if(grain < 4096) grain = 4096;
+
+    ICYM_FN(ICymFitJob) job = { x, y, order, center };
+    cym_fit_acc_init(acc, order, center);
+    if(cym_parallel_reduce(0, number_of_points, grain, acc, sizeof(CymFitAcc), ICYM_FN(icym_fit_task), icym_fit_acc_combine, &job)){
+        ICYM_FN(cym_fit_acc_push_batch)(acc, x, y, number_of_points);
+    }
+}
+
+// X==============X DATA ANALYSIS X=================X
+
+// chunks of about CYM_BATCH_GRAIN multiply adds
+static size_t ICYM_FN(icym_poly_grain)(int order, size_t polys){
+    const size_t work = ((size_t)order + 1) * (polys? polys : 1);
+    return (CYM_BATCH_GRAIN / work > 1024)? CYM_BATCH_GRAIN / work : 1024;
+}
+
+// cym_newton_coefficients with the n doubles of scratch the Leja ordering scores the nodes in
+static int ICYM_FN(icym_newton_coefficients)(const ICYM_T* x, const ICYM_T* y, size_t n, ICYM_T* nodes, ICYM_T* coefficients,
+    double* scores){
+
+    ICYM_T* c = coefficients;
+    if(nodes != x) for(size_t i = 0; i < n; i+=1) nodes[i] = x[i];
+    if(c != y) for(size_t i = 0; i < n; i+=1) c[i] = y[i];
+    if(n == 0) return 0;
+
+    // scores[i] is the product of the distances of nodes[i] to the nodes already placed, the distances being scaled by 4 over
+    // the span of the nodes (the capacity of an interval being a quarter of its length) and the products by the last biggest,
+    // so they neither overflow nor underflow
+    double low = nodes[0], high = nodes[0];
+    size_t pick = 0;
+    for(size_t i = 0; i < n; i+=1){
+        if(nodes[i] < low)  low  = nodes[i];
+        if(nodes[i] > high) high = nodes[i];
+        if(CYM_ABS(nodes[i]) > CYM_ABS(nodes[pick])) pick = i;
+        scores[i] = 1;
+    }
+    const double scale = (high > low)? 4 / (high - low) : 1;
+
+    for(size_t k = 0; k + 1 < n; k+=1){
+        if(k > 0){
+            pick = k;
+            for(size_t i = k + 1; i < n; i+=1) if(scores[i] > scores[pick]) pick = i;
+        }
+        const ICYM_T node = nodes[pick], value = c[pick];
+        const double score = scores[pick];
+        nodes[pick]  = nodes[k];
+        c[pick]      = c[k];
+        scores[pick] = scores[k];
+        nodes[k] = node;
+        c[k]     = value;
+
+        const double norm = (score > 0)? scale / score : scale;
+        for(size_t i = k + 1; i < n; i+=1) scores[i] *= CYM_ABS((double)nodes[i] - node) * norm;
+    }
+
+    // column j of the table overwrites c[j..n) from the bottom so c[i - 1] still holds column j - 1
+    for(size_t j = 1; j < n; j+=1){
+        for(size_t i = n - 1; i >= j; i-=1){
+            const ICYM_T step = nodes[i] - nodes[i - j];
+            if(step == 0){
+                for(size_t k = 0; k < n; k+=1) c[k] = (ICYM_T)(0.0 / 0.0);
+                return 1;
+            }
+            c[i] = (c[i] - c[i - 1]) / step;
+        }
+    }
+    return 0;
+}
+
+int ICYM_FN(cym_newton_coefficients)(const ICYM_T* x, const ICYM_T* y, size_t n, ICYM_T* nodes, ICYM_T* coefficients){
+    uint8_t stack[ICYM_STACK_WORKSPACE];
+    const size_t workspace_size = ICYM_WORKSPACE_ALIGN + icym_workspace_bytes(n * sizeof(double));
+    void* workspace = icym_workspace_alloc(workspace_size, stack);
+    ICymWorkspace ws = icym_workspace(workspace, workspace_size);
+    double* scores = (double*)icym_workspace_take(&ws, n * sizeof(double));
+    if(!scores){
+        for(size_t k = 0; k < n; k+=1) coefficients[k] = (ICYM_T)(0.0 / 0.0);
+        return 1;
+    }
+    const int status = ICYM_FN(icym_newton_coefficients)(x, y, n, nodes, coefficients, scores);
+    icym_workspace_free(workspace, stack);
+    return status;
+}
+
+ICYM_T ICYM_FN(cym_newton_eval)(const ICYM_T* nodes, const ICYM_T* coefficients, size_t n, ICYM_T t){
+    if(n == 0) return 0;
+    ICYM_T r = coefficients[n - 1];
+    for(size_t k = n - 1; k > 0; k-=1) r = r * (t - nodes[k - 1]) + coefficients[k - 1];
+    return r;
+}
+
+void ICYM_FN(cym_newton_to_monomial)(const ICYM_T* nodes, const ICYM_T* coefficients, size_t n, ICYM_T* output){
+    if(n == 0) return;
+    if(output != coefficients) for(size_t i = 0; i < n; i+=1) output[i] = coefficients[i];
+
+    // output[k + 1..n) holds the monomial coefficients of c_{k + 1} + (t - x_{k + 1}) * (...), multiplying it by (t - x_k)
+    // shifts it one place down onto c_k, which then gets added, so every step is a single in place pass going up
+    for(size_t k = n - 1; k > 0; k-=1){
+        const ICYM_T xk = nodes[k - 1];
+        for(size_t i = k - 1; i + 1 < n; i+=1) output[i] -= xk * output[i + 1];
+    }
+}
+
+// 2^512 and 2^-512, by which the barycentric products are rescaled exactly
+#define ICYM_BARY_BIG   1.3407807929942597e154
+#define ICYM_BARY_SMALL 7.458340731200207e-155
+
+// \returns the product of the scaled differences of node j to the others as p * 2^(512 * exponent) with 1 <= |p| < 2^512,
+// since the partial products of many nodes leave the range of a double long before the whole product does
+static double ICYM_FN(icym_barycentric_product)(const ICYM_T* x, size_t n, size_t j, double scale, int* exponent){
+    double product = 1;
+    int e = 0;
+    for(size_t k = 0; k < n; k+=1){
+        if(k == j) continue;
+        product *= scale * ((double)x[j] - (double)x[k]);
+        if(product == 0) break;
+        if(CYM_ABS(product) >= ICYM_BARY_BIG){
+            product *= ICYM_BARY_SMALL;
+            e += 1;
+        } else if(CYM_ABS(product) < ICYM_BARY_SMALL){
+            product *= ICYM_BARY_BIG;
+            e -= 1;
+        }
+    }
+    while(product != 0 && CYM_ABS(product) < 1){
+        product *= ICYM_BARY_BIG;
+        e -= 1;
+    }
+    *exponent = e;
+    return product;
+}
+
+int ICYM_FN(cym_barycentric_weights)(const ICYM_T* x, size_t n, ICYM_T* weights){
+    if(n == 0) return 0;
+
+    ICYM_T low = x[0], high = x[0];
+    for(size_t i = 1; i < n; i+=1){
+        if(x[i] < low)  low  = x[i];
+        if(x[i] > high) high = x[i];
+    }
+    // the differences scaled by 4 / span have a product of order 1 for well spread nodes (the capacity of an interval is a
+    // quarter of its length), the common factor cancelling in the second barycentric form
+    const double scale = (high > low)? 4.0 / ((double)high - (double)low) : 1.0;
+
+    // the smallest product gives the biggest weight, which the weights are normalized by, the products being computed twice
+    // instead of stored
+    double smallest = 0;
+    int smallest_exponent = 0;
+    for(size_t j = 0; j < n; j+=1){
+        int e;
+        const double product = ICYM_FN(icym_barycentric_product)(x, n, j, scale, &e);
+        if(product == 0){
+            for(size_t i = 0; i < n; i+=1) weights[i] = (ICYM_T)(0.0 / 0.0);
+            return 1;
+        }
+        if(j == 0 || e < smallest_exponent || (e == smallest_exponent && CYM_ABS(product) < smallest)){
+            smallest = CYM_ABS(product);
+            smallest_exponent = e;
+        }
+    }
+    for(size_t j = 0; j < n; j+=1){
+        int e;
+        double w = smallest / ICYM_FN(icym_barycentric_product)(x, n, j, scale, &e);
+        for(; e > smallest_exponent && w != 0; e-=1) w *= ICYM_BARY_SMALL;
+        weights[j] = (ICYM_T)w;
+    }
+    return 0;
+}
+
+#undef ICYM_BARY_SMALL
+#undef ICYM_BARY_BIG
+
+ICYM_T ICYM_FN(cym_barycentric_eval)(const ICYM_T* x, const ICYM_T* y, const ICYM_T* weights, size_t n, ICYM_T t){
+    ICYM_T num = 0, den = 0;
+    for(size_t j = 0; j < n; j+=1){
+        const ICYM_T d = t - x[j];
+        if(d == 0) return y[j];
+        const ICYM_T q = weights[j] / d;
+        num += q * y[j];
+        den += q;
+    }
+    return (n == 0)? 0 : num / den;
+}
+
+typedef struct ICYM_FN(ICymInterpolEval){
+    const ICYM_FN(IcymKernels)* kernels;
+    const ICYM_T* x;
+    const ICYM_T* y;
+    const ICYM_T* weights;
+    size_t n;
+    const ICYM_T* t;
+    ICYM_T* out;
+    ICYM_T scale;
+} ICYM_FN(ICymInterpolEval);
+
+static void ICYM_FN(icym_newton_eval_task)(size_t begin, size_t end, void* user){
+    const ICYM_FN(ICymInterpolEval)* job = (const ICYM_FN(ICymInterpolEval)*)user;
+    job->kernels->newton_eval(end - begin, job->t + begin, job->x, job->y, job->n, job->out + begin);
+}
+
+static void ICYM_FN(icym_barycentric_eval_task)(size_t begin, size_t end, void* user){
+    const ICYM_FN(ICymInterpolEval)* job = (const ICYM_FN(ICymInterpolEval)*)user;
+    ICYM_T* out = job->out;
+    job->kernels->barycentric_eval(end - begin, job->t + begin, job->x, job->y, job->weights, job->n, job->scale, out + begin);
+    // the values on a node (or so close to one that a quotient overflowed) are left NaN or inf by the kernel
+    for(size_t i = begin; i < end; i+=1){
+        if(out[i] - out[i] != 0) out[i] = ICYM_FN(cym_barycentric_eval)(job->x, job->y, job->weights, job->n, job->t[i]);
+    }
+}
+
+void ICYM_FN(cym_newton_eval_batch)(const ICYM_T* nodes, const ICYM_T* coefficients, size_t n, const ICYM_T* t, size_t count,
+    ICYM_T* out){
+
+    if(n == 0){
+        for(size_t i = 0; i < count; i+=1) out[i] = 0;
+        return;
+    }
+    ICYM_FN(ICymInterpolEval) job = { ICYM_FN(icym_kernels)(), nodes, coefficients, NULL, n, t, out, 1 };
+    cym_parallel_for(0, count, ICYM_FN(icym_poly_grain)((int)n - 1, 1), ICYM_FN(icym_newton_eval_task), &job);
+}
+
+void ICYM_FN(cym_barycentric_eval_batch)(const ICYM_T* x, const ICYM_T* y, const ICYM_T* weights, size_t n, const ICYM_T* t,
+    size_t count, ICYM_T* out){
+
+    if(n == 0){
+        for(size_t i = 0; i < count; i+=1) out[i] = 0;
+        return;
+    }
+    // the power of 2 closest to 4 over the span of the nodes, so scaling the differences is exact
+    ICYM_T low = x[0], high = x[0];
+    for(size_t j = 1; j < n; j+=1){
+        if(x[j] < low)  low  = x[j];
+        if(x[j] > high) high = x[j];
+    }
+    const double span = (double)high - (double)low;
+    double scale = 1;
+    if(span > 0 && span - span == 0){
+        while(scale * span > 8)  scale *= 0.5;
+        while(scale * span < 2) scale *= 2;
+    }
+
+    // half a division and 4 multiply adds per node, about 4 times the multiply add of a Newton step
+    ICYM_FN(ICymInterpolEval) job = { ICYM_FN(icym_kernels)(), x, y, weights, n, t, out, (ICYM_T)scale };
+    cym_parallel_for(0, count, ICYM_FN(icym_poly_grain)(4 * (int)n - 1, 1), ICYM_FN(icym_barycentric_eval_task), &job);
+}
+
+size_t ICYM_FN(cym_interpol_workspace_size)(size_t number_of_points){
+    return ICYM_WORKSPACE_ALIGN + icym_workspace_bytes(number_of_points * sizeof(ICYM_T)) +
+        icym_workspace_bytes(number_of_points * sizeof(double));
+}
+
+int ICYM_FN(cym_interpol_ws)(const ICYM_T* x, const ICYM_T* y, size_t number_of_points, ICYM_T* output, void* workspace,
+    size_t workspace_size){
+
+    ICymWorkspace ws = icym_workspace(workspace, workspace_size);
+    ICYM_T* nodes  = (ICYM_T*)icym_workspace_take(&ws, number_of_points * sizeof(ICYM_T));
+    double* scores = (double*)icym_workspace_take(&ws, number_of_points * sizeof(double));
+    if(!nodes || !scores){
+        for(size_t i = 0; i < number_of_points; i+=1) output[i] = (ICYM_T)(0.0 / 0.0);
+        return 1;
+    }
+
+    if(ICYM_FN(icym_newton_coefficients)(x, y, number_of_points, nodes, output, scores)) return 1;
+    ICYM_FN(cym_newton_to_monomial)(nodes, output, number_of_points, output);
+    return 0;
+}
+
+int ICYM_FN(cym_interpol)(const ICYM_T* x, const ICYM_T* y, size_t number_of_points, ICYM_T* output){
+    uint8_t stack[ICYM_STACK_WORKSPACE];
+    const size_t workspace_size = ICYM_FN(cym_interpol_workspace_size)(number_of_points);
+    void* workspace = icym_workspace_alloc(workspace_size, stack);
+    const int status = ICYM_FN(cym_interpol_ws)(x, y, number_of_points, output, workspace, workspace? workspace_size : 0);
+    icym_workspace_free(workspace, stack);
+    return status;
+}
+
+void ICYM_FN(cym_linear_fit)(const ICYM_T* x, const ICYM_T* y, size_t number_of_points, ICYM_T* a, ICYM_T* b, ICYM_T* r){
+    CymFitAcc acc;
+    ICYM_FN(icym_fit_acc_fill)(&acc, x, y, number_of_points, 1);
+    ICYM_FN(cym_fit_acc_linear)(&acc, a, b, r);
+}
+
+// one dataset of the fits with errors on both axes, its weighted moments being summed around (xc, yc)
+typedef struct ICYM_FN(ICymRlinearJob){
+    const ICYM_FN(IcymKernels)* kernels;
+    const ICYM_T* x;
+    const ICYM_T* y;
+    const ICYM_T* dx;
+    const ICYM_T* dy;
+    ICYM_T slope;
+    ICYM_T xc;
+    ICYM_T yc;
+} ICYM_FN(ICymRlinearJob);
+
+static void ICYM_FN(icym_rlinear_task)(size_t begin, size_t end, void* partial, void* user){
+    const ICYM_FN(ICymRlinearJob)* job = (const ICYM_FN(ICymRlinearJob)*)user;
+    double* total = (double*)partial;
+    for(int k = 0; k < 5; k+=1) total[k] = 0;
+
+    for(size_t first = begin; first < end; first += 1024){
+        const size_t block = (end - first < 1024)? end - first : 1024;
+        ICYM_T sums[5];
+        job->kernels->weighted_moments(block, job->x + first, job->y + first, job->dx + first, job->dy + first, job->slope,
+            job->xc, job->yc, sums);
+        for(int k = 0; k < 5; k+=1) total[k] += sums[k];
+    }
+}
+
+static void ICYM_FN(icym_rlinear_combine)(void* result, const void* partial, void* user){
+    (void)user;
+    for(int k = 0; k < 5; k+=1) ((double*)result)[k] += ((const double*)partial)[k];
+}
+
+// the weighted fit with the weights of job->slope, in a single pass over the points, out being A, B, dA and dB
+// \returns 1 if the weighted x values are degenerate
+static int ICYM_FN(icym_rlinear_pass)(const ICYM_FN(ICymRlinearJob)* job, size_t n, double* out){
+    double sums[5] = { 0, 0, 0, 0, 0 };
+    if(cym_parallel_reduce(0, n, CYM_BATCH_GRAIN, sums, sizeof(sums), ICYM_FN(icym_rlinear_task), ICYM_FN(icym_rlinear_combine),
+        (void*)job)){
+        ICYM_FN(icym_rlinear_task)(0, n, sums, (void*)job);
+    }
+
+    const double sw = sums[0], swu = sums[1], swuu = sums[2], swv = sums[3], swuv = sums[4];
+    const double xc = (double)job->xc;
+    const double val = sw * swuu - swu * swu;
+    if(!(val > 0) || !(sw > 0) || val * 0 != 0) return 1;
+
+    const double slope = (sw * swuv - swu * swv) / val;
+    out[0] = slope;
+    out[1] = (swv - swu * slope) / sw + (double)job->yc - slope * xc;
+    out[2] = icym_sqrt_d(sw / val);
+    // the sum of w x^2 moved back from around xc
+    out[3] = icym_sqrt_d((swuu + 2 * xc * swu + xc * xc * sw) / val);
+    return 0;
+}
+
+// fits one dataset, slope being the warm start or NULL
+// \returns 0 on success, 1 if the points are degenerate, 2 if the slope did not converge
+static int ICYM_FN(icym_rlinear_fit)(const ICYM_T* x, const ICYM_T* y, const ICYM_T* dx, const ICYM_T* dy, size_t n,
+    const ICYM_T* slope, ICYM_T* a, ICYM_T* b, ICYM_T* da, ICYM_T* db, ICYM_T* r){
+
+    const double eps = ICYM_F32? FLT_EPSILON : DBL_EPSILON;
+    const ICYM_T nan = (ICYM_T)(0.0 / 0.0);
+    *a = *b = *da = *db = nan;
+    if(r) *r = nan;
+    if(n < 2) return 1;
+
+    ICYM_FN(ICymRlinearJob) job = { ICYM_FN(icym_kernels)(), x, y, dx, dy, 0, x[n / 2], y[n / 2] };
+    if(!slope || r){
+        // the unweighted fit gives the correlation, the centers and the cold start
+        CymFitAcc acc;
+        ICYM_T ua, ub, ur;
+        ICYM_FN(icym_fit_acc_fill)(&acc, x, y, n, 1);
+        if(ICYM_FN(cym_fit_acc_linear)(&acc, &ua, &ub, &ur)) return 1;
+        if(r) *r = ur;
+        job.slope = ua;
+        job.xc = (ICYM_T)(acc.center + acc.sums[1] / acc.sums[0]);
+        job.yc = (ICYM_T)(acc.sums[3] / acc.sums[0]);
+    }
+    if(slope) job.slope = *slope;
+
+    // the slope is the fixed point of s -> F(s), F being a weighted pass with the weights of s: two passes from s0 give s1 and
+    // s2, and Aitken's extrapolation s2 - (s2 - s1)^2 / (s2 - 2 s1 + s0) is the next s0 (Steffensen's method)
+    double out[4];
+    double s0 = (double)job.slope, s1 = 0;
+    int have_s1 = 0, status = 2;
+    for(int pass = 0; pass < CYM_RLINEAR_ITERATIONS; pass+=1){
+        const double current = have_s1? s1 : s0;
+        job.slope = (ICYM_T)current;
+        if(ICYM_FN(icym_rlinear_pass)(&job, n, out)) return 1;
+        const double s = out[0];
+        if(CYM_ABS(s - current) <= icym_sqrt_d(eps) * (CYM_ABS(s) + out[2])){
+            status = 0;
+            break;
+        }
+
+        if(!have_s1){
+            s1 = s;
+            have_s1 = 1;
+            continue;
+        }
+        const double denominator = s - 2 * s1 + s0;
+        const double extrapolated = (denominator != 0)? s - (s - s1) * (s - s1) / denominator : s;
+        s0 = (extrapolated * 0 == 0)? extrapolated : s;
+        have_s1 = 0;
+    }
+
+    *a  = (ICYM_T)out[0];
+    *b  = (ICYM_T)out[1];
+    *da = (ICYM_T)out[2];
+    *db = (ICYM_T)out[3];
+    return status;
+}
+
+int ICYM_FN(cym_rlinear_fit)(const ICYM_T* x, const ICYM_T* y, const ICYM_T* dx, const ICYM_T* dy,
+        size_t number_of_points, ICYM_T* a, ICYM_T* b, ICYM_T* da, ICYM_T* db ,ICYM_T* r){
+
+    return ICYM_FN(icym_rlinear_fit)(x, y, dx, dy, number_of_points, NULL, a, b, da, db, r) != 0;
+}
+
+typedef struct ICYM_FN(ICymRlinearBatch){
+    const ICYM_T* x;
+    const ICYM_T* y;
+    const ICYM_T* dx;
+    const ICYM_T* dy;
+    size_t        points;
+    const ICYM_T* slopes;
+    ICYM_T*       a;
+    ICYM_T*       b;
+    ICYM_T*       da;
+    ICYM_T*       db;
+    ICYM_T*       r;
+    int           failed;
+} ICYM_FN(ICymRlinearBatch);
+
+static void ICYM_FN(icym_rlinear_batch_task)(size_t begin, size_t end, void* user){
+    ICYM_FN(ICymRlinearBatch)* job = (ICYM_FN(ICymRlinearBatch)*)user;
+    for(size_t s = begin; s < end; s+=1){
+        const size_t offset = s * job->points;
+        if(ICYM_FN(icym_rlinear_fit)(job->x + offset, job->y + offset, job->dx + offset, job->dy + offset, job->points,
+            job->slopes? job->slopes + s : NULL, job->a + s, job->b + s, job->da + s, job->db + s, job->r? job->r + s : NULL)){
+            __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+int ICYM_FN(cym_rlinear_fit_batch)(const ICYM_T* x, const ICYM_T* y, const ICYM_T* dx, const ICYM_T* dy, size_t number_of_points,
+    size_t series, const ICYM_T* slopes, ICYM_T* a, ICYM_T* b, ICYM_T* da, ICYM_T* db, ICYM_T* r){
+
+    ICYM_FN(ICymRlinearBatch) job = { x, y, dx, dy, number_of_points, slopes, a, b, da, db, r, 0 };
+    // a single dataset keeps the thread pool for its passes, many small ones are fitted a few per task
+    const size_t grain = (number_of_points >= CYM_BATCH_GRAIN)? 1 : CYM_BATCH_GRAIN / (number_of_points + 1) + 1;
+    cym_parallel_for(0, series, grain, ICYM_FN(icym_rlinear_batch_task), &job);
+    return job.failed;
+}
+
+typedef struct ICYM_FN(ICymPolyJob){
+    const ICYM_T* x;
+    // the y values of the first series, the others following every points values
+    const ICYM_T* y;
+    size_t points;
+    size_t count;
+    size_t columns;
+    // u = (x - shift) * scale maps x to [-1, 1]
+    ICYM_T shift;
+    ICYM_T scale;
+    int cholesky;
+    int failed;
+    // 2 * columns lines of [R | Q^T * y] and the taus for the combination of the partials, with the scratch of their qr
+    ICYM_T* merge;
+    ICymWorkspace merge_ws;
+    // the chunks of grain points, their partials and the scratch of each worker, scratch_size bytes apart
+    size_t grain;
+    ICYM_T* partials;
+    uint8_t* scratch;
+    size_t scratch_size;
+} ICYM_FN(ICymPolyJob);
+
+// \returns the bytes of scratch icym_poly_fit_task needs, for the qr and the normal equations alike
+static size_t ICYM_FN(icym_poly_fit_task_size)(size_t columns, size_t width){
+    const size_t qr       = ICYM_FN(icym_qr_workspace_size)(columns + CYM_LSQ_ROWS, width, columns);
+    const size_t cholesky = ICYM_FN(cym_gemm_workspace_size)(columns, width, CYM_LSQ_ROWS);
+    return ICYM_WORKSPACE_ALIGN + icym_workspace_bytes(((columns + CYM_LSQ_ROWS) * width + columns) * sizeof(ICYM_T))
+        + ((qr > cholesky)? qr : cholesky);
+}
+
+// partial is the columns x (columns + count) matrix [R | Q^T * y] of the qr of the design lines (1, u, u^2, ...) of the
+// points [begin, end) and their y values, or [D^T * D | D^T * y] for the normal equations, streamed by CYM_LSQ_ROWS points
+static void ICYM_FN(icym_poly_fit_task)(size_t begin, size_t end, ICYM_T* partial, ICymWorkspace ws, ICYM_FN(ICymPolyJob)* job){
+    const size_t columns = job->columns;
+    const size_t width   = columns + job->count;
+    ICYM_T* top = partial;
+
+    // the lines of a block go under the columns lines of [R | Q^T * y] so each step is the qr of both
+    const size_t lead = job->cholesky? 0 : columns;
+    ICYM_T* m = (ICYM_T*)icym_workspace_take(&ws, ((lead + CYM_LSQ_ROWS) * width + columns) * sizeof(ICYM_T));
+    if(!m){
+        job->failed = 1;
+        return;
+    }
+    ICYM_T* lines = m + lead * width;
+    ICYM_T* tau   = lines + CYM_LSQ_ROWS * width;
+
+    for(size_t i = 0; i < columns * width; i+=1) top[i] = m[i] = 0;
+
+    for(size_t first = begin; first < end; first += CYM_LSQ_ROWS){
+        const size_t block = (end - first < CYM_LSQ_ROWS)? end - first : CYM_LSQ_ROWS;
+
+        for(size_t i = 0; i < block; i+=1){
+            const ICYM_T u = (job->x[first + i] - job->shift) * job->scale;
+            ICYM_T power = 1;
+            for(size_t j = 0; j < columns; j+=1){
+                lines[i * width + j] = power;
+                power *= u;
+            }
+        }
+        for(size_t s = 0; s < job->count; s+=1){
+            const ICYM_T* ys = job->y + s * job->points + first;
+            for(size_t i = 0; i < block; i+=1) lines[i * width + columns + s] = ys[i];
+        }
+
+        if(job->cholesky){
+            ICYM_FN(cym_gemm_ws)(columns, width, block, 1, lines, 1, (ptrdiff_t)width, lines, (ptrdiff_t)width, 1, 1, top,
+                (ptrdiff_t)width, 1, ws.next, ws.left);
+            continue;
+        }
+        if(ICYM_FN(icym_qr_ws)(columns + block, width, columns, m, (ptrdiff_t)width, tau, ws)){
+            job->failed = 1;
+            break;
+        }
+        // the reflectors left under the diagonal of R
+        for(size_t i = 1; i < columns; i+=1){
+            for(size_t j = 0; j < i; j+=1) m[i * width + j] = 0;
+        }
+    }
+
+    if(!job->cholesky) for(size_t i = 0; i < columns * width; i+=1) top[i] = m[i];
+}
+
+static void ICYM_FN(icym_poly_fit_chunk)(size_t chunk, unsigned int worker, void* user){
+    ICYM_FN(ICymPolyJob)* job = (ICYM_FN(ICymPolyJob)*)user;
+    const size_t begin = chunk * job->grain;
+    const size_t end   = (job->points - begin < job->grain)? job->points : begin + job->grain;
+    ICYM_FN(icym_poly_fit_task)(begin, end, job->partials + chunk * job->columns * (job->columns + job->count),
+        icym_workspace(job->scratch + (size_t)worker * job->scratch_size, job->scratch_size), job);
+}
+
+// the normal equations add up, the qr partials are stacked and factored again
+static void ICYM_FN(icym_poly_fit_combine)(ICYM_T* result, const ICYM_T* partial, ICYM_FN(ICymPolyJob)* job){
+    const size_t columns = job->columns;
+    const size_t width   = columns + job->count;
+    ICYM_T* r = result;
+    const ICYM_T* p = partial;
+
+    if(job->cholesky){
+        for(size_t i = 0; i < columns * width; i+=1) r[i] += p[i];
+        return;
+    }
+
+    ICYM_T* m = job->merge;
+    for(size_t i = 0; i < columns * width; i+=1){
+        m[i] = r[i];
+        m[columns * width + i] = p[i];
+    }
+    ICYM_T* tau = m + 2 * columns * width;
+    if(ICYM_FN(icym_qr_ws)(2 * columns, width, columns, m, (ptrdiff_t)width, tau, job->merge_ws)) job->failed = 1;
+    for(size_t i = 0; i < columns; i+=1){
+        for(size_t j = 0; j < width; j+=1) r[i * width + j] = (j < i)? 0 : m[i * width + j];
+    }
+}
+
+// the chunks only depend on the number of points, so the fit is the same for any number of threads
+static size_t ICYM_FN(icym_poly_fit_grain)(size_t points){
+    const size_t grain = (points + 255) / 256;
+    return (grain < 4096)? 4096 : grain;
+}
+
+// \returns the bytes of workspace icym_poly_fit_group needs with workers threads
+static size_t ICYM_FN(icym_poly_fit_group_size)(size_t points, size_t count, size_t columns, unsigned int workers){
+    const size_t width  = columns + count;
+    const size_t grain  = ICYM_FN(icym_poly_fit_grain)(points);
+    const size_t chunks = (points + grain - 1) / grain;
+    if(workers < 2 || chunks < 2) workers = 1;
+    return ICYM_WORKSPACE_ALIGN + icym_workspace_bytes(((3 * columns) * width + columns + columns * columns) * sizeof(ICYM_T))
+        + icym_workspace_bytes(ICYM_FN(icym_qr_workspace_size)(2 * columns, width, columns))
+        + icym_workspace_bytes(((workers > 1)? chunks : 1) * columns * width * sizeof(ICYM_T))
+        + workers * ICYM_FN(icym_poly_fit_task_size)(columns, width);
+}
+
+// fits the count series sharing the x values, their y values following every points values, writing their columns
+// coefficients to output one series after the other, with their scratch taken from workspace (allocated when it is NULL),
+// the scratch of the threads being left out when it does not fit, the fit then running serially
+// \returns 0 on success, 1 otherwise (the coefficients are then NaN)
+static int ICYM_FN(icym_poly_fit_group)(const ICYM_T* x, const ICYM_T* y, size_t points, size_t count, size_t columns,
+    int flags, ICYM_T* output, const ICymWorkspace* workspace){
+
+    const size_t width = columns + count;
+    const size_t grain = ICYM_FN(icym_poly_fit_grain)(points);
+    const size_t chunks = (points + grain - 1) / grain;
+    int info = 1;
+
+    uint8_t stack[ICYM_STACK_WORKSPACE];
+    void* allocated = NULL;
+    ICymWorkspace ws = icym_workspace(NULL, 0);
+    if(workspace){
+        ws = *workspace;
+    } else if(points >= columns){
+        const size_t size = ICYM_FN(icym_poly_fit_group_size)(points, count, columns, icym_parallel_workers(chunks));
+        allocated = icym_workspace_alloc(size, stack);
+        ws = icym_workspace(allocated, size);
+    }
+    const size_t merge_size = ICYM_FN(icym_qr_workspace_size)(2 * columns, width, columns);
+    ICYM_T* result = (points >= columns)?
+        (ICYM_T*)icym_workspace_take(&ws, ((3 * columns) * width + columns + columns * columns) * sizeof(ICYM_T)) : NULL;
+    void* merge = icym_workspace_take(&ws, merge_size);
+
+    // a partial per chunk and a scratch per worker, or a single one of each for a serial run
+    const size_t task_size = ICYM_FN(icym_poly_fit_task_size)(columns, width);
+    unsigned int workers = icym_parallel_workers(chunks);
+    ICYM_T* partials = NULL;
+    uint8_t* scratch = NULL;
+    if(workers > 1){
+        ICymWorkspace threads = ws;
+        partials = (ICYM_T*)icym_workspace_take(&threads, chunks * columns * width * sizeof(ICYM_T));
+        scratch  = (uint8_t*)icym_workspace_take(&threads, workers * task_size);
+        if(partials && scratch) ws = threads;
+        else                    workers = 1;
+    }
+    if(workers == 1){
+        partials = (ICYM_T*)icym_workspace_take(&ws, columns * width * sizeof(ICYM_T));
+        scratch  = (uint8_t*)icym_workspace_take(&ws, task_size);
+    }
+
+    if(result && merge && partials && scratch){
+        ICYM_T xmin = x[0], xmax = x[0];
+        for(size_t i = 1; i < points; i+=1){
+            if(x[i] < xmin) xmin = x[i];
+            if(x[i] > xmax) xmax = x[i];
+        }
 
+        ICYM_FN(ICymPolyJob) job = {
+            x, y, points, count, columns, (xmax + xmin) / 2, (xmax > xmin)? 2 / (xmax - xmin) : 1,
+            (flags & CYM_LSQ_CHOLESKY) != 0, 0, result + columns * width, icym_workspace(merge, merge_size),
+            grain, partials, scratch, task_size
+        };
+        ICYM_T* normal = job.merge + 2 * columns * width + columns;
+
+        for(int attempt = 0; attempt < 2 && info; attempt+=1){
+            for(size_t i = 0; i < columns * width; i+=1) result[i] = 0;
+
+            // the partials are combined in chunk order, serially one partial is reused
+            if(workers > 1){
+                icym_parallel_run(chunks, ICYM_FN(icym_poly_fit_chunk), &job);
+                for(size_t chunk = 0; chunk < chunks; chunk+=1){
+                    ICYM_FN(icym_poly_fit_combine)(result, partials + chunk * columns * width, &job);
+                }
+            } else{
+                for(size_t first = 0; first < points; first += grain){
+                    ICYM_FN(icym_poly_fit_task)(first, (points - first < grain)? points : first + grain, partials,
+                        icym_workspace(scratch, task_size), &job);
+                    ICYM_FN(icym_poly_fit_combine)(result, partials, &job);
+                }
+            }
+            if(job.failed) break;
 
-static inline void cym_smatmul(const CYM_IMAT mat1, const CYM_IMAT mat2, CYM_FLOAT* output){
+            if(job.cholesky){
+                for(size_t i = 0; i < columns; i+=1){
+                    for(size_t j = 0; j < columns; j+=1) normal[i * columns + j] = result[i * width + j];
+                }
+                if(!ICYM_FN(cym_cholesky_factor)(normal, (unsigned int)columns)){
+                    ICYM_FN(icym_cholesky_solve_many)(normal, columns, result + columns, count, (ptrdiff_t)width, NULL);
+                    info = 0;
+                }
+                // too ill conditioned for the normal equations, the qr gets another try
+                job.cholesky = 0;
+            } else if(!ICYM_FN(icym_rank_deficient)(result, columns, (ptrdiff_t)width)){
+                ICYM_FN(icym_trsm_upper)(columns, count, result, (ptrdiff_t)width, result + columns, (ptrdiff_t)width, NULL);
+                info = 0;
+            } else{
+                break;
+            }
+        }
 
-    for(size_t i = 0; i < mat1.rows; i+=1){
-        for(size_t j = 0; j < mat2.columns; j+=1){
-            output[i * mat2.columns + j] = 0;
-            for(size_t n = 0; n < mat1.columns; n+=1){
-                output[i * mat2.columns + j] += mat1.data[i * mat1.stride + n] * mat2.data[n * mat2.stride + j];
+        // q(u) with u = (x - shift) * scale, to powers of x - shift, then taylor shift by -shift to powers of x
+        for(size_t s = 0; s < count && !info; s+=1){
+            ICYM_T* c = output + s * columns;
+            ICYM_T power = 1;
+            for(size_t j = 0; j < columns; j+=1){
+                c[j] = result[j * width + columns + s] * power;
+                power *= job.scale;
+            }
+            for(size_t i = 0; i + 1 < columns; i+=1){
+                for(size_t j = columns - 1; j-- > i;) c[j] -= job.shift * c[j + 1];
             }
         }
     }
+    if(allocated) icym_workspace_free(allocated, stack);
 
+    if(info){
+        const double nan = 0.0 / 0.0;
+        for(size_t i = 0; i < count * columns; i+=1) output[i] = (ICYM_T)nan;
+    }
+    return info;
 }
-*/
-/* TODO:
-void cym_multi_param_fit(CYM_FLOAT* input_data, size_t data_point_count,
-    CYM_FLOAT(*model)(CYM_FLOAT*), CYM_FLOAT* param, size_t param_count){
 
-    CYM_FLOAT cost;
+typedef struct ICYM_FN(ICymPolyBatch){
+    const ICYM_T* x;
+    size_t x_stride;
+    const ICYM_T* y;
+    size_t points;
+    size_t series;
+    // series fitted together, they share their x values
+    size_t group;
+    size_t columns;
+    int flags;
+    int failed;
+    ICYM_T* output;
+} ICYM_FN(ICymPolyBatch);
+
+static void ICYM_FN(icym_poly_fit_batch_task)(size_t begin, size_t end, void* user){
+    ICYM_FN(ICymPolyBatch)* batch = (ICYM_FN(ICymPolyBatch)*)user;
+    for(size_t g = begin; g < end; g+=1){
+        const size_t first = g * batch->group;
+        const size_t count = (batch->series - first < batch->group)? batch->series - first : batch->group;
+        if(ICYM_FN(icym_poly_fit_group)(batch->x + first * batch->x_stride, batch->y + first * batch->points, batch->points,
+            count, batch->columns, batch->flags, batch->output + first * batch->columns, NULL)) batch->failed = 1;
+    }
+}
 
-    const CYM_FLOAT accuracy = 1e-6, step = 1e-6;
+int ICYM_FN(cym_poly_fit_batch)(const ICYM_T* x, size_t x_stride, const ICYM_T* y, size_t number_of_points, size_t series,
+        int order, int flags, ICYM_T* output){
 
-    CYM_FLOAT* output = (CYM_FLOAT*)malloc((data_point_count + param_count) * sizeof(CYM_FLOAT));
-    CYM_FLOAT* grad   = output + data_point_count;
+    if(order < 0) return 1;
 
-    CYM_IMAT w = (CYM_IMAT){
-        .data    = param,
-        .rows    = param_count,
-        .columns = 1,
-        .stride  = 1
-    };
-    CYM_IMAT x = (CYM_IMAT){
-        .data    = input_data,
-        .rows    = data_point_count,
-        .columns = param_count,
-        .stride  = param_count + 1
-    };
-    CYM_IMAT y = (CYM_IMAT){
-        .data   = input_data + param_count,
-        .rows   = data_point_count, .columns = 1,
-        .stride = param_count + 1
+    // the series sharing x are fitted 64 at a time, one qr serving all of them
+    ICYM_FN(ICymPolyBatch) batch = { x, x_stride, y, number_of_points, series, (size_t)(x_stride? 1 : 64), (size_t)order + 1, flags, 0, output };
+    const size_t groups = (series + batch.group - 1) / batch.group;
+    if(groups == 1){
+        ICYM_FN(icym_poly_fit_batch_task)(0, 1, &batch);
+    } else{
+        const size_t grain = (number_of_points * batch.group < 4096)? 4096 / (number_of_points * batch.group + 1) + 1 : 1;
+        cym_parallel_for(0, groups, grain, ICYM_FN(icym_poly_fit_batch_task), &batch);
+    }
+    return batch.failed;
+}
+
+size_t ICYM_FN(cym_poly_fit_workspace_size)(size_t number_of_points, int order){
+    if(order < 0) return 0;
+    return ICYM_FN(icym_poly_fit_group_size)(number_of_points, 1, (size_t)order + 1, cym_get_num_threads());
+}
+
+int ICYM_FN(cym_poly_fit_ws)(const ICYM_T* x, const ICYM_T* y, size_t number_of_points, int order, ICYM_T* output,
+    void* workspace, size_t workspace_size){
+
+    if(order < 0) return 1;
+    const ICymWorkspace ws = icym_workspace(workspace, workspace_size);
+    return ICYM_FN(icym_poly_fit_group)(x, y, number_of_points, 1, (size_t)order + 1, CYM_LSQ_QR, output, &ws);
+}
+
+int ICYM_FN(cym_poly_fit)(const ICYM_T* x, const ICYM_T* y, size_t number_of_points, int order, ICYM_T* output){
+    return ICYM_FN(cym_poly_fit_batch)(x, 0, y, number_of_points, 1, order, CYM_LSQ_QR, output);
+}
+
+typedef struct ICYM_FN(ICymPolyEval){
+    const ICYM_FN(IcymKernels)* kernels;
+    const ICYM_T* coefficients;
+    int order;
+    size_t polys;
+    const ICYM_T* x;
+    const ICYM_T* y;
+    size_t n;
+    ICYM_T* out;
+    ICYM_T shift;
+} ICYM_FN(ICymPolyEval);
+
+static void ICYM_FN(icym_poly_eval_task)(size_t begin, size_t end, void* user){
+    const ICYM_FN(ICymPolyEval)* job = (const ICYM_FN(ICymPolyEval)*)user;
+    job->kernels->poly_eval(end - begin, job->x + begin, job->coefficients, job->order, job->polys, job->out + begin, job->n);
+}
+
+void ICYM_FN(cym_poly_eval_batch)(const ICYM_T* coefficients, int order, size_t polys, const ICYM_T* x, size_t n, ICYM_T* out){
+    if(order < 0){
+        for(size_t i = 0; i < polys * n; i+=1) out[i] = 0;
+        return;
+    }
+    ICYM_FN(ICymPolyEval) job = { ICYM_FN(icym_kernels)(), coefficients, order, polys, x, NULL, n, out, 0 };
+    cym_parallel_for(0, n, ICYM_FN(icym_poly_grain)(order, polys), ICYM_FN(icym_poly_eval_task), &job);
+}
+
+// partial holds the sums of icym_poly_residuals in double, gathered by blocks of 1024 points so float sums stay short
+static void ICYM_FN(icym_poly_residuals_task)(size_t begin, size_t end, void* partial, void* user){
+    const ICYM_FN(ICymPolyEval)* job = (const ICYM_FN(ICymPolyEval)*)user;
+    double* total = (double*)partial;
+    total[0] = total[1] = total[2] = 0;
+
+    for(size_t first = begin; first < end; first += 1024){
+        const size_t block = (end - first < 1024)? end - first : 1024;
+        ICYM_T sums[3];
+        job->kernels->poly_residuals(block, job->x + first, job->y + first, job->coefficients, job->order, job->shift,
+            job->out? job->out + first : NULL, sums);
+        total[0] += sums[0];
+        total[1] += sums[1];
+        total[2] += sums[2];
+    }
+}
+
+static void ICYM_FN(icym_poly_residuals_combine)(void* result, const void* partial, void* user){
+    (void)user;
+    for(int k = 0; k < 3; k+=1) ((double*)result)[k] += ((const double*)partial)[k];
+}
+
+ICYM_T ICYM_FN(cym_poly_residuals)(const ICYM_T* coefficients, int order, const ICYM_T* x, const ICYM_T* y, size_t n,
+        ICYM_T* residuals, ICYM_T* r2){
+
+    const ICYM_T zero = 0;
+    // y is taken around its first value so the total sum of squares does not cancel
+    ICYM_FN(ICymPolyEval) job = { ICYM_FN(icym_kernels)(), (order < 0)? &zero : coefficients, (order < 0)? 0 : order, 1,
+        x, y, n, residuals, n? y[0] : 0 };
+    double sums[3] = { 0, 0, 0 };
+    if(cym_parallel_reduce(0, n, ICYM_FN(icym_poly_grain)(job.order, 1), sums, sizeof(sums),
+        ICYM_FN(icym_poly_residuals_task), ICYM_FN(icym_poly_residuals_combine), &job)){
+        ICYM_FN(icym_poly_residuals_task)(0, n, sums, &job);
+    }
+
+    if(r2){
+        const double total = sums[2] - (n? sums[1] * sums[1] / (double)n : 0);
+        *r2 = (ICYM_T)((total > 0)? 1 - sums[0] / total : 0.0 / 0.0);
+    }
+    return (ICYM_T)sums[0];
+}
+
+// X==============X ROOT FINDING X=================X
+
+// a bracketed root search, advanced by icym_root_step proposing the next x and icym_root_update taking its value
+// Brent keeps the root in [b, c] with b the best point and a the previous one, Illinois keeps it in [a, b]
+typedef struct ICYM_FN(ICymRoot){
+    ICYM_T a, b, c;
+    ICYM_T fa, fb, fc;
+    // Brent's last two steps, Illinois' pending x is in d
+    ICYM_T d, e;
+    // stops once |fb| is at most this
+    ICYM_T accuracy;
+    // Illinois: 1 when b moved last, -1 for a
+    int    side;
+} ICYM_FN(ICymRoot);
+
+// \returns 1 if fa and fb do not bracket a root
+static int ICYM_FN(icym_root_init)(ICYM_FN(ICymRoot)* r, ICYM_T a, ICYM_T b, ICYM_T fa, ICYM_T fb, ICYM_T accuracy){
+    if(fa != fa || fb != fb || (fa > 0 && fb > 0) || (fa < 0 && fb < 0)) return 1;
+    r->a = a;  r->b = b;  r->c = a;
+    r->fa = fa; r->fb = fb; r->fc = fa;
+    r->d = r->e = b - a;
+    r->accuracy = accuracy;
+    r->side = 0;
+    return 0;
+}
+
+// \returns 1 once the root is found (see icym_root_value), 0 after writing the next point to evaluate to x
+static int ICYM_FN(icym_root_step)(ICYM_FN(ICymRoot)* r, int method, ICYM_T tolerance, ICYM_T* x){
+    const ICYM_T eps = ICYM_F32? FLT_EPSILON : DBL_EPSILON;
+
+    if(method == CYM_ROOT_ILLINOIS){
+        const ICYM_T biggest = (CYM_ABS(r->a) > CYM_ABS(r->b))? CYM_ABS(r->a) : CYM_ABS(r->b);
+        const ICYM_T tol1 = 2 * eps * biggest + tolerance / 2;
+        if(CYM_ABS(r->b - r->a) <= 2 * tol1 || r->fa == 0 || r->fb == 0) return 1;
+        if(CYM_ABS(r->fa) <= r->accuracy || CYM_ABS(r->fb) <= r->accuracy) return 1;
+
+        ICYM_T next = r->b - r->fb * (r->b - r->a) / (r->fb - r->fa);
+        // kept strictly inside the bracket so it always shrinks
+        const ICYM_T lo = (r->a < r->b)? r->a : r->b, hi = (r->a < r->b)? r->b : r->a;
+        if(!(next > lo + tol1)) next = lo + tol1;
+        if(!(next < hi - tol1)) next = hi - tol1;
+        r->d = *x = next;
+        return 0;
+    }
+
+    // Brent, as in Numerical Recipes' zbrent
+    if((r->fb > 0 && r->fc > 0) || (r->fb < 0 && r->fc < 0)){
+        r->c  = r->a;
+        r->fc = r->fa;
+        r->d  = r->e = r->b - r->a;
+    }
+    if(CYM_ABS(r->fc) < CYM_ABS(r->fb)){
+        r->a = r->b;  r->b = r->c;  r->c = r->a;
+        r->fa = r->fb; r->fb = r->fc; r->fc = r->fa;
+    }
+    const ICYM_T tol1 = 2 * eps * CYM_ABS(r->b) + tolerance / 2;
+    const ICYM_T xm = (r->c - r->b) / 2;
+    if(CYM_ABS(xm) <= tol1 || r->fb == 0 || CYM_ABS(r->fb) <= r->accuracy) return 1;
+
+    if(CYM_ABS(r->e) >= tol1 && CYM_ABS(r->fa) > CYM_ABS(r->fb)){
+        // secant when only two points are known, inverse quadratic interpolation otherwise
+        const ICYM_T s = r->fb / r->fa;
+        ICYM_T p, q;
+        if(r->a == r->c){
+            p = 2 * xm * s;
+            q = 1 - s;
+        }
+        else{
+            const ICYM_T t = r->fa / r->fc, u = r->fb / r->fc;
+            p = s * (2 * xm * t * (t - u) - (r->b - r->a) * (u - 1));
+            q = (t - 1) * (u - 1) * (s - 1);
+        }
+        if(p > 0) q = -q;
+        p = CYM_ABS(p);
+        const ICYM_T min1 = 3 * xm * q - CYM_ABS(tol1 * q), min2 = CYM_ABS(r->e * q);
+        if(2 * p < ((min1 < min2)? min1 : min2)){
+            r->e = r->d;
+            r->d = p / q;
+        }
+        else{
+            r->d = xm;
+            r->e = r->d;
+        }
+    }
+    else{
+        r->d = xm;
+        r->e = r->d;
+    }
+    r->a  = r->b;
+    r->fa = r->fb;
+    r->b += (CYM_ABS(r->d) > tol1)? r->d : ((xm > 0)? tol1 : -tol1);
+    *x = r->b;
+    return 0;
+}
+
+// fx being the value at the x of the last icym_root_step
+static void ICYM_FN(icym_root_update)(ICYM_FN(ICymRoot)* r, int method, ICYM_T fx){
+    if(method != CYM_ROOT_ILLINOIS){
+        r->fb = fx;
+        return;
+    }
+    if((fx > 0 && r->fb > 0) || (fx < 0 && r->fb < 0)){
+        r->b  = r->d;
+        r->fb = fx;
+        if(r->side == 1) r->fa /= 2;
+        r->side = 1;
+    }
+    else{
+        r->a  = r->d;
+        r->fa = fx;
+        if(r->side == -1) r->fb /= 2;
+        r->side = -1;
+    }
+}
+
+static ICYM_T ICYM_FN(icym_root_value)(const ICYM_FN(ICymRoot)* r, int method){
+    if(method == CYM_ROOT_ILLINOIS && CYM_ABS(r->fa) < CYM_ABS(r->fb)) return r->a;
+    return r->b;
+}
+
+// runs an initialized search, adding its steps and calls to stats
+static ICYM_T ICYM_FN(icym_root_solve)(ICYM_FN(ICymRoot)* r, ICYM_FN(CymRootFn) function, void* user, ICYM_T value,
+    ICYM_T tolerance, int method, CymRootStats* stats){
+
+    ICYM_T x;
+    while(!ICYM_FN(icym_root_step)(r, method, tolerance, &x)){
+        if(stats->iterations >= CYM_ROOT_ITERATIONS){
+            stats->status = CYM_ROOT_MAX_ITERATIONS;
+            break;
+        }
+        ICYM_FN(icym_root_update)(r, method, function(x, user) - value);
+        stats->iterations  += 1;
+        stats->evaluations += 1;
+    }
+    return ICYM_FN(icym_root_value)(r, method);
+}
+
+ICYM_T ICYM_FN(cym_root_bracket)(ICYM_FN(CymRootFn) function, void* user, ICYM_T a, ICYM_T b, ICYM_T value, ICYM_T tolerance,
+    int method, CymRootStats* stats){
+
+    CymRootStats local = { CYM_ROOT_CONVERGED, 0, 2, 0 };
+    if(!stats) stats = &local;
+    *stats = local;
+
+    ICYM_FN(ICymRoot) r;
+    if(ICYM_FN(icym_root_init)(&r, a, b, function(a, user) - value, function(b, user) - value, 0)){
+        stats->status   = CYM_ROOT_NO_BRACKET;
+        stats->failures = 1;
+        return (ICYM_T)(0.0 / 0.0);
+    }
+    const ICYM_T root = ICYM_FN(icym_root_solve)(&r, function, user, value, tolerance, method, stats);
+    stats->failures = stats->status != CYM_ROOT_CONVERGED;
+    return root;
+}
+
+// the secant search stopping on the value accuracy as well, for cym_newton_method
+static ICYM_T ICYM_FN(icym_root_secant)(ICYM_FN(CymRootFn) function, void* user, ICYM_T guess, ICYM_T step, ICYM_T value,
+    ICYM_T tolerance, ICYM_T accuracy, CymRootStats* stats){
+
+    const ICYM_T eps = ICYM_F32? FLT_EPSILON : DBL_EPSILON;
+    CymRootStats local = { CYM_ROOT_CONVERGED, 0, 2, 0 };
+    if(!stats) stats = &local;
+    *stats = local;
+
+    if(step == 0) step = ICYM_FN(icym_sqrt)(eps) * (CYM_ABS(guess) > 1? CYM_ABS(guess) : 1);
+    ICYM_T x0 = guess, x1 = guess + step;
+    ICYM_T f0 = function(x0, user) - value, f1 = function(x1, user) - value;
+    if(CYM_ABS(f0) < CYM_ABS(f1)){
+        ICYM_T t = x0; x0 = x1; x1 = t;
+        t = f0; f0 = f1; f1 = t;
+    }
+
+    while(!(f1 == 0 || CYM_ABS(f1) <= accuracy)){
+        ICYM_FN(ICymRoot) r;
+        if(!ICYM_FN(icym_root_init)(&r, x0, x1, f0, f1, accuracy)){
+            // the two latest points bracket the root, Brent takes over with their values
+            x1 = ICYM_FN(icym_root_solve)(&r, function, user, value, tolerance, CYM_ROOT_BRENT, stats);
+            break;
+        }
+        if(stats->iterations >= CYM_ROOT_ITERATIONS){
+            stats->status = CYM_ROOT_MAX_ITERATIONS;
+            break;
+        }
+        // a flat secant doubles the last step instead
+        const ICYM_T x2 = (f1 != f0)? x1 - f1 * (x1 - x0) / (f1 - f0) : x1 + (x1 - x0);
+        const ICYM_T tol1 = 2 * eps * CYM_ABS(x1) + tolerance / 2;
+        if(x2 != x2 || CYM_ABS(x2 - x1) <= tol1){
+            if(x2 == x2) x1 = x2;
+            break;
+        }
+        x0 = x1; f0 = f1;
+        x1 = x2; f1 = function(x2, user) - value;
+        stats->iterations  += 1;
+        stats->evaluations += 1;
+    }
+
+    stats->failures = stats->status != CYM_ROOT_CONVERGED;
+    return x1;
+}
+
+ICYM_T ICYM_FN(cym_root_secant)(ICYM_FN(CymRootFn) function, void* user, ICYM_T guess, ICYM_T step, ICYM_T value, ICYM_T tolerance,
+    CymRootStats* stats){
+
+    return ICYM_FN(icym_root_secant)(function, user, guess, step, value, tolerance, 0, stats);
+}
+
+// the blocks of roots of cym_root_batch
+typedef struct ICYM_FN(ICymRootJob){
+    ICYM_FN(CymRootBatchFn) function;
+    void*         user;
+    const ICYM_T* a;
+    const ICYM_T* b;
+    const ICYM_T* value;
+    ICYM_T        tolerance;
+    int           method;
+    ICYM_T*       roots;
+} ICYM_FN(ICymRootJob);
+
+static void ICYM_FN(icym_root_batch_task)(size_t begin, size_t end, void* partial, void* user){
+    const ICYM_FN(ICymRootJob)* job = (const ICYM_FN(ICymRootJob)*)user;
+    CymRootStats* stats = (CymRootStats*)partial;
+    const size_t n = end - begin;
+    stats->status = CYM_ROOT_CONVERGED;
+    stats->iterations = 0;
+    stats->evaluations = 0;
+    stats->failures = 0;
+    if(!n) return;
+
+    // the roots still searched are packed at the front of active, x, fx and index every step
+    ICYM_FN(ICymRoot)* states = (ICYM_FN(ICymRoot)*)malloc(n * sizeof(ICYM_FN(ICymRoot)));
+    ICYM_T* x   = (ICYM_T*)malloc(3 * n * sizeof(ICYM_T));
+    size_t* index = (size_t*)malloc(2 * n * sizeof(size_t));
+    if(!states || !x || !index){
+        free(states); free(x); free(index);
+        for(size_t i = begin; i < end; i+=1) job->roots[i] = (ICYM_T)(0.0 / 0.0);
+        stats->status   = CYM_ROOT_FAILED;
+        stats->failures = n;
+        return;
+    }
+    ICYM_T* fx  = x + n;
+    ICYM_T* fa  = fx + n;
+    size_t* active = index + n;
+
+    for(size_t i = 0; i < n; i+=1){
+        x[i] = job->a[begin + i];
+        index[i] = begin + i;
+    }
+    job->function(x, index, fa, n, job->user);
+    for(size_t i = 0; i < n; i+=1) x[i] = job->b[begin + i];
+    job->function(x, index, fx, n, job->user);
+    stats->evaluations = 2 * n;
+
+    size_t count = 0;
+    for(size_t i = 0; i < n; i+=1){
+        const ICYM_T value = job->value[begin + i];
+        if(ICYM_FN(icym_root_init)(&states[i], job->a[begin + i], job->b[begin + i], fa[i] - value, fx[i] - value, 0)){
+            job->roots[begin + i] = (ICYM_T)(0.0 / 0.0);
+            stats->status   = CYM_ROOT_NO_BRACKET;
+            stats->failures += 1;
+        }
+        else active[count++] = i;
+    }
+
+    while(count){
+        size_t next = 0;
+        for(size_t k = 0; k < count; k+=1){
+            const size_t i = active[k];
+            if(ICYM_FN(icym_root_step)(&states[i], job->method, job->tolerance, &x[next])){
+                job->roots[begin + i] = ICYM_FN(icym_root_value)(&states[i], job->method);
+            }
+            else{
+                index[next] = begin + i;
+                active[next++] = i;
+            }
+        }
+        count = next;
+        if(!count) break;
+        if(stats->iterations >= CYM_ROOT_ITERATIONS){
+            for(size_t k = 0; k < count; k+=1){
+                job->roots[begin + active[k]] = ICYM_FN(icym_root_value)(&states[active[k]], job->method);
+            }
+            if(stats->status < CYM_ROOT_MAX_ITERATIONS) stats->status = CYM_ROOT_MAX_ITERATIONS;
+            stats->failures += count;
+            break;
+        }
+
+        job->function(x, index, fx, count, job->user);
+        for(size_t k = 0; k < count; k+=1){
+            ICYM_FN(icym_root_update)(&states[active[k]], job->method, fx[k] - job->value[index[k]]);
+        }
+        stats->iterations  += 1;
+        stats->evaluations += count;
+    }
+
+    free(states); free(x); free(index);
+}
+
+static void ICYM_FN(icym_root_batch_combine)(void* result, const void* partial, void* user){
+    (void)user;
+    CymRootStats* total = (CymRootStats*)result;
+    const CymRootStats* block = (const CymRootStats*)partial;
+    if(block->status > total->status) total->status = block->status;
+    if(block->iterations > total->iterations) total->iterations = block->iterations;
+    total->evaluations += block->evaluations;
+    total->failures    += block->failures;
+}
+
+int ICYM_FN(cym_root_batch)(ICYM_FN(CymRootBatchFn) function, void* user, const ICYM_T* a, const ICYM_T* b, const ICYM_T* value,
+    size_t count, ICYM_T tolerance, int method, ICYM_T* roots, CymRootStats* stats){
+
+    ICYM_FN(ICymRootJob) job = { function, user, a, b, value, tolerance, method, roots };
+    CymRootStats total = { CYM_ROOT_CONVERGED, 0, 0, 0 };
+
+    if(cym_parallel_reduce(0, count, CYM_ROOT_BLOCK, &total, sizeof(total), ICYM_FN(icym_root_batch_task),
+        ICYM_FN(icym_root_batch_combine), &job)){
+        // one block at a time when the partials could not be allocated
+        for(size_t i = 0; i < count; i += CYM_ROOT_BLOCK){
+            CymRootStats block;
+            ICYM_FN(icym_root_batch_task)(i, (count - i < CYM_ROOT_BLOCK)? count : i + CYM_ROOT_BLOCK, &block, &job);
+            ICYM_FN(icym_root_batch_combine)(&total, &block, &job);
+        }
+    }
+
+    if(stats) *stats = total;
+    return total.failures != 0;
+}
+
+// lets cym_newton_method's plain function go through the root finders
+typedef struct ICYM_FN(ICymNewton){
+    ICYM_T (*function)(ICYM_T);
+} ICYM_FN(ICymNewton);
+
+static ICYM_T ICYM_FN(icym_newton_call)(ICYM_T x, void* user){
+    return ((ICYM_FN(ICymNewton)*)user)->function(x);
+}
+
+ICYM_T ICYM_FN(cym_newton_method)(ICYM_T (*function)(ICYM_T), ICYM_T guess, ICYM_T value, ICYM_T accuracy, ICYM_T step){
+    ICYM_FN(ICymNewton) newton = { function };
+    return ICYM_FN(icym_root_secant)(ICYM_FN(icym_newton_call), &newton, guess, step, value, 0, accuracy, NULL);
+}
+
+// X==============X MINIMIZATION X=================X
+
+// the forward differences of the residuals, each parameter filling its own column of the jacobian
+typedef struct ICYM_FN(ICymLmJob){
+    ICYM_FN(CymLmResiduals) residuals;
+    void*                   user;
+    const ICYM_T*           params;
+    const ICYM_T*           r;
+    ICYM_T*                 jacobian;
+    size_t                  p;
+    size_t                  m;
+    // p copies of the parameters past 64 of them, a task using the one of its first parameter
+    ICYM_T*                 copies;
+    // 1 when a residuals call returned non zero
+    int                     stop;
+} ICYM_FN(ICymLmJob);
+
+static void ICYM_FN(icym_lm_difference_task)(size_t begin, size_t end, void* user){
+    ICYM_FN(ICymLmJob)* job = (ICYM_FN(ICymLmJob)*)user;
+    const ICYM_T h0 = ICYM_FN(icym_sqrt)(ICYM_F32? FLT_EPSILON : DBL_EPSILON);
+
+    ICYM_T local[64];
+    ICYM_T* params = (job->p <= 64)? local : job->copies + begin * job->p;
+    for(size_t j = 0; j < job->p; j+=1) params[j] = job->params[j];
+
+    for(size_t j = begin; j < end; j+=1){
+        const ICYM_T old = params[j];
+        params[j] = old + h0 * (CYM_ABS(old) > 1? CYM_ABS(old) : 1);
+        // the step actually taken once old + h is rounded
+        const ICYM_T h = params[j] - old;
+        ICYM_T* column = job->jacobian + j * job->m;
+        if(job->residuals(params, column, job->user)) __atomic_store_n(&job->stop, 1, __ATOMIC_RELAXED);
+        params[j] = old;
+        for(size_t i = 0; i < job->m; i+=1) column[i] = (column[i] - job->r[i]) / h;
+    }
+}
+
+// the elements of the vectors and matrices of cym_lm_solve_ws
+static size_t ICYM_FN(icym_lm_scratch)(size_t p, size_t m){
+    return p * m + 3 * m + 2 * p * p + 8 * p + ((p > 64)? p * p : 0);
+}
+
+size_t ICYM_FN(cym_lm_solve_workspace_size)(size_t param_count, size_t residual_count){
+    const size_t p = param_count, m = residual_count;
+    if(!p || !m) return 0;
+
+    // J^T J, the Cholesky factor of the damped system and the products by J and J^T J, one after the other
+    const size_t products[4] = {
+        ICYM_FN(icym_syrk_workspace_size)(p, m), ICYM_FN(icym_cholesky_workspace_size)(p),
+        ICYM_FN(cym_gemm_workspace_size)(m, 1, p), ICYM_FN(cym_gemm_workspace_size)(p, 1, p)
     };
+    size_t scratch = 0;
+    for(int i = 0; i < 4; i+=1) if(products[i] > scratch) scratch = products[i];
+
+    return ICYM_WORKSPACE_ALIGN + icym_workspace_bytes(ICYM_FN(icym_lm_scratch)(p, m) * sizeof(ICYM_T)) + scratch;
+}
+
+int ICYM_FN(cym_lm_solve_ws)(ICYM_FN(CymLmResiduals) residuals, ICYM_FN(CymLmJacobian) jacobian, void* user, ICYM_T* params,
+    size_t param_count, size_t residual_count, const CymLmOptions* options, CymLmResult* result, void* workspace,
+    size_t workspace_size){
+
+    const double start = icym_seconds();
+    const size_t p = param_count, m = residual_count;
+    const double eps = ICYM_F32? FLT_EPSILON : DBL_EPSILON;
+
+    // zero initialized and never written, so it gives the defaults without a partial initializer warning in C++
+    static CymLmOptions no_options;
+    CymLmOptions o = options? *options : no_options;
+    if(o.max_iterations <= 0)     o.max_iterations = 100;
+    if(o.step_tolerance <= 0)     o.step_tolerance = 16 * eps;
+    if(o.gradient_tolerance <= 0) o.gradient_tolerance = icym_sqrt_d(eps);
+    if(o.cost_tolerance <= 0)     o.cost_tolerance = 16 * eps;
+
+    const ICYM_FN(IcymKernels)* kernels = ICYM_FN(icym_kernels)();
+    CymLmResult res = { CYM_LM_FAILED, 0, 0, 0, 0, 0, 0 };
+
+    // the jacobian is stored one parameter after the other, so J is m x p with strides 1 and m
+    ICymWorkspace ws = icym_workspace(workspace, workspace_size);
+    ICYM_T* scratch = (p && m)? (ICYM_T*)icym_workspace_take(&ws, ICYM_FN(icym_lm_scratch)(p, m) * sizeof(ICYM_T)) : NULL;
+    if(!scratch){
+        res.status = (!p || !m)? CYM_LM_SMALL_STEP : CYM_LM_FAILED;
+        if(result) *result = res;
+        return res.status;
+    }
+    ICYM_T* jac    = scratch;
+    ICYM_T* r      = jac + p * m;
+    ICYM_T* rt     = r + m;
+    ICYM_T* jd     = rt + m;
+    ICYM_T* a      = jd + m;
+    ICYM_T* factor = a + p * p;
+    ICYM_T* g      = factor + p * p;
+    ICYM_T* diag   = g + p;
+    ICYM_T* delta  = diag + p;
+    ICYM_T* accel  = delta + p;
+    ICYM_T* step   = accel + p;
+    ICYM_T* xt     = step + p;
+    ICYM_T* as     = xt + p;
+    ICYM_T* scale  = as + p;
+    ICYM_T* copies = scale + p;
+    for(size_t j = 0; j < p; j+=1) diag[j] = 0;
+
+    int status = CYM_LM_MAX_ITERATIONS;
+    res.residual_evaluations = 1;
+    if(residuals(params, r, user)) status = CYM_LM_STOPPED;
+    double cost = 0.5 * (double)ICYM_FN(cym_dot)(m, r, 1, r, 1);
+    res.initial_cost = cost;
+    if(status == CYM_LM_MAX_ITERATIONS && !(cost <= (double)(ICYM_F32? FLT_MAX : DBL_MAX))) status = CYM_LM_FAILED;
+
+    double lambda = 0, nu = 2;
+    int fresh = 0;
+    for(; status == CYM_LM_MAX_ITERATIONS && res.iterations < o.max_iterations; res.iterations+=1){
+        if(cost <= o.target_cost){
+            status = CYM_LM_TARGET_COST;
+            break;
+        }
+        if(o.max_seconds > 0 && icym_seconds() - start > o.max_seconds){
+            status = CYM_LM_TIME_LIMIT;
+            break;
+        }
+
+        if(!fresh){
+            res.jacobian_evaluations += 1;
+            if(jacobian){
+                if(jacobian(params, jac, user)){
+                    status = CYM_LM_STOPPED;
+                    break;
+                }
+            }
+            else{
+                ICYM_FN(ICymLmJob) job = { residuals, user, params, r, jac, p, m, copies, 0 };
+                if(o.serial) ICYM_FN(icym_lm_difference_task)(0, p, &job);
+                else         cym_parallel_for(0, p, 1, ICYM_FN(icym_lm_difference_task), &job);
+                res.residual_evaluations += p;
+                if(job.stop){
+                    status = CYM_LM_STOPPED;
+                    break;
+                }
+            }
+            fresh = 1;
+
+            // a = J^T J and g = J^T r, the gradient of the cost
+            ICYM_FN(icym_syrk)(p, m, jac, 1, (ptrdiff_t)m, a, (ptrdiff_t)p, &ws);
+            for(size_t j = 0; j < p; j+=1) g[j] = kernels->dot(m, jac + j * m, r);
+
+            // the damping scales with the biggest curvature seen along each parameter (Moré), so it is scale invariant
+            ICYM_T biggest = 0;
+            double cosine = 0;
+            const double norm = icym_sqrt_d(2 * cost);
+            for(size_t j = 0; j < p; j+=1){
+                const ICYM_T ajj = a[j * p + j];
+                if(ajj > diag[j]) diag[j] = ajj;
+                if(diag[j] > biggest) biggest = diag[j];
+                if(ajj > 0 && norm > 0){
+                    const double c = CYM_ABS((double)g[j]) / (icym_sqrt_d((double)ajj) * norm);
+                    if(c > cosine) cosine = c;
+                }
+            }
+            for(size_t j = 0; j < p; j+=1){
+                if(!(diag[j] > 0)) diag[j] = (biggest > 0)? biggest : 1;
+                scale[j] = 1 / ICYM_FN(icym_sqrt)(diag[j]);
+            }
+            if(lambda == 0) lambda = 1e-3;
+
+            if(cosine <= o.gradient_tolerance){
+                status = CYM_LM_SMALL_GRADIENT;
+                break;
+            }
+        }
 
-    int i = 0;
+        // (J^T J + lambda * D) delta = -g, growing lambda until the system is positive definite. it is solved for
+        // D^1/2 delta, which scales the curvatures to about 1 so the Cholesky factor does not lose the small ones
+        for(size_t i = 0; i < p; i+=1){
+            for(size_t j = 0; j < p; j+=1) factor[i * p + j] = a[i * p + j] * scale[i] * scale[j];
+            factor[i * p + i] += (ICYM_T)lambda;
+        }
+        if(ICYM_FN(icym_cholesky_factor)(factor, p, &ws)){
+            lambda *= nu;
+            nu *= 2;
+            continue;
+        }
+        for(size_t j = 0; j < p; j+=1) delta[j] = -g[j] * scale[j];
+        ICYM_FN(cym_cholesky_solve)(factor, (unsigned int)p, delta, delta);
+        for(size_t j = 0; j < p; j+=1) step[j] = delta[j] *= scale[j];
+
+        // geodesic acceleration: the second directional derivative r'' of the residuals along delta from a finite
+        // difference, then (J^T J + lambda * D) accel = -J^T r'', kept when small against delta
+        if(o.geodesic){
+            const ICYM_T h = (ICYM_T)0.1;
+            for(size_t j = 0; j < p; j+=1) xt[j] = params[j] + h * delta[j];
+            res.residual_evaluations += 1;
+            if(residuals(xt, rt, user)){
+                status = CYM_LM_STOPPED;
+                break;
+            }
+            ICYM_FN(cym_gemm_ws)(m, 1, p, 1, jac, 1, (ptrdiff_t)m, delta, 1, 1, 0, jd, 1, 1, ws.next, ws.left);
+            for(size_t i = 0; i < m; i+=1) rt[i] = 2 / h * ((rt[i] - r[i]) / h - jd[i]);
+            for(size_t j = 0; j < p; j+=1) accel[j] = -kernels->dot(m, jac + j * m, rt) * scale[j];
+            ICYM_FN(cym_cholesky_solve)(factor, (unsigned int)p, accel, accel);
+
+            // compared in the scaled parameters, where delta is accel / scale
+            double accel_norm = 0, delta_norm = 0;
+            for(size_t j = 0; j < p; j+=1){
+                const double da = (double)delta[j] / (double)scale[j];
+                accel_norm += (double)accel[j] * (double)accel[j];
+                delta_norm += da * da;
+                accel[j] *= scale[j];
+            }
+            if(4 * accel_norm <= 0.75 * 0.75 * delta_norm){
+                for(size_t j = 0; j < p; j+=1) step[j] += (ICYM_T)0.5 * accel[j];
+            }
+        }
 
-    do {
-        
-        cym_smatmul(x, w, output);
+        const ICYM_T step_norm = ICYM_FN(cym_nrm2)(p, step, 1), x_norm = ICYM_FN(cym_nrm2)(p, params, 1);
+        if(step_norm <= (ICYM_T)o.step_tolerance * (x_norm + (ICYM_T)o.step_tolerance)){
+            status = CYM_LM_SMALL_STEP;
+            break;
+        }
 
-        cost = 0;
-        for(size_t i = 0; i < data_point_count; i+=1){
-            cost += (output[i] - y.data[i * y.stride]) * (output[i] - y.data[i * y.stride]);
+        for(size_t j = 0; j < p; j+=1) xt[j] = params[j] + step[j];
+        res.residual_evaluations += 1;
+        if(residuals(xt, rt, user)){
+            status = CYM_LM_STOPPED;
+            break;
         }
+        const double new_cost = 0.5 * (double)ICYM_FN(cym_dot)(m, rt, 1, rt, 1);
+
+        // the decrease predicted by the linear model, -step.g - step^T J^T J step / 2
+        ICYM_FN(cym_gemm_ws)(p, 1, p, 1, a, (ptrdiff_t)p, 1, step, 1, 1, 0, as, 1, 1, ws.next, ws.left);
+        double predicted = 0;
+        for(size_t j = 0; j < p; j+=1) predicted -= (double)step[j] * ((double)g[j] + 0.5 * (double)as[j]);
+        const double rho = (predicted > 0)? (cost - new_cost) / predicted : -1;
+
+        if(rho > 0 && new_cost < cost){
+            const double decrease = cost - new_cost;
+            for(size_t j = 0; j < p; j+=1) params[j] = xt[j];
+            ICYM_T* swap = r; r = rt; rt = swap;
+            cost  = new_cost;
+            fresh = 0;
+
+            const double t = 2 * rho - 1;
+            lambda *= (1 - t * t * t > 1.0 / 3)? 1 - t * t * t : 1.0 / 3;
+            nu = 2;
+            if(decrease <= o.cost_tolerance * (cost + decrease)){
+                res.iterations += 1;
+                status = CYM_LM_SMALL_DECREASE;
+                break;
+            }
+        }
+        else{
+            lambda *= nu;
+            nu *= 2;
+        }
+    }
+
+    res.status  = status;
+    res.cost    = cost;
+    res.seconds = icym_seconds() - start;
+    if(result) *result = res;
+    return status;
+}
+
+int ICYM_FN(cym_lm_solve)(ICYM_FN(CymLmResiduals) residuals, ICYM_FN(CymLmJacobian) jacobian, void* user, ICYM_T* params,
+    size_t param_count, size_t residual_count, const CymLmOptions* options, CymLmResult* result){
+
+    uint8_t stack[ICYM_STACK_WORKSPACE];
+    const size_t workspace_size = ICYM_FN(cym_lm_solve_workspace_size)(param_count, residual_count);
+    void* workspace = icym_workspace_alloc(workspace_size, stack);
+    const int status = ICYM_FN(cym_lm_solve_ws)(residuals, jacobian, user, params, param_count, residual_count, options, result,
+        workspace, workspace? workspace_size : 0);
+    icym_workspace_free(workspace, stack);
+    return status;
+}
+
+// the residuals model - y of the points of cym_minimize
+typedef struct ICYM_FN(ICymMinimizeJob){
+    ICYM_FN(CYM_IMAT) inputs;
+    ICYM_FN(CYM_IMAT) y;
+    ICYM_T (*model)(ICYM_T*);
+} ICYM_FN(ICymMinimizeJob);
+
+static int ICYM_FN(icym_minimize_residuals)(const ICYM_T* params, ICYM_T* r, void* user){
+    const ICYM_FN(ICymMinimizeJob)* job = (const ICYM_FN(ICymMinimizeJob)*)user;
+    const size_t p = job->inputs.columns;
+
+    // the inputs of a point followed by the parameters
+    ICYM_T local[64];
+    ICYM_T* buffer = (2 * p <= 64)? local : (ICYM_T*)malloc(2 * p * sizeof(ICYM_T));
+    if(!buffer) return 1;
+    for(size_t j = 0; j < p; j+=1) buffer[p + j] = params[j];
+
+    for(size_t i = 0; i < job->inputs.rows; i+=1){
+        for(size_t j = 0; j < p; j+=1) buffer[j] = CYM_IMAT_AT(job->inputs, i, j);
+        r[i] = job->model(buffer) - CYM_IMAT_AT(job->y, i, 0);
+    }
+
+    if(buffer != local) free(buffer);
+    return 0;
+}
+
+void ICYM_FN(cym_minimize)(ICYM_T* input_data, size_t data_point_count, ICYM_T (*model)(ICYM_T*), ICYM_T* param, size_t param_count){
+    const size_t n = data_point_count, p = param_count;
+    if(!n || !p) return;
+
+    // a point is its p inputs followed by its y
+    const ICYM_FN(CYM_IMAT) points = ICYM_FN(cym_imat)(input_data, n, p + 1);
+    ICYM_FN(ICymMinimizeJob) job;
+    job.inputs = ICYM_FN(cym_imat_sub)(points, 0, 0, n, p);
+    job.y      = ICYM_FN(cym_imat_col)(points, p);
+    job.model  = model;
+
+    ICYM_FN(cym_lm_solve)(ICYM_FN(icym_minimize_residuals), NULL, &job, param, p, n, NULL, NULL);
+}
+
+// X==============X SPARSE MATRICES X=================X
+
+void ICYM_FN(cym_sparse_free)(ICYM_FN(CymSparse)* a){
+    free(a->values);
+    free(a->indices);
+    free(a->offsets);
+    a->values   = NULL;
+    a->indices  = NULL;
+    a->offsets  = NULL;
+    a->rows     = 0;
+    a->columns  = 0;
+    a->nonzeros = 0;
+}
 
-        for(size_t i = 0; i < param_count; i+=1){
-            const CYM_FLOAT oparam = param[i];
+static int ICYM_FN(icym_sparse_alloc)(ICYM_FN(CymSparse)* a, size_t rows, size_t columns, size_t nonzeros, int format){
+    const size_t major = (format == CYM_SPARSE_CSC)? columns : rows;
+    a->rows     = rows;
+    a->columns  = columns;
+    a->nonzeros = nonzeros;
+    a->format   = format;
+    // one more element so empty matrices do not ask malloc for 0 bytes
+    a->values   = (ICYM_T*)malloc((nonzeros + 1) * sizeof(ICYM_T));
+    a->indices  = (unsigned int*)malloc((nonzeros + 1) * sizeof(unsigned int));
+    a->offsets  = (size_t*)calloc(major + 1, sizeof(size_t));
+    if(!a->values || !a->indices || !a->offsets){
+        ICYM_FN(cym_sparse_free)(a);
+        return 1;
+    }
+    return 0;
+}
 
-            param[i] += step;
+int ICYM_FN(cym_sparse_from_coo)(size_t rows, size_t columns, const unsigned int* row_indices, const unsigned int* column_indices,
+    const ICYM_T* values, size_t count, int format, ICYM_FN(CymSparse)* out){
 
-            cym_smatmul(x, w, output);
+    const int csc = (format == CYM_SPARSE_CSC);
+    const size_t major = csc? columns : rows, minor = csc? rows : columns;
+    const unsigned int* major_index = csc? column_indices : row_indices;
+    const unsigned int* minor_index = csc? row_indices : column_indices;
+
+    if(rows >= ((size_t)1 << 31) || columns >= ((size_t)1 << 31)) return 1;
+    for(size_t k = 0; k < count; k+=1){
+        if(row_indices[k] >= rows || column_indices[k] >= columns) return 1;
+    }
+
+    // the triplets sorted by their minor index, then (stably) by their major one, so each line ends up sorted
+    size_t* by_minor = (size_t*)malloc((count + 1) * sizeof(size_t));
+    size_t* starts   = (size_t*)calloc(minor + 1, sizeof(size_t));
+    if(!by_minor || !starts || ICYM_FN(icym_sparse_alloc)(out, rows, columns, count, format)){
+        free(by_minor);
+        free(starts);
+        return 1;
+    }
 
-            CYM_FLOAT ncost = 0;
-            for(size_t i = 0; i < data_point_count; i+=1){
-                ncost += (output[i] - y.data[i * y.stride]) * (output[i] - y.data[i * y.stride]);
+    for(size_t k = 0; k < count; k+=1) starts[minor_index[k] + 1] += 1;
+    for(size_t j = 0; j < minor; j+=1) starts[j + 1] += starts[j];
+    for(size_t k = 0; k < count; k+=1) by_minor[starts[minor_index[k]]++] = k;
+    free(starts);
+
+    size_t* offsets = out->offsets;
+    for(size_t k = 0; k < count; k+=1) offsets[major_index[k] + 1] += 1;
+    for(size_t i = 0; i < major; i+=1) offsets[i + 1] += offsets[i];
+    // offsets[i] is used as the write position of line i, ending at the start of line i + 1
+    for(size_t t = 0; t < count; t+=1){
+        const size_t k = by_minor[t];
+        const size_t at = offsets[major_index[k]]++;
+        out->values[at]  = values[k];
+        out->indices[at] = minor_index[k];
+    }
+    free(by_minor);
+
+    // shifts the positions back into starts while summing the duplicates, which are now next to each other
+    size_t nonzeros = 0, begin = 0;
+    for(size_t i = 0; i < major; i+=1){
+        const size_t end = offsets[i];
+        offsets[i] = nonzeros;
+        for(size_t k = begin; k < end; k+=1){
+            if(nonzeros > offsets[i] && out->indices[nonzeros - 1] == out->indices[k]){
+                out->values[nonzeros - 1] += out->values[k];
+            } else{
+                out->values[nonzeros]  = out->values[k];
+                out->indices[nonzeros] = out->indices[k];
+                nonzeros += 1;
             }
-            param[i] = oparam;
+        }
+        begin = end;
+    }
+    offsets[major] = nonzeros;
+    out->nonzeros = nonzeros;
+    return 0;
+}
+
+// fills out, which has room for a in format and its offsets zeroed
+static void ICYM_FN(icym_sparse_convert_into)(const ICYM_FN(CymSparse)* a, int format, ICYM_FN(CymSparse)* out){
+    const int csc = (a->format == CYM_SPARSE_CSC);
+    const size_t major = csc? a->columns : a->rows, minor = csc? a->rows : a->columns;
 
-            grad[i] = (ncost - cost) / step;
+    if(format == a->format){
+        for(size_t i = 0; i <= major; i+=1) out->offsets[i] = a->offsets[i];
+        for(size_t k = 0; k < a->nonzeros; k+=1){
+            out->values[k]  = a->values[k];
+            out->indices[k] = a->indices[k];
         }
-        for(size_t i = 0; i < param_count; i+=1){
-            param[i] += grad[i];
-        }        
+        return;
+    }
 
-    } while (cost > accuracy && i++ < 1000);
-    
-    free(output);
+    // counting sort of the nonzeros by their minor index, walking the lines in order keeps the new lines sorted
+    size_t* offsets = out->offsets;
+    for(size_t k = 0; k < a->nonzeros; k+=1) offsets[a->indices[k] + 1] += 1;
+    for(size_t j = 0; j < minor; j+=1) offsets[j + 1] += offsets[j];
+    for(size_t i = 0; i < major; i+=1){
+        for(size_t k = a->offsets[i]; k < a->offsets[i + 1]; k+=1){
+            const size_t at = offsets[a->indices[k]]++;
+            out->values[at]  = a->values[k];
+            out->indices[at] = (unsigned int)i;
+        }
+    }
+    for(size_t j = minor; j > 0; j-=1) offsets[j] = offsets[j - 1];
+    offsets[0] = 0;
+}
 
+int ICYM_FN(cym_sparse_convert)(const ICYM_FN(CymSparse)* a, int format, ICYM_FN(CymSparse)* out){
+    if(ICYM_FN(icym_sparse_alloc)(out, a->rows, a->columns, a->nonzeros, format)) return 1;
+    ICYM_FN(icym_sparse_convert_into)(a, format, out);
+    return 0;
 }
-*/
 
-#endif // ======================== END OF FUNCTION IMPLEMENTATIONS =========================
+typedef struct ICYM_FN(ICymSpmv){
+    const ICYM_FN(IcymKernels)* kernels;
+    const ICYM_FN(CymSparse)*   a;
+    const ICYM_T*               x;
+    ICYM_T*                     y;
+    ICYM_T                      alpha;
+    ICYM_T                      beta;
+} ICYM_FN(ICymSpmv);
+
+static void ICYM_FN(icym_spmv_task)(size_t begin, size_t end, void* user){
+    const ICYM_FN(ICymSpmv)* job = (const ICYM_FN(ICymSpmv)*)user;
+    job->kernels->csr_rows(begin, end, job->a->offsets, job->a->indices, job->a->values, job->x, job->alpha, job->beta, job->y);
+}
 
+void ICYM_FN(cym_sparse_mv)(ICYM_T alpha, const ICYM_FN(CymSparse)* a, const ICYM_T* x, ICYM_T beta, ICYM_T* y){
+    const ICYM_FN(IcymKernels)* kernels = ICYM_FN(icym_kernels)();
 
-#ifdef __cplusplus
+    if(a->format == CYM_SPARSE_CSC){
+        if(beta == 0){
+            for(size_t i = 0; i < a->rows; i+=1) y[i] = 0;
+        } else if(beta != 1){
+            kernels->scal(a->rows, beta, y);
+        }
+        for(size_t j = 0; j < a->columns; j+=1){
+            const ICYM_T ax = alpha * x[j];
+            for(size_t k = a->offsets[j]; k < a->offsets[j + 1]; k+=1) y[a->indices[k]] += ax * a->values[k];
+        }
+        return;
+    }
+
+    // chunks of about CYM_SPARSE_GRAIN nonzeros
+    const size_t grain = (a->nonzeros > CYM_SPARSE_GRAIN)? a->rows / (a->nonzeros / CYM_SPARSE_GRAIN) + 1 : a->rows + 1;
+    ICYM_FN(ICymSpmv) job;
+    job.kernels = kernels;
+    job.a       = a;
+    job.x       = x;
+    job.y       = y;
+    job.alpha   = alpha;
+    job.beta    = beta;
+    cym_parallel_for(0, a->rows, grain, ICYM_FN(icym_spmv_task), &job);
+}
+
+// the preconditioners of the iterative solvers, z = M^-1 * r
+typedef struct ICYM_FN(ICymPrecond){
+    int                       kind;
+    const ICYM_FN(CymSparse)* a;
+    // the inverse of the diagonal of a (Jacobi) or of U (ILU(0))
+    ICYM_T*                   inverse_diagonal;
+    // the factors of ILU(0), L (unit, its diagonal not stored) and U sharing the nonzeros of a
+    ICYM_T*                   lu;
+    // the position of the diagonal element of each line
+    size_t*                   diagonal;
+} ICYM_FN(ICymPrecond);
+
+// \returns the bytes of workspace icym_precond_init needs for the n x n a with its nonzeros
+static size_t ICYM_FN(icym_precond_size)(size_t n, size_t nonzeros, int kind){
+    if(kind != CYM_PRECOND_JACOBI && kind != CYM_PRECOND_ILU0) return 0;
+    const size_t jacobi = icym_workspace_bytes((n + 1) * sizeof(ICYM_T)) + icym_workspace_bytes((n + 1) * sizeof(size_t));
+    if(kind == CYM_PRECOND_JACOBI) return jacobi;
+    return jacobi + icym_workspace_bytes((n + 1) * sizeof(size_t)) + icym_workspace_bytes((nonzeros + 1) * sizeof(ICYM_T));
+}
+
+// sets up the preconditioner with its arrays taken from ws
+// \returns 0 on success, 1 if a diagonal element is missing or zero (a pivot for ILU(0)) or the factors do not fit in ws
+static int ICYM_FN(icym_precond_init)(ICYM_FN(ICymPrecond)* p, const ICYM_FN(CymSparse)* a, int kind, ICymWorkspace* ws){
+    const size_t n = a->rows;
+    p->kind = kind;
+    p->a = a;
+    p->inverse_diagonal = NULL;
+    p->lu = NULL;
+    p->diagonal = NULL;
+    if(kind != CYM_PRECOND_JACOBI && kind != CYM_PRECOND_ILU0) return 0;
+
+    p->inverse_diagonal = (ICYM_T*)icym_workspace_take(ws, (n + 1) * sizeof(ICYM_T));
+    p->diagonal = (size_t*)icym_workspace_take(ws, (n + 1) * sizeof(size_t));
+    if(!p->inverse_diagonal || !p->diagonal) return 1;
+    for(size_t i = 0; i < n; i+=1){
+        size_t k = a->offsets[i];
+        while(k < a->offsets[i + 1] && a->indices[k] < i) k += 1;
+        if(k == a->offsets[i + 1] || a->indices[k] != i || a->values[k] == 0) return 1;
+        p->diagonal[i] = k;
+        p->inverse_diagonal[i] = 1 / a->values[k];
+    }
+    if(kind == CYM_PRECOND_JACOBI) return 0;
+
+    // IKJ elimination restricted to the nonzeros of a, position[j] being where column j sits in the current line
+    size_t* position = (size_t*)icym_workspace_take(ws, (n + 1) * sizeof(size_t));
+    p->lu = (ICYM_T*)icym_workspace_take(ws, (a->nonzeros + 1) * sizeof(ICYM_T));
+    if(!position || !p->lu) return 1;
+    ICYM_T* lu = p->lu;
+    for(size_t k = 0; k < a->nonzeros; k+=1) lu[k] = a->values[k];
+    for(size_t j = 0; j < n; j+=1) position[j] = SIZE_MAX;
+
+    for(size_t i = 0; i < n; i+=1){
+        const size_t begin = a->offsets[i], end = a->offsets[i + 1];
+        for(size_t k = begin; k < end; k+=1) position[a->indices[k]] = k;
+
+        for(size_t k = begin; k < p->diagonal[i]; k+=1){
+            const size_t c = a->indices[k];
+            const ICYM_T factor = lu[k] * p->inverse_diagonal[c];
+            lu[k] = factor;
+            for(size_t q = p->diagonal[c] + 1; q < a->offsets[c + 1]; q+=1){
+                const size_t at = position[a->indices[q]];
+                if(at != SIZE_MAX) lu[at] -= factor * lu[q];
+            }
+        }
+
+        const ICYM_T pivot = lu[p->diagonal[i]];
+        for(size_t k = begin; k < end; k+=1) position[a->indices[k]] = SIZE_MAX;
+        if(pivot == 0 || pivot != pivot) return 1;
+        p->inverse_diagonal[i] = 1 / pivot;
+    }
+
+    return 0;
+}
+
+// z = M^-1 * r, z may be r only without preconditioner
+static void ICYM_FN(icym_precond_apply)(const ICYM_FN(ICymPrecond)* p, const ICYM_FN(IcymKernels)* kernels, const ICYM_T* r,
+    ICYM_T* z){
+
+    const ICYM_FN(CymSparse)* a = p->a;
+    const size_t n = a->rows;
+    if(p->kind == CYM_PRECOND_JACOBI){
+        kernels->mul(n, p->inverse_diagonal, r, z);
+    } else if(p->kind == CYM_PRECOND_ILU0){
+        // L * u = r then U * z = u, the lines being split at their diagonal
+        for(size_t i = 0; i < n; i+=1){
+            ICYM_T s = r[i];
+            for(size_t k = a->offsets[i]; k < p->diagonal[i]; k+=1) s -= p->lu[k] * z[a->indices[k]];
+            z[i] = s;
+        }
+        for(size_t i = n; i > 0; i-=1){
+            ICYM_T s = z[i - 1];
+            for(size_t k = p->diagonal[i - 1] + 1; k < a->offsets[i]; k+=1) s -= p->lu[k] * z[a->indices[k]];
+            z[i - 1] = s * p->inverse_diagonal[i - 1];
+        }
+    } else if(z != r){
+        for(size_t i = 0; i < n; i+=1) z[i] = r[i];
+    }
+}
+
+// \returns the bytes of workspace icym_sparse_solver_setup needs for a and vectors vectors of its size
+static size_t ICYM_FN(icym_sparse_solver_size)(const ICYM_FN(CymSparse)* a, int preconditioner, size_t vectors){
+    const size_t n = a->rows, nonzeros = a->nonzeros;
+    const size_t csr = (a->format == CYM_SPARSE_CSR)? 0 : icym_workspace_bytes((nonzeros + 1) * sizeof(ICYM_T)) +
+        icym_workspace_bytes((nonzeros + 1) * sizeof(unsigned int)) + icym_workspace_bytes((n + 1) * sizeof(size_t));
+    return ICYM_WORKSPACE_ALIGN + icym_workspace_bytes((vectors * n + 1) * sizeof(ICYM_T)) + csr +
+        ICYM_FN(icym_precond_size)(n, nonzeros, preconditioner);
+}
+
+// takes from ws the vectors of the solvers, the CSR form of a when it is CSC and the preconditioner
+// \returns the matrix to use, NULL if a is not square, lacks what the preconditioner needs or ws is too small
+static const ICYM_FN(CymSparse)* ICYM_FN(icym_sparse_solver_setup)(const ICYM_FN(CymSparse)* a, int preconditioner,
+    size_t vectors, ICymWorkspace* ws, ICYM_FN(CymSparse)* csr, ICYM_FN(ICymPrecond)* precond, ICYM_T** r){
+
+    const size_t n = a->rows;
+    if(a->rows != a->columns) return NULL;
+    *r = (ICYM_T*)icym_workspace_take(ws, (vectors * n + 1) * sizeof(ICYM_T));
+    if(!*r) return NULL;
+
+    const ICYM_FN(CymSparse)* m = a;
+    if(a->format != CYM_SPARSE_CSR){
+        csr->rows     = n;
+        csr->columns  = n;
+        csr->nonzeros = a->nonzeros;
+        csr->format   = CYM_SPARSE_CSR;
+        csr->values   = (ICYM_T*)icym_workspace_take(ws, (a->nonzeros + 1) * sizeof(ICYM_T));
+        csr->indices  = (unsigned int*)icym_workspace_take(ws, (a->nonzeros + 1) * sizeof(unsigned int));
+        csr->offsets  = (size_t*)icym_workspace_take(ws, (n + 1) * sizeof(size_t));
+        if(!csr->values || !csr->indices || !csr->offsets) return NULL;
+        for(size_t i = 0; i <= n; i+=1) csr->offsets[i] = 0;
+        ICYM_FN(icym_sparse_convert_into)(a, CYM_SPARSE_CSR, csr);
+        m = csr;
+    }
+
+    if(ICYM_FN(icym_precond_init)(precond, m, preconditioner, ws)) return NULL;
+    return m;
+}
+
+// r = b - a * x
+// \returns |r| / b_norm, 0 when b_norm is 0
+static double ICYM_FN(icym_sparse_residual)(const ICYM_FN(CymSparse)* a, const ICYM_FN(IcymKernels)* kernels, const ICYM_T* b,
+    const ICYM_T* x, ICYM_T* r, double b_norm){
+
+    const size_t n = a->rows;
+    for(size_t i = 0; i < n; i+=1) r[i] = b[i];
+    ICYM_FN(cym_sparse_mv)(-1, a, x, 1, r);
+    return (b_norm > 0)? icym_sqrt_d((double)kernels->dot(n, r, r)) / b_norm : 0;
+}
+
+size_t ICYM_FN(cym_sparse_cg_workspace_size)(const ICYM_FN(CymSparse)* a, int preconditioner){
+    const int preconditioned = (preconditioner == CYM_PRECOND_JACOBI || preconditioner == CYM_PRECOND_ILU0);
+    return ICYM_FN(icym_sparse_solver_size)(a, preconditioner, (preconditioned? 4 : 3));
+}
+
+int ICYM_FN(cym_sparse_cg_ws)(const ICYM_FN(CymSparse)* a, const ICYM_T* b, ICYM_T* x, double tolerance, int max_iterations,
+    int preconditioner, CymIterStats* stats, void* workspace, size_t workspace_size){
+
+    const double start = icym_seconds();
+    CymIterStats st = { CYM_ITER_FAILED, 0, 0.0 / 0.0, 0 };
+    const ICYM_FN(IcymKernels)* kernels = ICYM_FN(icym_kernels)();
+    const int preconditioned = (preconditioner == CYM_PRECOND_JACOBI || preconditioner == CYM_PRECOND_ILU0);
+
+    ICymWorkspace ws = icym_workspace(workspace, workspace_size);
+    ICYM_FN(CymSparse) converted;
+    ICYM_FN(ICymPrecond) precond;
+    ICYM_T* r = NULL;
+    const ICYM_FN(CymSparse)* m = ICYM_FN(icym_sparse_solver_setup)(a, preconditioner, (preconditioned? 4 : 3), &ws, &converted,
+        &precond, &r);
+    const size_t n = a->rows;
+    if(!m){
+        st.seconds = icym_seconds() - start;
+        if(stats) *stats = st;
+        return st.status;
+    }
+    ICYM_T* p = r + n;
+    ICYM_T* q = p + n;
+    ICYM_T* z = preconditioned? q + n : r;
+    if(max_iterations <= 0) max_iterations = (n < INT_MAX)? (int)n + 1 : INT_MAX;
+
+    const double b_norm = icym_sqrt_d((double)kernels->dot(n, b, b));
+    // the solution of a * x = 0
+    if(b_norm == 0){
+        for(size_t i = 0; i < n; i+=1) x[i] = 0;
+    }
+    st.status = CYM_ITER_MAX_ITERATIONS;
+    st.residual = ICYM_FN(icym_sparse_residual)(m, kernels, b, x, r, b_norm);
+    ICYM_T rz = 0;
+    int restart = 1;
+
+    for(;;){
+        // the updated residual drifts away from b - a * x over long runs, so convergence is checked against the true one
+        // and the iteration restarted from it when they disagree
+        if(st.residual <= tolerance && !restart){
+            st.residual = ICYM_FN(icym_sparse_residual)(m, kernels, b, x, r, b_norm);
+            restart = 1;
+        }
+        if(st.residual <= tolerance){
+            st.status = CYM_ITER_CONVERGED;
+            break;
+        }
+        if(restart){
+            ICYM_FN(icym_precond_apply)(&precond, kernels, r, z);
+            for(size_t i = 0; i < n; i+=1) p[i] = z[i];
+            rz = kernels->dot(n, r, z);
+            restart = 0;
+        }
+        if(st.iterations == max_iterations) break;
+        st.iterations += 1;
+
+        ICYM_FN(cym_sparse_mv)(1, m, p, 0, q);
+        const ICYM_T pq = kernels->dot(n, p, q);
+        if(!(pq > 0)){
+            st.status = CYM_ITER_BREAKDOWN;
+            break;
+        }
+        const ICYM_T alpha = rz / pq;
+        kernels->axpy(n, alpha, p, x);
+        kernels->axpy(n, -alpha, q, r);
+        st.residual = icym_sqrt_d((double)kernels->dot(n, r, r)) / b_norm;
+
+        ICYM_FN(icym_precond_apply)(&precond, kernels, r, z);
+        const ICYM_T rz_next = kernels->dot(n, r, z);
+        kernels->axpby(n, 1, z, rz_next / rz, p);
+        rz = rz_next;
+    }
+
+    st.seconds = icym_seconds() - start;
+    if(stats) *stats = st;
+    return st.status;
+}
+
+int ICYM_FN(cym_sparse_cg)(const ICYM_FN(CymSparse)* a, const ICYM_T* b, ICYM_T* x, double tolerance, int max_iterations,
+    int preconditioner, CymIterStats* stats){
+
+    uint8_t stack[ICYM_STACK_WORKSPACE];
+    const size_t workspace_size = ICYM_FN(cym_sparse_cg_workspace_size)(a, preconditioner);
+    void* workspace = icym_workspace_alloc(workspace_size, stack);
+    const int status = ICYM_FN(cym_sparse_cg_ws)(a, b, x, tolerance, max_iterations, preconditioner, stats, workspace,
+        workspace? workspace_size : 0);
+    icym_workspace_free(workspace, stack);
+    return status;
+}
+
+size_t ICYM_FN(cym_sparse_bicgstab_workspace_size)(const ICYM_FN(CymSparse)* a, int preconditioner){
+    const int preconditioned = (preconditioner == CYM_PRECOND_JACOBI || preconditioner == CYM_PRECOND_ILU0);
+    return ICYM_FN(icym_sparse_solver_size)(a, preconditioner, (preconditioned? 7 : 5));
+}
+
+int ICYM_FN(cym_sparse_bicgstab_ws)(const ICYM_FN(CymSparse)* a, const ICYM_T* b, ICYM_T* x, double tolerance, int max_iterations,
+    int preconditioner, CymIterStats* stats, void* workspace, size_t workspace_size){
+
+    const double start = icym_seconds();
+    CymIterStats st = { CYM_ITER_FAILED, 0, 0.0 / 0.0, 0 };
+    const ICYM_FN(IcymKernels)* kernels = ICYM_FN(icym_kernels)();
+    const int preconditioned = (preconditioner == CYM_PRECOND_JACOBI || preconditioner == CYM_PRECOND_ILU0);
+
+    ICymWorkspace ws = icym_workspace(workspace, workspace_size);
+    ICYM_FN(CymSparse) converted;
+    ICYM_FN(ICymPrecond) precond;
+    ICYM_T* r = NULL;
+    const ICYM_FN(CymSparse)* m = ICYM_FN(icym_sparse_solver_setup)(a, preconditioner, (preconditioned? 7 : 5), &ws, &converted,
+        &precond, &r);
+    const size_t n = a->rows;
+    if(!m){
+        st.seconds = icym_seconds() - start;
+        if(stats) *stats = st;
+        return st.status;
+    }
+    // s shares r, the preconditioned p and s are p_hat and s_hat
+    ICYM_T* r0    = r + n;
+    ICYM_T* p     = r0 + n;
+    ICYM_T* v     = p + n;
+    ICYM_T* t     = v + n;
+    ICYM_T* p_hat = preconditioned? t + n : p;
+    ICYM_T* s_hat = preconditioned? p_hat + n : r;
+    if(max_iterations <= 0) max_iterations = (n < INT_MAX)? (int)n + 1 : INT_MAX;
+
+    const double b_norm = icym_sqrt_d((double)kernels->dot(n, b, b));
+    // the solution of a * x = 0
+    if(b_norm == 0){
+        for(size_t i = 0; i < n; i+=1) x[i] = 0;
+    }
+    st.status = CYM_ITER_MAX_ITERATIONS;
+    st.residual = ICYM_FN(icym_sparse_residual)(m, kernels, b, x, r, b_norm);
+    ICYM_T rho = 1, alpha = 1, omega = 1;
+    int restart = 1;
+
+    for(;;){
+        // as in cym_sparse_cg, convergence is checked against the true residual, restarting from it when it is off
+        if(st.residual <= tolerance && !restart){
+            st.residual = ICYM_FN(icym_sparse_residual)(m, kernels, b, x, r, b_norm);
+            restart = 1;
+        }
+        if(st.residual <= tolerance){
+            st.status = CYM_ITER_CONVERGED;
+            break;
+        }
+        if(restart){
+            for(size_t i = 0; i < n; i+=1){
+                r0[i] = r[i];
+                p[i]  = 0;
+                v[i]  = 0;
+            }
+            rho = alpha = omega = 1;
+            restart = 0;
+        }
+        if(st.iterations == max_iterations) break;
+        st.iterations += 1;
+
+        const ICYM_T rho_next = kernels->dot(n, r0, r);
+        if(rho_next == 0 || omega == 0){
+            st.status = CYM_ITER_BREAKDOWN;
+            break;
+        }
+        // p = r + beta * (p - omega * v)
+        kernels->axpy(n, -omega, v, p);
+        kernels->axpby(n, 1, r, (rho_next / rho) * (alpha / omega), p);
+        rho = rho_next;
+
+        ICYM_FN(icym_precond_apply)(&precond, kernels, p, p_hat);
+        ICYM_FN(cym_sparse_mv)(1, m, p_hat, 0, v);
+        const ICYM_T r0v = kernels->dot(n, r0, v);
+        if(r0v == 0){
+            st.status = CYM_ITER_BREAKDOWN;
+            break;
+        }
+        alpha = rho / r0v;
+
+        // s = r - alpha * v, stopping at the half step when it is small enough
+        kernels->axpy(n, -alpha, v, r);
+        kernels->axpy(n, alpha, p_hat, x);
+        st.residual = icym_sqrt_d((double)kernels->dot(n, r, r)) / b_norm;
+        if(st.residual <= tolerance) continue;
+
+        ICYM_FN(icym_precond_apply)(&precond, kernels, r, s_hat);
+        ICYM_FN(cym_sparse_mv)(1, m, s_hat, 0, t);
+        const ICYM_T tt = kernels->dot(n, t, t);
+        omega = (tt > 0)? kernels->dot(n, t, r) / tt : 0;
+        kernels->axpy(n, omega, s_hat, x);
+        kernels->axpy(n, -omega, t, r);
+        st.residual = icym_sqrt_d((double)kernels->dot(n, r, r)) / b_norm;
+    }
+
+    st.seconds = icym_seconds() - start;
+    if(stats) *stats = st;
+    return st.status;
+}
+
+int ICYM_FN(cym_sparse_bicgstab)(const ICYM_FN(CymSparse)* a, const ICYM_T* b, ICYM_T* x, double tolerance, int max_iterations,
+    int preconditioner, CymIterStats* stats){
+
+    uint8_t stack[ICYM_STACK_WORKSPACE];
+    const size_t workspace_size = ICYM_FN(cym_sparse_bicgstab_workspace_size)(a, preconditioner);
+    void* workspace = icym_workspace_alloc(workspace_size, stack);
+    const int status = ICYM_FN(cym_sparse_bicgstab_ws)(a, b, x, tolerance, max_iterations, preconditioner, stats, workspace,
+        workspace? workspace_size : 0);
+    icym_workspace_free(workspace, stack);
+    return status;
 }
-#endif
 
-#endif // =====================  END OF FILE CMATH_HEADER ===========================
\ No newline at end of file
+#endif // ======================== END OF PASSES =========================
\ No newline at end of file
@@ -0,0 +1,983 @@
+#define CYMATH_IMPLEMENTATION
+#include "cymath.h"
+
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+// benchmarks cymath.h's kernels over a sweep of sizes, each measurement giving the time per call, GFLOPS, GB/s and the
+// error against a long double reference, gemm and the square roots at every SIMD level the cpu supports and the other
+// kernels scalar and at the best level, so each one shows its speedup
+// --json writes the measurements to a file and --compare lines up two such files
+
+// default minimum time spent on each measurement, in seconds
+#define BENCH_MIN_TIME 0.25
+
+static const char* level_names[] = { "scalar", "sse2", "avx2", "avx512" };
+
+static double min_time = BENCH_MIN_TIME;
+static const char* only = NULL;
+
+static double now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// X==============X RECORDS X=================X
+
+// one measurement, a line of the printed tables and of the json file, the counters that do not apply are 0 and the errors
+// that do not apply are negative
+typedef struct BenchRecord{
+    char kernel[32];
+    char variant[32];
+    size_t n;
+    double seconds;     // per call
+    double gflops;
+    double gbps;        // the bytes a call has to move at least, over its time
+    double error;       // forward error against the long double reference, relative
+    double residual;    // backward error (residual), relative
+} BenchRecord;
+
+static BenchRecord* records = NULL;
+static size_t record_count = 0, record_capacity = 0;
+
+static void record(const char* kernel, const char* variant, size_t n, double seconds, double flops, double bytes,
+    double error, double residual){
+
+    if(record_count == record_capacity){
+        record_capacity = record_capacity? 2 * record_capacity : 64;
+        records = (BenchRecord*)realloc(records, record_capacity * sizeof(BenchRecord));
+        if(!records){
+            fprintf(stderr, "[ERROR] could not allocate the benchmark records\n");
+            exit(1);
+        }
+    }
+    BenchRecord* r = records + record_count;
+    record_count += 1;
+    snprintf(r->kernel, sizeof(r->kernel), "%s", kernel);
+    snprintf(r->variant, sizeof(r->variant), "%s", variant);
+    r->n        = n;
+    r->seconds  = seconds;
+    r->gflops   = flops / seconds * 1e-9;
+    r->gbps     = bytes / seconds * 1e-9;
+    r->error    = error;
+    r->residual = residual;
+}
+
+static void print_header(const char* title){
+    printf("\n%s\n", title);
+    printf("%-16s %-16s %9s %12s %9s %9s %10s %10s\n", "kernel", "variant", "n", "s/call", "GFLOPS", "GB/s", "error",
+        "residual");
+}
+
+static void print_last(void){
+    const BenchRecord* r = records + record_count - 1;
+    printf("%-16s %-16s %9zu %12.4e %9.2f %9.2f", r->kernel, r->variant, r->n, r->seconds, r->gflops, r->gbps);
+    if(r->error >= 0)    printf(" %10.2e", r->error);
+    else                 printf(" %10s", "-");
+    if(r->residual >= 0) printf(" %10.2e\n", r->residual);
+    else                 printf(" %10s\n", "-");
+}
+
+static int wanted(const char* kernel){
+    return !only || strstr(kernel, only);
+}
+
+// calls call(user) until min_time has passed, \returns the seconds per call
+static double time_calls(void (*call)(void* user), void* user){
+    size_t calls = 0;
+    const double start = now();
+    double elapsed = 0;
+    do{
+        call(user);
+        calls += 1;
+        elapsed = now() - start;
+    } while(elapsed < min_time);
+    return elapsed / calls;
+}
+
+static double uniform(void){
+    return (double)rand() / RAND_MAX - 0.5;
+}
+
+static void* bench_alloc(size_t bytes){
+    void* p = malloc(bytes);
+    if(!p){
+        fprintf(stderr, "[ERROR] could not allocate %zu bytes\n", bytes);
+        exit(1);
+    }
+    return p;
+}
+
+// X==============X GEMM X=================X
+
+typedef struct GemmCall{
+    size_t n;
+    const void* a;
+    const void* b;
+    void* c;
+    int is_float;
+} GemmCall;
+
+static void call_gemm(void* user){
+    const GemmCall* g = (const GemmCall*)user;
+    const size_t n = g->n;
+    if(g->is_float) cym_gemm_f(n, n, n, 1.0f, (const float*)g->a, n, 1, (const float*)g->b, n, 1, 0.0f, (float*)g->c, n, 1);
+    else            cym_gemm_d(n, n, n, 1.0, (const double*)g->a, n, 1, (const double*)g->b, n, 1, 0.0, (double*)g->c, n, 1);
+}
+
+static long double element(const void* p, int is_float, size_t i){
+    return is_float? (long double)((const float*)p)[i] : (long double)((const double*)p)[i];
+}
+
+// the error of 64 sampled entries of c = a * b over the sum of |a_ip * b_pj|, which bounds the rounding of a dot product
+static double gemm_error(const GemmCall* g){
+    const size_t n = g->n;
+    double worst = 0;
+    for(int s = 0; s < 64; s+=1){
+        const size_t i = (size_t)rand() % n, j = (size_t)rand() % n;
+        long double exact = 0, scale = 0;
+        for(size_t p = 0; p < n; p+=1){
+            const long double t = element(g->a, g->is_float, i * n + p) * element(g->b, g->is_float, p * n + j);
+            exact += t;
+            scale += fabsl(t);
+        }
+        const double e = (double)(fabsl(element(g->c, g->is_float, i * n + j) - exact) / scale);
+        if(e > worst) worst = e;
+    }
+    return worst;
+}
+
+// cym_mat_multiply is this same gemm call
+// the i-j-k loop cym_mat_multiply used before the gemm engine, as the baseline
+static void naive_multiply(const double* a, const double* b, double* c, size_t n){
+    for(size_t i = 0; i < n * n; i+=1) c[i] = 0;
+    for(size_t i = 0; i < n; i+=1){
+        for(size_t j = 0; j < n; j+=1)
+        for(size_t p = 0; p < n; p+=1){
+            c[i * n + j] += a[i * n + p] * b[p * n + j];
+        }
+    }
+}
+
+static void bench_gemm(const size_t* sizes, size_t size_count, int best_level){
+    if(!wanted("gemm")) return;
+    print_header("gemm, n x n times n x n");
+
+    for(size_t s = 0; s < size_count; s+=1){
+        const size_t n = sizes[s];
+        if(!n) continue;
+
+        double* a  = (double*)bench_alloc(n * n * sizeof(double));
+        double* b  = (double*)bench_alloc(n * n * sizeof(double));
+        double* c  = (double*)bench_alloc(n * n * sizeof(double));
+        float*  af = (float*) bench_alloc(n * n * sizeof(float));
+        float*  bf = (float*) bench_alloc(n * n * sizeof(float));
+        float*  cf = (float*) bench_alloc(n * n * sizeof(float));
+        for(size_t i = 0; i < n * n; i+=1){
+            af[i] = (float)(a[i] = uniform());
+            bf[i] = (float)(b[i] = uniform());
+        }
+        const double flops = 2.0 * n * n * n;
+
+        // the naive loop takes minutes past this size
+        if(n <= 512){
+            const double start = now();
+            naive_multiply(a, b, c, n);
+            const GemmCall g = { n, a, b, c, 0 };
+            record("gemm", "naive double", n, now() - start, flops, 3.0 * n * n * sizeof(double), gemm_error(&g), -1);
+            print_last();
+        }
+
+        for(int level = 0; level <= best_level; level+=1){
+            cym_simd_set_level(level);
+            char variant[32];
+            for(int is_float = 0; is_float <= 1; is_float+=1){
+                GemmCall g = { n, is_float? (const void*)af : (const void*)a, is_float? (const void*)bf : (const void*)b,
+                    is_float? (void*)cf : (void*)c, is_float };
+                const double seconds = time_calls(call_gemm, &g);
+                snprintf(variant, sizeof(variant), "%s %s", is_float? "float" : "double", level_names[level]);
+                record("gemm", variant, n, seconds, flops, 3.0 * n * n * (is_float? sizeof(float) : sizeof(double)),
+                    gemm_error(&g), -1);
+                print_last();
+            }
+        }
+        cym_simd_set_level(-1);
+
+        free(a); free(b); free(c);
+        free(af); free(bf); free(cf);
+    }
+}
+
+// X==============X LINEAR SYSTEMS X=================X
+
+typedef struct SolveCall{
+    size_t n;
+    const double* a;
+    const double* y;
+    double* work;
+    double* x;
+} SolveCall;
+
+// cym_solve_gauss factors a in place, so every call starts from a copy (n^2 against the n^3 of the factorization)
+static void call_solve(void* user){
+    const SolveCall* s = (const SolveCall*)user;
+    for(size_t i = 0; i < s->n * s->n; i+=1) s->work[i] = s->a[i];
+    cym_solve_gauss_d(s->work, (double*)s->y, (unsigned int)s->n, s->x);
+}
+
+static void bench_solve(const size_t* sizes, size_t size_count, int best_level){
+    if(!wanted("solve_gauss")) return;
+    print_header("cym_solve_gauss, n x n system with a known solution");
+
+    for(size_t s = 0; s < size_count; s+=1){
+        const size_t n = sizes[s];
+        if(!n || n > 4096) continue;
+
+        double* a     = (double*)bench_alloc(n * n * sizeof(double));
+        double* work  = (double*)bench_alloc(n * n * sizeof(double));
+        double* y     = (double*)bench_alloc(n * sizeof(double));
+        double* x     = (double*)bench_alloc(n * sizeof(double));
+        double* truth = (double*)bench_alloc(n * sizeof(double));
+        for(size_t i = 0; i < n * n; i+=1) a[i] = uniform();
+        for(size_t i = 0; i < n; i+=1) truth[i] = uniform();
+        // y rounded from the long double product, so the truth solves it to within the conditioning of a
+        for(size_t i = 0; i < n; i+=1){
+            long double sum = 0;
+            for(size_t j = 0; j < n; j+=1) sum += (long double)a[i * n + j] * truth[j];
+            y[i] = (double)sum;
+        }
+
+        for(int level = 0; level <= best_level; level+=best_level? best_level : 1){
+            cym_simd_set_level(level);
+            SolveCall call = { n, a, y, work, x };
+            const double seconds = time_calls(call_solve, &call);
+
+            long double error = 0, scale = 0, residual = 0, a_norm = 0, x_norm = 0, y_norm = 0;
+            for(size_t i = 0; i < n; i+=1){
+                long double r = y[i], row = 0;
+                for(size_t j = 0; j < n; j+=1){
+                    r   -= (long double)a[i * n + j] * x[j];
+                    row += fabsl((long double)a[i * n + j]);
+                }
+                if(fabsl(r) > residual)          residual = fabsl(r);
+                if(row > a_norm)                 a_norm = row;
+                if(fabsl((long double)x[i]) > x_norm) x_norm = fabsl((long double)x[i]);
+                if(fabsl((long double)y[i]) > y_norm) y_norm = fabsl((long double)y[i]);
+                if(fabsl((long double)x[i] - truth[i]) > error) error = fabsl((long double)x[i] - truth[i]);
+                if(fabsl((long double)truth[i]) > scale) scale = fabsl((long double)truth[i]);
+            }
+
+            char variant[32];
+            snprintf(variant, sizeof(variant), "double %s", level_names[level]);
+            record("solve_gauss", variant, n, seconds, 2.0 / 3.0 * n * n * n + 2.0 * n * n, (double)n * n * sizeof(double),
+                (double)(error / scale), (double)(residual / (a_norm * x_norm + y_norm)));
+            print_last();
+        }
+        cym_simd_set_level(-1);
+
+        free(a); free(work); free(y); free(x); free(truth);
+    }
+}
+
+// X==============X FITS X=================X
+
+#define POLY_ORDER 8
+
+typedef struct PolyCall{
+    size_t n;
+    const double* x;
+    const double* y;
+    double* coefficients;
+} PolyCall;
+
+static void call_poly_fit(void* user){
+    const PolyCall* p = (const PolyCall*)user;
+    cym_poly_fit_d(p->x, p->y, p->n, POLY_ORDER, p->coefficients);
+}
+
+// fits exact samples of a known polynomial over [-1, 3], the error being that of the coefficients and the residual the
+// relative rms of y - p(x)
+static void bench_poly_fit(int best_level){
+    if(!wanted("poly_fit")) return;
+    print_header("cym_poly_fit, order 8 through n exact samples");
+
+    const size_t sizes[] = { 1000, 100000, 1000000 };
+    long double truth[POLY_ORDER + 1];
+    for(int k = 0; k <= POLY_ORDER; k+=1) truth[k] = ((k % 2)? -1.0L : 1.0L) / (k + 1);
+
+    for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s+=1){
+        const size_t n = sizes[s];
+        double* x = (double*)bench_alloc(n * sizeof(double));
+        double* y = (double*)bench_alloc(n * sizeof(double));
+        for(size_t i = 0; i < n; i+=1){
+            x[i] = 1.0 + 4.0 * uniform();
+            long double v = 0;
+            for(int k = POLY_ORDER; k >= 0; k-=1) v = v * x[i] + truth[k];
+            y[i] = (double)v;
+        }
+
+        for(int level = 0; level <= best_level; level+=best_level? best_level : 1){
+            cym_simd_set_level(level);
+            double coefficients[POLY_ORDER + 1];
+            PolyCall call = { n, x, y, coefficients };
+            const double seconds = time_calls(call_poly_fit, &call);
+
+            long double error = 0, scale = 0, r2 = 0, y2 = 0;
+            for(int k = 0; k <= POLY_ORDER; k+=1){
+                if(fabsl(coefficients[k] - truth[k]) > error) error = fabsl(coefficients[k] - truth[k]);
+                if(fabsl(truth[k]) > scale) scale = fabsl(truth[k]);
+            }
+            for(size_t i = 0; i < n; i+=1){
+                long double v = 0;
+                for(int k = POLY_ORDER; k >= 0; k-=1) v = v * x[i] + coefficients[k];
+                r2 += (y[i] - v) * (y[i] - v);
+                y2 += (long double)y[i] * y[i];
+            }
+
+            char variant[32];
+            snprintf(variant, sizeof(variant), "double %s", level_names[level]);
+            // the QR of the n x (order + 1) design matrix dominates
+            record("poly_fit", variant, n, seconds, 2.0 * n * (POLY_ORDER + 1) * (POLY_ORDER + 1), 2.0 * n * sizeof(double),
+                (double)(error / scale), (double)sqrtl(r2 / y2));
+            print_last();
+        }
+        cym_simd_set_level(-1);
+
+        free(x); free(y);
+    }
+}
+
+// X==============X INTERPOLATION X=================X
+
+#define INTERPOL_POINTS 100000
+
+typedef struct InterpolCall{
+    size_t n;
+    const double* x;
+    const double* y;
+    const double* weights;
+    const double* nodes;
+    const double* coefficients;
+    const double* t;
+    double* out;
+} InterpolCall;
+
+static void call_barycentric(void* user){
+    const InterpolCall* p = (const InterpolCall*)user;
+    cym_barycentric_eval_batch_d(p->x, p->y, p->weights, p->n, p->t, INTERPOL_POINTS, p->out);
+}
+
+static void call_newton(void* user){
+    const InterpolCall* p = (const InterpolCall*)user;
+    cym_newton_eval_batch_d(p->nodes, p->coefficients, p->n, p->t, INTERPOL_POINTS, p->out);
+}
+
+// interpolates 1 / (1 + 25 x^2) on n Chebyshev nodes (in decreasing order) and evaluates the interpolant at 100000 points,
+// the error being against the barycentric form evaluated in long double with long double weights
+static void bench_interpol(int best_level){
+    if(!wanted("barycentric") && !wanted("newton")) return;
+    print_header("cym_barycentric_eval_batch and cym_newton_eval_batch, n Chebyshev nodes at 100000 points");
+
+    const size_t sizes[] = { 16, 64, 256 };
+    double* t   = (double*)bench_alloc(INTERPOL_POINTS * sizeof(double));
+    double* out = (double*)bench_alloc(INTERPOL_POINTS * sizeof(double));
+    long double* reference = (long double*)bench_alloc(INTERPOL_POINTS * sizeof(long double));
+    for(size_t i = 0; i < INTERPOL_POINTS; i+=1) t[i] = 2.0 * uniform();
+
+    for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s+=1){
+        const size_t n = sizes[s];
+        double* x       = (double*)bench_alloc(5 * n * sizeof(double));
+        double* y       = x + n;
+        double* weights = x + 2 * n;
+        double* nodes   = x + 3 * n;
+        double* coefficients = x + 4 * n;
+        for(size_t i = 0; i < n; i+=1){
+            x[i] = cos(3.14159265358979323846 * (i + 0.5) / n);
+            y[i] = 1 / (1 + 25 * x[i] * x[i]);
+        }
+        cym_barycentric_weights_d(x, n, weights);
+        cym_newton_coefficients_d(x, y, n, nodes, coefficients);
+
+        // the weights of Chebyshev nodes of the first kind are (-1)^j sin((2j + 1) pi / 2n), up to a common factor
+        long double scale = 0;
+        for(size_t i = 0; i < INTERPOL_POINTS; i+=1){
+            long double num = 0, den = 0;
+            reference[i] = 0.0L / 0.0L;
+            for(size_t j = 0; j < n; j+=1){
+                const long double w = ((j % 2)? -1.0L : 1.0L) * sinl(3.14159265358979323846L * (2 * j + 1) / (2 * n));
+                const long double d = (long double)t[i] - x[j];
+                if(d == 0){
+                    reference[i] = y[j];
+                    break;
+                }
+                num += w / d * y[j];
+                den += w / d;
+            }
+            if(reference[i] != reference[i]) reference[i] = num / den;
+            if(fabsl(reference[i]) > scale) scale = fabsl(reference[i]);
+        }
+
+        for(int form = 0; form < 2; form+=1){
+            const char* kernel = form? "newton" : "barycentric";
+            if(!wanted(kernel)) continue;
+            for(int level = 0; level <= best_level; level+=best_level? best_level : 1){
+                cym_simd_set_level(level);
+                InterpolCall call = { n, x, y, weights, nodes, coefficients, t, out };
+                const double seconds = time_calls(form? call_newton : call_barycentric, &call);
+
+                long double error = 0;
+                for(size_t i = 0; i < INTERPOL_POINTS; i+=1){
+                    if(!(fabsl(out[i] - reference[i]) <= error)) error = fabsl(out[i] - reference[i]);
+                }
+
+                char variant[32];
+                snprintf(variant, sizeof(variant), "double %s", level_names[level]);
+                // a Newton step is a subtraction and a multiply add, a barycentric node a division counted as one flop
+                record(kernel, variant, n, seconds, (form? 3.0 : 5.0) * n * INTERPOL_POINTS, 2.0 * INTERPOL_POINTS * sizeof(double),
+                    (double)(error / scale), -1);
+                print_last();
+            }
+        }
+        cym_simd_set_level(-1);
+
+        free(x);
+    }
+    free(t); free(out); free(reference);
+}
+
+// X==============X BLAS 1 X=================X
+
+typedef struct VectorCall{
+    size_t n;
+    const double* x;
+    double* y;
+    double result;
+} VectorCall;
+
+static void call_axpy(void* user){
+    VectorCall* v = (VectorCall*)user;
+    cym_axpy_d(v->n, 1e-9, v->x, 1, v->y, 1);
+}
+
+static void call_dot(void* user){
+    VectorCall* v = (VectorCall*)user;
+    v->result = cym_dot_d(v->n, v->x, 1, v->y, 1);
+}
+
+static void bench_blas1(int best_level){
+    if(!wanted("axpy") && !wanted("dot")) return;
+    print_header("BLAS 1, vectors of n doubles");
+
+    const size_t sizes[] = { 1000, 100000, 10000000 };
+    for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s+=1){
+        const size_t n = sizes[s];
+        double* x = (double*)bench_alloc(n * sizeof(double));
+        double* y = (double*)bench_alloc(n * sizeof(double));
+        double* y0 = (double*)bench_alloc(n * sizeof(double));
+        for(size_t i = 0; i < n; i+=1){
+            x[i]  = uniform();
+            y0[i] = uniform();
+        }
+
+        for(int level = 0; level <= best_level; level+=best_level? best_level : 1){
+            cym_simd_set_level(level);
+            char variant[32];
+            snprintf(variant, sizeof(variant), "double %s", level_names[level]);
+            VectorCall call = { n, x, y, 0 };
+
+            if(wanted("axpy")){
+                for(size_t i = 0; i < n; i+=1) y[i] = y0[i];
+                const double seconds = time_calls(call_axpy, &call);
+                // one more call from y0 for the error
+                for(size_t i = 0; i < n; i+=1) y[i] = y0[i];
+                call_axpy(&call);
+                double error = 0;
+                for(size_t i = 0; i < n; i+=1){
+                    const long double exact = 1e-9L * x[i] + y0[i];
+                    const double e = (double)(fabsl(y[i] - exact) / fabsl(exact));
+                    if(e > error) error = e;
+                }
+                record("axpy", variant, n, seconds, 2.0 * n, 3.0 * n * sizeof(double), error, -1);
+                print_last();
+            }
+            if(wanted("dot")){
+                for(size_t i = 0; i < n; i+=1) y[i] = y0[i];
+                const double seconds = time_calls(call_dot, &call);
+                long double exact = 0, scale = 0;
+                for(size_t i = 0; i < n; i+=1){
+                    exact += (long double)x[i] * y[i];
+                    scale += fabsl((long double)x[i] * y[i]);
+                }
+                record("dot", variant, n, seconds, 2.0 * n, 2.0 * n * sizeof(double),
+                    (double)(fabsl(call.result - exact) / scale), -1);
+                print_last();
+            }
+        }
+        cym_simd_set_level(-1);
+
+        free(x); free(y); free(y0);
+    }
+}
+
+// X==============X SPARSE X=================X
+
+typedef struct SpmvCall{
+    const CymSparse_d* a;
+    const double* x;
+    double* y;
+} SpmvCall;
+
+static void call_spmv(void* user){
+    const SpmvCall* s = (const SpmvCall*)user;
+    cym_sparse_mv_d(1.0, s->a, s->x, 0.0, s->y);
+}
+
+// the 5 point laplacian of a g x g grid in CSR
+static void bench_spmv(int best_level){
+    if(!wanted("sparse_mv")) return;
+    print_header("cym_sparse_mv, 5 point laplacian of a g x g grid (n = g^2 rows)");
+
+    const size_t grids[] = { 64, 512, 1024 };
+    for(size_t s = 0; s < sizeof(grids) / sizeof(grids[0]); s+=1){
+        const size_t g = grids[s], n = g * g;
+        unsigned int* rows    = (unsigned int*)bench_alloc(5 * n * sizeof(unsigned int));
+        unsigned int* columns = (unsigned int*)bench_alloc(5 * n * sizeof(unsigned int));
+        double* values = (double*)bench_alloc(5 * n * sizeof(double));
+        double* x = (double*)bench_alloc(n * sizeof(double));
+        double* y = (double*)bench_alloc(n * sizeof(double));
+        size_t count = 0;
+        for(size_t i = 0; i < g; i+=1)
+        for(size_t j = 0; j < g; j+=1){
+            const unsigned int row = (unsigned int)(i * g + j);
+            const long neighbours[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+            rows[count] = columns[count] = row;
+            values[count++] = 4;
+            for(int k = 0; k < 4; k+=1){
+                const long ni = (long)i + neighbours[k][0], nj = (long)j + neighbours[k][1];
+                if(ni < 0 || nj < 0 || ni >= (long)g || nj >= (long)g) continue;
+                rows[count] = row;
+                columns[count] = (unsigned int)(ni * g + nj);
+                values[count++] = -1;
+            }
+            x[row] = uniform();
+        }
+        CymSparse_d a;
+        if(cym_sparse_from_coo_d(n, n, rows, columns, values, count, CYM_SPARSE_CSR, &a)){
+            fprintf(stderr, "[ERROR] could not build the %zux%zu laplacian\n", n, n);
+            exit(1);
+        }
+        const double bytes = (double)a.nonzeros * (sizeof(double) + sizeof(unsigned int))
+            + n * (sizeof(size_t) + 2 * sizeof(double));
+
+        for(int level = 0; level <= best_level; level+=best_level? best_level : 1){
+            cym_simd_set_level(level);
+            SpmvCall call = { &a, x, y };
+            const double seconds = time_calls(call_spmv, &call);
+
+            double error = 0;
+            for(size_t r = 0; r < n; r+=1){
+                long double exact = 0, scale = 0;
+                for(size_t k = a.offsets[r]; k < a.offsets[r + 1]; k+=1){
+                    exact += (long double)a.values[k] * x[a.indices[k]];
+                    scale += fabsl((long double)a.values[k] * x[a.indices[k]]);
+                }
+                const double e = (double)(fabsl(y[r] - exact) / scale);
+                if(e > error) error = e;
+            }
+
+            char variant[32];
+            snprintf(variant, sizeof(variant), "double %s", level_names[level]);
+            record("sparse_mv", variant, n, seconds, 2.0 * a.nonzeros, bytes, error, -1);
+            print_last();
+        }
+        cym_simd_set_level(-1);
+
+        cym_sparse_free_d(&a);
+        free(rows); free(columns); free(values); free(x); free(y);
+    }
+}
+
+// X==============X SQUARE ROOTS X=================X
+
+// the square root variants compared by bench_roots
+enum{ ROOT_QUAKE, ROOT_QUAKE_SQRT, ROOT_RSQRT_D, ROOT_RSQRT_D_FAST, ROOT_RSQRT_F, ROOT_RSQRT_F_FAST, ROOT_SQRT_D, ROOT_SQRT_F, ROOT_COUNT };
+static const char* root_names[] = { "quake", "1/quake", "rsqrt d", "fast d", "rsqrt f", "fast f", "sqrt d", "sqrt f" };
+
+typedef struct RootCall{
+    int op;
+    size_t n;
+    const double* x;
+    const float* xf;
+    double* out;
+    float* outf;
+} RootCall;
+
+static void call_roots(void* user){
+    const RootCall* r = (const RootCall*)user;
+    const size_t n = r->n;
+    switch(r->op){
+    case ROOT_QUAKE:        for(size_t i = 0; i < n; i+=1) r->out[i] = cym_Q_rsqrt_d(r->x[i]); break;
+    case ROOT_QUAKE_SQRT:   for(size_t i = 0; i < n; i+=1) r->out[i] = 1.0 / cym_Q_rsqrt_d(r->x[i]); break;
+    case ROOT_RSQRT_D:      cym_rsqrt_batch_d(r->x, n, r->out, 0); break;
+    case ROOT_RSQRT_D_FAST: cym_rsqrt_batch_d(r->x, n, r->out, 1); break;
+    case ROOT_RSQRT_F:      cym_rsqrt_batch_f(r->xf, n, r->outf, 0); break;
+    case ROOT_RSQRT_F_FAST: cym_rsqrt_batch_f(r->xf, n, r->outf, 1); break;
+    case ROOT_SQRT_D:       cym_sqrt_batch_d(r->x, n, r->out); break;
+    case ROOT_SQRT_F:       cym_sqrt_batch_f(r->xf, n, r->outf); break;
+    }
+}
+
+// times op over the n values, \returns the nanoseconds per value and writes the biggest relative error against the long double
+// references to error
+static double bench_roots(RootCall* call, const long double* ref_rsqrt, const long double* ref_rsqrt_f, double* error){
+    const int op = call->op;
+    const double seconds = time_calls(call_roots, call);
+
+    const int is_float = op == ROOT_RSQRT_F || op == ROOT_RSQRT_F_FAST || op == ROOT_SQRT_F;
+    const int is_sqrt  = op == ROOT_QUAKE_SQRT || op == ROOT_SQRT_D || op == ROOT_SQRT_F;
+    *error = 0;
+    for(size_t i = 0; i < call->n; i+=1){
+        const long double value = is_float? call->outf[i] : call->out[i];
+        const long double ref   = is_float? ref_rsqrt_f[i] : ref_rsqrt[i];
+        const long double exact = is_sqrt? (is_float? call->xf[i] : call->x[i]) * ref : ref;
+        const double e = (double)((value - exact) / exact);
+        if(e > *error || -e > *error) *error = (e < 0)? -e : e;
+    }
+    return seconds * 1e9 / call->n;
+}
+
+static void bench_all_roots(int best_level){
+    if(!wanted("sqrt") && !wanted("quake")) return;
+    const size_t n = 1 << 20;
+    double* x   = (double*)bench_alloc(n * sizeof(double));
+    double* out = (double*)bench_alloc(n * sizeof(double));
+    float*  xf   = (float*)bench_alloc(n * sizeof(float));
+    float*  outf = (float*)bench_alloc(n * sizeof(float));
+    long double* ref   = (long double*)bench_alloc(n * sizeof(long double));
+    long double* ref_f = (long double*)bench_alloc(n * sizeof(long double));
+
+    // values spread over [1e-30, 1e30], the references being the correctly rounded roots refined in long double
+    for(size_t i = 0; i < n; i+=1){
+        double v = 1.0 + (double)rand() / RAND_MAX;
+        const int exponent = rand() % 200 - 100;
+        for(int e = 0; e < exponent; e+=1) v *= 2;
+        for(int e = 0; e > exponent; e-=1) v *= 0.5;
+        xf[i] = (float)v;
+        x[i]  = v;
+    }
+    cym_sqrt_batch_d(x, n, out);
+    for(size_t i = 0; i < n; i+=1){
+        long double r = 1.0L / out[i];
+        ref[i] = r * (1.5L - 0.5L * x[i] * r * r);
+        const double sf = cym_sqrt(xf[i]);
+        r = 1.0L / sf;
+        ref_f[i] = r * (1.5L - 0.5L * xf[i] * r * r);
+    }
+
+    printf("\nsquare roots of 2^20 values, ns per value (max relative error)\n");
+    printf("%8s", "simd");
+    for(int op = 0; op < ROOT_COUNT; op+=1) printf(" %18s", root_names[op]);
+    printf("\n");
+
+    for(int level = 0; level <= best_level; level+=1){
+        cym_simd_set_level(level);
+        printf("%8s", level_names[level]);
+        for(int op = 0; op < ROOT_COUNT; op+=1){
+            RootCall call = { op, n, x, xf, out, outf };
+            double error;
+            const double ns = bench_roots(&call, ref, ref_f, &error);
+            printf(" %7.3f (%8.1e)", ns, error);
+
+            const size_t size = (op == ROOT_RSQRT_F || op == ROOT_RSQRT_F_FAST || op == ROOT_SQRT_F)? sizeof(float) : sizeof(double);
+            record(root_names[op], level_names[level], n, ns * 1e-9 * n, 0, 2.0 * n * size, error, -1);
+        }
+        printf("\n");
+    }
+    cym_simd_set_level(-1);
+
+    free(x); free(out); free(xf); free(outf); free(ref); free(ref_f);
+}
+
+// X==============X LEVENBERG-MARQUARDT X=================X
+
+// the Levenberg-Marquardt fit of a sum of gaussians y = sum a exp(-((x - c) / s)^2 / 2), 3 parameters per gaussian
+typedef struct LmProblem{
+    size_t gaussians;
+    size_t points;
+    const double* x;
+    const double* y;
+} LmProblem;
+
+static int lm_residuals(const double* params, double* residuals, void* user){
+    const LmProblem* problem = (const LmProblem*)user;
+    for(size_t i = 0; i < problem->points; i+=1) residuals[i] = -problem->y[i];
+    for(size_t k = 0; k < problem->gaussians; k+=1){
+        const double a = params[3 * k], c = params[3 * k + 1], s = params[3 * k + 2];
+        for(size_t i = 0; i < problem->points; i+=1){
+            const double d = (problem->x[i] - c) / s;
+            residuals[i] += a * exp(-0.5 * d * d);
+        }
+    }
+    return 0;
+}
+
+static int lm_jacobian(const double* params, double* jacobian, void* user){
+    const LmProblem* problem = (const LmProblem*)user;
+    const size_t m = problem->points;
+    for(size_t k = 0; k < problem->gaussians; k+=1){
+        const double a = params[3 * k], c = params[3 * k + 1], s = params[3 * k + 2];
+        double* da = jacobian + 3 * k * m;
+        for(size_t i = 0; i < m; i+=1){
+            const double d = (problem->x[i] - c) / s;
+            const double e = exp(-0.5 * d * d);
+            da[i]         = e;
+            da[m + i]     = a * e * d / s;
+            da[2 * m + i] = a * e * d * d / s;
+        }
+    }
+    return 0;
+}
+
+// fits gaussians from a guess off by up to half their width, with the analytic jacobian or forward differences and with or without the geodesic
+// acceleration, the convergence rate being the decades of cost removed per second, the recorded error is that of the parameters
+static void bench_lm(void){
+    if(!wanted("lm")) return;
+    const size_t gaussians = 16, points = 50000, p = 3 * gaussians;
+    double* x = (double*)bench_alloc(points * sizeof(double));
+    double* y = (double*)bench_alloc(points * sizeof(double));
+    double* truth  = (double*)bench_alloc(p * sizeof(double));
+    double* params = (double*)bench_alloc(p * sizeof(double));
+
+    for(size_t k = 0; k < gaussians; k+=1){
+        truth[3 * k]     = 1 + 0.25 * (double)k;
+        truth[3 * k + 1] = (k + 0.5) / gaussians;
+        truth[3 * k + 2] = 0.3 / gaussians;
+    }
+    LmProblem problem = { gaussians, points, x, y };
+    for(size_t i = 0; i < points; i+=1){
+        x[i] = (double)i / points;
+        y[i] = 0;
+    }
+    // the residuals against y = 0 are the model itself
+    lm_residuals(truth, y, &problem);
+    for(size_t i = 0; i < points; i+=1) y[i] += 1e-3 * ((double)rand() / RAND_MAX - 0.5);
+
+    printf("\nLevenberg-Marquardt, %zu gaussians (%zu parameters) over %zu points\n", gaussians, p, points);
+    printf("%10s %9s %6s %6s %6s %12s %12s %9s %12s\n", "jacobian", "geodesic", "status", "iters", "evals", "start cost",
+        "final cost", "seconds", "decades/s");
+
+    for(int analytic = 1; analytic >= 0; analytic-=1)
+    for(int geodesic = 0; geodesic <= 1; geodesic+=1){
+        for(size_t k = 0; k < gaussians; k+=1){
+            params[3 * k]     = truth[3 * k] * (1 + 0.1 * sin(3.1 * k));
+            params[3 * k + 1] = truth[3 * k + 1] + 0.5 * truth[3 * k + 2] * sin(1.7 * k);
+            params[3 * k + 2] = truth[3 * k + 2] * (1 + 0.2 * sin(2.3 * k));
+        }
+        CymLmOptions options = { 0 };
+        options.geodesic = geodesic;
+        CymLmResult result;
+        cym_lm_solve_d(lm_residuals, analytic? lm_jacobian : NULL, &problem, params, p, points, &options, &result);
+        const double decades = log10(result.initial_cost / result.cost);
+        printf("%10s %9s %6d %6d %6zu %12.4e %12.4e %9.4f %12.2f\n", analytic? "analytic" : "forward", geodesic? "yes" : "no",
+            result.status, result.iterations, result.residual_evaluations, result.initial_cost, result.cost, result.seconds,
+            decades / result.seconds);
+
+        double error = 0, scale = 0;
+        for(size_t k = 0; k < p; k+=1){
+            if(fabs(params[k] - truth[k]) > error) error = fabs(params[k] - truth[k]);
+            if(fabs(truth[k]) > scale) scale = fabs(truth[k]);
+        }
+        char variant[32];
+        snprintf(variant, sizeof(variant), "%s%s", analytic? "analytic" : "forward", geodesic? " geodesic" : "");
+        record("lm", variant, points, result.seconds, 0, 0, error / scale, sqrt(result.cost / result.initial_cost));
+    }
+
+    free(x); free(y); free(truth); free(params);
+}
+
+// X==============X JSON X=================X
+
+// one record per line, so compare_files can read the files back with a line scanner instead of a json parser
+static int write_json(const char* path){
+    FILE* file = fopen(path, "w");
+    if(!file){
+        fprintf(stderr, "[ERROR] could not open '%s'\n", path);
+        return 1;
+    }
+    fprintf(file, "{\n\"simd\": \"%s\",\n\"threads\": %u,\n\"results\": [\n", level_names[cym_simd_level()], cym_get_num_threads());
+    for(size_t i = 0; i < record_count; i+=1){
+        const BenchRecord* r = records + i;
+        fprintf(file, "{\"kernel\": \"%s\", \"variant\": \"%s\", \"n\": %zu, \"seconds\": %.6e, \"gflops\": %.6e, "
+            "\"gbps\": %.6e, \"error\": %.6e, \"residual\": %.6e}%s\n", r->kernel, r->variant, r->n, r->seconds, r->gflops,
+            r->gbps, r->error, r->residual, (i + 1 < record_count)? "," : "");
+    }
+    fprintf(file, "]\n}\n");
+    fclose(file);
+    return 0;
+}
+
+// \returns a pointer just past "key": in line, NULL if it is not there
+static const char* json_field(const char* line, const char* key){
+    char pattern[48];
+    snprintf(pattern, sizeof(pattern), "\"%s\": ", key);
+    const char* at = strstr(line, pattern);
+    return at? at + strlen(pattern) : NULL;
+}
+
+// reads the records of a file written by write_json, \returns how many, or -1 if the file could not be read
+static long read_json(const char* path, BenchRecord** out){
+    FILE* file = fopen(path, "r");
+    if(!file){
+        fprintf(stderr, "[ERROR] could not open '%s'\n", path);
+        return -1;
+    }
+    BenchRecord* list = NULL;
+    size_t count = 0, capacity = 0;
+    char line[1024];
+    while(fgets(line, sizeof(line), file)){
+        const char* kernel  = json_field(line, "kernel");
+        const char* variant = json_field(line, "variant");
+        const char* fields[6] = { json_field(line, "n"), json_field(line, "seconds"), json_field(line, "gflops"),
+            json_field(line, "gbps"), json_field(line, "error"), json_field(line, "residual") };
+        if(!kernel || !variant || !fields[0] || !fields[1] || !fields[2] || !fields[3] || !fields[4] || !fields[5]) continue;
+
+        if(count == capacity){
+            capacity = capacity? 2 * capacity : 64;
+            BenchRecord* grown = (BenchRecord*)realloc(list, capacity * sizeof(BenchRecord));
+            if(!grown){
+                free(list);
+                fclose(file);
+                fprintf(stderr, "[ERROR] could not allocate the records of '%s'\n", path);
+                return -1;
+            }
+            list = grown;
+        }
+        BenchRecord* r = list + count;
+        count += 1;
+        if(sscanf(kernel, "\"%31[^\"]\"", r->kernel) != 1)   r->kernel[0] = 0;
+        if(sscanf(variant, "\"%31[^\"]\"", r->variant) != 1) r->variant[0] = 0;
+        r->n        = strtoul(fields[0], NULL, 10);
+        r->seconds  = strtod(fields[1], NULL);
+        r->gflops   = strtod(fields[2], NULL);
+        r->gbps     = strtod(fields[3], NULL);
+        r->error    = strtod(fields[4], NULL);
+        r->residual = strtod(fields[5], NULL);
+    }
+    fclose(file);
+    *out = list;
+    return (long)count;
+}
+
+// prints the speedup (old time over new time) and the errors of every measurement found in both files
+static int compare_files(const char* old_path, const char* new_path){
+    BenchRecord* old_records = NULL;
+    BenchRecord* new_records = NULL;
+    const long old_count = read_json(old_path, &old_records);
+    const long new_count = read_json(new_path, &new_records);
+    if(old_count < 0 || new_count < 0){
+        free(old_records);
+        free(new_records);
+        return 1;
+    }
+
+    printf("%-16s %-16s %9s %12s %12s %9s %10s %10s\n", "kernel", "variant", "n", "old s/call", "new s/call", "speedup",
+        "old error", "new error");
+    long matched = 0;
+    double log_speedup = 0;
+    for(long i = 0; i < new_count; i+=1){
+        const BenchRecord* r = new_records + i;
+        const BenchRecord* o = NULL;
+        for(long j = 0; j < old_count && !o; j+=1){
+            const BenchRecord* c = old_records + j;
+            if(c->n == r->n && !strcmp(c->kernel, r->kernel) && !strcmp(c->variant, r->variant)) o = c;
+        }
+        if(!o || r->seconds <= 0 || o->seconds <= 0) continue;
+        matched += 1;
+        log_speedup += log(o->seconds / r->seconds);
+        printf("%-16s %-16s %9zu %12.4e %12.4e %8.2fx", r->kernel, r->variant, r->n, o->seconds, r->seconds,
+            o->seconds / r->seconds);
+        if(o->error >= 0) printf(" %10.2e", o->error);
+        else              printf(" %10s", "-");
+        if(r->error >= 0) printf(" %10.2e\n", r->error);
+        else              printf(" %10s\n", "-");
+    }
+    if(matched) printf("\n%ld measurements in both files, geometric mean speedup %.3fx\n", matched, exp(log_speedup / matched));
+    else        printf("\nno measurement is in both files\n");
+    printf("%ld only in '%s', %ld only in '%s'\n", old_count - matched, old_path, new_count - matched, new_path);
+
+    free(old_records);
+    free(new_records);
+    return 0;
+}
+
+static void usage(const char* name){
+    printf("usage: %s [options] <optional: matrix sizes>\n", name);
+    printf("    --json <file>            also writes every measurement to file\n");
+    printf("    --compare <old> <new>    compares two files written by --json instead of benchmarking\n");
+    printf("    --only <kernel>          runs the benchmarks of the kernels whose name contains this (gemm, solve_gauss,\n");
+    printf("                             poly_fit, barycentric, newton, axpy, dot, sparse_mv, sqrt, quake, lm)\n");
+    printf("    --min-time <seconds>     minimum time of each measurement (default %g)\n", BENCH_MIN_TIME);
+}
+
+int main(int argc, char** argv){
+
+    size_t default_sizes[] = { 64, 128, 256, 512, 1024, 2048 };
+    size_t* sizes = default_sizes;
+    size_t size_count = sizeof(default_sizes) / sizeof(default_sizes[0]);
+    const char* json_path = NULL;
+
+    size_t* given = (size_t*)bench_alloc(argc * sizeof(size_t));
+    size_t given_count = 0;
+    for(int i = 1; i < argc; i+=1){
+        if(!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")){
+            usage(argv[0]);
+            free(given);
+            return 0;
+        } else if(!strcmp(argv[i], "--compare") && i + 2 < argc){
+            const int status = compare_files(argv[i + 1], argv[i + 2]);
+            free(given);
+            return status;
+        } else if(!strcmp(argv[i], "--json") && i + 1 < argc){
+            json_path = argv[++i];
+        } else if(!strcmp(argv[i], "--only") && i + 1 < argc){
+            only = argv[++i];
+        } else if(!strcmp(argv[i], "--min-time") && i + 1 < argc){
+            min_time = strtod(argv[++i], NULL);
+        } else if(argv[i][0] >= '0' && argv[i][0] <= '9'){
+            given[given_count++] = strtoul(argv[i], NULL, 10);
+        } else{
+            fprintf(stderr, "[ERROR] unknown argument '%s'\n", argv[i]);
+            usage(argv[0]);
+            free(given);
+            return 1;
+        }
+    }
+    if(given_count){
+        sizes = given;
+        size_count = given_count;
+    }
+
+    const int best_level = cym_simd_level();
+    printf("simd %s, %u threads\n", level_names[best_level], cym_get_num_threads());
+
+    bench_gemm(sizes, size_count, best_level);
+    bench_solve(sizes, size_count, best_level);
+    bench_poly_fit(best_level);
+    bench_interpol(best_level);
+    bench_blas1(best_level);
+    bench_spmv(best_level);
+    bench_all_roots(best_level);
+
+    cym_simd_set_level(-1);
+    bench_lm();
+
+    cym_simd_set_level(-1);
+    int status = 0;
+    if(json_path) status = write_json(json_path);
+
+    free(given);
+    free(records);
+    return status;
+}
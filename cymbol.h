@@ -205,6 +205,59 @@ CYMDEF void* _cym_unpack_data(const void* src, ...);
 */
 CYMDEF void* cym_pack_values(void* dest, const char* __format, ...);
 
+// flags for the *_ex packing functions
+enum CymPackFlags{
+    CYMPACK_DEFAULT         = 0,
+    // also packs the values passed to '*' prefixes (as int) right before the values they describe,
+    // so the packed data can be decoded without the original arguments (check cymlog.h)
+    CYMPACK_STORE_ASTERIX   = 1,
+};
+
+// same as cym_pack_values, but takes a va_list
+CYMDEF void* cym_vpack_values(void* dest, const char* format, va_list args);
+
+// same as cym_vpack_values, but with flags given in CymPackFlags enum
+CYMDEF void* cym_vpack_values_ex(void* dest, int flags, const char* format, va_list args);
+
+// \returns the number of bytes cym_vpack_values_ex would write for the given format and arguments, without writing anything
+CYMDEF size_t cym_vpack_size(int flags, const char* format, va_list args);
+
+// \returns the number of bytes cym_pack_values would write for the given format and arguments, without writing anything
+CYMDEF size_t cym_pack_size(const char* format, ...);
+
+// a parsed format specifier, check cym_compile_format
+typedef struct CymFormatSpec{
+    // type given in CymCtypes enum
+    int    ctype;
+    // bit 1 set if the count is passed as an argument ('*' before the dot), bit 2 if the maximum string size is ('*' after it)
+    int    asterix;
+    // how many values of ctype are packed
+    size_t count;
+    // maximum size of packed strings (SIZE_MAX if not given)
+    size_t max_size;
+} CymFormatSpec;
+
+// parses format ahead of time, so it can be packed repeatedly without being parsed again (check cym_vpack_compiled).
+// writes at most max_specs specifiers to specs, specs can be NULL to query how many there are.
+// specifiers without a type are dropped, unless they take '*' arguments
+// \returns the number of specifiers in format
+CYMDEF size_t cym_compile_format(const char* format, CymFormatSpec* specs, size_t max_specs);
+
+// same as cym_vpack_values_ex, but takes the format already parsed by cym_compile_format
+CYMDEF void* cym_vpack_compiled(void* dest, int flags, const CymFormatSpec* specs, size_t spec_count, va_list args);
+
+// same as cym_vpack_size, but takes the format already parsed by cym_compile_format
+CYMDEF size_t cym_vpack_compiled_size(int flags, const CymFormatSpec* specs, size_t spec_count, va_list args);
+
+// parses the count and size prefixes of the specifier at format (just after its '%'), before_dot getting the count (1 if
+// none, untouched for a '*'), after_dot the size after a '.' (SIZE_MAX if none) and asterix bit 0 for a '*' count and
+// bit 1 for a '.*' size
+// \returns the type specifier after the prefixes
+CYMDEF const char* cym_parse_format_preffixes(const char* format, size_t* before_dot, size_t* after_dot, int* asterix);
+
+// \returns the length of the type specifier at the beginning of format (the part after the prefixes), or 0 if there is none
+CYMDEF size_t cym_format_token_len(const char* format);
+
 /*
     Unpacks a sequence of values from src to passed pointers.
     pointers are passed through variadics, where the types are given through the formated string.
@@ -254,11 +307,11 @@ CYMDEF size_t cym_atom_size(int atom_type){
     case CYMATOM_U32:
     case CYMATOM_I32:
     case CYMATOM_F32:
-        return 3;
+        return 4;
     case CYMATOM_U64:
     case CYMATOM_I64:
     case CYMATOM_F64:
-        return 4;
+        return 8;
     
     default:
         return 0;
@@ -401,45 +454,67 @@ CYMDEF int cym_get_atomtype_from_format(const char* format, int compare_whole_cs
 
 
 
-CYMDEF int cym_get_ctype_from_format(const char* format, int compare_whole_cstr){
+static const struct { const char* str; int ctype; } icym_ctype_formats[] = {
+    {"hhu", CYMCTYPE_UNSIGNED_CHAR},
+    {"c",   CYMCTYPE_CHAR},
+    {"hhd", CYMCTYPE_SIGNED_CHAR},
+    {"hhi", CYMCTYPE_SIGNED_CHAR},
 
-    if(cym_compare_str(format, "hhu", !compare_whole_cstr))     return CYMCTYPE_UNSIGNED_CHAR;
-    if(cym_compare_str(format, "c",   !compare_whole_cstr))     return CYMCTYPE_CHAR;
-    if(cym_compare_str(format, "hhd", !compare_whole_cstr))     return CYMCTYPE_SIGNED_CHAR;
-    if(cym_compare_str(format, "hhi", !compare_whole_cstr))     return CYMCTYPE_SIGNED_CHAR;
+    {"hd",  CYMCTYPE_SIGNED_SHORT},
+    {"hi",  CYMCTYPE_SHORT},
+    {"hu",  CYMCTYPE_UNSIGNED_SHORT},
 
-    if(cym_compare_str(format, "hd", !compare_whole_cstr))      return CYMCTYPE_SIGNED_SHORT;
-    if(cym_compare_str(format, "hi", !compare_whole_cstr))      return CYMCTYPE_SHORT;
-    if(cym_compare_str(format, "hu", !compare_whole_cstr))      return CYMCTYPE_UNSIGNED_SHORT;
+    {"u",   CYMCTYPE_UNSIGNED_INT},
+    {"i",   CYMCTYPE_INT},
+    {"d",   CYMCTYPE_SIGNED_INT},
+    {"x",   CYMCTYPE_INT},
+    {"X",   CYMCTYPE_INT},
+    {"o",   CYMCTYPE_INT},
+    {"O",   CYMCTYPE_INT},
 
-    if(cym_compare_str(format, "u", !compare_whole_cstr))       return CYMCTYPE_UNSIGNED_INT;
-    if(cym_compare_str(format, "i", !compare_whole_cstr))       return CYMCTYPE_INT;
-    if(cym_compare_str(format, "d", !compare_whole_cstr))       return CYMCTYPE_SIGNED_INT;
-    if(cym_compare_str(format, "x", !compare_whole_cstr))       return CYMCTYPE_INT;
-    if(cym_compare_str(format, "X", !compare_whole_cstr))       return CYMCTYPE_INT;
-    if(cym_compare_str(format, "o", !compare_whole_cstr))       return CYMCTYPE_INT;
-    if(cym_compare_str(format, "O", !compare_whole_cstr))       return CYMCTYPE_INT;
+    {"f",   CYMCTYPE_FLOAT},
+    {"lf",  CYMCTYPE_DOUBLE},
+    {"Lf",  CYMCTYPE_LONG_DOUBLE},
 
-    if(cym_compare_str(format, "f",     !compare_whole_cstr))   return CYMCTYPE_FLOAT;
-    if(cym_compare_str(format, "lf",    !compare_whole_cstr))   return CYMCTYPE_DOUBLE;
-    if(cym_compare_str(format, "Lf",    !compare_whole_cstr))   return CYMCTYPE_LONG_DOUBLE;
+    {"lu",  CYMCTYPE_UNSIGNED_LONG},
+    {"ld",  CYMCTYPE_SIGNED_LONG},
+    {"li",  CYMCTYPE_LONG},
 
-    if(cym_compare_str(format, "lu", !compare_whole_cstr))      return CYMCTYPE_UNSIGNED_LONG;
-    if(cym_compare_str(format, "ld", !compare_whole_cstr))      return CYMCTYPE_SIGNED_LONG;
-    if(cym_compare_str(format, "li", !compare_whole_cstr))      return CYMCTYPE_LONG;
+    {"llu", CYMCTYPE_UNSIGNED_LONG_LONG},
+    {"lld", CYMCTYPE_SIGNED_LONG_LONG},
+    {"lli", CYMCTYPE_LONG_LONG},
 
-    if(cym_compare_str(format, "llu", !compare_whole_cstr))     return CYMCTYPE_UNSIGNED_LONG_LONG;
-    if(cym_compare_str(format, "lld", !compare_whole_cstr))     return CYMCTYPE_SIGNED_LONG_LONG;
-    if(cym_compare_str(format, "lli", !compare_whole_cstr))     return CYMCTYPE_LONG_LONG;
+    {"p",   CYMCTYPE_PTR},
+    {"s",   CYMCTYPE_STR},
 
-    if(cym_compare_str(format, "p",   !compare_whole_cstr))     return CYMCTYPE_PTR;
-    if(cym_compare_str(format, "s",   !compare_whole_cstr))     return CYMCTYPE_STR;
+    {"zu",  CYMCTYPE_SIZE_T},
+};
+
+CYMDEF int cym_get_ctype_from_format(const char* format, int compare_whole_cstr){
 
-    if(cym_compare_str(format, "zu",  !compare_whole_cstr))     return CYMCTYPE_SIZE_T;
+    if(!format) return CYMCTYPE_NONE;
+
+    CYM_ARRAY_ITER(i, icym_ctype_formats,
+        if(*format == *icym_ctype_formats[i].str && cym_compare_str(format, icym_ctype_formats[i].str, !compare_whole_cstr))
+            return icym_ctype_formats[i].ctype;
+    )
     
     return CYMCTYPE_NONE;
 }
 
+CYMDEF size_t cym_format_token_len(const char* format){
+
+    CYM_ARRAY_ITER(i, icym_ctype_formats,
+        if(cym_compare_str(format, icym_ctype_formats[i].str, 1)){
+            size_t len = 0;
+            for(; icym_ctype_formats[i].str[len] && format[len]; len+=1);
+            return len;
+        }
+    )
+
+    return 0;
+}
+
 CYMDEF const char* cym_atomtype_str(int atom_type){
     switch (atom_type)
     {
@@ -537,81 +612,254 @@ CYMDEF void* _cym_unpack_data(const void* src, ...){
 
 CYMDEF void* cym_pack_values(void* dest, const char* __format, ...){
 
-    #define ICYM_PACK_WRAPPER(TYPE) while(before_dot--) {\
-        const TYPE d = va_arg(args, TYPE);\
+    va_list args;
+    va_start(args, __format);
+
+    dest = cym_vpack_values_ex(dest, CYMPACK_DEFAULT, __format, args);
+
+    va_end(args);
+    return dest;
+}
+
+CYMDEF void* cym_vpack_values(void* dest, const char* format, va_list args){
+    return cym_vpack_values_ex(dest, CYMPACK_DEFAULT, format, args);
+}
+
+// parses the next format specifier in format into spec
+// \returns a pointer to the specifier's type in format, or NULL if there are no more specifiers
+static inline const char* icym_next_format_spec(const char* format, CymFormatSpec* spec){
+
+    for(; *format && *format != '%'; format+=1);
+    if(!*format) return NULL;
+
+    spec->count    = 0;
+    spec->max_size = 0;
+    spec->asterix  = 0;
+
+    format = cym_parse_format_preffixes(format + 1, &spec->count, &spec->max_size, &spec->asterix);
+    spec->ctype = cym_get_ctype_from_format(format, 0);
+
+    return format;
+}
+
+// packs the values described by spec, args is taken by pointer so the caller's va_list advances
+static inline void* icym_pack_spec(void* dest, int flags, CymFormatSpec spec, va_list* args){
+
+    #define ICYM_PACK_WRAPPER(TYPE) while(spec.count--) {\
+        const TYPE d = va_arg(*args, TYPE);\
         CYM_MEMCPY(dest, &d, sizeof(d));\
         dest = (uint8_t*)(dest) + sizeof(d);\
     }
-    #define ICYM_PACK_WRAPPER_EX(TYPE0, TYPE1) while(before_dot--) {\
-        const TYPE1 d = (TYPE1) va_arg(args, TYPE0);\
+    #define ICYM_PACK_WRAPPER_EX(TYPE0, TYPE1) while(spec.count--) {\
+        const TYPE1 d = (TYPE1) va_arg(*args, TYPE0);\
         CYM_MEMCPY(dest, &d, sizeof(d));\
         dest = (uint8_t*)(dest) + sizeof(d);\
     }
 
-    va_list args;
-    va_start(args, __format);
+    if(spec.asterix & 1){
+        const int d = va_arg(*args, int);
+        spec.count = (size_t) d;
+        if(flags & CYMPACK_STORE_ASTERIX){
+            CYM_MEMCPY(dest, &d, sizeof(d));
+            dest = (uint8_t*)(dest) + sizeof(d);
+        }
+    }
+    if(spec.asterix & 2){
+        const int d = va_arg(*args, int);
+        spec.max_size = (size_t) d;
+        if(flags & CYMPACK_STORE_ASTERIX){
+            CYM_MEMCPY(dest, &d, sizeof(d));
+            dest = (uint8_t*)(dest) + sizeof(d);
+        }
+    }
 
-    for(; *__format; __format+=1){
+    switch (spec.ctype)
+    {
+    case CYMCTYPE_UNSIGNED_CHAR:        ICYM_PACK_WRAPPER_EX(int, unsigned char);   break;
+    case CYMCTYPE_CHAR:                 ICYM_PACK_WRAPPER_EX(int, char);            break;
+    case CYMCTYPE_SIGNED_CHAR:          ICYM_PACK_WRAPPER_EX(int, signed char);     break;
+    case CYMCTYPE_UNSIGNED_SHORT:       ICYM_PACK_WRAPPER_EX(int, unsigned short);  break;
+    case CYMCTYPE_SHORT:                ICYM_PACK_WRAPPER_EX(int, short);           break;
+    case CYMCTYPE_INT:                  ICYM_PACK_WRAPPER(int);                     break;
+    case CYMCTYPE_UNSIGNED_INT:         ICYM_PACK_WRAPPER(unsigned int);            break;
+    case CYMCTYPE_FLOAT:                ICYM_PACK_WRAPPER_EX(double, float);        break;
+    case CYMCTYPE_DOUBLE:               ICYM_PACK_WRAPPER(double);                  break;
+    case CYMCTYPE_LONG_DOUBLE:          ICYM_PACK_WRAPPER(long double);             break;
+    case CYMCTYPE_UNSIGNED_LONG:        ICYM_PACK_WRAPPER(unsigned long);           break;
+    case CYMCTYPE_LONG:                 ICYM_PACK_WRAPPER(long);                    break;
+    case CYMCTYPE_SIGNED_LONG:          ICYM_PACK_WRAPPER(signed long);             break;
+    case CYMCTYPE_UNSIGNED_LONG_LONG:   ICYM_PACK_WRAPPER(unsigned long long);      break;
+    case CYMCTYPE_LONG_LONG:            ICYM_PACK_WRAPPER(long long);               break;
+    case CYMCTYPE_SIGNED_LONG_LONG:     ICYM_PACK_WRAPPER(signed long long);        break;
+    case CYMCTYPE_PTR:                  ICYM_PACK_WRAPPER(void*);                   break;
+    case CYMCTYPE_STR:{
+        while(spec.count--){
+            char* dest_str = (char*) dest;
+            const char* str = va_arg(*args, const char*);
+            size_t size = spec.max_size;
+            while(size-- && *str){
+                *dest_str = *str;
+                dest_str+=1;
+                str+=1;
+            }
+            *dest_str = '\0';
+            dest = (void*) (dest_str + 1);
+        }
+    }   break;
+    case CYMCTYPE_SIZE_T:               ICYM_PACK_WRAPPER(size_t);                  break;
+    
+    default:                            break;                  
+    }
 
-        if(*__format == '%'){
-            size_t before_dot = 0;
-            size_t after_dot  = 0;
-            int    asterix    = 0;
+    #undef ICYM_PACK_WRAPPER
+    #undef ICYM_PACK_WRAPPER_EX
+    return dest;
+}
 
-            __format = cym_parse_format_preffixes(__format + 1, &before_dot, &after_dot, &asterix);
+// consumes the values described by spec
+// \returns the number of bytes icym_pack_spec would write for them
+static inline size_t icym_pack_spec_size(int flags, CymFormatSpec spec, va_list* args){
 
-            if(asterix & 1) before_dot = (size_t) va_arg(args, int);
-            if(asterix & 2) after_dot  = (size_t) va_arg(args, int);
+    #define ICYM_SIZE_WRAPPER(TYPE0, TYPE1) while(spec.count--) {\
+        (void) va_arg(*args, TYPE0);\
+        size += sizeof(TYPE1);\
+    }
 
-            const int _type = cym_get_ctype_from_format(__format, 0);
+    size_t size = 0;
 
-            switch (_type)
-            {
-            case CYMCTYPE_UNSIGNED_CHAR:        ICYM_PACK_WRAPPER_EX(int, unsigned char);   break;
-            case CYMCTYPE_CHAR:                 ICYM_PACK_WRAPPER_EX(int, char);            break;
-            case CYMCTYPE_SIGNED_CHAR:          ICYM_PACK_WRAPPER_EX(int, signed char);     break;
-            case CYMCTYPE_UNSIGNED_SHORT:       ICYM_PACK_WRAPPER_EX(int, unsigned short);  break;
-            case CYMCTYPE_SHORT:                ICYM_PACK_WRAPPER_EX(int, short);           break;
-            case CYMCTYPE_INT:                  ICYM_PACK_WRAPPER(int);                     break;
-            case CYMCTYPE_UNSIGNED_INT:         ICYM_PACK_WRAPPER(unsigned int);            break;
-            case CYMCTYPE_FLOAT:                ICYM_PACK_WRAPPER_EX(double, float);        break;
-            case CYMCTYPE_DOUBLE:               ICYM_PACK_WRAPPER(double);                  break;
-            case CYMCTYPE_LONG_DOUBLE:          ICYM_PACK_WRAPPER(long double);             break;
-            case CYMCTYPE_UNSIGNED_LONG:        ICYM_PACK_WRAPPER(unsigned long);           break;
-            case CYMCTYPE_LONG:                 ICYM_PACK_WRAPPER(long);                    break;
-            case CYMCTYPE_SIGNED_LONG:          ICYM_PACK_WRAPPER(signed long);             break;
-            case CYMCTYPE_UNSIGNED_LONG_LONG:   ICYM_PACK_WRAPPER(unsigned long long);      break;
-            case CYMCTYPE_LONG_LONG:            ICYM_PACK_WRAPPER(long long);               break;
-            case CYMCTYPE_SIGNED_LONG_LONG:     ICYM_PACK_WRAPPER(signed long long);        break;
-            case CYMCTYPE_PTR:                  ICYM_PACK_WRAPPER(void*);                   break;
-            case CYMCTYPE_STR:{
-                while(before_dot--){
-                    char* dest_str = (char*) dest;
-                    const char* str = va_arg(args, const char*);
-                    size_t size = after_dot;
-                    while(size-- && *str){
-                        *dest_str = *str;
-                        dest_str+=1;
-                        str+=1;
-                    }
-                    *dest_str = '\0';
-                    dest = (void*) (dest_str + 1);
-                }
-            }   break;
-            case CYMCTYPE_SIZE_T:               ICYM_PACK_WRAPPER(size_t);                  break;
-            
-            default:                            break;                  
-            }
-            continue;
+    if(spec.asterix & 1){
+        spec.count = (size_t) va_arg(*args, int);
+        if(flags & CYMPACK_STORE_ASTERIX) size += sizeof(int);
+    }
+    if(spec.asterix & 2){
+        spec.max_size = (size_t) va_arg(*args, int);
+        if(flags & CYMPACK_STORE_ASTERIX) size += sizeof(int);
+    }
+
+    switch (spec.ctype)
+    {
+    case CYMCTYPE_UNSIGNED_CHAR:        ICYM_SIZE_WRAPPER(int, unsigned char);          break;
+    case CYMCTYPE_CHAR:                 ICYM_SIZE_WRAPPER(int, char);                   break;
+    case CYMCTYPE_SIGNED_CHAR:          ICYM_SIZE_WRAPPER(int, signed char);            break;
+    case CYMCTYPE_UNSIGNED_SHORT:       ICYM_SIZE_WRAPPER(int, unsigned short);         break;
+    case CYMCTYPE_SHORT:                ICYM_SIZE_WRAPPER(int, short);                  break;
+    case CYMCTYPE_INT:                  ICYM_SIZE_WRAPPER(int, int);                    break;
+    case CYMCTYPE_UNSIGNED_INT:         ICYM_SIZE_WRAPPER(unsigned int, unsigned int);  break;
+    case CYMCTYPE_FLOAT:                ICYM_SIZE_WRAPPER(double, float);               break;
+    case CYMCTYPE_DOUBLE:               ICYM_SIZE_WRAPPER(double, double);              break;
+    case CYMCTYPE_LONG_DOUBLE:          ICYM_SIZE_WRAPPER(long double, long double);    break;
+    case CYMCTYPE_UNSIGNED_LONG:        ICYM_SIZE_WRAPPER(unsigned long, unsigned long);break;
+    case CYMCTYPE_LONG:                 ICYM_SIZE_WRAPPER(long, long);                  break;
+    case CYMCTYPE_SIGNED_LONG:          ICYM_SIZE_WRAPPER(signed long, signed long);    break;
+    case CYMCTYPE_UNSIGNED_LONG_LONG:   ICYM_SIZE_WRAPPER(unsigned long long, unsigned long long);  break;
+    case CYMCTYPE_LONG_LONG:            ICYM_SIZE_WRAPPER(long long, long long);        break;
+    case CYMCTYPE_SIGNED_LONG_LONG:     ICYM_SIZE_WRAPPER(signed long long, signed long long);      break;
+    case CYMCTYPE_PTR:                  ICYM_SIZE_WRAPPER(void*, void*);                break;
+    case CYMCTYPE_STR:{
+        while(spec.count--){
+            const char* str = va_arg(*args, const char*);
+            size_t len = 0;
+            for(; len < spec.max_size && str[len]; len+=1);
+            size += len + 1;
         }
+    }   break;
+    case CYMCTYPE_SIZE_T:               ICYM_SIZE_WRAPPER(size_t, size_t);              break;
+    
+    default:                            break;                  
     }
 
-    #undef ICYM_PACK_WRAPPER
-    #undef ICYM_PACK_WRAPPER_EX
-    va_end(args);
+    #undef ICYM_SIZE_WRAPPER
+    return size;
+}
+
+CYMDEF void* cym_vpack_values_ex(void* dest, int flags, const char* format, va_list args){
+
+    va_list ap;
+    va_copy(ap, args);
+
+    CymFormatSpec spec;
+    while((format = icym_next_format_spec(format, &spec))){
+        dest = icym_pack_spec(dest, flags, spec, &ap);
+        if(*format) format+=1;
+    }
+
+    va_end(ap);
+    return dest;
+}
+
+CYMDEF size_t cym_vpack_size(int flags, const char* format, va_list args){
+
+    va_list ap;
+    va_copy(ap, args);
+
+    size_t size = 0;
+
+    CymFormatSpec spec;
+    while((format = icym_next_format_spec(format, &spec))){
+        size += icym_pack_spec_size(flags, spec, &ap);
+        if(*format) format+=1;
+    }
+
+    va_end(ap);
+    return size;
+}
+
+CYMDEF size_t cym_compile_format(const char* format, CymFormatSpec* specs, size_t max_specs){
+
+    size_t count = 0;
+
+    CymFormatSpec spec;
+    while((format = icym_next_format_spec(format, &spec))){
+        // a specifier without a type still consumes its '*' arguments in cym_vpack_values_ex, so it is kept to do the same
+        if(spec.ctype != CYMCTYPE_NONE || spec.asterix){
+            if(specs && count < max_specs) specs[count] = spec;
+            count += 1;
+        }
+        if(*format) format+=1;
+    }
+
+    return count;
+}
+
+CYMDEF void* cym_vpack_compiled(void* dest, int flags, const CymFormatSpec* specs, size_t spec_count, va_list args){
+
+    va_list ap;
+    va_copy(ap, args);
+
+    for(size_t i = 0; i < spec_count; i+=1){
+        dest = icym_pack_spec(dest, flags, specs[i], &ap);
+    }
+
+    va_end(ap);
     return dest;
 }
 
+CYMDEF size_t cym_vpack_compiled_size(int flags, const CymFormatSpec* specs, size_t spec_count, va_list args){
+
+    va_list ap;
+    va_copy(ap, args);
+
+    size_t size = 0;
+
+    for(size_t i = 0; i < spec_count; i+=1){
+        size += icym_pack_spec_size(flags, specs[i], &ap);
+    }
+
+    va_end(ap);
+    return size;
+}
+
+CYMDEF size_t cym_pack_size(const char* format, ...){
+
+    va_list args;
+    va_start(args, format);
+
+    const size_t size = cym_vpack_size(CYMPACK_DEFAULT, format, args);
+
+    va_end(args);
+    return size;
+}
+
 CYMDEF void* cym_unpack_values(const void* src, const char* __format, ...){
 
     va_list args;
@@ -0,0 +1,735 @@
+#ifndef CYMLOG_HEADER
+#define CYMLOG_HEADER
+
+/*
+    Deferred formatting binary logger built on top of cymbol.h's packing functions.
+
+    The hot path (CYM_LOG) registers its format once per call site, packs only the raw arguments into a
+    per thread lock free ring buffer and returns, a background thread drains the buffers to a binary file,
+    and cym_log_decode (or the logdecode executable) renders the text later.
+
+    The formats follow cymbol.h's format language, so "%u" packs an unsigned int, "%3lf" packs 3 doubles,
+    "%*u" packs an int counted number of unsigned ints and "%.*s" packs a string of at most the given size.
+
+    usage:
+        #define CYMBOL_IMPLEMENTATION
+        #define CYMLOG_IMPLEMENTATION
+        #include "cymlog.h"
+
+        cym_log_open("run.cymlog");
+        CYM_LOG("frame %u took %lf ms", frame, ms);
+        cym_log_close();
+
+    needs pthreads.
+*/
+
+// included before cymbol.h so CYM_MEMCPY expands to memcpy
+#include <string.h>
+#include "cymbol.h"
+#include <stdio.h>
+#include <stdint.h>
+
+// size in bytes of each thread's ring buffer, must be a power of 2
+#ifndef CYM_LOG_BUFFER_SIZE
+#define CYM_LOG_BUFFER_SIZE (1 << 20)
+#endif
+
+// how long the background thread sleeps between drains, in microseconds
+#ifndef CYM_LOG_DRAIN_INTERVAL_US
+#define CYM_LOG_DRAIN_INTERVAL_US 1000
+#endif
+
+// logs a message, the format is registered the first time this call site is reached
+#define CYM_LOG(...) do{\
+        static CymLogSite icym_log_site = {0};\
+        cym_log_write(&icym_log_site, __FILE__, __LINE__, __VA_ARGS__);\
+    } while(0)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// static per call site state used by CYM_LOG
+typedef struct CymLogSite{
+    uint32_t             id;
+    // the format parsed ahead of time, so the hot path only packs
+    const CymFormatSpec* specs;
+    size_t               spec_count;
+    // the size of the packed arguments if it does not depend on their values, SIZE_MAX otherwise
+    size_t               static_size;
+} CymLogSite;
+
+// opens the log file and starts the background thread
+// \returns 0 on success, 1 otherwise
+CYMDEF int cym_log_open(const char* path);
+
+// drains what is left, stops the background thread and closes the log file
+CYMDEF void cym_log_close(void);
+
+// synchronously drains every thread's buffer to the log file
+CYMDEF void cym_log_flush(void);
+
+// registers a static format, filling site if it is not NULL
+// \returns the format's id (never 0)
+CYMDEF uint32_t cym_log_register(CymLogSite* site, const char* format, const char* file, int line);
+
+// the hot path behind CYM_LOG, registers the call site if needed and packs the arguments to the calling thread's buffer
+CYMDEF void cym_log_write(CymLogSite* site, const char* file, int line, const char* format, ...);
+
+// \returns the number of messages dropped because they did not fit in a buffer
+CYMDEF uint64_t cym_log_dropped(void);
+
+// renders a log file written by the logger as text
+// \returns 0 on success, 1 if input is not a valid log
+CYMDEF int cym_log_decode(FILE* input, FILE* output);
+
+
+#ifdef CYMLOG_IMPLEMENTATION
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define ICYM_LOG_HAS_TSC
+#endif
+
+#if defined(__cplusplus)
+    #define ICYM_THREAD_LOCAL thread_local
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+    #define ICYM_THREAD_LOCAL _Thread_local
+#else
+    #define ICYM_THREAD_LOCAL __thread
+#endif
+
+#define ICYM_LOG_MAGIC          "CYMLOG01"
+#define ICYM_LOG_RECORD_FORMAT  1
+#define ICYM_LOG_RECORD_ENTRY   2
+// size of the in buffer entry header: u32 size, u32 format id, u64 timestamp
+#define ICYM_LOG_ENTRY_HEADER   16
+#define ICYM_LOG_MAX_STR        4095
+
+typedef struct ICymLogBuffer{
+    uint8_t*  data;
+    uint64_t  mask;
+    uint32_t  thread_id;
+    int       retired;
+    struct ICymLogBuffer* next;
+
+    // consumer position, only written by whoever drains (with icym_log.lock held)
+    uint64_t  head __attribute__((aligned(64)));
+    // producer position, only written by the owning thread
+    uint64_t  tail __attribute__((aligned(64)));
+} ICymLogBuffer;
+
+typedef struct ICymLogFormat{
+    const char*    format;
+    const char*    file;
+    int            line;
+    CymFormatSpec* specs;
+} ICymLogFormat;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_t       thread;
+    pthread_key_t   key;
+    int             key_created;
+    int             running;
+
+    FILE*           file;
+
+    ICymLogBuffer*  buffers;
+    uint32_t        thread_count;
+
+    ICymLogFormat*  formats;
+    uint32_t        format_count;
+    uint32_t        format_capacity;
+    uint32_t        formats_written;
+
+    uint64_t        dropped;
+
+    double          ns_per_tick;
+} icym_log = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static ICYM_THREAD_LOCAL ICymLogBuffer* icym_log_local = NULL;
+
+static inline uint64_t icym_log_ticks(void){
+#ifdef ICYM_LOG_HAS_TSC
+    return (uint64_t) __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+static inline uint64_t icym_log_realtime_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+static size_t icym_log_fwrite(const void* src, size_t _size, size_t n, void* stream){
+    return fwrite(src, _size, n, (FILE*) stream) * _size;
+}
+
+static size_t icym_log_fread(void* dest, size_t _size, size_t n, void* stream){
+    return fread(dest, _size, n, (FILE*) stream) * _size;
+}
+
+// \returns the size of the packed arguments if it does not depend on their values, SIZE_MAX otherwise
+static size_t icym_log_static_size(const CymFormatSpec* specs, size_t spec_count){
+
+    size_t size = 0;
+
+    for(size_t i = 0; i < spec_count; i+=1){
+        if(specs[i].asterix || specs[i].ctype == CYMCTYPE_STR) return SIZE_MAX;
+        size += specs[i].count * cym_ctype_size(specs[i].ctype);
+    }
+
+    return size;
+}
+
+static void icym_log_retire(void* buffer){
+    __atomic_store_n(&((ICymLogBuffer*) buffer)->retired, 1, __ATOMIC_RELEASE);
+}
+
+static ICymLogBuffer* icym_log_create_buffer(void){
+
+    ICymLogBuffer* buffer = (ICymLogBuffer*) aligned_alloc(64, sizeof(ICymLogBuffer));
+    if(!buffer) return NULL;
+    memset(buffer, 0, sizeof(*buffer));
+
+    buffer->data = (uint8_t*) malloc(CYM_LOG_BUFFER_SIZE);
+    if(!buffer->data){
+        free(buffer);
+        return NULL;
+    }
+    buffer->mask = CYM_LOG_BUFFER_SIZE - 1;
+
+    pthread_mutex_lock(&icym_log.lock);
+
+    if(!icym_log.key_created){
+        icym_log.key_created = !pthread_key_create(&icym_log.key, icym_log_retire);
+    }
+    if(icym_log.key_created) pthread_setspecific(icym_log.key, buffer);
+
+    buffer->thread_id = ++icym_log.thread_count;
+    buffer->next      = icym_log.buffers;
+    icym_log.buffers  = buffer;
+
+    pthread_mutex_unlock(&icym_log.lock);
+
+    return buffer;
+}
+
+// writes the formats not yet in the file, must be called with icym_log.lock held
+static void icym_log_write_formats(void){
+    for(; icym_log.formats_written < icym_log.format_count; icym_log.formats_written+=1){
+        const ICymLogFormat f = icym_log.formats[icym_log.formats_written];
+        cym_spack_values(icym_log.file, icym_log_fwrite, "%u%u%i%.*s%.*s",
+            (unsigned int) ICYM_LOG_RECORD_FORMAT, (unsigned int) (icym_log.formats_written + 1), f.line,
+            ICYM_LOG_MAX_STR, f.format, ICYM_LOG_MAX_STR, f.file ? f.file : ""
+        );
+    }
+}
+
+// drains every buffer to the log file, must be called with icym_log.lock held
+static void icym_log_drain(void){
+
+    if(!icym_log.file) return;
+
+    size_t count = 0;
+    for(ICymLogBuffer* b = icym_log.buffers; b; b = b->next) count += 1;
+
+    struct { uint64_t tail; int retired; } snapshot_stack[64], *snapshot = snapshot_stack;
+    if(count > sizeof(snapshot_stack) / sizeof(snapshot_stack[0])){
+        snapshot = malloc(count * sizeof(snapshot_stack[0]));
+        if(!snapshot) return;
+    }
+
+    // snapshot the producers' positions before looking at the formats,
+    // any entry visible here had its format registered before.
+    // retired is read first so a retired buffer's tail is known to be final
+    size_t n = 0;
+    for(ICymLogBuffer* b = icym_log.buffers; b; b = b->next, n+=1){
+        snapshot[n].retired = __atomic_load_n(&b->retired, __ATOMIC_ACQUIRE);
+        snapshot[n].tail    = __atomic_load_n(&b->tail, __ATOMIC_ACQUIRE);
+    }
+
+    icym_log_write_formats();
+
+    n = 0;
+    for(ICymLogBuffer* b = icym_log.buffers; b; b = b->next){
+        const uint64_t tail = snapshot[n++].tail;
+        uint64_t head = b->head;
+
+        while(head < tail){
+            const uint64_t offset = head & b->mask;
+            const uint8_t* entry  = b->data + offset;
+
+            uint32_t size;
+            CYM_MEMCPY(&size, entry, sizeof(size));
+
+            if(size == 0){ // wrap marker
+                head += (b->mask + 1) - offset;
+                continue;
+            }
+
+            uint32_t id;
+            uint64_t ticks;
+            cym_unpack_data(entry + sizeof(size), CYM_UNPACK_MEMPTR(&id), CYM_UNPACK_MEMPTR(&ticks));
+
+            uint32_t payload_size;
+            CYM_MEMCPY(&payload_size, entry + size - sizeof(uint32_t), sizeof(uint32_t));
+
+            cym_spack_values(icym_log.file, icym_log_fwrite, "%u%u%u%llu%u",
+                (unsigned int) ICYM_LOG_RECORD_ENTRY, b->thread_id, id, (unsigned long long) ticks, payload_size
+            );
+            cym_spack_data(icym_log.file, icym_log_fwrite, (size_t) payload_size, (void*) (entry + ICYM_LOG_ENTRY_HEADER));
+
+            head += size;
+        }
+
+        __atomic_store_n(&b->head, head, __ATOMIC_RELEASE);
+    }
+
+    // free the buffers of threads that exited and were fully drained
+    n = 0;
+    for(ICymLogBuffer** b = &icym_log.buffers; *b; n+=1){
+        ICymLogBuffer* const buffer = *b;
+        if(snapshot[n].retired && buffer->head == snapshot[n].tail){
+            *b = buffer->next;
+            free(buffer->data);
+            free(buffer);
+        } else b = &buffer->next;
+    }
+
+    if(snapshot != snapshot_stack) free(snapshot);
+
+    fflush(icym_log.file);
+}
+
+static void* icym_log_thread(void* arg){
+    (void) arg;
+
+    const struct timespec interval = {
+        .tv_sec  = CYM_LOG_DRAIN_INTERVAL_US / 1000000,
+        .tv_nsec = (CYM_LOG_DRAIN_INTERVAL_US % 1000000) * 1000
+    };
+
+    while(__atomic_load_n(&icym_log.running, __ATOMIC_ACQUIRE)){
+        pthread_mutex_lock(&icym_log.lock);
+        icym_log_drain();
+        pthread_mutex_unlock(&icym_log.lock);
+        nanosleep(&interval, NULL);
+    }
+
+    return NULL;
+}
+
+CYMDEF int cym_log_open(const char* path){
+
+    pthread_mutex_lock(&icym_log.lock);
+
+    if(icym_log.file){
+        pthread_mutex_unlock(&icym_log.lock);
+        return 1;
+    }
+
+    icym_log.file = fopen(path, "wb");
+    if(!icym_log.file){
+        pthread_mutex_unlock(&icym_log.lock);
+        return 1;
+    }
+
+    // calibrate the timestamps against the real time clock
+    const uint64_t realtime0 = icym_log_realtime_ns();
+    const uint64_t ticks0    = icym_log_ticks();
+#ifdef ICYM_LOG_HAS_TSC
+    const struct timespec calibration = {0, 10000000};
+    nanosleep(&calibration, NULL);
+    const uint64_t realtime1 = icym_log_realtime_ns();
+    const uint64_t ticks1    = icym_log_ticks();
+    icym_log.ns_per_tick = (ticks1 > ticks0)? (double) (realtime1 - realtime0) / (double) (ticks1 - ticks0) : 1.0;
+#else
+    icym_log.ns_per_tick = 1.0;
+#endif
+
+    cym_spack_data(icym_log.file, icym_log_fwrite, (size_t) 8, (void*) ICYM_LOG_MAGIC);
+    cym_spack_values(icym_log.file, icym_log_fwrite, "%llu%llu%lf",
+        (unsigned long long) realtime0, (unsigned long long) ticks0, icym_log.ns_per_tick
+    );
+
+    // formats registered before opening still have to be written to this file
+    icym_log.formats_written = 0;
+    for(ICymLogBuffer* b = icym_log.buffers; b; b = b->next) b->head = b->tail;
+
+    __atomic_store_n(&icym_log.running, 1, __ATOMIC_RELEASE);
+
+    if(pthread_create(&icym_log.thread, NULL, icym_log_thread, NULL)){
+        icym_log.running = 0;
+        fclose(icym_log.file);
+        icym_log.file = NULL;
+        pthread_mutex_unlock(&icym_log.lock);
+        return 1;
+    }
+
+    pthread_mutex_unlock(&icym_log.lock);
+    return 0;
+}
+
+CYMDEF void cym_log_close(void){
+
+    if(!__atomic_load_n(&icym_log.running, __ATOMIC_ACQUIRE)) return;
+
+    __atomic_store_n(&icym_log.running, 0, __ATOMIC_RELEASE);
+    pthread_join(icym_log.thread, NULL);
+
+    pthread_mutex_lock(&icym_log.lock);
+    icym_log_drain();
+    fclose(icym_log.file);
+    icym_log.file = NULL;
+    pthread_mutex_unlock(&icym_log.lock);
+}
+
+CYMDEF void cym_log_flush(void){
+    pthread_mutex_lock(&icym_log.lock);
+    icym_log_drain();
+    pthread_mutex_unlock(&icym_log.lock);
+}
+
+CYMDEF uint64_t cym_log_dropped(void){
+    return __atomic_load_n(&icym_log.dropped, __ATOMIC_RELAXED);
+}
+
+CYMDEF uint32_t cym_log_register(CymLogSite* site, const char* format, const char* file, int line){
+
+    const size_t spec_count = cym_compile_format(format, NULL, 0);
+    CymFormatSpec* specs    = (CymFormatSpec*) malloc((spec_count? spec_count : 1) * sizeof(CymFormatSpec));
+    if(!specs) return 0;
+    cym_compile_format(format, specs, spec_count);
+
+    pthread_mutex_lock(&icym_log.lock);
+
+    if(icym_log.format_count == icym_log.format_capacity){
+        const uint32_t capacity = icym_log.format_capacity? 2 * icym_log.format_capacity : 64;
+        ICymLogFormat* formats  = (ICymLogFormat*) realloc(icym_log.formats, capacity * sizeof(ICymLogFormat));
+        if(!formats){
+            pthread_mutex_unlock(&icym_log.lock);
+            free(specs);
+            return 0;
+        }
+        icym_log.formats         = formats;
+        icym_log.format_capacity = capacity;
+    }
+
+    icym_log.formats[icym_log.format_count] = (ICymLogFormat){ .format = format, .file = file, .line = line, .specs = specs };
+    const uint32_t id = ++icym_log.format_count;
+
+    pthread_mutex_unlock(&icym_log.lock);
+
+    if(site){
+        site->specs       = specs;
+        site->spec_count  = spec_count;
+        site->static_size = icym_log_static_size(specs, spec_count);
+        __atomic_store_n(&site->id, id, __ATOMIC_RELEASE);
+    }
+
+    return id;
+}
+
+CYMDEF void cym_log_write(CymLogSite* site, const char* file, int line, const char* format, ...){
+
+    if(!__atomic_load_n(&icym_log.running, __ATOMIC_RELAXED)) return;
+
+    uint32_t id = __atomic_load_n(&site->id, __ATOMIC_ACQUIRE);
+    if(!id){
+        id = cym_log_register(site, format, file, line);
+        if(!id) return;
+    }
+
+    ICymLogBuffer* buffer = icym_log_local;
+    if(!buffer){
+        buffer = icym_log_local = icym_log_create_buffer();
+        if(!buffer) return;
+    }
+
+    va_list args;
+    va_start(args, format);
+
+    // strings and counted arrays are the only reason to look at the arguments twice
+    const size_t payload_size = (site->static_size != SIZE_MAX)? site->static_size :
+        cym_vpack_compiled_size(CYMPACK_STORE_ASTERIX, site->specs, site->spec_count, args);
+
+    // header + payload + trailing payload size, rounded up to keep the headers aligned
+    const uint64_t size     = (ICYM_LOG_ENTRY_HEADER + payload_size + sizeof(uint32_t) + 7) & ~(uint64_t) 7;
+    const uint64_t capacity = buffer->mask + 1;
+
+    if(size > capacity / 2){
+        __atomic_fetch_add(&icym_log.dropped, 1, __ATOMIC_RELAXED);
+        va_end(args);
+        return;
+    }
+
+    const uint64_t tail       = buffer->tail;
+    const uint64_t offset     = tail & buffer->mask;
+    const uint64_t contiguous = capacity - offset;
+    const uint64_t needed     = (contiguous < size)? contiguous + size : size;
+
+    // the buffer is full, wait for the background thread to make room
+    while(capacity - (tail - __atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE)) < needed){
+        if(!__atomic_load_n(&icym_log.running, __ATOMIC_RELAXED)){
+            va_end(args);
+            return;
+        }
+        sched_yield();
+    }
+
+    uint8_t* entry = buffer->data + offset;
+    if(contiguous < size){
+        const uint32_t wrap = 0;
+        CYM_MEMCPY(entry, &wrap, sizeof(wrap));
+        entry = buffer->data;
+    }
+
+    const uint32_t entry_size = (uint32_t) size;
+    const uint64_t ticks      = icym_log_ticks();
+    const uint32_t payload32  = (uint32_t) payload_size;
+
+    cym_pack_data(entry, CYM_UNPACK_MEMPTR(&entry_size), CYM_UNPACK_MEMPTR(&id), CYM_UNPACK_MEMPTR(&ticks));
+    cym_vpack_compiled(entry + ICYM_LOG_ENTRY_HEADER, CYMPACK_STORE_ASTERIX, site->specs, site->spec_count, args);
+    CYM_MEMCPY(entry + size - sizeof(uint32_t), &payload32, sizeof(uint32_t));
+
+    va_end(args);
+
+    __atomic_store_n(&buffer->tail, tail + needed, __ATOMIC_RELEASE);
+}
+
+static char* icym_log_strdup(const char* str){
+    const size_t size = strlen(str) + 1;
+    char* const copy  = (char*) malloc(size);
+    if(copy) CYM_MEMCPY(copy, str, size);
+    return copy;
+}
+
+// renders the packed arguments of format in payload to output
+static void icym_log_render(FILE* output, const char* format, const uint8_t* payload, size_t payload_size){
+
+    const uint8_t* const end = payload + payload_size;
+
+    #define ICYM_RENDER_WRAPPER(TYPE, CAST) {\
+            TYPE d;\
+            if(payload + sizeof(d) > end) return;\
+            CYM_MEMCPY(&d, payload, sizeof(d));\
+            payload += sizeof(d);\
+            fprintf(output, spec, (CAST) d);\
+        }
+
+    while(*format){
+
+        if(*format != '%'){
+            fputc(*format, output);
+            format+=1;
+            continue;
+        }
+        if(format[1] == '%'){
+            fputc('%', output);
+            format+=2;
+            continue;
+        }
+
+        size_t before_dot = 0;
+        size_t after_dot  = 0;
+        int    asterix    = 0;
+
+        const char* token = cym_parse_format_preffixes(format + 1, &before_dot, &after_dot, &asterix);
+        const size_t len  = cym_format_token_len(token);
+        const int ctype   = cym_get_ctype_from_format(token, 0);
+
+        if(ctype == CYMCTYPE_NONE || len == 0){
+            // not something the packer understands, print it as is
+            for(; format < token; format+=1) fputc(*format, output);
+            continue;
+        }
+
+        int d;
+        if(asterix & 1){
+            if(payload + sizeof(d) > end) return;
+            CYM_MEMCPY(&d, payload, sizeof(d));
+            payload += sizeof(d);
+            before_dot = (size_t) d;
+        }
+        if(asterix & 2){
+            if(payload + sizeof(d) > end) return;
+            CYM_MEMCPY(&d, payload, sizeof(d));
+            payload += sizeof(d);
+        }
+
+        char spec[8] = "%";
+        CYM_MEMCPY(spec + 1, token, len);
+        spec[len + 1] = '\0';
+        if(spec[len] == 'O') spec[len] = 'o';
+
+        for(size_t i = 0; i < before_dot; i+=1){
+            if(i) fputc(' ', output);
+            switch (ctype)
+            {
+            case CYMCTYPE_UNSIGNED_CHAR:        ICYM_RENDER_WRAPPER(unsigned char, unsigned int);   break;
+            case CYMCTYPE_CHAR:                 ICYM_RENDER_WRAPPER(char, int);                     break;
+            case CYMCTYPE_SIGNED_CHAR:          ICYM_RENDER_WRAPPER(signed char, int);              break;
+            case CYMCTYPE_UNSIGNED_SHORT:       ICYM_RENDER_WRAPPER(unsigned short, unsigned int);  break;
+            case CYMCTYPE_SHORT:                ICYM_RENDER_WRAPPER(short, int);                    break;
+            case CYMCTYPE_UNSIGNED_INT:         ICYM_RENDER_WRAPPER(unsigned int, unsigned int);    break;
+            case CYMCTYPE_INT:                  ICYM_RENDER_WRAPPER(int, int);                      break;
+            case CYMCTYPE_FLOAT:                ICYM_RENDER_WRAPPER(float, double);                 break;
+            case CYMCTYPE_DOUBLE:               ICYM_RENDER_WRAPPER(double, double);                break;
+            case CYMCTYPE_LONG_DOUBLE:          ICYM_RENDER_WRAPPER(long double, long double);      break;
+            case CYMCTYPE_UNSIGNED_LONG:        ICYM_RENDER_WRAPPER(unsigned long, unsigned long);  break;
+            case CYMCTYPE_LONG:                 ICYM_RENDER_WRAPPER(long, long);                    break;
+            case CYMCTYPE_SIGNED_LONG:          ICYM_RENDER_WRAPPER(signed long, signed long);      break;
+            case CYMCTYPE_UNSIGNED_LONG_LONG:   ICYM_RENDER_WRAPPER(unsigned long long, unsigned long long); break;
+            case CYMCTYPE_LONG_LONG:            ICYM_RENDER_WRAPPER(long long, long long);          break;
+            case CYMCTYPE_SIGNED_LONG_LONG:     ICYM_RENDER_WRAPPER(signed long long, signed long long); break;
+            case CYMCTYPE_PTR:                  ICYM_RENDER_WRAPPER(void*, void*);                  break;
+            case CYMCTYPE_SIZE_T:               ICYM_RENDER_WRAPPER(size_t, size_t);                break;
+            case CYMCTYPE_STR:{
+                const uint8_t* str = payload;
+                for(; payload < end && *payload; payload+=1);
+                if(payload >= end) return;
+                fwrite(str, 1, (size_t) (payload - str), output);
+                payload += 1;
+            }   break;
+            default:                            break;
+            }
+        }
+
+        format = token + len;
+    }
+
+    #undef ICYM_RENDER_WRAPPER
+}
+
+CYMDEF int cym_log_decode(FILE* input, FILE* output){
+
+    char magic[8];
+    if(fread(magic, 1, sizeof(magic), input) != sizeof(magic) || memcmp(magic, ICYM_LOG_MAGIC, sizeof(magic))){
+        return 1;
+    }
+
+    unsigned long long realtime0;
+    unsigned long long ticks0;
+    double ns_per_tick;
+    if(cym_sunpack_values(input, icym_log_fread, "%llu%llu%lf", &realtime0, &ticks0, &ns_per_tick)
+        != 2 * sizeof(unsigned long long) + sizeof(double)){
+        return 1;
+    }
+
+    ICymLogFormat* formats  = NULL;
+    uint32_t format_count   = 0;
+    uint8_t* payload        = NULL;
+    size_t payload_capacity = 0;
+    int status              = 0;
+
+    for(unsigned int kind; icym_log_fread(&kind, 1, sizeof(kind), input) == sizeof(kind); ){
+
+        if(kind == ICYM_LOG_RECORD_FORMAT){
+            unsigned int id;
+            int line;
+            char format[ICYM_LOG_MAX_STR + 1];
+            char file[ICYM_LOG_MAX_STR + 1];
+            // the strings report the characters read without their terminator, so a file cut inside them shows as eof
+            if(cym_sunpack_values(input, icym_log_fread, "%u%i", &id, &line) != sizeof(id) + sizeof(line) || id == 0){
+                status = 1;
+                break;
+            }
+            cym_sunpack_values(input, icym_log_fread, "%.*s%.*s",
+                ICYM_LOG_MAX_STR + 1, format, ICYM_LOG_MAX_STR + 1, file
+            );
+            if(feof(input)){
+                status = 1;
+                break;
+            }
+
+            if(id > format_count){
+                ICymLogFormat* f = (ICymLogFormat*) realloc(formats, id * sizeof(ICymLogFormat));
+                if(!f){
+                    status = 1;
+                    break;
+                }
+                for(uint32_t i = format_count; i < id; i+=1) f[i] = (ICymLogFormat){0};
+                formats      = f;
+                format_count = id;
+            }
+            free((void*) formats[id - 1].format);
+            free((void*) formats[id - 1].file);
+            formats[id - 1].format = icym_log_strdup(format);
+            formats[id - 1].file   = icym_log_strdup(file);
+            formats[id - 1].line   = line;
+        }
+        else if(kind == ICYM_LOG_RECORD_ENTRY){
+            unsigned int thread_id;
+            unsigned int id;
+            unsigned long long ticks;
+            unsigned int size;
+            if(cym_sunpack_values(input, icym_log_fread, "%u%u%llu%u", &thread_id, &id, &ticks, &size)
+                != sizeof(thread_id) + sizeof(id) + sizeof(ticks) + sizeof(size)){
+                status = 1;
+                break;
+            }
+
+            if(size > payload_capacity){
+                uint8_t* p = (uint8_t*) realloc(payload, size);
+                if(!p){
+                    status = 1;
+                    break;
+                }
+                payload          = p;
+                payload_capacity = size;
+            }
+            if(icym_log_fread(payload, 1, size, input) != size){
+                status = 1;
+                break;
+            }
+
+            const double ns = (double) realtime0 + (double) (long long) (ticks - ticks0) * ns_per_tick;
+            const unsigned long long ins = (unsigned long long) ns;
+
+            fprintf(output, "[%llu.%09llu] [%u] ", ins / 1000000000ull, ins % 1000000000ull, thread_id);
+
+            if(id == 0 || id > format_count || !formats[id - 1].format){
+                fprintf(output, "<unknown format %u>\n", id);
+                continue;
+            }
+
+            fprintf(output, "%s:%i: ", formats[id - 1].file, formats[id - 1].line);
+            icym_log_render(output, formats[id - 1].format, payload, size);
+            fputc('\n', output);
+        }
+        else{
+            status = 1;
+            break;
+        }
+    }
+
+    for(uint32_t i = 0; i < format_count; i+=1){
+        free((void*) formats[i].format);
+        free((void*) formats[i].file);
+    }
+    free(formats);
+    free(payload);
+
+    return status;
+}
+
+#endif // ======================== END OF FUNCTION IMPLEMENTATIONS ==================================================
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // =====================  END OF FILE CYMLOG_HEADER ===========================
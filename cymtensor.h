@@ -0,0 +1,363 @@
+#ifndef CYMTENSOR_HEADER
+#define CYMTENSOR_HEADER
+
+/*
+    Self describing typed tensor files, written through cymbol.h's packing functions and loaded with mmap,
+    so the data can be handed straight to cymath.h's routines without copies.
+
+    file layout (native byte order):
+        magic "CYMTENS1"
+        u32 byte order mark (0x01020304)
+        u32 element type given in CymAtomTypes enum
+        u32 rank
+        u32 reserved (0)
+        u64 alignment of the data in the file
+        u64 offset of the data from the beginning of the file
+        u64 shape[rank]
+        i64 strides[rank] (in elements)
+        zero padding up to the data offset
+        data
+
+    usage with cymath.h:
+        CymTensor t;
+        if(!cym_tensor_map("weights.cyt", &t, 0)){
+            unsigned int rows, columns;
+            const CYM_FLOAT* m = (const CYM_FLOAT*) cym_tensor_matrix(&t, CYM_TYPE_TO_ATOM_MAP(CYM_FLOAT), &rows, &columns);
+            if(m) cym_mat_multiply(m, columns, rows, other, other_columns, output);
+            cym_tensor_unmap(&t);
+        }
+
+    needs POSIX (mmap).
+*/
+
+#include "cymbol.h"
+#include <stdint.h>
+
+#ifndef CYM_TENSOR_MAX_RANK
+#define CYM_TENSOR_MAX_RANK 8
+#endif
+
+// alignment used by cym_tensor_save, enough for any SIMD load
+#ifndef CYM_TENSOR_DEFAULT_ALIGNMENT
+#define CYM_TENSOR_DEFAULT_ALIGNMENT 64
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct CymTensor{
+    // first element of the tensor (or slice)
+    void*    data;
+    // element type given in CymAtomTypes enum
+    int      atom_type;
+    uint32_t rank;
+    uint64_t shape[CYM_TENSOR_MAX_RANK];
+    // in elements
+    int64_t  strides[CYM_TENSOR_MAX_RANK];
+    uint64_t alignment;
+    uint64_t data_offset;
+
+    // the mapping backing data, NULL if the tensor was only read from a header
+    void*    map;
+    size_t   map_size;
+} CymTensor;
+
+// writes a contiguous row major tensor to path
+// \returns 0 on success, 1 otherwise
+CYMDEF int cym_tensor_save(const char* path, int atom_type, uint32_t rank, const uint64_t* shape, const void* data);
+
+// writes a tensor to path, data is read with strides (in elements, NULL for contiguous row major)
+// and stored contiguously, the start of the data in the file is aligned to alignment (0 for the default)
+// \returns 0 on success, 1 otherwise
+CYMDEF int cym_tensor_save_ex(const char* path, int atom_type, uint32_t rank, const uint64_t* shape,
+    const int64_t* strides, uint64_t alignment, const void* data);
+
+// same as cym_tensor_save for a rows x columns matrix
+CYMDEF int cym_tensor_save_matrix(const char* path, int atom_type, unsigned int rows, unsigned int columns, const void* data);
+
+// reads only the header of the tensor file at path, tensor->data is left NULL
+// \returns 0 on success, 1 otherwise (also for a header cym_tensor_save_ex would not write: strides that are not
+// contiguous row major, a size overflowing 64 bits or data overlapping the header)
+CYMDEF int cym_tensor_read_header(const char* path, CymTensor* tensor);
+
+// maps the whole tensor file at path, pages are only read from disk when touched
+// \returns 0 on success, 1 otherwise
+CYMDEF int cym_tensor_map(const char* path, CymTensor* tensor, int writable);
+
+// maps only count entries along the first axis starting at first, for working with files larger than memory
+// (or than the address space) one slice at a time
+// \returns 0 on success, 1 otherwise
+CYMDEF int cym_tensor_map_slice(const char* path, uint64_t first, uint64_t count, CymTensor* tensor, int writable);
+
+// hints the system to start reading the mapped tensor from disk in the background
+CYMDEF void cym_tensor_prefetch(const CymTensor* tensor);
+
+CYMDEF void cym_tensor_unmap(CymTensor* tensor);
+
+CYMDEF uint64_t cym_tensor_element_count(const CymTensor* tensor);
+
+// \returns 1 if the tensor's elements are contiguous and in row major order, 0 otherwise
+CYMDEF int cym_tensor_is_contiguous(const CymTensor* tensor);
+
+// \returns the data of a contiguous rank 2 (or rank 1, as a single row) tensor of elements of atom_type, writing its size to
+// rows and columns, or NULL if the tensor can not be used as such a matrix
+CYMDEF void* cym_tensor_matrix(const CymTensor* tensor, int atom_type, unsigned int* rows, unsigned int* columns);
+
+
+#ifdef CYMTENSOR_IMPLEMENTATION
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define ICYM_TENSOR_MAGIC   "CYMTENS1"
+#define ICYM_TENSOR_BOM     0x01020304u
+
+static size_t icym_tensor_fwrite(const void* src, size_t _size, size_t n, void* stream){
+    return fwrite(src, _size, n, (FILE*) stream) * _size;
+}
+
+static size_t icym_tensor_fread(void* dest, size_t _size, size_t n, void* stream){
+    return fread(dest, _size, n, (FILE*) stream) * _size;
+}
+
+static inline uint64_t icym_tensor_header_size(uint32_t rank){
+    return 8 + 4 * sizeof(uint32_t) + 2 * sizeof(uint64_t) + rank * (sizeof(uint64_t) + sizeof(int64_t));
+}
+
+CYMDEF uint64_t cym_tensor_element_count(const CymTensor* tensor){
+    uint64_t count = 1;
+    for(uint32_t i = 0; i < tensor->rank; i+=1) count *= tensor->shape[i];
+    return count;
+}
+
+CYMDEF int cym_tensor_is_contiguous(const CymTensor* tensor){
+    int64_t stride = 1;
+    for(uint32_t i = tensor->rank; i > 0; i-=1){
+        if(tensor->shape[i - 1] > 1 && tensor->strides[i - 1] != stride) return 0;
+        stride *= (int64_t) tensor->shape[i - 1];
+    }
+    return 1;
+}
+
+CYMDEF int cym_tensor_save_ex(const char* path, int atom_type, uint32_t rank, const uint64_t* shape,
+    const int64_t* strides, uint64_t alignment, const void* data){
+
+    const size_t element_size = cym_atom_size(atom_type);
+    if(!element_size || rank > CYM_TENSOR_MAX_RANK || (rank && !shape) || !data) return 1;
+
+    if(alignment == 0) alignment = CYM_TENSOR_DEFAULT_ALIGNMENT;
+    if(alignment & (alignment - 1)) return 1;
+
+    FILE* file = fopen(path, "wb");
+    if(!file) return 1;
+
+    uint64_t count = 1;
+    int64_t  file_strides[CYM_TENSOR_MAX_RANK];
+    for(uint32_t i = rank; i > 0; i-=1){
+        file_strides[i - 1] = (int64_t) count;
+        count *= shape[i - 1];
+    }
+
+    const uint64_t header_size = icym_tensor_header_size(rank);
+    const uint64_t data_offset = (header_size + alignment - 1) & ~(alignment - 1);
+
+    size_t written = cym_spack_data(file, icym_tensor_fwrite, (size_t) 8, (void*) ICYM_TENSOR_MAGIC);
+    written += cym_spack_values(file, icym_tensor_fwrite, "%u%u%u%u%llu%llu",
+        ICYM_TENSOR_BOM, (unsigned int) atom_type, (unsigned int) rank, 0u,
+        (unsigned long long) alignment, (unsigned long long) data_offset
+    );
+    if(rank){
+        written += cym_spack_data(file, icym_tensor_fwrite,
+            rank * sizeof(uint64_t), (void*) shape,
+            rank * sizeof(int64_t),  (void*) file_strides
+        );
+    }
+    for(uint64_t i = header_size; i < data_offset; i+=1){
+        fputc(0, file);
+        written += 1;
+    }
+
+    int status = written != data_offset;
+
+    if(!status && !strides){
+        status = fwrite(data, element_size, count, file) != count;
+    }
+    else if(!status){
+        // gathers the elements in row major order, one innermost row at a time
+        const uint64_t inner   = rank? shape[rank - 1] : 1;
+        const int64_t  istride = rank? strides[rank - 1] : 1;
+        uint64_t index[CYM_TENSOR_MAX_RANK] = {0};
+        uint8_t row[4096];
+
+        for(uint64_t done = 0; done < count && !status; done += inner){
+
+            const uint8_t* src = (const uint8_t*) data;
+            for(uint32_t i = 0; i + 1 < rank; i+=1) src += (int64_t) index[i] * strides[i] * (int64_t) element_size;
+
+            for(uint64_t j = 0; j < inner && !status; ){
+                size_t n = 0;
+                for(; j < inner && (n + 1) * element_size <= sizeof(row); j+=1, n+=1){
+                    memcpy(row + n * element_size, src + (int64_t) j * istride * (int64_t) element_size, element_size);
+                }
+                status = fwrite(row, element_size, n, file) != n;
+            }
+
+            for(uint32_t i = rank? rank - 1 : 0; i > 0; i-=1){
+                if(++index[i - 1] < shape[i - 1]) break;
+                index[i - 1] = 0;
+            }
+        }
+    }
+
+    if(fclose(file)) status = 1;
+
+    return status;
+}
+
+CYMDEF int cym_tensor_save(const char* path, int atom_type, uint32_t rank, const uint64_t* shape, const void* data){
+    return cym_tensor_save_ex(path, atom_type, rank, shape, NULL, 0, data);
+}
+
+CYMDEF int cym_tensor_save_matrix(const char* path, int atom_type, unsigned int rows, unsigned int columns, const void* data){
+    const uint64_t shape[2] = {rows, columns};
+    return cym_tensor_save_ex(path, atom_type, 2, shape, NULL, 0, data);
+}
+
+CYMDEF int cym_tensor_read_header(const char* path, CymTensor* tensor){
+
+    FILE* file = fopen(path, "rb");
+    if(!file) return 1;
+
+    memset(tensor, 0, sizeof(*tensor));
+
+    char magic[8];
+    unsigned int bom, atom_type, rank, reserved;
+    unsigned long long alignment, data_offset;
+
+    int status = icym_tensor_fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, ICYM_TENSOR_MAGIC, sizeof(magic));
+
+    status = status || cym_sunpack_values(file, icym_tensor_fread, "%u%u%u%u%llu%llu",
+        &bom, &atom_type, &rank, &reserved, &alignment, &data_offset
+    ) != 4 * sizeof(unsigned int) + 2 * sizeof(unsigned long long);
+
+    status = status || bom != ICYM_TENSOR_BOM || rank > CYM_TENSOR_MAX_RANK || !cym_atom_size((int) atom_type);
+
+    status = status || cym_sunpack_data(file, icym_tensor_fread,
+        rank * sizeof(uint64_t), (void*) tensor->shape,
+        rank * sizeof(int64_t),  (void*) tensor->strides
+    ) != rank * (sizeof(uint64_t) + sizeof(int64_t));
+
+    fclose(file);
+
+    if(status) return 1;
+
+    // the mapping trusts the header, so it has to describe what cym_tensor_save_ex writes: contiguous row major strides,
+    // data past the header and a size that fits in an off_t
+    const uint64_t limit = (uint64_t) INT64_MAX / cym_atom_size((int) atom_type);
+    uint64_t count = 1;
+    for(uint32_t i = rank; i > 0; i-=1){
+        if(tensor->strides[i - 1] != (int64_t) count) return 1;
+        if(tensor->shape[i - 1] && count > limit / tensor->shape[i - 1]) return 1;
+        count *= tensor->shape[i - 1];
+    }
+    const uint64_t size = count * cym_atom_size((int) atom_type);
+    if(data_offset < icym_tensor_header_size(rank) || data_offset > (uint64_t) INT64_MAX - size) return 1;
+
+    tensor->atom_type   = (int) atom_type;
+    tensor->rank        = rank;
+    tensor->alignment   = alignment;
+    tensor->data_offset = data_offset;
+
+    return 0;
+}
+
+CYMDEF int cym_tensor_map_slice(const char* path, uint64_t first, uint64_t count, CymTensor* tensor, int writable){
+
+    if(cym_tensor_read_header(path, tensor)) return 1;
+
+    const size_t element_size = cym_atom_size(tensor->atom_type);
+
+    // bytes of one entry along the first axis
+    uint64_t entry = element_size;
+    for(uint32_t i = 1; i < tensor->rank; i+=1) entry *= tensor->shape[i];
+
+    const uint64_t total = tensor->rank? tensor->shape[0] : 1;
+    if(first > total) return 1;
+    if(count > total - first) count = total - first;
+
+    const int fd = open(path, writable? O_RDWR : O_RDONLY);
+    if(fd < 0) return 1;
+
+    struct stat st;
+    if(fstat(fd, &st) || (uint64_t) st.st_size < tensor->data_offset + total * entry){
+        close(fd);
+        return 1;
+    }
+
+    // mmap offsets have to be page aligned
+    const uint64_t page   = (uint64_t) sysconf(_SC_PAGESIZE);
+    const uint64_t begin  = tensor->data_offset + first * entry;
+    const uint64_t offset = begin & ~(page - 1);
+    const size_t   size   = (size_t) (begin - offset + count * entry);
+
+    void* map = NULL;
+    if(size){
+        map = mmap(NULL, size, writable? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, (off_t) offset);
+        if(map == MAP_FAILED){
+            close(fd);
+            return 1;
+        }
+    }
+    close(fd);
+
+    tensor->map      = map;
+    tensor->map_size = size;
+    tensor->data     = map? (uint8_t*) map + (begin - offset) : NULL;
+    if(tensor->rank) tensor->shape[0] = count;
+
+    return 0;
+}
+
+CYMDEF int cym_tensor_map(const char* path, CymTensor* tensor, int writable){
+    return cym_tensor_map_slice(path, 0, UINT64_MAX, tensor, writable);
+}
+
+CYMDEF void cym_tensor_prefetch(const CymTensor* tensor){
+    if(tensor->map) madvise(tensor->map, tensor->map_size, MADV_WILLNEED);
+}
+
+CYMDEF void cym_tensor_unmap(CymTensor* tensor){
+    if(tensor->map) munmap(tensor->map, tensor->map_size);
+    tensor->map      = NULL;
+    tensor->map_size = 0;
+    tensor->data     = NULL;
+}
+
+CYMDEF void* cym_tensor_matrix(const CymTensor* tensor, int atom_type, unsigned int* rows, unsigned int* columns){
+
+    if(tensor->atom_type != atom_type || !tensor->data || tensor->rank < 1 || tensor->rank > 2) return NULL;
+    if(!cym_tensor_is_contiguous(tensor)) return NULL;
+
+    const uint64_t r = (tensor->rank == 2)? tensor->shape[0] : 1;
+    const uint64_t c = tensor->shape[tensor->rank - 1];
+    if(r > UINT32_MAX || c > UINT32_MAX) return NULL;
+
+    if(rows)    *rows    = (unsigned int) r;
+    if(columns) *columns = (unsigned int) c;
+
+    return tensor->data;
+}
+
+#endif // ======================== END OF FUNCTION IMPLEMENTATIONS ==================================================
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // =====================  END OF FILE CYMTENSOR_HEADER ===========================
@@ -0,0 +1,33 @@
+#define CYMBOL_IMPLEMENTATION
+#define CYMLOG_IMPLEMENTATION
+#include "cymlog.h"
+
+// renders binary logs written by cymlog.h as text
+int main(int argc, char** argv){
+
+    if(argc < 2 || argc > 3){
+        printf("usage: %s <input log> <optional: output text file>\n", argv[0]);
+        return 1;
+    }
+
+    FILE* input = fopen(argv[1], "rb");
+    if(!input){
+        fprintf(stderr, "[ERROR] could not open '%s'\n", argv[1]);
+        return 1;
+    }
+
+    FILE* output = (argc == 3)? fopen(argv[2], "w") : stdout;
+    if(!output){
+        fprintf(stderr, "[ERROR] could not open '%s'\n", argv[2]);
+        fclose(input);
+        return 1;
+    }
+
+    const int status = cym_log_decode(input, output);
+    if(status) fprintf(stderr, "[ERROR] '%s' is not a valid log or is truncated\n", argv[1]);
+
+    fclose(input);
+    if(output != stdout) fclose(output);
+
+    return status;
+}
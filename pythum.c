@@ -0,0 +1,626 @@
+#define CYMATH_IMPLEMENTATION
+#include "cymath.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// native state-vector engine for pythum.py, which loads it with ctypes when it finds the shared library next to it:
+//     cc -O3 -march=native -shared -fPIC pythum.c -o libpythum.so -lm -lpthread
+// a state of n qbits is 2^n complex amplitudes stored as interleaved (re, im) doubles, amplitude i being the basis state
+// whose bit q is the value of qbit q
+// controls are given as two bitmasks: a gate acts on the amplitudes whose index has (index & ctrl_mask) == ctrl_value
+// the kernels walk the pairs (or groups) of amplitudes a gate mixes in runs of consecutive indices, so each run is a plain
+// loop the compiler vectorizes, and circuits above PYTHUM_GRAIN pairs are split over cymath.h's thread pool
+
+// pairs of amplitudes per parallel task, states with fewer pairs than this run on the calling thread
+#ifndef PYTHUM_GRAIN
+#define PYTHUM_GRAIN (1 << 14)
+#endif
+
+// largest state pythum_alloc makes, 2^40 amplitudes are already 16 TiB
+#define PYTHUM_MAX_QBITS 40
+
+// amplitudes multi qbit gates gather at once, sharing each matrix element between them
+#define IPYTHUM_BLOCK 8
+// gate dimension up to which the multi qbit scratch lives on the stack
+#define IPYTHUM_STACK_DIM 64
+
+enum IPythumKind{
+    IPYTHUM_X = 0,
+    IPYTHUM_Y,
+    IPYTHUM_Z,
+    IPYTHUM_H,
+    IPYTHUM_U,
+    IPYTHUM_MATRIX,
+};
+
+typedef struct IPythumJob{
+    double* state;
+    int kind;
+    double gate[8];                 // g00, g01, g10, g11 as (re, im) for IPYTHUM_U
+    const double* matrix;           // row major dim x dim complex matrix for IPYTHUM_MATRIX
+    const size_t* offsets;          // offsets[b] is the index of basis state b of the targets, relative to the group
+    size_t dim;
+    size_t target_bit;              // distance between the two amplitudes of a pair
+    unsigned int positions[64];     // qbits fixed by the gate (targets and controls) in increasing order
+    unsigned int position_count;
+    size_t ctrl_value;
+    size_t run, stride;             // groups come in runs of run groups, stride amplitudes apart
+    int failed;
+    int outcome;
+    double scale;
+} IPythumJob;
+
+// \returns the index of the first amplitude of group k: k with a zero bit inserted at each fixed qbit, controls then set
+static inline size_t ipythum_group(const IPythumJob* job, size_t k){
+    for(unsigned int i = 0; i < job->position_count; i+=1){
+        const size_t low = ((size_t)1 << job->positions[i]) - 1;
+        k = ((k & ~low) << 1) | (k & low);
+    }
+    return k | job->ctrl_value;
+}
+
+// fills in the fixed qbits of job, which the groups are built around, with no targets the groups are the controls' ones
+// \returns 0 on success, -1 if a qbit is out of range or a target is repeated or also a control
+static int ipythum_setup(IPythumJob* job, double* state, unsigned int number_of_qbits, const unsigned int* targets,
+    unsigned int target_count, uint64_t ctrl_mask, uint64_t ctrl_value){
+
+    if(!state || number_of_qbits > PYTHUM_MAX_QBITS || target_count > number_of_qbits) return -1;
+    if(number_of_qbits < 64 && (ctrl_mask >> number_of_qbits)) return -1;
+
+    uint64_t fixed = ctrl_mask;
+    for(unsigned int i = 0; i < target_count; i+=1){
+        if(targets[i] >= number_of_qbits || ((fixed >> targets[i]) & 1)) return -1;
+        fixed |= (uint64_t)1 << targets[i];
+    }
+
+    job->state          = state;
+    job->ctrl_value     = (size_t)(ctrl_value & ctrl_mask);
+    job->target_bit     = target_count? (size_t)1 << targets[0] : 0;
+    job->position_count = 0;
+    for(unsigned int q = 0; q < number_of_qbits; q+=1){
+        if((fixed >> q) & 1) job->positions[job->position_count++] = q;
+    }
+
+    // a run ends where the lowest fixed qbit would flip, or the second one when the lowest is qbit 0
+    const size_t groups = (size_t)1 << (number_of_qbits - job->position_count);
+    if(job->position_count == 0){
+        job->run    = groups;
+        job->stride = 1;
+    } else if(job->positions[0] > 0){
+        job->run    = (size_t)1 << job->positions[0];
+        job->stride = 1;
+    } else{
+        job->run    = (job->position_count > 1)? (size_t)1 << (job->positions[1] - 1) : groups;
+        job->stride = 2;
+    }
+    if(job->run > groups) job->run = groups;
+    job->failed = 0;
+    return 0;
+}
+
+// \returns how many groups job has
+static size_t ipythum_groups(const IPythumJob* job, unsigned int number_of_qbits){
+    return (size_t)1 << (number_of_qbits - job->position_count);
+}
+
+// the pair kernels: a and b point at the first pair of a run of n pairs, step doubles apart
+
+static inline void ipythum_x(double* restrict a, double* restrict b, size_t n, size_t step){
+    for(size_t i = 0; i < n * step; i+=step){
+        const double ar = a[i], ai = a[i + 1];
+        a[i] = b[i];  a[i + 1] = b[i + 1];
+        b[i] = ar;    b[i + 1] = ai;
+    }
+}
+
+static inline void ipythum_y(double* restrict a, double* restrict b, size_t n, size_t step){
+    for(size_t i = 0; i < n * step; i+=step){
+        const double ar = a[i], ai = a[i + 1];
+        a[i] =  b[i + 1];  a[i + 1] = -b[i];
+        b[i] = -ai;        b[i + 1] =  ar;
+    }
+}
+
+static inline void ipythum_z(double* b, size_t n, size_t step){
+    for(size_t i = 0; i < n * step; i+=step){
+        b[i] = -b[i];  b[i + 1] = -b[i + 1];
+    }
+}
+
+static inline void ipythum_h(double* restrict a, double* restrict b, size_t n, size_t step){
+    const double r = 0.70710678118654752440;
+    for(size_t i = 0; i < n * step; i+=step){
+        const double ar = a[i], ai = a[i + 1], br = b[i], bi = b[i + 1];
+        a[i] = (ar + br) * r;  a[i + 1] = (ai + bi) * r;
+        b[i] = (ar - br) * r;  b[i + 1] = (ai - bi) * r;
+    }
+}
+
+static inline void ipythum_u(double* restrict a, double* restrict b, size_t n, size_t step, const double* g){
+    for(size_t i = 0; i < n * step; i+=step){
+        const double ar = a[i], ai = a[i + 1], br = b[i], bi = b[i + 1];
+        a[i]     = g[0] * ar - g[1] * ai + g[2] * br - g[3] * bi;
+        a[i + 1] = g[0] * ai + g[1] * ar + g[2] * bi + g[3] * br;
+        b[i]     = g[4] * ar - g[5] * ai + g[6] * br - g[7] * bi;
+        b[i + 1] = g[4] * ai + g[5] * ar + g[6] * bi + g[7] * br;
+    }
+}
+
+// applies the pair kernel of job to n pairs, step is a literal at both call sites so each gets its own vector loop
+static inline void ipythum_pairs(const IPythumJob* job, double* a, double* b, size_t n, size_t step){
+    switch(job->kind){
+    case IPYTHUM_X: ipythum_x(a, b, n, step); break;
+    case IPYTHUM_Y: ipythum_y(a, b, n, step); break;
+    case IPYTHUM_Z: ipythum_z(b, n, step); break;
+    case IPYTHUM_H: ipythum_h(a, b, n, step); break;
+    default:        ipythum_u(a, b, n, step, job->gate); break;
+    }
+}
+
+static void ipythum_pair_task(size_t begin, size_t end, void* user){
+    const IPythumJob* job = (const IPythumJob*)user;
+    for(size_t k = begin; k < end;){
+        size_t n = job->run - (k & (job->run - 1));
+        if(n > end - k) n = end - k;
+
+        double* a = job->state + 2 * ipythum_group(job, k);
+        double* b = a + 2 * job->target_bit;
+        if(job->stride == 1) ipythum_pairs(job, a, b, n, 2);
+        else                 ipythum_pairs(job, a, b, n, 4);
+        k += n;
+    }
+}
+
+// two qbit gates, the size fused circuits mostly have, mix the four amplitudes of a group in place like the pair kernels
+static inline void ipythum_u4(double* restrict a0, double* restrict a1, double* restrict a2, double* restrict a3, size_t n,
+    size_t step, const double* m){
+
+    for(size_t i = 0; i < n * step; i+=step){
+        const double vr[4] = { a0[i], a1[i], a2[i], a3[i] };
+        const double vi[4] = { a0[i + 1], a1[i + 1], a2[i + 1], a3[i + 1] };
+        double outr[4], outi[4];
+        for(int r = 0; r < 4; r+=1){
+            const double* row = m + 8 * r;
+            outr[r] = row[0] * vr[0] - row[1] * vi[0] + row[2] * vr[1] - row[3] * vi[1]
+                    + row[4] * vr[2] - row[5] * vi[2] + row[6] * vr[3] - row[7] * vi[3];
+            outi[r] = row[0] * vi[0] + row[1] * vr[0] + row[2] * vi[1] + row[3] * vr[1]
+                    + row[4] * vi[2] + row[5] * vr[2] + row[6] * vi[3] + row[7] * vr[3];
+        }
+        a0[i] = outr[0];  a0[i + 1] = outi[0];
+        a1[i] = outr[1];  a1[i + 1] = outi[1];
+        a2[i] = outr[2];  a2[i + 1] = outi[2];
+        a3[i] = outr[3];  a3[i + 1] = outi[3];
+    }
+}
+
+static void ipythum_quad_task(size_t begin, size_t end, void* user){
+    const IPythumJob* job = (const IPythumJob*)user;
+    for(size_t k = begin; k < end;){
+        size_t n = job->run - (k & (job->run - 1));
+        if(n > end - k) n = end - k;
+
+        double* a = job->state + 2 * ipythum_group(job, k);
+        double* a1 = a + 2 * job->offsets[1];
+        double* a2 = a + 2 * job->offsets[2];
+        double* a3 = a + 2 * job->offsets[3];
+        if(job->stride == 1) ipythum_u4(a, a1, a2, a3, n, 2, job->matrix);
+        else                 ipythum_u4(a, a1, a2, a3, n, 4, job->matrix);
+        k += n;
+    }
+}
+
+// gathers IPYTHUM_BLOCK groups at a time split in real and imaginary parts, so the matrix product runs across the groups
+static void ipythum_matrix_task(size_t begin, size_t end, void* user){
+    IPythumJob* job = (IPythumJob*)user;
+    const size_t dim = job->dim;
+
+    double stack[4 * IPYTHUM_STACK_DIM * IPYTHUM_BLOCK];
+    double* scratch = stack;
+    if(dim > IPYTHUM_STACK_DIM){
+        scratch = (double*)malloc(4 * dim * IPYTHUM_BLOCK * sizeof(double));
+        if(!scratch){
+            __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    }
+    double* vr = scratch;
+    double* vi = vr + dim * IPYTHUM_BLOCK;
+    double* sr = vi + dim * IPYTHUM_BLOCK;
+    double* si = sr + dim * IPYTHUM_BLOCK;
+
+    size_t groups[IPYTHUM_BLOCK];
+    for(size_t k = begin; k < end; k+=IPYTHUM_BLOCK){
+        const size_t w = (end - k < IPYTHUM_BLOCK)? end - k : IPYTHUM_BLOCK;
+        // a short last block repeats its first group, whose copies are computed but never written back
+        if((k & (job->run - 1)) + IPYTHUM_BLOCK <= job->run){
+            const size_t first = 2 * ipythum_group(job, k);
+            for(size_t j = 0; j < IPYTHUM_BLOCK; j+=1) groups[j] = first + ((j < w)? 2 * job->stride * j : 0);
+        } else{
+            for(size_t j = 0; j < IPYTHUM_BLOCK; j+=1) groups[j] = 2 * ipythum_group(job, (j < w)? k + j : k);
+        }
+
+        for(size_t c = 0; c < dim; c+=1){
+            const double* amplitudes = job->state + 2 * job->offsets[c];
+            for(size_t j = 0; j < IPYTHUM_BLOCK; j+=1){
+                vr[c * IPYTHUM_BLOCK + j] = amplitudes[groups[j]];
+                vi[c * IPYTHUM_BLOCK + j] = amplitudes[groups[j] + 1];
+            }
+        }
+        for(size_t r = 0; r < dim; r+=1){
+            // the sums stay in registers, the scratch rows would alias them
+            double out_r[IPYTHUM_BLOCK] = {0}, out_i[IPYTHUM_BLOCK] = {0};
+            for(size_t c = 0; c < dim; c+=1){
+                const double ur = job->matrix[2 * (r * dim + c)], ui = job->matrix[2 * (r * dim + c) + 1];
+                const double* in_r = vr + c * IPYTHUM_BLOCK;
+                const double* in_i = vi + c * IPYTHUM_BLOCK;
+                for(size_t j = 0; j < IPYTHUM_BLOCK; j+=1){
+                    out_r[j] += ur * in_r[j] - ui * in_i[j];
+                    out_i[j] += ur * in_i[j] + ui * in_r[j];
+                }
+            }
+            for(size_t j = 0; j < IPYTHUM_BLOCK; j+=1){
+                sr[r * IPYTHUM_BLOCK + j] = out_r[j];
+                si[r * IPYTHUM_BLOCK + j] = out_i[j];
+            }
+        }
+        for(size_t r = 0; r < dim; r+=1){
+            double* amplitudes = job->state + 2 * job->offsets[r];
+            for(size_t j = 0; j < w; j+=1){
+                amplitudes[groups[j]]     = sr[r * IPYTHUM_BLOCK + j];
+                amplitudes[groups[j] + 1] = si[r * IPYTHUM_BLOCK + j];
+            }
+        }
+    }
+
+    if(scratch != stack) free(scratch);
+}
+
+static int ipythum_pair_gate(double* state, unsigned int number_of_qbits, unsigned int target, uint64_t ctrl_mask,
+    uint64_t ctrl_value, int kind, const double* gate){
+
+    IPythumJob job;
+    if(ipythum_setup(&job, state, number_of_qbits, &target, 1, ctrl_mask, ctrl_value)) return -1;
+    job.kind = kind;
+    if(gate) for(int i = 0; i < 8; i+=1) job.gate[i] = gate[i];
+
+    cym_parallel_for(0, ipythum_groups(&job, number_of_qbits), PYTHUM_GRAIN, ipythum_pair_task, &job);
+    return 0;
+}
+
+// \returns a zeroed state of number_of_qbits qbits (all amplitudes 0, not |0>), NULL on failure, release it with pythum_free
+double* pythum_alloc(unsigned int number_of_qbits){
+    if(number_of_qbits > PYTHUM_MAX_QBITS) return NULL;
+    return (double*)calloc((size_t)2 << number_of_qbits, sizeof(double));
+}
+
+void pythum_free(double* state){
+    free(state);
+}
+
+// the gates below \returns 0 on success and -1 if a qbit is out of range, a target is repeated or also a control
+// (the state is then left untouched)
+
+int pythum_x(double* state, unsigned int number_of_qbits, unsigned int target, uint64_t ctrl_mask, uint64_t ctrl_value){
+    return ipythum_pair_gate(state, number_of_qbits, target, ctrl_mask, ctrl_value, IPYTHUM_X, NULL);
+}
+
+int pythum_y(double* state, unsigned int number_of_qbits, unsigned int target, uint64_t ctrl_mask, uint64_t ctrl_value){
+    return ipythum_pair_gate(state, number_of_qbits, target, ctrl_mask, ctrl_value, IPYTHUM_Y, NULL);
+}
+
+int pythum_z(double* state, unsigned int number_of_qbits, unsigned int target, uint64_t ctrl_mask, uint64_t ctrl_value){
+    return ipythum_pair_gate(state, number_of_qbits, target, ctrl_mask, ctrl_value, IPYTHUM_Z, NULL);
+}
+
+int pythum_h(double* state, unsigned int number_of_qbits, unsigned int target, uint64_t ctrl_mask, uint64_t ctrl_value){
+    return ipythum_pair_gate(state, number_of_qbits, target, ctrl_mask, ctrl_value, IPYTHUM_H, NULL);
+}
+
+// applies the 2x2 complex matrix gate, given as g00, g01, g10, g11 in (re, im) pairs
+int pythum_single_qbit_gate(double* state, unsigned int number_of_qbits, unsigned int target, uint64_t ctrl_mask,
+    uint64_t ctrl_value, const double* gate){
+    return ipythum_pair_gate(state, number_of_qbits, target, ctrl_mask, ctrl_value, IPYTHUM_U, gate);
+}
+
+// applies the row major 2^target_count x 2^target_count complex matrix in (re, im) pairs, bit i of a row or column index
+// being the value of qbit targets[i]
+// \returns 1 if the scratch of a gate over more than 6 qbits could not be allocated (the state is then undefined)
+int pythum_multi_qbit_gate(double* state, unsigned int number_of_qbits, const unsigned int* targets,
+    unsigned int target_count, uint64_t ctrl_mask, uint64_t ctrl_value, const double* matrix){
+
+    if(target_count == 0) return -1;
+    if(target_count == 1) return ipythum_pair_gate(state, number_of_qbits, targets[0], ctrl_mask, ctrl_value, IPYTHUM_U, matrix);
+
+    IPythumJob job;
+    if(ipythum_setup(&job, state, number_of_qbits, targets, target_count, ctrl_mask, ctrl_value)) return -1;
+
+    const size_t dim = (size_t)1 << target_count;
+    size_t* offsets = (size_t*)malloc(dim * sizeof(size_t));
+    if(!offsets) return 1;
+    for(size_t b = 0; b < dim; b+=1){
+        offsets[b] = 0;
+        for(unsigned int i = 0; i < target_count; i+=1) if((b >> i) & 1) offsets[b] |= (size_t)1 << targets[i];
+    }
+
+    job.kind    = IPYTHUM_MATRIX;
+    job.matrix  = matrix;
+    job.offsets = offsets;
+    job.dim     = dim;
+    // a group costs dim^2 complex products instead of the 2x2 of a pair
+    size_t grain = PYTHUM_GRAIN / (dim * dim / 4);
+    if(grain == 0) grain = 1;
+    cym_parallel_for(0, ipythum_groups(&job, number_of_qbits), grain, (dim == 4)? ipythum_quad_task : ipythum_matrix_task,
+        &job);
+
+    free(offsets);
+    return job.failed;
+}
+
+static void ipythum_probability_task(size_t begin, size_t end, void* partial, void* user){
+    const IPythumJob* job = (const IPythumJob*)user;
+    const size_t step = 2 * job->stride;
+    double sum = 0;
+    for(size_t k = begin; k < end;){
+        size_t n = job->run - (k & (job->run - 1));
+        if(n > end - k) n = end - k;
+        const double* a = job->state + 2 * ipythum_group(job, k);
+        for(size_t i = 0; i < n * step; i+=step) sum += a[i] * a[i] + a[i + 1] * a[i + 1];
+        k += n;
+    }
+    *(double*)partial = sum;
+}
+
+static void ipythum_sum_combine(void* result, const void* partial, void* user){
+    (void)user;
+    *(double*)result += *(const double*)partial;
+}
+
+// \returns the probability of measuring qbit as 0, the sum of |amplitude|^2 over the indices with bit qbit clear,
+// NaN if qbit is out of range or the partial sums could not be allocated
+double pythum_probability(const double* state, unsigned int number_of_qbits, unsigned int qbit){
+    IPythumJob job;
+    if(ipythum_setup(&job, (double*)state, number_of_qbits, &qbit, 1, 0, 0)) return 0.0 / 0.0;
+
+    double p0 = 0;
+    if(cym_parallel_reduce(0, ipythum_groups(&job, number_of_qbits), PYTHUM_GRAIN, &p0, sizeof(p0),
+        ipythum_probability_task, ipythum_sum_combine, &job)) return 0.0 / 0.0;
+    return p0;
+}
+
+static void ipythum_collapse_task(size_t begin, size_t end, void* user){
+    const IPythumJob* job = (const IPythumJob*)user;
+    const size_t step = 2 * job->stride;
+    for(size_t k = begin; k < end;){
+        size_t n = job->run - (k & (job->run - 1));
+        if(n > end - k) n = end - k;
+        double* a = job->state + 2 * ipythum_group(job, k);
+        double* b = a + 2 * job->target_bit;
+        double* keep = job->outcome? b : a;
+        double* drop = job->outcome? a : b;
+        for(size_t i = 0; i < n * step; i+=step){
+            keep[i] *= job->scale;  keep[i + 1] *= job->scale;
+            drop[i]  = 0;           drop[i + 1]  = 0;
+        }
+        k += n;
+    }
+}
+
+// projects qbit onto outcome (0 or 1): zeroes the amplitudes where it differs and multiplies the others by scale
+// \returns 0 on success, -1 if qbit is out of range
+int pythum_collapse(double* state, unsigned int number_of_qbits, unsigned int qbit, int outcome, double scale){
+    IPythumJob job;
+    if(ipythum_setup(&job, state, number_of_qbits, &qbit, 1, 0, 0)) return -1;
+    job.outcome = outcome? 1 : 0;
+    job.scale   = scale;
+
+    cym_parallel_for(0, ipythum_groups(&job, number_of_qbits), PYTHUM_GRAIN, ipythum_collapse_task, &job);
+    return 0;
+}
+
+typedef struct IPythumLoad{
+    double* state;
+    const double* source;
+    size_t count;
+    double scale;
+} IPythumLoad;
+
+static void ipythum_load_task(size_t begin, size_t end, void* user){
+    const IPythumLoad* job = (const IPythumLoad*)user;
+    for(size_t i = begin; i < end; i+=1){
+        job->state[2 * i]     = (i < job->count)? job->source[2 * i] * job->scale : 0;
+        job->state[2 * i + 1] = (i < job->count)? job->source[2 * i + 1] * job->scale : 0;
+    }
+}
+
+// sets the first count amplitudes of state to those of source times scale and the rest to 0, source may be state
+void pythum_load(double* state, unsigned int number_of_qbits, const double* source, size_t count, double scale){
+    const size_t size = (size_t)1 << number_of_qbits;
+    IPythumLoad job = { state, source, (count < size)? count : size, scale };
+    cym_parallel_for(0, size, 2 * PYTHUM_GRAIN, ipythum_load_task, &job);
+}
+
+static void ipythum_norm_task(size_t begin, size_t end, void* partial, void* user){
+    const double* state = (const double*)user;
+    double sum = 0;
+    for(size_t i = 2 * begin; i < 2 * end; i+=1) sum += state[i] * state[i];
+    *(double*)partial = sum;
+}
+
+// \returns the sum of |amplitude|^2 over the first count amplitudes of state, NaN if the partial sums could not be allocated
+double pythum_norm2(const double* state, size_t count){
+    double sum = 0;
+    if(cym_parallel_reduce(0, count, 2 * PYTHUM_GRAIN, &sum, sizeof(sum), ipythum_norm_task, ipythum_sum_combine,
+        (void*)state)) return 0.0 / 0.0;
+    return sum;
+}
+
+// measured qbits at most, so the outcomes of pythum_sample fit the 32 bit indices of its alias table
+#define PYTHUM_MAX_MEASURED 32
+// outcomes up to which the marginal probabilities are summed in per task copies instead of one outcome per task
+#define IPYTHUM_MARGINAL_SPLIT 256
+
+typedef struct IPythumSample{
+    IPythumJob groups;              // the measured qbits as controls, the unmeasured ones walked in runs
+    size_t measured;                // mask of the measured qbits
+    size_t free_groups;             // amplitudes of each outcome
+    double* probability;            // marginal probability of each outcome, then the alias thresholds
+    uint32_t* outcome;              // outcome of each alias table column
+    uint32_t* alias;
+    size_t columns;
+    uint64_t seed;
+    uint64_t* outcomes;
+} IPythumSample;
+
+// \returns index with its bits spread over the fixed qbits of job, the inverse of packing them together
+static size_t ipythum_deposit(const IPythumJob* job, size_t index){
+    size_t out = 0;
+    for(unsigned int i = 0; i < job->position_count; i+=1) out |= ((index >> i) & 1) << job->positions[i];
+    return out;
+}
+
+// \returns the sum of |amplitude|^2 over the unmeasured groups [begin, end) of outcome, given with its bits spread
+static double ipythum_outcome_probability(const IPythumJob* job, size_t outcome, size_t begin, size_t end){
+    const size_t step = 2 * job->stride;
+    double sum = 0;
+    for(size_t k = begin; k < end;){
+        size_t n = job->run - (k & (job->run - 1));
+        if(n > end - k) n = end - k;
+        const double* a = job->state + 2 * (ipythum_group(job, k) | outcome);
+        for(size_t i = 0; i < n * step; i+=step) sum += a[i] * a[i] + a[i + 1] * a[i + 1];
+        k += n;
+    }
+    return sum;
+}
+
+static void ipythum_marginal_task(size_t begin, size_t end, void* user){
+    const IPythumSample* job = (const IPythumSample*)user;
+    const size_t measured = job->measured;
+    // consecutive outcomes spread by the masked increment, one amplitude each when every qbit is measured
+    size_t outcome = ipythum_deposit(&job->groups, begin);
+    for(size_t j = begin; j < end; j+=1){
+        if(job->free_groups == 1){
+            const double* a = job->groups.state + 2 * outcome;
+            job->probability[j] = a[0] * a[0] + a[1] * a[1];
+        } else{
+            job->probability[j] = ipythum_outcome_probability(&job->groups, outcome, 0, job->free_groups);
+        }
+        outcome = ((outcome | ~measured) + 1) & measured;
+    }
+}
+
+// few outcomes: each task sums a slice of the unmeasured groups for all of them
+static void ipythum_marginal_slice_task(size_t begin, size_t end, void* partial, void* user){
+    const IPythumSample* job = (const IPythumSample*)user;
+    double* sums = (double*)partial;
+    for(size_t j = 0; j < job->columns; j+=1){
+        sums[j] = ipythum_outcome_probability(&job->groups, ipythum_deposit(&job->groups, j), begin, end);
+    }
+}
+
+static void ipythum_marginal_combine(void* result, const void* partial, void* user){
+    const IPythumSample* job = (const IPythumSample*)user;
+    for(size_t j = 0; j < job->columns; j+=1) ((double*)result)[j] += ((const double*)partial)[j];
+}
+
+// counter based splitmix64: the random numbers of a shot only depend on the seed and the shot, so the sampling loop has no
+// carried state, vectorizes and gives the same shots for any number of threads
+static inline uint64_t ipythum_random(uint64_t seed, uint64_t counter){
+    uint64_t z = seed + counter * 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+static void ipythum_sample_task(size_t begin, size_t end, void* user){
+    const IPythumSample* job = (const IPythumSample*)user;
+    const double columns = (double)job->columns;
+    for(size_t shot = begin; shot < end; shot+=1){
+        const double u = (double)(ipythum_random(job->seed, 2 * shot + 1) >> 11) * 0x1.0p-53;
+        const double v = (double)(ipythum_random(job->seed, 2 * shot + 2) >> 11) * 0x1.0p-53;
+        size_t column = (size_t)(u * columns);
+        if(column >= job->columns) column = job->columns - 1;
+        job->outcomes[shot] = job->outcome[(v < job->probability[column])? column : job->alias[column]];
+    }
+}
+
+// draws shots measurements of the qbits in measured_mask from state without collapsing it, writing to outcomes the
+// measured bits of each packed together (bit i being the i-th lowest measured qbit)
+// the marginal probabilities go into an alias table (Vose's method) over the outcomes that can happen, so each shot is one
+// table lookup, the same seed gives the same shots
+// \returns 0 on success, -1 if a qbit is out of range, more than PYTHUM_MAX_MEASURED are measured or the state is 0,
+// 1 if the tables could not be allocated
+int pythum_sample(const double* state, unsigned int number_of_qbits, uint64_t measured_mask, size_t shots, uint64_t seed,
+    uint64_t* outcomes){
+
+    IPythumSample job;
+    if(ipythum_setup(&job.groups, (double*)state, number_of_qbits, NULL, 0, measured_mask, 0)) return -1;
+    if(job.groups.position_count > PYTHUM_MAX_MEASURED) return -1;
+
+    const size_t outcome_count = (size_t)1 << job.groups.position_count;
+    job.measured    = (size_t)measured_mask;
+    job.free_groups = ipythum_groups(&job.groups, number_of_qbits);
+    job.columns     = outcome_count;
+    job.probability = (double*)malloc(outcome_count * sizeof(double));
+    job.outcome     = (uint32_t*)malloc(outcome_count * sizeof(uint32_t));
+    job.alias       = (uint32_t*)malloc(outcome_count * sizeof(uint32_t));
+    uint32_t* work  = (uint32_t*)malloc(outcome_count * sizeof(uint32_t));
+    int status = (job.probability && job.outcome && job.alias && work)? 0 : 1;
+
+    if(!status && outcome_count <= IPYTHUM_MARGINAL_SPLIT){
+        for(size_t j = 0; j < outcome_count; j+=1) job.probability[j] = 0;
+        status = cym_parallel_reduce(0, job.free_groups, PYTHUM_GRAIN, job.probability, outcome_count * sizeof(double),
+            ipythum_marginal_slice_task, ipythum_marginal_combine, &job);
+    } else if(!status){
+        const size_t grain = (PYTHUM_GRAIN / job.free_groups)? PYTHUM_GRAIN / job.free_groups : 1;
+        cym_parallel_for(0, outcome_count, grain, ipythum_marginal_task, &job);
+    }
+
+    if(!status){
+        // only the outcomes that can happen get a column
+        double total = 0;
+        size_t columns = 0;
+        for(size_t j = 0; j < outcome_count; j+=1){
+            if(job.probability[j] <= 0) continue;
+            total += job.probability[j];
+            job.probability[columns] = job.probability[j];
+            job.outcome[columns]     = (uint32_t)j;
+            columns+=1;
+        }
+        if(columns == 0) status = -1;
+        job.columns = columns;
+
+        // work holds the columns below the average from the front and the ones above from the back
+        size_t small = 0, large = columns;
+        for(size_t j = 0; j < columns && !status; j+=1){
+            job.probability[j] *= (double)columns / total;
+            job.alias[j] = (uint32_t)j;
+            if(job.probability[j] < 1) work[small++] = (uint32_t)j;
+            else                       work[--large] = (uint32_t)j;
+        }
+        while(small > 0 && large < columns && !status){
+            const uint32_t s = work[--small], l = work[large];
+            job.alias[s] = l;
+            job.probability[l] -= 1 - job.probability[s];
+            if(job.probability[l] < 1){
+                large+=1;
+                work[small++] = l;
+            }
+        }
+        // what is left is 1 up to rounding
+        for(size_t j = 0; j < small; j+=1) job.probability[work[j]] = 1;
+        for(size_t j = large; j < columns; j+=1) job.probability[work[j]] = 1;
+    }
+
+    if(!status){
+        job.seed     = seed;
+        job.outcomes = outcomes;
+        cym_parallel_for(0, shots, 4 * PYTHUM_GRAIN, ipythum_sample_task, &job);
+    }
+
+    free(job.probability);
+    free(job.outcome);
+    free(job.alias);
+    free(work);
+    return status;
+}
@@ -1,11 +1,159 @@
 from math import sqrt, log2
 import random
 from time import time_ns
+import ctypes
+import os
+from collections import Counter
 
 """
     TODO state tracing to get smaller qbit set states from larger ones
 """
 
+def load_native_engine() -> ctypes.CDLL | None:
+    """
+    loads the native state-vector engine (pythum.c built as a shared library, see the top of pythum.c) from the path in
+    the PYTHUM_LIB environment variable or next to this file, None if it is not there or PYTHUM_NO_NATIVE is set to 1
+    """
+    if os.environ.get('PYTHUM_NO_NATIVE', '0') == '1':
+        return None
+    here  = os.path.dirname(os.path.abspath(__file__))
+    paths = [os.environ['PYTHUM_LIB']] if 'PYTHUM_LIB' in os.environ else []
+    paths += [os.path.join(here, name) for name in ('libpythum.so', 'libpythum.dylib', 'pythum.dll')]
+    for path in paths:
+        try:
+            lib = ctypes.CDLL(path)
+        except OSError:
+            continue
+        STATE = ctypes.POINTER(ctypes.c_double)
+        GATE  = [STATE, ctypes.c_uint, ctypes.c_uint, ctypes.c_uint64, ctypes.c_uint64]
+        lib.pythum_alloc.argtypes = [ctypes.c_uint]
+        lib.pythum_alloc.restype  = STATE
+        lib.pythum_free.argtypes  = [STATE]
+        lib.pythum_free.restype   = None
+        for name in ('pythum_x', 'pythum_y', 'pythum_z', 'pythum_h'):
+            getattr(lib, name).argtypes = GATE
+            getattr(lib, name).restype  = ctypes.c_int
+        lib.pythum_single_qbit_gate.argtypes = GATE + [STATE]
+        lib.pythum_single_qbit_gate.restype  = ctypes.c_int
+        lib.pythum_multi_qbit_gate.argtypes  = [STATE, ctypes.c_uint, ctypes.POINTER(ctypes.c_uint), ctypes.c_uint,
+                                                ctypes.c_uint64, ctypes.c_uint64, STATE]
+        lib.pythum_multi_qbit_gate.restype   = ctypes.c_int
+        lib.pythum_probability.argtypes = [STATE, ctypes.c_uint, ctypes.c_uint]
+        lib.pythum_probability.restype  = ctypes.c_double
+        lib.pythum_collapse.argtypes    = [STATE, ctypes.c_uint, ctypes.c_uint, ctypes.c_int, ctypes.c_double]
+        lib.pythum_collapse.restype     = ctypes.c_int
+        lib.pythum_load.argtypes        = [STATE, ctypes.c_uint, STATE, ctypes.c_size_t, ctypes.c_double]
+        lib.pythum_load.restype         = None
+        lib.pythum_norm2.argtypes       = [STATE, ctypes.c_size_t]
+        lib.pythum_norm2.restype        = ctypes.c_double
+        lib.pythum_sample.argtypes      = [STATE, ctypes.c_uint, ctypes.c_uint64, ctypes.c_size_t, ctypes.c_uint64,
+                                           ctypes.POINTER(ctypes.c_uint64)]
+        lib.pythum_sample.restype       = ctypes.c_int
+        lib.cym_set_num_threads.argtypes = [ctypes.c_uint]
+        lib.cym_set_num_threads.restype  = None
+        return lib
+    return None
+
+NATIVE_ENGINE = load_native_engine()
+
+# a state of n qbits takes 2 ** n amplitudes: 16 bytes each in the native engine, a python complex and its list slot otherwise
+MAX_NUMBER_OF_QBITS = 30 if NATIVE_ENGINE != None else 15
+
+def set_num_threads(count: int):
+    """
+    sets how many threads the native engine uses, 0 goes back to the CYM_NUM_THREADS environment variable or the number of
+    cpus, does nothing without the native engine
+    """
+    if NATIVE_ENGINE != None:
+        NATIVE_ENGINE.cym_set_num_threads(count)
+
+def control_masks(control: list[int], ctrl_value: list[bool] | None = None) -> tuple[int, int]:
+    """
+    Returns:
+        (mask, value) such that index & mask == value exactly when every control qbit of index holds its ctrl_value
+    """
+    mask:  int = 0
+    value: int = 0
+    for i in range(len(control)):
+        mask |= 1 << control[i]
+        if ctrl_value == None or ctrl_value[i]:
+            value |= 1 << control[i]
+    return mask, value
+
+def to_c_doubles(values: list[complex]) -> ctypes.Array:
+    """
+    Returns:
+        values as interleaved (re, im) c doubles, the layout of the native engine
+    """
+    out = (ctypes.c_double * (2 * len(values)))()
+    for i in range(len(values)):
+        v = complex(values[i])
+        out[2 * i]     = v.real
+        out[2 * i + 1] = v.imag
+    return out
+
+class StateVector:
+    """
+    the amplitudes of a circuit held by the native engine, indexable like the list[complex] the python loops use
+    """
+    def __init__(self, number_of_qbits: int):
+        self.number_of_qbits = number_of_qbits
+        self.data = NATIVE_ENGINE.pythum_alloc(number_of_qbits)
+        if not self.data:
+            raise MemoryError(f"could not allocate the state of {number_of_qbits} qbits")
+
+    def __del__(self):
+        if getattr(self, 'data', None) and NATIVE_ENGINE != None:
+            NATIVE_ENGINE.pythum_free(self.data)
+            self.data = None
+
+    def __len__(self) -> int:
+        return 1 << self.number_of_qbits
+
+    def index(self, i: int) -> int:
+        if i < 0:
+            i += len(self)
+        if i < 0 or i >= len(self):
+            raise IndexError("state index out of range")
+        return i
+
+    def __getitem__(self, i: int) -> complex:
+        i = self.index(i)
+        return complex(self.data[2 * i], self.data[2 * i + 1])
+
+    def __setitem__(self, i: int, value: complex):
+        i = self.index(i)
+        value = complex(value)
+        self.data[2 * i]     = value.real
+        self.data[2 * i + 1] = value.imag
+
+    def __iter__(self):
+        for i in range(len(self)):
+            yield complex(self.data[2 * i], self.data[2 * i + 1])
+
+    def copy(self) -> 'StateVector':
+        other = StateVector(self.number_of_qbits)
+        NATIVE_ENGINE.pythum_load(other.data, self.number_of_qbits, self.data, len(self), 1.0)
+        return other
+
+class ShotHistogram:
+    """
+    how many shots of QuantumCircuit.sample ended with each value of the classical bits, indexable like a state so
+    display_state_in_ket(histogram) shows it as (count)|cbits>
+    """
+    def __init__(self, number_of_cbits: int):
+        self.number_of_cbits = number_of_cbits
+        self.counts: dict[int, int] = {}
+
+    def __len__(self) -> int:
+        return 1 << self.number_of_cbits
+
+    def __getitem__(self, cbits: int) -> int:
+        return self.counts.get(cbits, 0)
+
+    def shots(self) -> int:
+        return sum(self.counts.values())
+
 def display_state_in_ket(state: list[complex], error: float = 0, mode: str = 'txt') -> str:
     def binary_str(num: int) -> str:
         o: str = ''
@@ -169,6 +317,77 @@ class QuantumCircuitComponent:
         self.lenght     = len(name) if name != None else len("COMP")
 
 
+def count_sweeps(component: QuantumCircuitComponent) -> int:
+    """
+    Returns:
+        how many passes over the state vector simulate makes for component (a measurement or reset sums the probability
+        then collapses, a trivial gate with several targets is applied once per target)
+    """
+    if type(component.what) == str:
+        return 2 if component.what == 'm' or component.what == 'r' else 1
+    if type(component.what.gate) == str:
+        return len(component.what.targets)
+    return 1
+
+class OptimizationReport:
+    """
+    what QuantumCircuit.optimize did, the simulation times are None unless it was asked to compare
+    """
+    def __init__(self):
+        self.gates_before: int  = 0
+        self.gates_after: int   = 0
+        self.sweeps_before: int = 0
+        self.sweeps_after: int  = 0
+        self.fused: int         = 0   # gates merged into the dense unitary of an earlier one
+        self.cancelled: int     = 0   # gates dropped because their fused unitary was the identity
+        self.optimize_seconds: float = 0
+        self.seconds_before: float | None = None
+        self.seconds_after: float | None  = None
+
+    def sweeps_saved(self) -> int:
+        return self.sweeps_before - self.sweeps_after
+
+    def __str__(self) -> str:
+        string  = f"gates: {self.gates_before} -> {self.gates_after} ({self.fused} fused, {self.cancelled} cancelled)\n"
+        string += f"sweeps: {self.sweeps_before} -> {self.sweeps_after} ({self.sweeps_saved()} saved)\n"
+        string += f"optimization: {self.optimize_seconds:.6f}s"
+        if self.seconds_before != None and self.seconds_after != None:
+            string += f"\nsimulation: {self.seconds_before:.6f}s -> {self.seconds_after:.6f}s"
+        return string
+
+class FusionBlock:
+    """
+    gates QuantumCircuit.optimize merges into one unitary, or a measurement/reset nothing can be merged with
+    """
+    def __init__(self, qbits: list[int], component: QuantumCircuitComponent, gate: Gate | None):
+        self.qbits: list[int] = list(qbits)
+        self.components: list[QuantumCircuitComponent] = [component]
+        self.gates: list[Gate] = [gate] if gate != None else []
+        self.barrier: bool = gate == None
+
+    def matrix(self) -> list[list[complex]]:
+        """
+        Returns:
+            the product of the gates of the block over its qbits, bit i of a row or column index being qbit self.qbits[i]
+        """
+        dim = 1 << len(self.qbits)
+        position = {q: i for i, q in enumerate(self.qbits)}
+        local = QuantumCircuit(len(self.qbits))
+        columns: list[list[complex]] = []
+        for c in range(dim):
+            local.qbits_state = [0j for _ in range(dim)]
+            local.qbits_state[c] = 1
+            for gate in self.gates:
+                local.perform_gate(Gate(
+                    gate.gate,
+                    [position[t] for t in gate.targets],
+                    gate.label,
+                    [position[q] for q in gate.control] if gate.control != None else None,
+                    gate.ctrl_value
+                ))
+            columns.append(local.qbits_state)
+        return [[columns[c][r] for c in range(dim)] for r in range(dim)]
+
 class QuantumCircuit:
     """
         QuantumCircuit Base class (NOT OPTIMIZED)
@@ -286,11 +505,13 @@ class QuantumCircuit:
 
     """
     def __init__(self, number_of_qbits: int):
-        MAX_NUMBER_OF_QBITS = 15
         if number_of_qbits > MAX_NUMBER_OF_QBITS:
             raise MemoryError(f"maximum allowed number of qbits({MAX_NUMBER_OF_QBITS}) exceeded ({number_of_qbits})")
         self.number_of_qbits = number_of_qbits
-        self.qbits_state: list[complex] = [0 for _ in range(2 ** number_of_qbits)]
+        if NATIVE_ENGINE != None:
+            self.qbits_state: list[complex] | StateVector = StateVector(number_of_qbits)
+        else:
+            self.qbits_state: list[complex] | StateVector = [0 for _ in range(2 ** number_of_qbits)]
         self.qbits_state[0] = 1
         self.circuit: list[QuantumCircuitComponent] = []
         self.cbits: int = 0
@@ -441,7 +662,139 @@ class QuantumCircuit:
             string += line + '\n'
         return string
     
+    
+    def fusion_pass(self, circuit: list[QuantumCircuitComponent], max_qbits: int, report: OptimizationReport) -> list[QuantumCircuitComponent]:
+        """
+        one pass of QuantumCircuit.optimize over circuit, counting the gates it fuses and cancels in report
+        Returns:
+            the rewritten circuit
+        """
+        FUSION_WINDOW = 16
+
+        blocks: list[FusionBlock] = []
+        last: dict[int, int] = {}           # qbit -> index of the latest block acting on it
+        for component in circuit:
+            if type(component.what) == str:
+                if component.what == 'm' or component.what == 'r':
+                    operations = [([component.qbit], component, None)]
+                else:
+                    operations = [([component.qbit], component, Gate(component.what, [component.qbit]))]
+            elif type(component.what.gate) == str and len(component.what.targets) > 1:
+                operations = []
+                for target in component.what.targets:
+                    gate  = Gate(component.what.gate, [target], component.what.label, component.what.control, component.what.ctrl_value)
+                    qbits = (gate.control or []) + [target]
+                    operations.append((qbits, QuantumCircuitComponent(gate, min(qbits)), gate))
+            else:
+                operations = [((component.what.control or []) + component.what.targets, component, component.what)]
+
+            for qbits, part, gate in operations:
+                # the gate commutes with every block after the latest one sharing a qbit with it, so it can join any of them
+                earliest = max((last[q] for q in qbits if q in last), default = -1)
+                target_block = None
+                if gate != None:
+                    for b in range(len(blocks) - 1, max(earliest, len(blocks) - FUSION_WINDOW, 0) - 1, -1):
+                        if blocks[b].barrier:
+                            continue
+                        merged = set(blocks[b].qbits) | set(qbits)
+                        if len(merged) <= max_qbits or merged == set(qbits) == set(blocks[b].qbits):
+                            target_block = b
+                            break
+                if target_block == None:
+                    blocks.append(FusionBlock(qbits, part, gate))
+                    target_block = len(blocks) - 1
+                else:
+                    block = blocks[target_block]
+                    block.qbits += [q for q in qbits if q not in block.qbits]
+                    block.components.append(part)
+                    block.gates.append(gate)
+                for q in qbits:
+                    last[q] = target_block
+
+        fused: list[QuantumCircuitComponent] = []
+        for block in blocks:
+            if len(block.components) == 1:
+                fused.append(block.components[0])
+                continue
+            matrix = block.matrix()
+            dim    = len(matrix)
+            if all(abs(matrix[r][c] - (r == c)) <= 1e-12 for r in range(dim) for c in range(dim)):
+                report.cancelled += len(block.components)
+                continue
+            if len(block.qbits) > max_qbits:
+                # gates on the qbits of a larger one only join it to cancel out
+                fused += block.components
+                continue
+            report.fused += len(block.components) - 1
+            fused.append(QuantumCircuitComponent(Gate(matrix, block.qbits, "fused"), qbit = min(block.qbits), name = "fused"))
+        return fused
+
+    def optimize(self, max_qbits: int | None = None, compare: bool = False) -> OptimizationReport:
+        """
+        rewrites the circuit so simulate makes fewer sweeps over the state: each gate is moved back past the gates it
+        commutes with (those on other qbits) and merged into the dense unitary of an earlier one when together they span
+        at most max_qbits qbits, the merged runs that multiply to the identity (X.X, H.H, CX.CX, CCX.CCX, ...) are
+        dropped, measurements and resets keep their order and are never merged
+        passes are repeated while they save sweeps, as cancelling a pair can bring two more together
+        Args:
+            max_qbits:
+                the largest fused unitary, each extra qbit makes it 4 times more work per amplitude, by default 2 with the
+                native engine (whose two qbit kernel costs about one pair sweep) and 1 for the python loops
+            compare:
+                also simulate the circuit before and after from the current state to time both, the state and cbits are
+                then those of the optimized run
+        """
+        if max_qbits == None:
+            max_qbits = 2 if self.native() else 1
+        report = OptimizationReport()
+        start  = time_ns()
+
+        report.gates_before  = len(self.circuit)
+        report.sweeps_before = sum(count_sweeps(component) for component in self.circuit)
+        circuit = self.circuit
+        sweeps  = report.sweeps_before
+        while True:
+            attempt = OptimizationReport()
+            rewritten = self.fusion_pass(circuit, max_qbits, attempt)
+            rewritten_sweeps = sum(count_sweeps(component) for component in rewritten)
+            if rewritten_sweeps >= sweeps:
+                break
+            circuit, sweeps = rewritten, rewritten_sweeps
+            report.fused     += attempt.fused
+            report.cancelled += attempt.cancelled
+        report.gates_after  = len(circuit)
+        report.sweeps_after = sweeps
+        report.optimize_seconds = (time_ns() - start) * 1e-9
+
+        if compare:
+            initial_state = self.qbits_state.copy()
+            cbits = self.cbits
+            start = time_ns()
+            self.simulate(initial_state)
+            report.seconds_before = (time_ns() - start) * 1e-9
+            self.circuit = circuit
+            self.cbits   = cbits
+            start = time_ns()
+            self.simulate(initial_state)
+            report.seconds_after = (time_ns() - start) * 1e-9
+
+        self.circuit = circuit
+        return report
+
+    def native(self) -> bool:
+        """
+        Returns:
+            whether the state is held by the native engine, which then runs the perform_* methods
+        """
+        return type(self.qbits_state) == StateVector
+
+    def perform_native(self, function, target: int, mask: int = 0, value: int = 0, *args):
+        if function(self.qbits_state.data, self.number_of_qbits, target, mask, value, *args) != 0:
+            raise IndexError(f"gate on qbit {target} is out of range or overlaps its controls")
+
     def perform_x(self, qbit: int):
+        if self.native():
+            return self.perform_native(NATIVE_ENGINE.pythum_x, qbit)
         for i in range(len(self.qbits_state)):
             if(0 == ((i >> qbit) & 1)):
                 j = i | (2 ** qbit)
@@ -449,18 +802,24 @@ class QuantumCircuit:
                 self.qbits_state[i] = self.qbits_state[j]
                 self.qbits_state[j] = tmp
     def perform_y(self, qbit: int):
+        if self.native():
+            return self.perform_native(NATIVE_ENGINE.pythum_y, qbit)
         for i in range(len(self.qbits_state)):
             if(0 == ((i >> qbit) & 1)):
                 j = i | (2 ** qbit)
                 tmp: complex = self.qbits_state[i]
                 self.qbits_state[i] = -1j * self.qbits_state[j]
-                self.qbits_state[j] = tmp
+                self.qbits_state[j] = 1j * tmp
     def perform_z(self, qbit: int):
+        if self.native():
+            return self.perform_native(NATIVE_ENGINE.pythum_z, qbit)
         for i in range(len(self.qbits_state)):
             if(0 == ((i >> qbit) & 1)):
                 j = i | (2 ** qbit)
                 self.qbits_state[j] *= -1
     def perform_h(self, qbit: int):
+        if self.native():
+            return self.perform_native(NATIVE_ENGINE.pythum_h, qbit)
         RSQRT2 = 1 / sqrt(2)
         for i in range(len(self.qbits_state)):
             if(0 == ((i >> qbit) & 1)):
@@ -469,12 +828,30 @@ class QuantumCircuit:
                 b: complex = self.qbits_state[j]
                 self.qbits_state[i] = (a + b) * RSQRT2
                 self.qbits_state[j] = (a - b) * RSQRT2
-    def perform_measuremnt(self, qbit: int, cbit: int) -> bool:
-        # compute probabilities
+    def probability_of_zero(self, qbit: int) -> float:
+        if self.native():
+            p0 = NATIVE_ENGINE.pythum_probability(self.qbits_state.data, self.number_of_qbits, qbit)
+            if p0 != p0:
+                raise IndexError(f"qbit {qbit} is out of range")
+            return p0
         p0 = 0.0
         for i in range(len(self.qbits_state)):
             if ((i >> qbit) & 1) == 0:
                 p0 += abs(self.qbits_state[i])**2
+        return p0
+    def collapse(self, qbit: int, outcome: bool, norm: float):
+        if self.native():
+            if NATIVE_ENGINE.pythum_collapse(self.qbits_state.data, self.number_of_qbits, qbit, outcome, 1 / norm) != 0:
+                raise IndexError(f"qbit {qbit} is out of range")
+            return
+        for i in range(len(self.qbits_state)):
+            if ((i >> qbit) & 1) != outcome:
+                self.qbits_state[i] = 0j
+            else:
+                self.qbits_state[i] /= norm
+    def perform_measuremnt(self, qbit: int, cbit: int) -> bool:
+        # compute probabilities
+        p0 = self.probability_of_zero(qbit)
 
         # sample outcome
         random.seed(time_ns())
@@ -483,12 +860,7 @@ class QuantumCircuit:
 
         # collapse + normalize
         norm = sqrt(p0 if outcome == 0 else (1 - p0))
-
-        for i in range(len(self.qbits_state)):
-            if ((i >> qbit) & 1) != outcome:
-                self.qbits_state[i] = 0j
-            else:
-                self.qbits_state[i] /= norm
+        self.collapse(qbit, outcome, norm)
         
         self.cbits &= ~(1 << cbit)
         self.cbits |= outcome << cbit
@@ -500,19 +872,11 @@ class QuantumCircuit:
             the probability of measuring the given state at the moment
         """
         # compute probabilities
-        p0: float = 0.0
-        for i in range(len(self.qbits_state)):
-            if ((i >> qbit) & 1) == 0:
-                p0 += abs(self.qbits_state[i])**2
+        p0: float = self.probability_of_zero(qbit)
 
         # collapse + normalize
         norm = sqrt(p0 if outcome == 0 else (1 - p0))
-
-        for i in range(len(self.qbits_state)):
-            if ((i >> qbit) & 1) != outcome:
-                self.qbits_state[i] = 0j
-            else:
-                self.qbits_state[i] /= norm
+        self.collapse(qbit, outcome, norm)
 
         return p0
 
@@ -527,6 +891,8 @@ class QuantumCircuit:
             case 'h':
                 self.perform_h(qbit)
     def perform_single_qbit_gate(self, qbit: int, g00: complex, g01: complex, g10: complex, g11: complex):
+        if self.native():
+            return self.perform_native(NATIVE_ENGINE.pythum_single_qbit_gate, qbit, 0, 0, to_c_doubles([g00, g01, g10, g11]))
         for i in range(len(self.qbits_state)):
             if(0 == ((i >> qbit) & 1)):
                 j = i | (2 ** qbit)
@@ -537,41 +903,45 @@ class QuantumCircuit:
 
     def test_ctrl(index: int, control: list[int], ctrl_value: list[bool]) -> bool:
         for i in range(len(control)):
-            if ((index >> control[i]) & 1) != ctrl_value[i]:
+            if ((index >> control[i]) & 1) != bool(ctrl_value[i]):
                 return False
         return True
             
     def perform_cx(self, control: list[int], target: int, ctrl_value: list[bool] | None = None):
-        if ctrl_value == None:
-            ctrl_value = [True for _ in range(len(control))]
+        mask, value = control_masks(control, ctrl_value)
+        if self.native():
+            return self.perform_native(NATIVE_ENGINE.pythum_x, target, mask, value)
         for i in range(len(self.qbits_state)):
-            if QuantumCircuit.test_ctrl(i, control, ctrl_value) and (((i >> target) & 1) == 0):
+            if (i & mask) == value and (((i >> target) & 1) == 0):
                 j = i | (1 << target)
                 tmp = self.qbits_state[i]
                 self.qbits_state[i] = self.qbits_state[j]
                 self.qbits_state[j] = tmp
     def perform_cy(self, control: list[int], target: int, ctrl_value: list[bool] | None = None):
-        if ctrl_value == None:
-            ctrl_value = [True for _ in range(len(control))]
+        mask, value = control_masks(control, ctrl_value)
+        if self.native():
+            return self.perform_native(NATIVE_ENGINE.pythum_y, target, mask, value)
         for i in range(len(self.qbits_state)):
-            if QuantumCircuit.test_ctrl(i, control, ctrl_value) and (((i >> target) & 1) == 0):
+            if (i & mask) == value and (((i >> target) & 1) == 0):
                 j = i | (1 << target)
                 tmp = self.qbits_state[i]
                 self.qbits_state[i] = -1j * self.qbits_state[j]
-                self.qbits_state[j] = tmp
+                self.qbits_state[j] = 1j * tmp
     def perform_cz(self, control: list[int], target: int, ctrl_value: list[bool] | None = None):
-        if ctrl_value == None:
-            ctrl_value = [True for _ in range(len(control))]
+        mask, value = control_masks(control, ctrl_value)
+        if self.native():
+            return self.perform_native(NATIVE_ENGINE.pythum_z, target, mask, value)
         for i in range(len(self.qbits_state)):
-            if QuantumCircuit.test_ctrl(i, control, ctrl_value) and (((i >> target) & 1) == 0):
+            if (i & mask) == value and (((i >> target) & 1) == 0):
                 j = i | (1 << target)
                 self.qbits_state[j] *= -1
     def perform_ch(self, control: list[int], target: int, ctrl_value: list[bool] | None = None):
-        if ctrl_value == None:
-            ctrl_value = [True for _ in range(len(control))]
+        mask, value = control_masks(control, ctrl_value)
+        if self.native():
+            return self.perform_native(NATIVE_ENGINE.pythum_h, target, mask, value)
         RSQRT2 = 1 / sqrt(2)
         for i in range(len(self.qbits_state)):
-            if QuantumCircuit.test_ctrl(i, control, ctrl_value) and (((i >> target) & 1) == 0):
+            if (i & mask) == value and (((i >> target) & 1) == 0):
                 j = i | (1 << target)
                 a = self.qbits_state[i]
                 b = self.qbits_state[j]
@@ -588,10 +958,12 @@ class QuantumCircuit:
             case 'h':
                 self.perform_ch(control, qbit, ctrl_value)
     def perform_single_qbit_controled_gate(self, control: list[int], target: int, g00: complex, g01: complex, g10: complex, g11: complex, ctrl_value: list[bool] | None = None):
-        if ctrl_value == None:
-            ctrl_value = [True for _ in range(len(control))]
+        mask, value = control_masks(control, ctrl_value)
+        if self.native():
+            GATE = to_c_doubles([g00, g01, g10, g11])
+            return self.perform_native(NATIVE_ENGINE.pythum_single_qbit_gate, target, mask, value, GATE)
         for i in range(len(self.qbits_state)):
-            if QuantumCircuit.test_ctrl(i, control, ctrl_value) and (((i >> target) & 1) == 0):
+            if (i & mask) == value and (((i >> target) & 1) == 0):
                 j = i | (1 << target)
                 a = self.qbits_state[i]
                 b = self.qbits_state[j]
@@ -599,48 +971,27 @@ class QuantumCircuit:
                 self.qbits_state[j] = g10 * a + g11 * b
     
     def perform_multi_qubit_gate(self, targets: list[int], U: list[list[complex]]):
-        k = len(targets)
-        dim = 1 << k
-
-        for i in range(self.number_of_qbits):
-
-            # process only if all target bits = 0
-            if any((i >> t) & 1 for t in targets):
-                continue
-
-            indices = [0] * dim
-            vec: list[complex] = [0] * dim
-
-            # build indices and extract amplitudes
-            for b in range(dim):
-                idx = i
-                for t_i, t in enumerate(targets):
-                    if (b >> t_i) & 1:
-                        idx |= (1 << t)
-                    else:
-                        idx &= ~(1 << t)
-                indices[b] = idx
-                vec[b] = self.qbits_state[idx]
-
-            # apply matrix
-            out: list[complex] = [0] * dim
-            for r in range(dim):
-                s: complex = 0
-                for c in range(dim):
-                    s += U[r][c] * vec[c]
-                out[r] = s
-
-            # write back
-            for r in range(dim):
-                self.qbits_state[indices[r]] = out[r]
+        self.perform_multi_qubit_controled_gate([], [], targets, U)
     def perform_multi_qubit_controled_gate(self, controls: list[int], ctrl_value: list[bool], targets: list[int], U: list[list[complex]]):
         k = len(targets)
         dim = 1 << k
+        mask, value = control_masks(controls, ctrl_value)
+
+        if self.native():
+            status = NATIVE_ENGINE.pythum_multi_qbit_gate(
+                self.qbits_state.data, self.number_of_qbits, (ctypes.c_uint * k)(*targets), k, mask, value,
+                to_c_doubles([U[r][c] for r in range(dim) for c in range(dim)])
+            )
+            if status < 0:
+                raise IndexError(f"gate on qbits {targets} is out of range or overlaps its controls")
+            if status > 0:
+                raise MemoryError(f"could not allocate the scratch of a {k} qbit gate")
+            return
 
-        for i in range(self.number_of_qbits):
+        for i in range(len(self.qbits_state)):
 
             # process only if all target bits = 0 and all controls test True
-            if any((i >> t) & 1 for t in targets) or not QuantumCircuit.test_ctrl(i, controls, ctrl_value):
+            if any((i >> t) & 1 for t in targets) or (i & mask) != value:
                 continue
 
             indices = [0] * dim
@@ -681,33 +1032,144 @@ class QuantumCircuit:
             for target in gate.targets:
                 self.perform_controled_trivial(gate.control, gate.gate, target, gate.ctrl_value)
         elif len(gate.targets) == 1:
-            if type(gate.gate) == str:
-                self.perform_controled_trivial(gate.control, gate.gate, target, gate.ctrl_value)
-            else:
-                self.perform_single_qbit_controled_gate(gate.control, gate.targets[0], gate.gate[0][0], gate.gate[0][1], gate.gate[1][0], gate.gate[1][1])
+            self.perform_single_qbit_controled_gate(gate.control, gate.targets[0], gate.gate[0][0], gate.gate[0][1], gate.gate[1][0], gate.gate[1][1], gate.ctrl_value)
         else:
-            self.perform_multi_qubit_controled_gate(gate.control, gate.control, gate.targets, gate.gate)
+            self.perform_multi_qubit_controled_gate(gate.control, gate.ctrl_value, gate.targets, gate.gate)
 
-    def simulate(self, initial_state: list[complex] | None = None):
-        if initial_state != None:
-            mod = 0
-            for i in initial_state:
-                mod += abs(i)
+    def load_initial_state(self, initial_state: list[complex] | StateVector) -> bool:
+        """
+        sets the state to initial_state normalized, padded with zeros up to the number of qbits
+        Returns:
+            False (leaving the state untouched) if initial_state is all zeros
+        """
+        if self.native():
+            source = initial_state.data if type(initial_state) == StateVector else to_c_doubles(initial_state)
+            mod = sqrt(NATIVE_ENGINE.pythum_norm2(source, len(initial_state)))
             if mod == 0:
-                return
-            self.qbits_state = initial_state.copy()
-            for i in range(len(initial_state)):
-                self.qbits_state[i] /= mod
-            for _ in range(len(initial_state), 2 ** self.number_of_qbits):
-                self.qbits_state.append(0)
+                return False
+            NATIVE_ENGINE.pythum_load(self.qbits_state.data, self.number_of_qbits, source, len(initial_state), 1 / mod)
+            return True
+        mod = 0
+        for i in initial_state:
+            mod += abs(i)**2
+        mod = sqrt(mod)
+        if mod == 0:
+            return False
+        self.qbits_state = list(initial_state)
+        for i in range(len(initial_state)):
+            self.qbits_state[i] /= mod
+        for _ in range(len(initial_state), 2 ** self.number_of_qbits):
+            self.qbits_state.append(0)
+        return True
+
+    def perform_component(self, component: QuantumCircuitComponent):
+        if type(component.what) == str:
+            if component.what == 'm':
+                self.perform_measuremnt(component.qbit, component.cbit)
+            elif component.what == 'r':
+                self.perform_reset(component.qbit, component.cbit if component.cbit != None else 0)
+            else:
+                self.perform_trivial(component.what, component.qbit)
+        else:
+            self.perform_gate(component.what)
+
+    def simulate(self, initial_state: list[complex] | StateVector | None = None):
+        if initial_state != None and not self.load_initial_state(initial_state):
+            return
+        for component in self.circuit:
+            self.perform_component(component)
+
+    def measurements_are_terminal(self) -> bool:
+        """
+        Returns:
+            whether no gate or reset acts on a qbit after it is measured, so measuring can wait until the end of the circuit
+        """
+        measured: set[int] = set()
         for component in self.circuit:
             if type(component.what) == str:
                 if component.what == 'm':
-                    self.perform_measuremnt(component.qbit, component.cbit)
-                elif component.what == 'r':
-                    self.perform_reset(component.qbit, component.cbit if component.cbit != None else 0)
-                else:
-                    self.perform_trivial(component.what, component.qbit)
+                    measured.add(component.qbit)
+                    continue
+                qbits = [component.qbit]
             else:
-                self.perform_gate(component.what)
+                qbits = (component.what.control or []) + component.what.targets
+            if any(q in measured for q in qbits):
+                return False
+        return True
 
+    def sample(self, shots: int, initial_state: list[complex] | StateVector | None = None, seed: int | None = None) -> ShotHistogram:
+        """
+        runs the circuit shots times and counts the values the classical bits end with, the bits no measurement writes
+        keep their value in self.cbits
+        when the measurements are terminal the circuit is simulated once without them, leaving the state before the
+        measurements, and the shots are drawn from its probabilities: by the native engine from an alias table with a
+        counter based generator, or from a cumulative table by random.choices, otherwise every shot is a full simulate
+        from the same initial state (the current one when initial_state is None)
+        Args:
+            seed:
+                makes the shots drawn from the probabilities reproducible, by default the time is used like
+                perform_measuremnt does (which also keeps seeding itself with it in the shot by shot case)
+        Returns:
+            the histogram of the classical bits, display_state_in_ket(histogram) shows it as (count)|cbits>
+        """
+        measurements: list[tuple[int, int]] = [(c.qbit, c.cbit) for c in self.circuit if type(c.what) == str and c.what == 'm']
+        number_of_cbits = max([cbit + 1 for _, cbit in measurements] + [self.cbits.bit_length(), 1])
+        histogram = ShotHistogram(number_of_cbits)
+        if seed == None:
+            seed = time_ns()
+
+        if not self.measurements_are_terminal():
+            start = self.qbits_state.copy() if initial_state == None else initial_state
+            for _ in range(shots):
+                self.simulate(start)
+                histogram.counts[self.cbits] = histogram.counts.get(self.cbits, 0) + 1
+            return histogram
+
+        if initial_state != None and not self.load_initial_state(initial_state):
+            return histogram
+        for component in self.circuit:
+            if not (type(component.what) == str and component.what == 'm'):
+                self.perform_component(component)
+
+        # outcome bit i is the i-th lowest measured qbit
+        measured = sorted(set(qbit for qbit, _ in measurements))
+        if self.native():
+            mask = sum(1 << q for q in measured)
+            outcomes = (ctypes.c_uint64 * shots)()
+            status = NATIVE_ENGINE.pythum_sample(self.qbits_state.data, self.number_of_qbits, mask, shots, seed & (2**64 - 1), outcomes)
+            if status < 0:
+                raise ValueError("cannot sample: the state is 0 or too many qbits are measured")
+            if status > 0:
+                raise MemoryError(f"could not allocate the sampling tables of {len(measured)} qbits")
+            drawn = Counter(outcomes)
+        else:
+            probabilities = [0.0 for _ in range(1 << len(measured))]
+            for i in range(len(self.qbits_state)):
+                outcome = 0
+                for b in range(len(measured)):
+                    outcome |= ((i >> measured[b]) & 1) << b
+                probabilities[outcome] += abs(self.qbits_state[i])**2
+            cumulative: list[float] = []
+            total = 0.0
+            for p in probabilities:
+                total += p
+                cumulative.append(total)
+            drawn = Counter(random.Random(seed).choices(range(len(probabilities)), cum_weights = cumulative, k = shots))
+
+        # each cbit ends with the qbit its last measurement read, so outcomes map to cbits through one table per byte
+        source: dict[int, int] = {}
+        for qbit, cbit in measurements:
+            source[cbit] = measured.index(qbit)
+        base = self.cbits
+        for cbit in source:
+            base &= ~(1 << cbit)
+        tables: list[list[int]] = []
+        for byte in range((len(measured) + 7) // 8):
+            bits = [sum(1 << cbit for cbit in source if source[cbit] == 8 * byte + b) for b in range(8)]
+            tables.append([sum(bits[b] for b in range(8) if (v >> b) & 1) for v in range(256)])
+        for outcome, count in drawn.items():
+            cbits = base
+            for byte in range(len(tables)):
+                cbits |= tables[byte][(outcome >> (8 * byte)) & 255]
+            histogram.counts[cbits] = histogram.counts.get(cbits, 0) + count
+        return histogram
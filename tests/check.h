@@ -0,0 +1,16 @@
+#ifndef CYM_TESTS_CHECK_H
+#define CYM_TESTS_CHECK_H
+
+// the harness of the tests: check prints one line per check and counts the failures, main then prints their count and
+// returns non zero if there was any
+
+#include <stdio.h>
+
+static int failures = 0;
+
+static void check(const char* name, int passed){
+    printf("%-56s %s\n", name, passed? "ok" : "FAILED");
+    if(!passed) failures += 1;
+}
+
+#endif
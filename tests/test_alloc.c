@@ -0,0 +1,305 @@
+#define CYMATH_IMPLEMENTATION
+#include "../cymath.h"
+
+#include <math.h>
+#include <string.h>
+#include "check.h"
+
+// checks that the _ws functions of cymath.h do not touch the heap once the thread pool is up, by replacing malloc and
+// its relatives with counting versions of glibc's (this test needs glibc)
+// cc -O2 test_alloc.c -o test_alloc -lm -lpthread
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void* __libc_memalign(size_t alignment, size_t size);
+extern void  __libc_free(void* ptr);
+
+static int counting = 0;
+static size_t allocations = 0;
+
+static void count_allocation(void){
+    if(__atomic_load_n(&counting, __ATOMIC_RELAXED)) __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+}
+
+void* malloc(size_t size){
+    count_allocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size){
+    count_allocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size){
+    count_allocation();
+    return __libc_realloc(ptr, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size){
+    count_allocation();
+    return __libc_memalign(alignment, size);
+}
+
+void* memalign(size_t alignment, size_t size){
+    count_allocation();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size){
+    count_allocation();
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr? 0 : 12;
+}
+
+void free(void* ptr){
+    __libc_free(ptr);
+}
+
+// \returns the biggest difference between a and b relative to the biggest absolute value of b
+static double difference(const double* a, const double* b, size_t n){
+    double biggest = 0, scale = 0;
+    for(size_t i = 0; i < n; i+=1){
+        const double d = fabs(a[i] - b[i]);
+        if(!(d <= biggest)) biggest = d;
+        if(fabs(b[i]) > scale) scale = fabs(b[i]);
+    }
+    return biggest / scale;
+}
+
+static double uniform(void){
+    return (double)rand() / RAND_MAX - 0.5;
+}
+
+static void sum_body(size_t begin, size_t end, void* partial, void* user){
+    const double* x = (const double*)user;
+    double sum = 0;
+    for(size_t i = begin; i < end; i+=1) sum += x[i];
+    *(double*)partial = sum;
+}
+
+static void sum_combine(void* result, const void* partial, void* user){
+    (void)user;
+    *(double*)result += *(const double*)partial;
+}
+
+#define SOLVE_SIZE  300
+#define GEMM_SIZE   256
+#define UNITARY     150
+#define INTERPOL    12
+#define FIT_POINTS  200000
+#define FIT_ORDER   8
+#define WIDE_ORDER  40
+// past CYM_LU_BLOCK, so the Cholesky and the triangular solves go through the gemm
+#define LSQ_COLUMNS 160
+// past 64, so the forward differences take their copies of the parameters from the workspace
+#define LM_PARAMS   80
+#define GRID        32
+
+static const double* lm_matrix;
+static const double* lm_target;
+
+// a * params + params^2 / 20 - target over the first SOLVE_SIZE lines and LM_PARAMS columns of a
+static int lm_residuals(const double* params, double* residuals, void* user){
+    (void)user;
+    for(size_t i = 0; i < SOLVE_SIZE; i+=1){
+        double r = 0.05 * params[i % LM_PARAMS] * params[i % LM_PARAMS] - lm_target[i];
+        for(size_t j = 0; j < LM_PARAMS; j+=1) r += lm_matrix[i * SOLVE_SIZE + j] * params[j];
+        residuals[i] = r;
+    }
+    return 0;
+}
+
+int main(void){
+
+    double* a      = (double*)malloc(SOLVE_SIZE * SOLVE_SIZE * sizeof(double));
+    double* lu     = (double*)malloc(SOLVE_SIZE * SOLVE_SIZE * sizeof(double));
+    double* y      = (double*)malloc(SOLVE_SIZE * sizeof(double));
+    double* x      = (double*)malloc(SOLVE_SIZE * sizeof(double));
+    double* x_ref  = (double*)malloc(SOLVE_SIZE * sizeof(double));
+    double* ga     = (double*)malloc(GEMM_SIZE * GEMM_SIZE * sizeof(double));
+    double* gb     = (double*)malloc(GEMM_SIZE * GEMM_SIZE * sizeof(double));
+    double* gc     = (double*)malloc(GEMM_SIZE * GEMM_SIZE * sizeof(double));
+    double* gc_ref = (double*)malloc(GEMM_SIZE * GEMM_SIZE * sizeof(double));
+    double* u      = (double*)malloc(UNITARY * UNITARY * sizeof(double));
+    double* fx     = (double*)malloc(FIT_POINTS * sizeof(double));
+    double* fy     = (double*)malloc(FIT_POINTS * sizeof(double));
+
+    for(size_t i = 0; i < SOLVE_SIZE * SOLVE_SIZE; i+=1) a[i] = uniform();
+    for(size_t i = 0; i < SOLVE_SIZE; i+=1) y[i] = uniform();
+    for(size_t i = 0; i < GEMM_SIZE * GEMM_SIZE; i+=1){
+        ga[i] = uniform();
+        gb[i] = uniform();
+    }
+    for(size_t i = 0; i < UNITARY; i+=1) u[i] = uniform();
+    cym_make_unitary_d(u, UNITARY, u);
+    for(size_t i = 0; i < FIT_POINTS; i+=1){
+        fx[i] = 4.0 * i / FIT_POINTS - 1.0;
+        fy[i] = 1 + fx[i] * (0.5 - fx[i] * (0.25 + fx[i])) + 1e-3 * uniform();
+    }
+    double ix[INTERPOL], iy[INTERPOL], coefficients[INTERPOL], coefficients_ref[INTERPOL];
+    for(int i = 0; i < INTERPOL; i+=1){
+        ix[i] = -1 + 2.0 * i / (INTERPOL - 1);
+        iy[i] = 1 / (1 + 4 * ix[i] * ix[i]);
+    }
+    double fit[WIDE_ORDER + 1], fit_ref[WIDE_ORDER + 1];
+    lm_matrix = a;
+    lm_target = y;
+
+    // the 5 point laplacian of a GRID x GRID grid, in both formats
+    static unsigned int ri[5 * GRID * GRID], ci[5 * GRID * GRID];
+    static double lv[5 * GRID * GRID], sb[GRID * GRID], sx[GRID * GRID], sx_ref[GRID * GRID];
+    size_t count = 0;
+    for(unsigned int i = 0; i < GRID * GRID; i+=1){
+        ri[count] = i; ci[count] = i; lv[count] = 4; count+=1;
+        if(i >= GRID)              { ri[count] = i; ci[count] = i - GRID; lv[count] = -1; count+=1; }
+        if(i + GRID < GRID * GRID) { ri[count] = i; ci[count] = i + GRID; lv[count] = -1; count+=1; }
+        if(i % GRID > 0)           { ri[count] = i; ci[count] = i - 1;    lv[count] = -1; count+=1; }
+        if(i % GRID + 1 < GRID)    { ri[count] = i; ci[count] = i + 1;    lv[count] = -1; count+=1; }
+        sb[i] = uniform();
+    }
+    CymSparse_d laplacian, laplacian_csc;
+    cym_sparse_from_coo_d(GRID * GRID, GRID * GRID, ri, ci, lv, count, CYM_SPARSE_CSR, &laplacian);
+    cym_sparse_convert_d(&laplacian, CYM_SPARSE_CSC, &laplacian_csc);
+
+    const unsigned int thread_counts[] = { 1, 4 };
+    for(size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t+=1){
+        cym_set_num_threads(thread_counts[t]);
+        printf("\n%u threads\n", thread_counts[t]);
+
+        size_t sizes[] = {
+            cym_solve_gauss_workspace_size_d(SOLVE_SIZE),
+            cym_gemm_workspace_size_d(GEMM_SIZE, GEMM_SIZE, GEMM_SIZE),
+            cym_test_unitary_workspace_size_d(UNITARY),
+            cym_interpol_workspace_size_d(INTERPOL),
+            cym_poly_fit_workspace_size_d(FIT_POINTS, FIT_ORDER),
+            cym_poly_fit_workspace_size_d(FIT_POINTS, WIDE_ORDER),
+            cym_qr_factor_workspace_size_d(SOLVE_SIZE, 64),
+            cym_parallel_reduce_workspace_size(0, FIT_POINTS, 1000, sizeof(double)),
+            cym_lstsq_workspace_size_d(SOLVE_SIZE, LSQ_COLUMNS, 1, CYM_LSQ_CHOLESKY | CYM_LSQ_SCALE),
+            cym_lstsq_workspace_size_d(SOLVE_SIZE, LSQ_COLUMNS, 1, CYM_LSQ_QR),
+            cym_lm_solve_workspace_size_d(LM_PARAMS, SOLVE_SIZE),
+            cym_sparse_cg_workspace_size_d(&laplacian_csc, CYM_PRECOND_ILU0),
+            cym_sparse_bicgstab_workspace_size_d(&laplacian, CYM_PRECOND_JACOBI)
+        };
+        size_t size = 0;
+        for(size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i+=1) if(sizes[i] > size) size = sizes[i];
+        void* workspace = malloc(size);
+
+        // the references, which also start the thread pool
+        memcpy(lu, a, SOLVE_SIZE * SOLVE_SIZE * sizeof(double));
+        cym_solve_gauss_d(lu, y, SOLVE_SIZE, x_ref);
+        cym_gemm_d(GEMM_SIZE, GEMM_SIZE, GEMM_SIZE, 1, ga, GEMM_SIZE, 1, gb, GEMM_SIZE, 1, 0, gc_ref, GEMM_SIZE, 1);
+        cym_interpol_d(ix, iy, INTERPOL, coefficients_ref);
+        cym_poly_fit_d(fx, fy, FIT_POINTS, FIT_ORDER, fit_ref);
+        double sum_ref = 0;
+        cym_parallel_reduce(0, FIT_POINTS, 1000, &sum_ref, sizeof(double), sum_body, sum_combine, fx);
+        double lsq_ref[2][LSQ_COLUMNS], lm_ref[LM_PARAMS], lsq[LSQ_COLUMNS], lm[LM_PARAMS];
+        const int lsq_flags[2] = { CYM_LSQ_CHOLESKY | CYM_LSQ_SCALE, CYM_LSQ_QR };
+        for(int f = 0; f < 2; f+=1){
+            memcpy(lu, a, SOLVE_SIZE * LSQ_COLUMNS * sizeof(double));
+            memcpy(x, y, SOLVE_SIZE * sizeof(double));
+            cym_lstsq_d(lu, SOLVE_SIZE, LSQ_COLUMNS, x, 1, lsq_ref[f], lsq_flags[f]);
+        }
+        memset(lm_ref, 0, sizeof(lm_ref));
+        const int lm_status = cym_lm_solve_d(lm_residuals, NULL, NULL, lm_ref, LM_PARAMS, SOLVE_SIZE, NULL, NULL);
+        memset(sx_ref, 0, sizeof(sx_ref));
+        cym_sparse_cg_d(&laplacian_csc, sb, sx_ref, 1e-12, 0, CYM_PRECOND_ILU0, NULL);
+
+        __atomic_store_n(&allocations, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&counting, 1, __ATOMIC_RELAXED);
+        double solve_error = 0, gemm_error = 0, interpol_error = 0, fit_error = 0, sum = 0, lsq_error = 0, lm_error = 0;
+        double cg_error = 0, bicgstab_residual = 0;
+        int unitary = 1, wide = 0, qr = 0, reduce = 0, lsq_status = 0, lm_ws_status = 0, iter_status = 0;
+        for(int repeat = 0; repeat < 3; repeat+=1){
+            memcpy(lu, a, SOLVE_SIZE * SOLVE_SIZE * sizeof(double));
+            cym_solve_gauss_ws_d(lu, y, SOLVE_SIZE, x, workspace, size);
+            solve_error += difference(x, x_ref, SOLVE_SIZE);
+
+            cym_gemm_ws_d(GEMM_SIZE, GEMM_SIZE, GEMM_SIZE, 1, ga, GEMM_SIZE, 1, gb, GEMM_SIZE, 1, 0, gc, GEMM_SIZE, 1,
+                          workspace, size);
+            gemm_error += difference(gc, gc_ref, GEMM_SIZE * GEMM_SIZE);
+
+            unitary &= cym_test_unitary_deviation_ws_d(u, UNITARY, 1e-12, NULL, workspace, size) == 1;
+
+            cym_interpol_ws_d(ix, iy, INTERPOL, coefficients, workspace, size);
+            interpol_error += difference(coefficients, coefficients_ref, INTERPOL);
+
+            cym_poly_fit_ws_d(fx, fy, FIT_POINTS, FIT_ORDER, fit, workspace, size);
+            fit_error += difference(fit, fit_ref, FIT_ORDER + 1);
+            wide |= cym_poly_fit_ws_d(fx, fy, FIT_POINTS, WIDE_ORDER, fit, workspace, size);
+
+            // the first 64 columns of a, which then holds their qr
+            memcpy(lu, a, SOLVE_SIZE * 64 * sizeof(double));
+            qr |= cym_qr_factor_ws_d(lu, SOLVE_SIZE, 64, x, workspace, size);
+
+            sum = 0;
+            reduce |= cym_parallel_reduce_ws(0, FIT_POINTS, 1000, &sum, sizeof(double), sum_body, sum_combine, fx, workspace, size);
+
+            for(int f = 0; f < 2; f+=1){
+                memcpy(lu, a, SOLVE_SIZE * LSQ_COLUMNS * sizeof(double));
+                memcpy(x, y, SOLVE_SIZE * sizeof(double));
+                lsq_status |= cym_lstsq_ws_d(lu, SOLVE_SIZE, LSQ_COLUMNS, x, 1, lsq, lsq_flags[f], workspace, size);
+                lsq_error += difference(lsq, lsq_ref[f], LSQ_COLUMNS);
+            }
+
+            memset(lm, 0, sizeof(lm));
+            lm_ws_status |= cym_lm_solve_ws_d(lm_residuals, NULL, NULL, lm, LM_PARAMS, SOLVE_SIZE, NULL, NULL, workspace, size) !=
+                lm_status;
+            lm_error += difference(lm, lm_ref, LM_PARAMS);
+
+            CymIterStats stats;
+            memset(sx, 0, sizeof(sx));
+            iter_status |= cym_sparse_cg_ws_d(&laplacian_csc, sb, sx, 1e-12, 0, CYM_PRECOND_ILU0, NULL, workspace, size);
+            cg_error += difference(sx, sx_ref, GRID * GRID);
+            memset(sx, 0, sizeof(sx));
+            iter_status |= cym_sparse_bicgstab_ws_d(&laplacian, sb, sx, 1e-12, 0, CYM_PRECOND_JACOBI, &stats, workspace, size);
+            bicgstab_residual += stats.residual;
+        }
+        __atomic_store_n(&counting, 0, __ATOMIC_RELAXED);
+
+        check("cym_solve_gauss_ws matches cym_solve_gauss", solve_error < 1e-12);
+        check("cym_gemm_ws matches cym_gemm", gemm_error < 1e-12);
+        check("cym_test_unitary_deviation_ws finds the unitary", unitary);
+        check("cym_interpol_ws matches cym_interpol", interpol_error < 1e-12);
+        check("cym_poly_fit_ws matches cym_poly_fit", fit_error < 1e-12);
+        check("cym_poly_fit_ws fits order 40 (blocked qr)", !wide);
+        check("cym_qr_factor_ws succeeds", !qr);
+        check("cym_parallel_reduce_ws matches cym_parallel_reduce", !reduce && sum == sum_ref);
+        check("cym_lstsq_ws matches cym_lstsq", !lsq_status && lsq_error < 1e-12);
+        check("cym_lm_solve_ws matches cym_lm_solve", lm_status <= CYM_LM_TARGET_COST && !lm_ws_status && lm_error < 1e-12);
+        check("cym_sparse_cg_ws matches cym_sparse_cg (csc, ilu0)", !iter_status && cg_error < 1e-12);
+        check("cym_sparse_bicgstab_ws converges (jacobi)", !iter_status && bicgstab_residual <= 3e-12);
+        printf("%zu allocations in the steady state\n", allocations);
+        check("no allocation in the steady state", allocations == 0);
+
+        // workspaces too small for the threads or the packing only cost speed, too small for the rest is an error
+        cym_gemm_ws_d(GEMM_SIZE, GEMM_SIZE, GEMM_SIZE, 1, ga, GEMM_SIZE, 1, gb, GEMM_SIZE, 1, 0, gc, GEMM_SIZE, 1, NULL, 0);
+        check("cym_gemm_ws without a workspace", difference(gc, gc_ref, GEMM_SIZE * GEMM_SIZE) < 1e-12);
+        const size_t serial_fit = cym_poly_fit_workspace_size_d(FIT_POINTS, FIT_ORDER) / thread_counts[t];
+        const int serial_status = cym_poly_fit_ws_d(fx, fy, FIT_POINTS, FIT_ORDER, fit, workspace, serial_fit);
+        check("cym_poly_fit_ws with a smaller workspace", !serial_status && difference(fit, fit_ref, FIT_ORDER + 1) < 1e-12);
+        check("cym_poly_fit_ws without a workspace fails", cym_poly_fit_ws_d(fx, fy, FIT_POINTS, FIT_ORDER, fit, NULL, 0) == 1);
+        cym_solve_gauss_ws_d(lu, y, SOLVE_SIZE, x, NULL, 0);
+        check("cym_solve_gauss_ws without a workspace gives NaN", x[0] != x[0]);
+        memcpy(lu, a, SOLVE_SIZE * LSQ_COLUMNS * sizeof(double));
+        check("cym_lstsq_ws without a workspace fails",
+            cym_lstsq_ws_d(lu, SOLVE_SIZE, LSQ_COLUMNS, x, 1, lsq, CYM_LSQ_QR, NULL, 0) == 1);
+        check("cym_lm_solve_ws without a workspace fails",
+            cym_lm_solve_ws_d(lm_residuals, NULL, NULL, lm, LM_PARAMS, SOLVE_SIZE, NULL, NULL, NULL, 0) == CYM_LM_FAILED);
+        check("cym_sparse_cg_ws without a workspace fails",
+            cym_sparse_cg_ws_d(&laplacian, sb, sx, 1e-12, 0, CYM_PRECOND_NONE, NULL, NULL, 0) == CYM_ITER_FAILED);
+
+        free(workspace);
+    }
+
+    free(a); free(lu); free(y); free(x); free(x_ref);
+    free(ga); free(gb); free(gc); free(gc_ref);
+    free(u); free(fx); free(fy);
+    cym_sparse_free_d(&laplacian);
+    cym_sparse_free_d(&laplacian_csc);
+
+    printf("\n%d failures\n", failures);
+    return failures != 0;
+}
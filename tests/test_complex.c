@@ -0,0 +1,109 @@
+#define CYMATH_IMPLEMENTATION
+#include "../cymath.h"
+
+#include <math.h>
+#include <string.h>
+#include "check.h"
+
+// checks cym_cgemm for every conjugate flag and the complex transposes, in place or not, against naive loops
+// cc -O2 test_complex.c -o test_complex -lm -lpthread
+
+static double uniform(void){
+    return (double)rand() / RAND_MAX - 0.5;
+}
+
+// \returns the biggest difference between a and b relative to the biggest absolute value of b
+static double difference(const CymComplex_d* a, const CymComplex_d* b, size_t n){
+    double biggest = 0, scale = 0;
+    for(size_t i = 0; i < n; i+=1){
+        const double d = fabs(a[i].re - b[i].re) + fabs(a[i].im - b[i].im);
+        if(!(d <= biggest)) biggest = d;
+        if(fabs(b[i].re) + fabs(b[i].im) > scale) scale = fabs(b[i].re) + fabs(b[i].im);
+    }
+    return biggest / scale;
+}
+
+// c = alpha * op(a) * op(b) + beta * c for row major a (m x k), b (k x n) and c (m x n)
+static void naive_cgemm(size_t m, size_t n, size_t k, CymComplex_d alpha, const CymComplex_d* a, const CymComplex_d* b,
+    CymComplex_d beta, CymComplex_d* c, int conjugate){
+
+    const double sa = (conjugate & CYM_CONJ_A)? -1 : 1, sb = (conjugate & CYM_CONJ_B)? -1 : 1;
+    for(size_t i = 0; i < m; i+=1){
+        for(size_t j = 0; j < n; j+=1){
+            double re = 0, im = 0;
+            for(size_t p = 0; p < k; p+=1){
+                const CymComplex_d x = a[i * k + p], y = b[p * n + j];
+                re += x.re * y.re - sa * x.im * sb * y.im;
+                im += x.re * sb * y.im + sa * x.im * y.re;
+            }
+            const CymComplex_d old = c[i * n + j];
+            c[i * n + j].re = alpha.re * re - alpha.im * im + beta.re * old.re - beta.im * old.im;
+            c[i * n + j].im = alpha.re * im + alpha.im * re + beta.re * old.im + beta.im * old.re;
+        }
+    }
+}
+
+#define M 37
+#define N 53
+#define K 71
+
+int main(void){
+    static CymComplex_d a[M * K], b[K * N], c[M * N], c_ref[M * N], c0[M * N];
+    for(size_t i = 0; i < M * K; i+=1) a[i] = (CymComplex_d){ uniform(), uniform() };
+    for(size_t i = 0; i < K * N; i+=1) b[i] = (CymComplex_d){ uniform(), uniform() };
+    for(size_t i = 0; i < M * N; i+=1) c0[i] = (CymComplex_d){ uniform(), uniform() };
+    const CymComplex_d alpha = { 0.75, -1.25 }, beta = { -0.5, 0.25 }, zero = { 0, 0 };
+
+    const char* names[] = {
+        "cym_cgemm a * b", "cym_cgemm conj(a) * b", "cym_cgemm a * conj(b)", "cym_cgemm conj(a) * conj(b)"
+    };
+    for(int conjugate = 0; conjugate < 4; conjugate+=1){
+        memcpy(c, c0, sizeof(c));
+        memcpy(c_ref, c0, sizeof(c));
+        cym_cgemm_d(M, N, K, alpha, a, K, 1, b, N, 1, beta, c, N, 1, conjugate);
+        naive_cgemm(M, N, K, alpha, a, b, beta, c_ref, conjugate);
+        check(names[conjugate], difference(c, c_ref, M * N) < 1e-13);
+    }
+
+    // alpha * a^H * a, a^H being a view of a through swapped strides, beta 0 only writing c (filled with NaN first)
+    static CymComplex_d h[K * M], ah[K * K], ah_ref[K * K];
+    cym_cmat_conj_transpose_d(a, K, M, h);
+    for(size_t i = 0; i < K * K; i+=1) ah[i] = (CymComplex_d){ 0.0 / 0.0, 0.0 / 0.0 };
+    memset(ah_ref, 0, sizeof(ah_ref));
+    cym_cgemm_d(K, K, M, alpha, a, 1, K, a, K, 1, zero, ah, K, 1, CYM_CONJ_A);
+    naive_cgemm(K, K, M, alpha, h, a, zero, ah_ref, 0);
+    check("cym_cgemm conjugate transpose through strides", difference(ah, ah_ref, K * K) < 1e-13);
+
+    // the transposes, out of place against a loop then in place against out of place, square and not
+    static CymComplex_d t[M * K], t_ref[M * K], s[K * K], s_ref[K * K];
+    int transposed = 1;
+    for(size_t i = 0; i < M; i+=1){
+        for(size_t j = 0; j < K; j+=1){
+            transposed &= h[j * M + i].re == a[i * K + j].re && h[j * M + i].im == -a[i * K + j].im;
+        }
+    }
+    check("cym_cmat_conj_transpose", transposed);
+
+    const size_t shapes[][2] = { { K, M }, { M, K }, { 1, K }, { K, 1 }, { K, K } };
+    for(int conjugate = 0; conjugate < 2; conjugate+=1){
+        int same = 1;
+        for(size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i+=1){
+            const unsigned int sizex = (unsigned int)shapes[i][0], sizey = (unsigned int)shapes[i][1];
+            CymComplex_d* in  = (sizex == sizey)? s : t;
+            CymComplex_d* ref = (sizex == sizey)? s_ref : t_ref;
+            memcpy(in, (sizex == sizey)? ah_ref : a, (size_t)sizex * sizey * sizeof(CymComplex_d));
+            if(conjugate){
+                cym_cmat_conj_transpose_d(in, sizex, sizey, ref);
+                cym_cmat_conj_transpose_d(in, sizex, sizey, in);
+            } else{
+                cym_cmat_transpose_d(in, sizex, sizey, ref);
+                cym_cmat_transpose_d(in, sizex, sizey, in);
+            }
+            same &= !memcmp(in, ref, (size_t)sizex * sizey * sizeof(CymComplex_d));
+        }
+        check(conjugate? "cym_cmat_conj_transpose in place" : "cym_cmat_transpose in place", same);
+    }
+
+    printf("\n%d failures\n", failures);
+    return failures != 0;
+}
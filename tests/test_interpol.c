@@ -0,0 +1,97 @@
+#define CYMATH_IMPLEMENTATION
+#include "../cymath.h"
+
+#include <math.h>
+#include <string.h>
+#include "check.h"
+
+// checks the Newton form (on Leja ordered nodes), the barycentric form and cym_interpol on Chebyshev nodes against the
+// interpolated functions
+// cc -O2 test_interpol.c -o test_interpol -lm -lpthread
+
+#define POINTS 2001
+#define MAX_N  256
+
+int main(void){
+    static double t[POINTS], newton[POINTS], barycentric[POINTS];
+    for(size_t i = 0; i < POINTS; i+=1) t[i] = -1 + 2.0 * i / (POINTS - 1);
+
+    // exp is interpolated to rounding from about 16 Chebyshev nodes on, so any error past that is the form's
+    const size_t sizes[] = { 16, 64, 256 };
+    char name[64];
+    for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s+=1){
+        const size_t n = sizes[s];
+        double x[MAX_N], y[MAX_N], nodes[MAX_N], coefficients[MAX_N], weights[MAX_N];
+        for(size_t i = 0; i < n; i+=1){
+            x[i] = cos(3.14159265358979323846 * (i + 0.5) / n);
+            y[i] = exp(x[i]);
+        }
+        const int status = cym_newton_coefficients_d(x, y, n, nodes, coefficients);
+        cym_newton_eval_batch_d(nodes, coefficients, n, t, POINTS, newton);
+        cym_barycentric_weights_d(x, n, weights);
+        cym_barycentric_eval_batch_d(x, y, weights, n, t, POINTS, barycentric);
+
+        double newton_error = 0, barycentric_error = 0, single_error = 0;
+        for(size_t i = 0; i < POINTS; i+=1){
+            const double f = exp(t[i]);
+            if(!(fabs(newton[i] - f) <= newton_error)) newton_error = fabs(newton[i] - f);
+            if(!(fabs(barycentric[i] - f) <= barycentric_error)) barycentric_error = fabs(barycentric[i] - f);
+            const double single = cym_newton_eval_d(nodes, coefficients, n, t[i]);
+            if(!(fabs(single - newton[i]) <= single_error)) single_error = fabs(single - newton[i]);
+        }
+        snprintf(name, sizeof(name), "cym_newton_eval_batch exp, %zu nodes", n);
+        check(name, !status && newton_error < 1e-13 && single_error < 1e-13);
+        snprintf(name, sizeof(name), "cym_barycentric_eval_batch exp, %zu nodes", n);
+        check(name, barycentric_error < 1e-13);
+
+        // ordered in place, the nodes being a permutation of x
+        double in_place_x[MAX_N], in_place_y[MAX_N];
+        memcpy(in_place_x, x, n * sizeof(double));
+        memcpy(in_place_y, y, n * sizeof(double));
+        cym_newton_coefficients_d(in_place_x, in_place_y, n, in_place_x, in_place_y);
+        int permutation = 1;
+        for(size_t i = 0; i < n; i+=1){
+            size_t found = 0;
+            for(size_t j = 0; j < n; j+=1) found += nodes[i] == x[j];
+            permutation &= found == 1;
+        }
+        snprintf(name, sizeof(name), "cym_newton_coefficients in place, %zu nodes", n);
+        check(name, permutation && !memcmp(in_place_x, nodes, n * sizeof(double)) &&
+            !memcmp(in_place_y, coefficients, n * sizeof(double)));
+    }
+
+    // the monomial form of exp on 64 nodes, evaluated by Horner, only loses the conditioning of the basis
+    double x[64], y[64], monomial[64];
+    for(size_t i = 0; i < 64; i+=1){
+        x[i] = cos(3.14159265358979323846 * (i + 0.5) / 64);
+        y[i] = exp(x[i]);
+    }
+    int status = cym_interpol_d(x, y, 64, monomial);
+    double monomial_error = 0;
+    for(size_t i = 0; i < POINTS; i+=1){
+        double r = 0;
+        for(size_t k = 64; k > 0; k-=1) r = r * t[i] + monomial[k - 1];
+        if(!(fabs(r - exp(t[i])) <= monomial_error)) monomial_error = fabs(r - exp(t[i]));
+    }
+    check("cym_interpol exp, 64 nodes", !status && monomial_error < 1e-7);
+
+    // an exact cubic through equispaced nodes given out of order
+    double cx[6] = { 3, -2, 0, 2, -1, 1 }, cy[6], cubic[6];
+    for(size_t i = 0; i < 6; i+=1) cy[i] = 1 - 2 * cx[i] + 0.5 * cx[i] * cx[i] * cx[i];
+    status = cym_interpol_d(cx, cy, 6, cubic);
+    check("cym_interpol cubic", !status && fabs(cubic[0] - 1) < 1e-14 && fabs(cubic[1] + 2) < 1e-14 && fabs(cubic[2]) < 1e-14 &&
+        fabs(cubic[3] - 0.5) < 1e-14 && fabs(cubic[4]) < 1e-14 && fabs(cubic[5]) < 1e-14);
+
+    // no points is the zero polynomial, with nothing written
+    double untouched = 7;
+    check("cym_interpol of no points", cym_interpol_d(cx, cy, 0, &untouched) == 0 && untouched == 7);
+    cym_newton_to_monomial_d(cx, cy, 0, &untouched);
+    check("cym_newton_to_monomial of no coefficients", untouched == 7);
+
+    double repeated[3] = { 0, 1, 1 };
+    check("cym_interpol fails on equal nodes", cym_interpol_d(repeated, cy, 3, cubic) == 1 && cubic[0] != cubic[0]);
+    check("cym_interpol_ws fails without a workspace", cym_interpol_ws_d(cx, cy, 6, cubic, NULL, 0) == 1);
+
+    printf("\n%d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,109 @@
+#define CYMATH_IMPLEMENTATION
+#include "../cymath.h"
+
+#include <math.h>
+#include <string.h>
+#include "check.h"
+
+// checks cym_lm_solve on the Rosenbrock valley and on an exponential fit, and cym_minimize on the same fit
+// cc -O2 test_lm.c -o test_lm -lm -lpthread
+
+// the residuals 1 - x and 10 (y - x^2), whose squares sum to the Rosenbrock function
+static int rosenbrock(const double* params, double* residuals, void* user){
+    (void)user;
+    residuals[0] = 1 - params[0];
+    residuals[1] = 10 * (params[1] - params[0] * params[0]);
+    return 0;
+}
+
+static int rosenbrock_jacobian(const double* params, double* jacobian, void* user){
+    (void)user;
+    jacobian[0] = -1;
+    jacobian[1] = -20 * params[0];
+    jacobian[2] = 0;
+    jacobian[3] = 10;
+    return 0;
+}
+
+// stops the solver at the third call
+static int stopping(const double* params, double* residuals, void* user){
+    *(int*)user += 1;
+    return (*(int*)user >= 3)? 1 : rosenbrock(params, residuals, NULL);
+}
+
+#define POINTS 200
+
+typedef struct Samples{
+    double t[POINTS];
+    double y[POINTS];
+} Samples;
+
+// y = a exp(-b t) + c
+static int decay(const double* params, double* residuals, void* user){
+    const Samples* s = (const Samples*)user;
+    for(size_t i = 0; i < POINTS; i+=1) residuals[i] = params[0] * exp(-params[1] * s->t[i]) + params[2] - s->y[i];
+    return 0;
+}
+
+static double decay_model(double* point){
+    return point[3] * exp(-point[4] * point[0]) + point[5];
+}
+
+int main(void){
+    const char* names[] = {
+        "cym_lm_solve rosenbrock", "cym_lm_solve rosenbrock, differences",
+        "cym_lm_solve rosenbrock, geodesic", "cym_lm_solve rosenbrock, serial"
+    };
+    char name[80];
+    for(int variant = 0; variant < 4; variant+=1){
+        CymLmOptions options;
+        memset(&options, 0, sizeof(options));
+        options.geodesic = variant == 2;
+        options.serial = variant == 3;
+        CymLmResult result;
+        double params[2] = { -1.2, 1 };
+        const int status = cym_lm_solve_d(rosenbrock, (variant & 1)? NULL : rosenbrock_jacobian, NULL, params, 2, 2,
+                                          variant? &options : NULL, &result);
+        snprintf(name, sizeof(name), "%s (%d iterations)", names[variant], result.iterations);
+        check(name, status <= CYM_LM_TARGET_COST && status == result.status && fabs(params[0] - 1) < 1e-8 &&
+            fabs(params[1] - 1) < 1e-8 && result.cost < 1e-20 && fabs(result.initial_cost - 12.1) < 1e-12);
+    }
+
+    CymLmOptions target;
+    memset(&target, 0, sizeof(target));
+    target.target_cost = 1e-3;
+    CymLmResult result;
+    double params[2] = { -1.2, 1 };
+    check("cym_lm_solve stops at the target cost",
+        cym_lm_solve_d(rosenbrock, rosenbrock_jacobian, NULL, params, 2, 2, &target, &result) == CYM_LM_TARGET_COST &&
+        result.cost <= 1e-3);
+
+    int calls = 0;
+    params[0] = -1.2;
+    params[1] = 1;
+    check("cym_lm_solve stops when the residuals ask",
+        cym_lm_solve_d(stopping, rosenbrock_jacobian, &calls, params, 2, 2, NULL, &result) == CYM_LM_STOPPED && calls == 3);
+
+    // 2 exp(-1.5 t) + 0.5 with a little deterministic noise
+    static Samples s;
+    static double data[POINTS * 4];
+    for(size_t i = 0; i < POINTS; i+=1){
+        s.t[i] = 4.0 * i / POINTS;
+        s.y[i] = 2 * exp(-1.5 * s.t[i]) + 0.5 + 1e-3 * sin(7.0 * i);
+        data[4 * i] = s.t[i];
+        data[4 * i + 3] = s.y[i];
+    }
+    double fit[3] = { 1, 1, 0 };
+    const int status = cym_lm_solve_d(decay, NULL, &s, fit, 3, POINTS, NULL, &result);
+    check("cym_lm_solve exponential decay", status <= CYM_LM_TARGET_COST && fabs(fit[0] - 2) < 1e-2 &&
+        fabs(fit[1] - 1.5) < 1e-2 && fabs(fit[2] - 0.5) < 1e-2);
+
+    // cym_minimize passes every point as param_count inputs then y, the inputs beyond t being unused here
+    double fit_minimize[3] = { 1, 1, 0 };
+    cym_minimize_d(data, POINTS, decay_model, fit_minimize, 3);
+    check("cym_minimize matches cym_lm_solve", fabs(fit_minimize[0] - fit[0]) < 1e-8 && fabs(fit_minimize[1] - fit[1]) < 1e-8 &&
+        fabs(fit_minimize[2] - fit[2]) < 1e-8);
+
+    printf("\n%d failures\n", failures);
+    return failures != 0;
+}
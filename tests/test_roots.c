@@ -0,0 +1,87 @@
+#define CYMATH_IMPLEMENTATION
+#include "../cymath.h"
+
+#include <math.h>
+#include "check.h"
+
+// checks the root finders on x^3 - 2x - 5, whose root Wallis used to show Newton's method
+// cc -O2 test_roots.c -o test_roots -lm -lpthread
+
+#define ROOT 2.0945514815423265
+
+static double wallis(double x, void* user){
+    *(int*)user += 1;
+    return x * (x * x - 2) - 5;
+}
+
+static float wallis_f(float x, void* user){
+    (void)user;
+    return x * (x * x - 2) - 5;
+}
+
+static double wallis_plain(double x){
+    return x * (x * x - 2) - 5;
+}
+
+// x^3 - 2x - 5 at the count values of x, the same function for every root of the batch
+static void wallis_batch(const double* x, const size_t* index, double* fx, size_t count, void* user){
+    (void)index;
+    (void)user;
+    for(size_t i = 0; i < count; i+=1) fx[i] = x[i] * (x[i] * x[i] - 2) - 5;
+}
+
+#define BATCH 3000
+
+int main(void){
+    const char* names[] = { "cym_root_bracket brent", "cym_root_bracket illinois" };
+    char name[64];
+    for(int method = CYM_ROOT_BRENT; method <= CYM_ROOT_ILLINOIS; method+=1){
+        CymRootStats stats;
+        int calls = 0;
+        const double root = cym_root_bracket_d(wallis, &calls, 2, 3, 0, 1e-14, method, &stats);
+        snprintf(name, sizeof(name), "%s (%d steps)", names[method], stats.iterations);
+        check(name, stats.status == CYM_ROOT_CONVERGED && fabs(root - ROOT) < 1e-13 && stats.evaluations == (size_t)calls);
+
+        // 2 as the root of x^3 - 2x - 5 = -1, from a bracket given backwards
+        const double shifted = cym_root_bracket_d(wallis, &calls, 3, 1, -1, 1e-14, method, &stats);
+        snprintf(name, sizeof(name), "%s, value and reversed bracket", names[method]);
+        check(name, stats.status == CYM_ROOT_CONVERGED && fabs(shifted - 2) < 1e-13);
+
+        const double none = cym_root_bracket_d(wallis, &calls, 3, 4, 0, 1e-14, method, &stats);
+        snprintf(name, sizeof(name), "%s without a bracket", names[method]);
+        check(name, stats.status == CYM_ROOT_NO_BRACKET && none != none);
+
+        const float root_f = cym_root_bracket_f(wallis_f, NULL, 2, 3, 0, 1e-6f, method, &stats);
+        snprintf(name, sizeof(name), "%s in float", names[method]);
+        check(name, stats.status == CYM_ROOT_CONVERGED && fabsf(root_f - (float)ROOT) < 4e-6f);
+    }
+
+    CymRootStats stats;
+    int calls = 0;
+    const double secant = cym_root_secant_d(wallis, &calls, 10, 1, 0, 1e-14, &stats);
+    snprintf(name, sizeof(name), "cym_root_secant (%d steps)", stats.iterations);
+    check(name, stats.status == CYM_ROOT_CONVERGED && fabs(secant - ROOT) < 1e-13);
+
+    check("cym_newton_method", fabs(cym_newton_method_d(wallis_plain, 1, 0, 1e-12, 1e-3) - ROOT) < 1e-12);
+
+    // x^3 - 2x - 5 = v for values on both sides of 0, each bracketed by [-1, 4] where x^3 - 2x - 5 > -3 only past 1.7
+    static double a[BATCH], b[BATCH], value[BATCH], roots[BATCH];
+    for(size_t i = 0; i < BATCH; i+=1){
+        a[i] = -1;
+        b[i] = 4;
+        value[i] = -3 + 50.0 * i / BATCH;
+    }
+    for(int method = CYM_ROOT_BRENT; method <= CYM_ROOT_ILLINOIS; method+=1){
+        const int status = cym_root_batch_d(wallis_batch, NULL, a, b, value, BATCH, 1e-13, method, roots, &stats);
+        double worst = 0;
+        for(size_t i = 0; i < BATCH; i+=1){
+            const double r = fabs(wallis_plain(roots[i]) - value[i]) / (3 * roots[i] * roots[i] - 2);
+            if(!(r <= worst)) worst = r;
+        }
+        snprintf(name, sizeof(name), "cym_root_batch %s", method? "illinois" : "brent");
+        check(name, !status && stats.failures == 0 && worst < 1e-12);
+    }
+
+    printf("\n%d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,144 @@
+#define CYMATH_IMPLEMENTATION
+#include "../cymath.h"
+
+#include <math.h>
+#include <string.h>
+#include "check.h"
+
+// checks the sparse products against the COO triplets and the iterative solvers on a 2D Poisson problem with a known
+// solution, at every SIMD level the cpu supports
+// cc -O2 test_sparse.c -o test_sparse -lm -lpthread
+
+static double uniform(void){
+    return (double)rand() / RAND_MAX - 0.5;
+}
+
+// \returns the biggest difference between a and b relative to the biggest absolute value of b
+static double difference(const double* a, const double* b, size_t n){
+    double biggest = 0, scale = 0;
+    for(size_t i = 0; i < n; i+=1){
+        const double d = fabs(a[i] - b[i]);
+        if(!(d <= biggest)) biggest = d;
+        if(fabs(b[i]) > scale) scale = fabs(b[i]);
+    }
+    return biggest / scale;
+}
+
+// y = a * x summing the triplets one by one
+static void coo_mv(size_t rows, const unsigned int* ri, const unsigned int* ci, const double* v, size_t count, const double* x,
+    double* y){
+    memset(y, 0, rows * sizeof(double));
+    for(size_t k = 0; k < count; k+=1) y[ri[k]] += v[k] * x[ci[k]];
+}
+
+#define GRID   48
+#define N      (GRID * GRID)
+// lines of the random matrix, long enough for the SIMD gathers
+#define WIDE   300
+#define PER    40
+
+int main(void){
+    // the 5 point laplacian of the grid, plus a first order convection term making it nonsymmetric for BiCGSTAB
+    static unsigned int ri[5 * N], ci[5 * N];
+    static double lv[5 * N], cv[5 * N];
+    size_t count = 0;
+    for(unsigned int i = 0; i < GRID; i+=1){
+        for(unsigned int j = 0; j < GRID; j+=1){
+            const unsigned int r = i * GRID + j;
+            ri[count] = r; ci[count] = r; lv[count] = 4; cv[count] = 4.5; count+=1;
+            if(i > 0)        { ri[count] = r; ci[count] = r - GRID; lv[count] = -1; cv[count] = -1.5; count+=1; }
+            if(i + 1 < GRID) { ri[count] = r; ci[count] = r + GRID; lv[count] = -1; cv[count] = -0.5; count+=1; }
+            if(j > 0)        { ri[count] = r; ci[count] = r - 1;    lv[count] = -1; cv[count] = -1.5; count+=1; }
+            if(j + 1 < GRID) { ri[count] = r; ci[count] = r + 1;    lv[count] = -1; cv[count] = -0.5; count+=1; }
+        }
+    }
+
+    static double x_true[N], b[N], c[N], x[N], y[N], y_ref[N];
+    for(size_t i = 0; i < N; i+=1){
+        const double u = (double)(i / GRID) / GRID, v = (double)(i % GRID) / GRID;
+        x_true[i] = sin(3 * u) * cos(2 * v) + u * v;
+    }
+    coo_mv(N, ri, ci, lv, count, x_true, b);
+    coo_mv(N, ri, ci, cv, count, x_true, c);
+
+    // a random WIDE x WIDE matrix with PER nonzeros a line, given twice to check duplicates are summed
+    static unsigned int wr[2 * WIDE * PER], wc[2 * WIDE * PER];
+    static double wv[2 * WIDE * PER], wx[WIDE], wy[WIDE], wy_ref[WIDE];
+    for(size_t k = 0; k < WIDE * PER; k+=1){
+        wr[k] = wr[k + WIDE * PER] = (unsigned int)(k / PER);
+        wc[k] = wc[k + WIDE * PER] = (unsigned int)(rand() % WIDE);
+        wv[k] = wv[k + WIDE * PER] = uniform();
+    }
+    for(size_t i = 0; i < WIDE; i+=1) wx[i] = uniform();
+    coo_mv(WIDE, wr, wc, wv, 2 * WIDE * PER, wx, wy_ref);
+
+    CymSparse_d laplacian, convection, laplacian_csc, wide, wide_csc, back;
+    check("cym_sparse_from_coo", !cym_sparse_from_coo_d(N, N, ri, ci, lv, count, CYM_SPARSE_CSR, &laplacian) &&
+        !cym_sparse_from_coo_d(N, N, ri, ci, cv, count, CYM_SPARSE_CSR, &convection) &&
+        !cym_sparse_from_coo_d(WIDE, WIDE, wr, wc, wv, 2 * WIDE * PER, CYM_SPARSE_CSR, &wide));
+    check("cym_sparse_convert", !cym_sparse_convert_d(&laplacian, CYM_SPARSE_CSC, &laplacian_csc) &&
+        !cym_sparse_convert_d(&wide, CYM_SPARSE_CSC, &wide_csc) && !cym_sparse_convert_d(&wide_csc, CYM_SPARSE_CSR, &back));
+    check("cym_sparse_convert round trip", back.nonzeros == wide.nonzeros &&
+        !memcmp(back.offsets, wide.offsets, (WIDE + 1) * sizeof(size_t)) &&
+        !memcmp(back.indices, wide.indices, wide.nonzeros * sizeof(unsigned int)) &&
+        !memcmp(back.values, wide.values, wide.nonzeros * sizeof(double)));
+    unsigned int out_of_range = WIDE;
+    CymSparse_d bad;
+    check("cym_sparse_from_coo rejects an index out of the matrix",
+        cym_sparse_from_coo_d(WIDE, WIDE, wr, &out_of_range, wv, 1, CYM_SPARSE_CSR, &bad) == 1);
+
+    // several threads, so the products split their lines over the pool
+    cym_set_num_threads(4);
+    const int best = cym_simd_level();
+    const char* level_names[] = { "scalar", "sse2", "avx2", "avx512" };
+    const char* solver_names[] = { "cg", "bicgstab" };
+    const char* preconditioner_names[] = { "none", "jacobi", "ilu0" };
+    char name[64];
+    for(int level = 0; level <= best; level+=1){
+        cym_simd_set_level(level);
+        printf("\n%s\n", level_names[level]);
+
+        // y = 2 a x - y starting from y = 1, through CSR and CSC
+        for(int csc = 0; csc < 2; csc+=1){
+            for(size_t i = 0; i < N; i+=1) y[i] = 1;
+            cym_sparse_mv_d(2, csc? &laplacian_csc : &laplacian, x_true, -1, y);
+            for(size_t i = 0; i < N; i+=1) y_ref[i] = 2 * b[i] - 1;
+            const double laplacian_error = difference(y, y_ref, N);
+            for(size_t i = 0; i < WIDE; i+=1) wy[i] = 0.0 / 0.0;
+            cym_sparse_mv_d(1, csc? &wide_csc : &wide, wx, 0, wy);
+            snprintf(name, sizeof(name), "cym_sparse_mv %s", csc? "csc" : "csr");
+            check(name, laplacian_error < 1e-14 && difference(wy, wy_ref, WIDE) < 1e-13);
+        }
+
+        for(int solver = 0; solver < 2; solver+=1){
+            for(int preconditioner = CYM_PRECOND_NONE; preconditioner <= CYM_PRECOND_ILU0; preconditioner+=1){
+                for(int problem = 0; problem < 1 + solver; problem+=1){
+                    const CymSparse_d* a = problem? &convection : &laplacian;
+                    CymIterStats stats;
+                    memset(x, 0, sizeof(x));
+                    const int status = solver? cym_sparse_bicgstab_d(a, problem? c : b, x, 1e-12, 0, preconditioner, &stats)
+                                             : cym_sparse_cg_d(a, b, x, 1e-12, 0, preconditioner, &stats);
+                    snprintf(name, sizeof(name), "cym_sparse_%s %s%s (%d iterations)", solver_names[solver],
+                        preconditioner_names[preconditioner], problem? " nonsymmetric" : "", stats.iterations);
+                    check(name, status == CYM_ITER_CONVERGED && stats.residual <= 1e-12 && difference(x, x_true, N) < 1e-9);
+                }
+            }
+        }
+    }
+    cym_simd_set_level(-1);
+
+    // the random matrix lacks most of its diagonal, which the preconditioners need
+    memset(x, 0, sizeof(x));
+    check("cym_sparse_cg fails without a diagonal for jacobi",
+        cym_sparse_cg_d(&wide, wx, x, 1e-12, 0, CYM_PRECOND_JACOBI, NULL) == CYM_ITER_FAILED);
+
+    cym_sparse_free_d(&laplacian);
+    cym_sparse_free_d(&convection);
+    cym_sparse_free_d(&laplacian_csc);
+    cym_sparse_free_d(&wide);
+    cym_sparse_free_d(&wide_csc);
+    cym_sparse_free_d(&back);
+
+    printf("\n%d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,93 @@
+#define CYMBOL_IMPLEMENTATION
+#define CYMTENSOR_IMPLEMENTATION
+#include "../cymtensor.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "check.h"
+
+// checks saving, mapping and slicing tensor files, and that headers the mapping can not trust are rejected
+// cc -O2 test_tensor.c -o test_tensor
+
+#define PATH     "test_tensor.cyt"
+#define CORRUPT  "test_tensor_corrupt.cyt"
+
+// byte offsets of the header fields of a rank 2 tensor
+#define DATA_OFFSET_AT 32
+#define SHAPE_AT       40
+#define STRIDES_AT     56
+
+// copies PATH to CORRUPT with the 8 bytes at offset replaced by value
+static void corrupt(long offset, uint64_t value){
+    static unsigned char bytes[4096];
+    FILE* in = fopen(PATH, "rb");
+    const size_t size = fread(bytes, 1, sizeof(bytes), in);
+    fclose(in);
+    memcpy(bytes + offset, &value, sizeof(value));
+    FILE* out = fopen(CORRUPT, "wb");
+    fwrite(bytes, 1, size, out);
+    fclose(out);
+}
+
+int main(void){
+    double m[6 * 4];
+    for(size_t i = 0; i < 6 * 4; i+=1) m[i] = 0.5 * i - 3;
+    const uint64_t shape[2] = { 6, 4 };
+
+    CymTensor t;
+    check("cym_tensor_save", !cym_tensor_save(PATH, CYMATOM_F64, 2, shape, m));
+    check("cym_tensor_read_header", !cym_tensor_read_header(PATH, &t) && t.atom_type == CYMATOM_F64 && t.rank == 2 &&
+        t.shape[0] == 6 && t.shape[1] == 4 && t.strides[0] == 4 && t.strides[1] == 1 && !t.data &&
+        t.data_offset % CYM_TENSOR_DEFAULT_ALIGNMENT == 0);
+
+    unsigned int rows = 0, columns = 0;
+    int status = cym_tensor_map(PATH, &t, 0);
+    const double* mapped = (const double*) cym_tensor_matrix(&t, CYMATOM_F64, &rows, &columns);
+    check("cym_tensor_map", !status && mapped && rows == 6 && columns == 4 && !memcmp(mapped, m, sizeof(m)));
+    check("cym_tensor_matrix of another type", !cym_tensor_matrix(&t, CYMATOM_F32, NULL, NULL));
+    cym_tensor_unmap(&t);
+
+    // rows 2 to 4, then a slice running past the end being cut to the last row
+    status = cym_tensor_map_slice(PATH, 2, 3, &t, 0);
+    check("cym_tensor_map_slice", !status && t.shape[0] == 3 && !memcmp(t.data, m + 2 * 4, 3 * 4 * sizeof(double)));
+    cym_tensor_unmap(&t);
+    status = cym_tensor_map_slice(PATH, 5, 10, &t, 0);
+    check("cym_tensor_map_slice past the end", !status && t.shape[0] == 1 && !memcmp(t.data, m + 5 * 4, 4 * sizeof(double)));
+    cym_tensor_unmap(&t);
+    check("cym_tensor_map_slice starting past the end", cym_tensor_map_slice(PATH, 7, 1, &t, 0) == 1);
+
+    // the transpose, read through strides and stored contiguously
+    const uint64_t transposed_shape[2] = { 4, 6 };
+    const int64_t transposed_strides[2] = { 1, 4 };
+    status = cym_tensor_save_ex(PATH, CYMATOM_F64, 2, transposed_shape, transposed_strides, 4096, m);
+    status = status || cym_tensor_map(PATH, &t, 0);
+    int transposed = !status && (uintptr_t) t.data % 4096 == 0 && cym_tensor_is_contiguous(&t);
+    for(size_t i = 0; i < 4 && transposed; i+=1){
+        for(size_t j = 0; j < 6; j+=1) transposed &= ((const double*) t.data)[i * 6 + j] == m[j * 4 + i];
+    }
+    check("cym_tensor_save_ex strided", transposed);
+    cym_tensor_unmap(&t);
+
+    // headers that would make the mapping read outside the file or past the address space
+    cym_tensor_save(PATH, CYMATOM_F64, 2, shape, m);
+    corrupt(SHAPE_AT, (uint64_t) 1 << 62);
+    check("cym_tensor_map rejects an overflowing shape", cym_tensor_map(CORRUPT, &t, 0) == 1 &&
+        cym_tensor_read_header(CORRUPT, &t) == 1);
+    corrupt(DATA_OFFSET_AT, 8);
+    check("cym_tensor_map rejects data inside the header", cym_tensor_map(CORRUPT, &t, 0) == 1);
+    corrupt(DATA_OFFSET_AT, UINT64_MAX - 64);
+    check("cym_tensor_map rejects an overflowing data offset", cym_tensor_map(CORRUPT, &t, 0) == 1);
+    corrupt(STRIDES_AT, 1);
+    check("cym_tensor_map rejects strides that are not row major", cym_tensor_map(CORRUPT, &t, 0) == 1);
+    corrupt(SHAPE_AT, 7);
+    check("cym_tensor_map rejects a shape longer than the file", cym_tensor_map(CORRUPT, &t, 0) == 1);
+    corrupt(SHAPE_AT, 3);
+    check("cym_tensor_map accepts a shape shorter than the file", !cym_tensor_map(CORRUPT, &t, 0) && t.shape[0] == 3);
+    cym_tensor_unmap(&t);
+
+    remove(PATH);
+    remove(CORRUPT);
+
+    printf("\n%d failures\n", failures);
+    return failures != 0;
+}